@@ -33,7 +33,9 @@
 #include "TVectorD.h"
 
 #include <cstdio>
+#include <fstream>
 #include <string>
+#include <vector>
 
 // #define USE_FWD_PARAM
 #ifdef USE_FWD_PARAM
@@ -378,6 +380,46 @@ void DelphesO2LutWriter::diagonalise(lutEntry_t& lutEntry)
       lutEntry.eiginv[i][j] = eigenVec[i][j];
 }
 
+bool DelphesO2LutWriter::lutConvertToFlat(const char* inFilename, const char* outFilename)
+{
+  LOGF(info, " --- converting LUT file %s to flat format %s", inFilename, outFilename);
+  std::ifstream inFile(inFilename, std::ifstream::binary);
+  if (!inFile.is_open()) {
+    LOGF(info, " --- cannot open input LUT file %s", inFilename);
+    return false;
+  }
+  lutFlatHeader_t flatHeader;
+  inFile.read(reinterpret_cast<char*>(&flatHeader.lut), sizeof(lutHeader_t));
+  if (inFile.gcount() != sizeof(lutHeader_t) || !flatHeader.lut.check_version()) {
+    LOGF(info, " --- input LUT file %s is not in the original format version %d", inFilename, LUTCOVM_VERSION);
+    return false;
+  }
+  flatHeader.setLayout();
+  std::vector<lutEntry_t> entries(flatHeader.nEntries);
+  const std::streamsize nBytes = flatHeader.nEntries * sizeof(lutEntry_t);
+  inFile.read(reinterpret_cast<char*>(entries.data()), nBytes);
+  if (inFile.gcount() != nBytes) {
+    LOGF(info, " --- troubles reading LUT entries: expected/detected %lld/%lld bytes", static_cast<long long>(nBytes), static_cast<long long>(inFile.gcount()));
+    return false;
+  }
+
+  std::ofstream outFile(outFilename, std::ofstream::binary);
+  if (!outFile.is_open()) {
+    LOGF(info, " --- cannot open output LUT file %s", outFilename);
+    return false;
+  }
+  outFile.write(reinterpret_cast<const char*>(&flatHeader), sizeof(lutFlatHeader_t));
+  const std::vector<char> padding(flatHeader.entryOffset - sizeof(lutFlatHeader_t), 0);
+  outFile.write(padding.data(), padding.size());
+  outFile.write(reinterpret_cast<const char*>(entries.data()), nBytes);
+  if (!outFile.good()) {
+    LOGF(info, " --- troubles writing output LUT file %s", outFilename);
+    return false;
+  }
+  LOGF(info, " --- written %lld entries to flat LUT file %s", static_cast<long long>(flatHeader.nEntries), outFilename);
+  return true;
+}
+
 TGraph* DelphesO2LutWriter::lutRead(const char* filename, int pdg, int what, int vs, float nch, float radius, float eta, float pt)
 {
   LOGF(info, " --- reading LUT file %s", filename);
@@ -60,6 +60,8 @@ class DelphesO2LutWriter
   bool fwdPara(lutEntry_t& lutEntry, float pt = 0.1, float eta = 0.0, float mass = o2::track::pid_constants::sMasses[o2::track::PID::Pion], float Bfield = 0.5);
   void lutWrite(const char* filename = "lutCovm.dat", int pdg = 211, float field = 0.2, size_t itof = 0, size_t otof = 0);
   TGraph* lutRead(const char* filename, int pdg, int what, int vs, float nch = 0., float radius = 0., float eta = 0., float pt = 0.);
+  /// Converts a LUT file from the original format to the flat format, which the track smearer memory-maps
+  static bool lutConvertToFlat(const char* inFilename, const char* outFilename);
 
   o2::fastsim::FastTracker fat;
 
@@ -41,8 +41,17 @@
 #include <CommonConstants/PhysicsConstants.h>
 #include <Framework/Logger.h>
 
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
 #include <map>
 #include <string>
+#include <vector>
 
 namespace o2
 {
@@ -51,6 +60,30 @@ namespace delphes
 
 /*****************************************************************/
 
+TrackSmearer::~TrackSmearer()
+{
+  for (unsigned int ipdg = 0; ipdg < nLUTs; ++ipdg) {
+    unloadTable(ipdg);
+  }
+}
+
+/*****************************************************************/
+
+void TrackSmearer::unloadTable(int ipdg)
+{
+  delete mLUTHeader[ipdg];
+  mLUTHeader[ipdg] = nullptr;
+  mLUTEntry[ipdg] = nullptr;
+  std::vector<lutEntry_t>().swap(mLUTStorage[ipdg]);
+  if (mLUTMapping[ipdg]) {
+    munmap(mLUTMapping[ipdg], mLUTMappingSize[ipdg]);
+    mLUTMapping[ipdg] = nullptr;
+    mLUTMappingSize[ipdg] = 0;
+  }
+}
+
+/*****************************************************************/
+
 bool TrackSmearer::loadTable(int pdg, const char* filename, bool forceReload)
 {
   if (!filename || filename[0] == '\0') {
@@ -63,29 +96,40 @@ bool TrackSmearer::loadTable(int pdg, const char* filename, bool forceReload)
     LOG(info) << " --- LUT table for PDG " << pdg << " has been already loaded with index " << ipdg << std::endl;
     return false;
   }
+  unloadTable(ipdg);
 
   const std::string localFilename = o2::fastsim::GeometryEntry::accessFile(filename, "./.ALICE3/LUTs/", mCcdbManager, 10);
-  mLUTHeader[ipdg] = new lutHeader_t;
 
   std::ifstream lutFile(localFilename, std::ifstream::binary);
   if (!lutFile.is_open()) {
     LOG(info) << " --- cannot open covariance matrix file for PDG " << pdg << ": " << localFilename << std::endl;
-    delete mLUTHeader[ipdg];
-    mLUTHeader[ipdg] = nullptr;
     return false;
   }
-  lutFile.read(reinterpret_cast<char*>(mLUTHeader[ipdg]), sizeof(lutHeader_t));
-  if (lutFile.gcount() != sizeof(lutHeader_t)) {
-    LOG(info) << " --- troubles reading covariance matrix header for PDG " << pdg << ": " << filename << std::endl;
-    LOG(info) << " --- expected/detected " << sizeof(lutHeader_t) << "/" << lutFile.gcount() << std::endl;
-    delete mLUTHeader[ipdg];
-    mLUTHeader[ipdg] = nullptr;
-    return false;
+  char magic[sizeof(lutFlatHeader_t::magic)] = {0};
+  lutFile.read(magic, sizeof(magic));
+  const bool isFlat = lutFile.gcount() == sizeof(magic) && lutFlatHeader_t::isFlat(magic);
+  lutFile.clear();
+  lutFile.seekg(0);
+
+  mLUTHeader[ipdg] = new lutHeader_t;
+  if (isFlat) {
+    lutFile.close();
+    if (!loadFlatTable(ipdg, localFilename)) {
+      unloadTable(ipdg);
+      return false;
+    }
+  } else {
+    lutFile.read(reinterpret_cast<char*>(mLUTHeader[ipdg]), sizeof(lutHeader_t));
+    if (lutFile.gcount() != sizeof(lutHeader_t)) {
+      LOG(info) << " --- troubles reading covariance matrix header for PDG " << pdg << ": " << filename << std::endl;
+      LOG(info) << " --- expected/detected " << sizeof(lutHeader_t) << "/" << lutFile.gcount() << std::endl;
+      unloadTable(ipdg);
+      return false;
+    }
   }
   if (mLUTHeader[ipdg]->version != LUTCOVM_VERSION) {
     LOG(info) << " --- LUT header version mismatch: expected/detected = " << LUTCOVM_VERSION << "/" << mLUTHeader[ipdg]->version << std::endl;
-    delete mLUTHeader[ipdg];
-    mLUTHeader[ipdg] = nullptr;
+    unloadTable(ipdg);
     return false;
   }
   bool specialPdgCase = false;
@@ -101,34 +145,27 @@ bool TrackSmearer::loadTable(int pdg, const char* filename, bool forceReload)
   }
   if (mLUTHeader[ipdg]->pdg != pdg && !specialPdgCase) {
     LOG(info) << " --- LUT header PDG mismatch: expected/detected = " << pdg << "/" << mLUTHeader[ipdg]->pdg << std::endl;
-    delete mLUTHeader[ipdg];
-    mLUTHeader[ipdg] = nullptr;
+    unloadTable(ipdg);
     return false;
   }
-  const int nnch = mLUTHeader[ipdg]->nchmap.nbins;
-  const int nrad = mLUTHeader[ipdg]->radmap.nbins;
-  const int neta = mLUTHeader[ipdg]->etamap.nbins;
-  const int npt = mLUTHeader[ipdg]->ptmap.nbins;
-  mLUTEntry[ipdg] = new lutEntry_t****[nnch];
-  for (int inch = 0; inch < nnch; ++inch) {
-    mLUTEntry[ipdg][inch] = new lutEntry_t***[nrad];
-    for (int irad = 0; irad < nrad; ++irad) {
-      mLUTEntry[ipdg][inch][irad] = new lutEntry_t**[neta];
-      for (int ieta = 0; ieta < neta; ++ieta) {
-        mLUTEntry[ipdg][inch][irad][ieta] = new lutEntry_t*[npt];
-        for (int ipt = 0; ipt < npt; ++ipt) {
-          mLUTEntry[ipdg][inch][irad][ieta][ipt] = new lutEntry_t;
-          lutFile.read(reinterpret_cast<char*>(mLUTEntry[ipdg][inch][irad][ieta][ipt]), sizeof(lutEntry_t));
-          if (lutFile.gcount() != sizeof(lutEntry_t)) {
-            LOG(info) << " --- troubles reading covariance matrix entry for PDG " << pdg << ": " << localFilename << std::endl;
-            LOG(info) << " --- expected/detected " << sizeof(lutHeader_t) << "/" << lutFile.gcount() << std::endl;
-            return false;
-          }
-        }
-      }
+  if (!isFlat) {
+    // the entries of the original format follow the header in the flat order, read them in one go
+    lutFlatHeader_t layout;
+    layout.lut = *mLUTHeader[ipdg];
+    layout.setLayout();
+    std::copy(std::begin(layout.stride), std::end(layout.stride), mLUTStride[ipdg]);
+    mLUTStorage[ipdg].resize(layout.nEntries);
+    const std::streamsize nBytes = layout.nEntries * sizeof(lutEntry_t);
+    lutFile.read(reinterpret_cast<char*>(mLUTStorage[ipdg].data()), nBytes);
+    if (lutFile.gcount() != nBytes) {
+      LOG(info) << " --- troubles reading covariance matrix entries for PDG " << pdg << ": " << localFilename << std::endl;
+      LOG(info) << " --- expected/detected " << nBytes << "/" << lutFile.gcount() << std::endl;
+      unloadTable(ipdg);
+      return false;
     }
+    mLUTEntry[ipdg] = mLUTStorage[ipdg].data();
   }
-  LOG(info) << " --- read covariance matrix table for PDG " << pdg << ": " << filename << std::endl;
+  LOG(info) << " --- read covariance matrix table for PDG " << pdg << ": " << filename << (isFlat ? " (flat, memory-mapped)" : "") << std::endl;
   mLUTHeader[ipdg]->print();
 
   lutFile.close();
@@ -137,7 +174,58 @@ bool TrackSmearer::loadTable(int pdg, const char* filename, bool forceReload)
 
 /*****************************************************************/
 
-lutEntry_t* TrackSmearer::getLUTEntry(const int pdg, const float nch, const float radius, const float eta, const float pt, float& interpolatedEff)
+bool TrackSmearer::loadFlatTable(int ipdg, const std::string& localFilename)
+{
+  const int fd = open(localFilename.c_str(), O_RDONLY);
+  if (fd < 0) {
+    LOG(info) << " --- cannot open flat LUT file: " << localFilename << std::endl;
+    return false;
+  }
+  struct stat fileStat;
+  if (fstat(fd, &fileStat) != 0 || fileStat.st_size < static_cast<off_t>(sizeof(lutFlatHeader_t))) {
+    LOG(info) << " --- troubles reading flat LUT header: " << localFilename << std::endl;
+    close(fd);
+    return false;
+  }
+  void* mapping = mmap(nullptr, fileStat.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (mapping == MAP_FAILED) {
+    LOG(info) << " --- cannot memory-map flat LUT file: " << localFilename << std::endl;
+    return false;
+  }
+  mLUTMapping[ipdg] = mapping;
+  mLUTMappingSize[ipdg] = fileStat.st_size;
+
+  const auto* flatHeader = static_cast<const lutFlatHeader_t*>(mapping);
+  if (!flatHeader->check_version()) {
+    LOG(info) << " --- flat LUT version mismatch: expected/detected = " << LUTFLAT_VERSION << "/" << flatHeader->version
+              << ", entry size " << sizeof(lutEntry_t) << "/" << flatHeader->entrySize << std::endl;
+    return false;
+  }
+  // the last entry addressed by the strides must be inside the file
+  const int nBins[4] = {flatHeader->lut.nchmap.nbins, flatHeader->lut.radmap.nbins, flatHeader->lut.etamap.nbins, flatHeader->lut.ptmap.nbins};
+  int64_t lastEntry = 0;
+  for (int i = 0; i < 4; ++i) {
+    if (nBins[i] < 1 || flatHeader->stride[i] < 0) {
+      lastEntry = flatHeader->nEntries;
+      break;
+    }
+    lastEntry += (nBins[i] - 1) * flatHeader->stride[i];
+  }
+  if (flatHeader->entryOffset < static_cast<int64_t>(sizeof(lutFlatHeader_t)) || flatHeader->entryOffset % alignof(lutEntry_t) != 0 ||
+      lastEntry >= flatHeader->nEntries || flatHeader->entryOffset + flatHeader->nEntries * static_cast<int64_t>(sizeof(lutEntry_t)) > fileStat.st_size) {
+    LOG(info) << " --- inconsistent flat LUT layout: " << localFilename << std::endl;
+    return false;
+  }
+  *mLUTHeader[ipdg] = flatHeader->lut;
+  std::copy(std::begin(flatHeader->stride), std::end(flatHeader->stride), mLUTStride[ipdg]);
+  mLUTEntry[ipdg] = reinterpret_cast<const lutEntry_t*>(static_cast<const char*>(mapping) + flatHeader->entryOffset);
+  return true;
+}
+
+/*****************************************************************/
+
+const lutEntry_t* TrackSmearer::getLUTEntry(const int pdg, const float nch, const float radius, const float eta, const float pt, float& interpolatedEff)
 {
   const int ipdg = getIndexPDG(pdg);
   if (!mLUTHeader[ipdg]) {
@@ -148,6 +236,8 @@ lutEntry_t* TrackSmearer::getLUTEntry(const int pdg, const float nch, const floa
   auto irad = mLUTHeader[ipdg]->radmap.find(radius);
   auto ieta = mLUTHeader[ipdg]->etamap.find(eta);
   auto ipt = mLUTHeader[ipdg]->ptmap.find(pt);
+  const int64_t* stride = mLUTStride[ipdg];
+  const lutEntry_t* lutEntry = mLUTEntry[ipdg] + inch * stride[0] + irad * stride[1] + ieta * stride[2] + ipt * stride[3];
 
   // Interpolate if requested
   auto fraction = mLUTHeader[ipdg]->nchmap.fracPositionWithinBin(nch);
@@ -157,16 +247,16 @@ lutEntry_t* TrackSmearer::getLUTEntry(const int pdg, const float nch, const floa
       switch (mWhatEfficiency) {
         case 1:
           if (inch < mLUTHeader[ipdg]->nchmap.nbins - 1) {
-            interpolatedEff = (1.5f - fraction) * mLUTEntry[ipdg][inch][irad][ieta][ipt]->eff + (-0.5f + fraction) * mLUTEntry[ipdg][inch + 1][irad][ieta][ipt]->eff;
+            interpolatedEff = (1.5f - fraction) * lutEntry->eff + (-0.5f + fraction) * lutEntry[stride[0]].eff;
           } else {
-            interpolatedEff = mLUTEntry[ipdg][inch][irad][ieta][ipt]->eff;
+            interpolatedEff = lutEntry->eff;
           }
           break;
         case 2:
           if (inch < mLUTHeader[ipdg]->nchmap.nbins - 1) {
-            interpolatedEff = (1.5f - fraction) * mLUTEntry[ipdg][inch][irad][ieta][ipt]->eff2 + (-0.5f + fraction) * mLUTEntry[ipdg][inch + 1][irad][ieta][ipt]->eff2;
+            interpolatedEff = (1.5f - fraction) * lutEntry->eff2 + (-0.5f + fraction) * lutEntry[stride[0]].eff2;
           } else {
-            interpolatedEff = mLUTEntry[ipdg][inch][irad][ieta][ipt]->eff2;
+            interpolatedEff = lutEntry->eff2;
           }
           break;
         default:
@@ -177,16 +267,16 @@ lutEntry_t* TrackSmearer::getLUTEntry(const int pdg, const float nch, const floa
       switch (mWhatEfficiency) {
         case 1:
           if (inch > 0 && comparisonValue < mLUTHeader[ipdg]->nchmap.max) {
-            interpolatedEff = (0.5f + fraction) * mLUTEntry[ipdg][inch][irad][ieta][ipt]->eff + (0.5f - fraction) * mLUTEntry[ipdg][inch - 1][irad][ieta][ipt]->eff;
+            interpolatedEff = (0.5f + fraction) * lutEntry->eff + (0.5f - fraction) * lutEntry[-stride[0]].eff;
           } else {
-            interpolatedEff = mLUTEntry[ipdg][inch][irad][ieta][ipt]->eff;
+            interpolatedEff = lutEntry->eff;
           }
           break;
         case 2:
           if (inch > 0 && comparisonValue < mLUTHeader[ipdg]->nchmap.max) {
-            interpolatedEff = (0.5f + fraction) * mLUTEntry[ipdg][inch][irad][ieta][ipt]->eff2 + (0.5f - fraction) * mLUTEntry[ipdg][inch - 1][irad][ieta][ipt]->eff2;
+            interpolatedEff = (0.5f + fraction) * lutEntry->eff2 + (0.5f - fraction) * lutEntry[-stride[0]].eff2;
           } else {
-            interpolatedEff = mLUTEntry[ipdg][inch][irad][ieta][ipt]->eff2;
+            interpolatedEff = lutEntry->eff2;
           }
           break;
         default:
@@ -196,21 +286,21 @@ lutEntry_t* TrackSmearer::getLUTEntry(const int pdg, const float nch, const floa
   } else {
     switch (mWhatEfficiency) {
       case 1:
-        interpolatedEff = mLUTEntry[ipdg][inch][irad][ieta][ipt]->eff;
+        interpolatedEff = lutEntry->eff;
         break;
       case 2:
-        interpolatedEff = mLUTEntry[ipdg][inch][irad][ieta][ipt]->eff2;
+        interpolatedEff = lutEntry->eff2;
         break;
       default:
         LOG(fatal) << " --- getLUTEntry: unknown efficiency type " << mWhatEfficiency;
     }
   }
-  return mLUTEntry[ipdg][inch][irad][ieta][ipt];
+  return lutEntry;
 } //;
 
 /*****************************************************************/
 
-bool TrackSmearer::smearTrack(O2Track& o2track, lutEntry_t* lutEntry, float interpolatedEff)
+bool TrackSmearer::smearTrack(O2Track& o2track, const lutEntry_t* lutEntry, float interpolatedEff)
 {
   bool isReconstructed = true;
   // generate efficiency
@@ -274,7 +364,7 @@ bool TrackSmearer::smearTrack(O2Track& o2track, int pdg, float nch)
   }
   auto eta = o2track.getEta();
   float interpolatedEff = 0.0f;
-  lutEntry_t* lutEntry = getLUTEntry(pdg, nch, 0., eta, pt, interpolatedEff);
+  const lutEntry_t* lutEntry = getLUTEntry(pdg, nch, 0., eta, pt, interpolatedEff);
   if (!lutEntry || !lutEntry->valid)
     return false;
   return smearTrack(o2track, lutEntry, interpolatedEff);
@@ -285,7 +375,7 @@ bool TrackSmearer::smearTrack(O2Track& o2track, int pdg, float nch)
 double TrackSmearer::getPtRes(const int pdg, const float nch, const float eta, const float pt)
 {
   float dummy = 0.0f;
-  lutEntry_t* lutEntry = getLUTEntry(pdg, nch, 0., eta, pt, dummy);
+  const lutEntry_t* lutEntry = getLUTEntry(pdg, nch, 0., eta, pt, dummy);
   auto val = std::sqrt(lutEntry->covm[14]) * lutEntry->pt;
   return val;
 }
@@ -295,7 +385,7 @@ double TrackSmearer::getPtRes(const int pdg, const float nch, const float eta, c
 double TrackSmearer::getEtaRes(const int pdg, const float nch, const float eta, const float pt)
 {
   float dummy = 0.0f;
-  lutEntry_t* lutEntry = getLUTEntry(pdg, nch, 0., eta, pt, dummy);
+  const lutEntry_t* lutEntry = getLUTEntry(pdg, nch, 0., eta, pt, dummy);
   auto sigmatgl = std::sqrt(lutEntry->covm[9]);                                  // sigmatgl2
   auto etaRes = std::fabs(std::sin(2.0 * std::atan(std::exp(-eta)))) * sigmatgl; // propagate tgl to eta uncertainty
   etaRes /= lutEntry->eta;                                                       // relative uncertainty
@@ -306,7 +396,7 @@ double TrackSmearer::getEtaRes(const int pdg, const float nch, const float eta,
 double TrackSmearer::getAbsPtRes(const int pdg, const float nch, const float eta, const float pt)
 {
   float dummy = 0.0f;
-  lutEntry_t* lutEntry = getLUTEntry(pdg, nch, 0., eta, pt, dummy);
+  const lutEntry_t* lutEntry = getLUTEntry(pdg, nch, 0., eta, pt, dummy);
   auto val = std::sqrt(lutEntry->covm[14]) * lutEntry->pt * lutEntry->pt;
   return val;
 }
@@ -316,7 +406,7 @@ double TrackSmearer::getAbsPtRes(const int pdg, const float nch, const float eta
 double TrackSmearer::getAbsEtaRes(const int pdg, const float nch, const float eta, const float pt)
 {
   float dummy = 0.0f;
-  lutEntry_t* lutEntry = getLUTEntry(pdg, nch, 0., eta, pt, dummy);
+  const lutEntry_t* lutEntry = getLUTEntry(pdg, nch, 0., eta, pt, dummy);
   auto sigmatgl = std::sqrt(lutEntry->covm[9]);                                  // sigmatgl2
   auto etaRes = std::fabs(std::sin(2.0 * std::atan(std::exp(-eta)))) * sigmatgl; // propagate tgl to eta uncertainty
   return etaRes;
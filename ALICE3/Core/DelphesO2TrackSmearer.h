@@ -29,11 +29,14 @@
 
 #include <TRandom.h>
 
+#include <cstdint>
 #include <cstdio>
+#include <cstring>
 #include <fstream>
 #include <iostream>
 #include <map>
 #include <string>
+#include <vector>
 
 ///////////////////////////////
 /// DelphesO2/src/lutCovm.hh //
@@ -150,6 +153,40 @@ struct lutEntry_t {
   }
 };
 
+/// Flat LUT format: a lutFlatHeader_t followed, entryOffset bytes from the start of the file, by all
+/// the lutEntry_t of the table stored contiguously in (nch, radius, eta, pt) order, pt running fastest.
+/// The entry of bins (inch, irad, ieta, ipt) is at inch * stride[0] + irad * stride[1] + ieta * stride[2] + ipt * stride[3].
+/// Files in this format are memory-mapped read-only, so that the pages are shared between processes.
+#define LUTFLAT_VERSION 1
+
+struct lutFlatHeader_t {
+  static constexpr int kAlignment = 64; // alignment of the first entry in the file, in bytes
+
+  char magic[8] = {'L', 'U', 'T', 'F', 'L', 'A', 'T', '\0'};
+  int version = LUTFLAT_VERSION;
+  int entrySize = sizeof(lutEntry_t); // size of one entry, in bytes
+  int64_t entryOffset = 0;            // offset of the first entry from the start of the file, in bytes
+  int64_t nEntries = 0;               // number of entries
+  int64_t stride[4] = {0, 0, 0, 0};   // distance between consecutive nch, radius, eta and pt bins, in entries
+  lutHeader_t lut;                    // header of the table
+
+  static bool isFlat(const char* bytes) { return std::memcmp(bytes, "LUTFLAT", 8) == 0; }
+  bool check_version() const
+  {
+    return isFlat(magic) && version == LUTFLAT_VERSION && entrySize == static_cast<int>(sizeof(lutEntry_t));
+  } //;
+  /// Sets the strides, number of entries and entry offset from the binning of lut
+  void setLayout()
+  {
+    stride[3] = 1;
+    stride[2] = stride[3] * lut.ptmap.nbins;
+    stride[1] = stride[2] * lut.etamap.nbins;
+    stride[0] = stride[1] * lut.radmap.nbins;
+    nEntries = stride[0] * lut.nchmap.nbins;
+    entryOffset = (sizeof(lutFlatHeader_t) + kAlignment - 1) / kAlignment * kAlignment;
+  } //;
+};
+
 ////////////////////////////////////
 /// DelphesO2/src/TrackSmearer.hh //
 ////////////////////////////////////
@@ -177,9 +214,12 @@ class TrackSmearer
 
  public:
   TrackSmearer() = default;
-  ~TrackSmearer() = default;
+  ~TrackSmearer();
+  TrackSmearer(const TrackSmearer&) = delete;
+  TrackSmearer& operator=(const TrackSmearer&) = delete;
 
   /** LUT methods **/
+  /// Loads a LUT in the original format (read into memory) or in the flat format (memory-mapped read-only)
   bool loadTable(int pdg, const char* filename, bool forceReload = false);
   bool hasTable(int pdg) { return (mLUTHeader[getIndexPDG(pdg)] != nullptr); } //;
   void useEfficiency(bool val) { mUseEfficiency = val; }                       //;
@@ -187,9 +227,9 @@ class TrackSmearer
   void skipUnreconstructed(bool val) { mSkipUnreconstructed = val; }           //;
   void setWhatEfficiency(int val) { mWhatEfficiency = val; }                   //;
   lutHeader_t* getLUTHeader(int pdg) { return mLUTHeader[getIndexPDG(pdg)]; }  //;
-  lutEntry_t* getLUTEntry(const int pdg, const float nch, const float radius, const float eta, const float pt, float& interpolatedEff);
+  const lutEntry_t* getLUTEntry(const int pdg, const float nch, const float radius, const float eta, const float pt, float& interpolatedEff);
 
-  bool smearTrack(O2Track& o2track, lutEntry_t* lutEntry, float interpolatedEff);
+  bool smearTrack(O2Track& o2track, const lutEntry_t* lutEntry, float interpolatedEff);
   bool smearTrack(O2Track& o2track, int pdg, float nch);
   // bool smearTrack(Track& track, bool atDCA = true); // Only in DelphesO2
   double getPtRes(const int pdg, const float nch, const float eta, const float pt);
@@ -255,7 +295,11 @@ class TrackSmearer
  protected:
   static constexpr unsigned int nLUTs = 9; // Number of LUT available
   lutHeader_t* mLUTHeader[nLUTs] = {nullptr};
-  lutEntry_t***** mLUTEntry[nLUTs] = {nullptr};
+  const lutEntry_t* mLUTEntry[nLUTs] = {nullptr}; // first entry of each table, see lutFlatHeader_t for the layout
+  int64_t mLUTStride[nLUTs][4] = {{0}};           // distance between consecutive nch, radius, eta and pt bins, in entries
+  std::vector<lutEntry_t> mLUTStorage[nLUTs];     // entries of the tables read from the original format
+  void* mLUTMapping[nLUTs] = {nullptr};           // memory mapping of the tables read from the flat format
+  size_t mLUTMappingSize[nLUTs] = {0};
   bool mUseEfficiency = true;
   bool mInterpolateEfficiency = false;
   bool mSkipUnreconstructed = true; // don't smear tracks that are not reco'ed
@@ -263,6 +307,8 @@ class TrackSmearer
   float mdNdEta = 1600.;
 
  private:
+  void unloadTable(int ipdg);
+  bool loadFlatTable(int ipdg, const std::string& localFilename);
   o2::ccdb::BasicCCDBManager* mCcdbManager = nullptr;
 };
 
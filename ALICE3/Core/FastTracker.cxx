@@ -22,11 +22,15 @@
 #include <TMatrixDSymEigen.h>
 #include <TObject.h>
 #include <TRandom.h>
+#include <TRandom3.h>
 #include <TSystem.h>
 
+#include <algorithm>
 #include <chrono>
 #include <fstream>
+#include <functional>
 #include <map>
+#include <span>
 #include <string>
 #include <thread>
 #include <vector>
@@ -58,6 +62,7 @@ DetLayer* FastTracker::AddLayer(TString name, float r, float z, float x0, float
   }
   // Add the new layer to the layers vector
   layers.push_back(newLayer);
+  mLayerConstantsValid = false;
   // Return the last added layer
   return &layers.back();
 }
@@ -70,6 +75,7 @@ void FastTracker::addDeadPhiRegionInLayer(const std::string& layerName, float ph
     return;
   }
   layers[layerIdx].addDeadPhiRegion(phiStart, phiEnd);
+  mLayerConstantsValid = false;
 }
 
 int FastTracker::GetLayerIndex(const std::string& name) const
@@ -290,24 +296,104 @@ float FastTracker::ProbGoodChiSqHit(float radius, float searchRadiusRPhi, float
 // returns number of intercepts (generic for now)
 int FastTracker::FastTrack(o2::track::TrackParCov inputTrack, o2::track::TrackParCov& outputTrack, const float nch, const float maxRadius)
 {
-  dNdEtaCent = nch; // set the number of charged particles per unit rapidity
-  hits.clear();
-  nIntercepts = 0;
-  nSiliconPoints = 0;
-  nGasPoints = 0;
+  updateLayerConstants(nch);
+  const int status = fastTrack(inputTrack, outputTrack, maxRadius, mLastTrack, gRandom);
+  covMatOK += mLastTrack.covMatOK;
+  covMatNotOK += mLastTrack.covMatNotOK;
+  mLastTrack.covMatOK = mLastTrack.covMatNotOK = 0;
+  return status;
+}
+
+void FastTracker::FastTrackBatch(std::span<const o2::track::TrackParCov> inputTracks, BatchOutput& output, const float nch, const float maxRadius, const int nThreads)
+{
+  updateLayerConstants(nch);
+  const size_t nTracks = inputTracks.size();
+  output.tracks.resize(nTracks);
+  output.status.resize(nTracks);
+  output.nSiliconPoints.resize(nTracks);
+  output.nGasPoints.resize(nTracks);
+  output.goodHitProbability.resize(nTracks);
+
+  auto processChunk = [&](size_t first, size_t last, TrackScratch& scratch, TRandom* random) {
+    for (size_t i = first; i < last; ++i) {
+      o2::track::TrackParCov inputTrack(inputTracks[i]);
+      output.status[i] = fastTrack(inputTrack, output.tracks[i], maxRadius, scratch, random);
+      output.nSiliconPoints[i] = scratch.nSiliconPoints;
+      output.nGasPoints[i] = scratch.nGasPoints;
+      output.goodHitProbability[i] = scratch.goodHitProbability.empty() ? 0.f : scratch.goodHitProbability[0];
+    }
+  };
+
+  const size_t nChunks = std::min<size_t>(std::max(nThreads, 1), nTracks);
+  if (nChunks <= 1) {
+    processChunk(0, nTracks, mLastTrack, gRandom);
+    covMatOK += mLastTrack.covMatOK;
+    covMatNotOK += mLastTrack.covMatNotOK;
+    mLastTrack.covMatOK = mLastTrack.covMatNotOK = 0;
+    return;
+  }
+
+  mThreadScratch.resize(nChunks);
+  std::vector<std::thread> threads;
+  threads.reserve(nChunks);
+  for (size_t iChunk = 0; iChunk < nChunks; ++iChunk) {
+    TrackScratch& scratch = mThreadScratch[iChunk];
+    scratch.random.SetSeed(gRandom->Integer(kMaxUInt - 1) + 1); // seeds drawn in order, for reproducibility
+    threads.emplace_back(processChunk, nTracks * iChunk / nChunks, nTracks * (iChunk + 1) / nChunks, std::ref(scratch), &scratch.random);
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (auto& scratch : mThreadScratch) {
+    covMatOK += scratch.covMatOK;
+    covMatNotOK += scratch.covMatNotOK;
+    scratch.covMatOK = scratch.covMatNotOK = 0;
+  }
+}
+
+void FastTracker::updateLayerConstants(const float nch)
+{
+  const int multiplicity = nch; // number of charged particles per unit rapidity, as used by HitDensity
+  if (mLayerConstantsValid && multiplicity == dNdEtaCent) {
+    return;
+  }
+  dNdEtaCent = multiplicity;
+  mLayerConstantsValid = true;
+  mLayerConstants.resize(layers.size());
+  mFirstActiveLayer = -1;
+  for (size_t i = 0; i < layers.size(); ++i) {
+    const DetLayer& layer = layers[i];
+    LayerConstants& constants = mLayerConstants[i];
+    constants.radius = layer.getRadius();
+    constants.z = layer.getZ();
+    constants.x0 = layer.getRadiationLength();
+    constants.xrho = layer.getDensity();
+    constants.resRPhi2 = layer.getResolutionRPhi() * layer.getResolutionRPhi();
+    constants.resZ2 = layer.getResolutionZ() * layer.getResolutionZ();
+    constants.inert = layer.isInert();
+    constants.silicon = layer.isSilicon();
+    constants.gas = layer.isGas();
+    constants.hasDeadPhiRegions = layer.getDeadPhiRegions() != nullptr;
+    constants.hitDensity = constants.inert ? 0.f : HitDensity(constants.radius * 100);
+    if (mFirstActiveLayer < 0 && !constants.inert) {
+      mFirstActiveLayer = i;
+    }
+  }
+}
+
+// propagates inputTrack (modified) through the layers and fills outputTrack, using the layer constants of the current call
+int FastTracker::fastTrack(o2::track::TrackParCov& inputTrack, o2::track::TrackParCov& outputTrack, const float maxRadius, TrackScratch& scratch, TRandom* random)
+{
+  scratch.hits.clear();
+  scratch.nIntercepts = 0;
+  scratch.nSiliconPoints = 0;
+  scratch.nGasPoints = 0;
   std::array<float, 3> posIni; // provision for != PV
   inputTrack.getXYZGlo(posIni);
   const float initialRadius = std::hypot(posIni[0], posIni[1]);
   const float kTrackingMargin = 0.1;
 
-  int firstActiveLayer = -1; // first layer that is not inert
-  for (size_t i = 0; i < layers.size(); ++i) {
-    if (!layers[i].isInert()) {
-      firstActiveLayer = i;
-      break;
-    }
-  }
-  if (firstActiveLayer < 0) {
+  if (mFirstActiveLayer < 0) {
     LOG(fatal) << "No active layers found in FastTracker, check layer setup";
     return -2; // no active layers
   }
@@ -318,10 +404,8 @@ int FastTracker::FastTrack(o2::track::TrackParCov inputTrack, o2::track::TrackPa
   // but does not count all points in the tpc as layers which we do here
   // Loop over all the added layers to prevent crash when adding the tpc
   // Should not affect efficiency calculation
-  goodHitProbability.clear();
-  for (size_t i = 0; i < layers.size(); ++i) {
-    goodHitProbability.push_back(-1.);
-  }
+  std::vector<float>& goodHitProbability = scratch.goodHitProbability;
+  goodHitProbability.assign(layers.size(), -1.f);
   goodHitProbability[0] = 1.; // we use layer zero to accumulate
 
   // +-~-<*>-~-+-~-<*>-~-+-~-<*>-~-+-~-<*>-~-+-~-<*>-~-+
@@ -330,12 +414,13 @@ int FastTracker::FastTrack(o2::track::TrackParCov inputTrack, o2::track::TrackPa
   int lastLayerReached = -1;
   new (&outputTrack)(o2::track::TrackParCov)(inputTrack);
   for (size_t il = 0; il < layers.size(); il++) {
+    const LayerConstants& layer = mLayerConstants[il];
     // check if layer is doable
-    if (layers[il].getRadius() < initialRadius) {
+    if (layer.radius < initialRadius) {
       continue; // this layer should not be attempted, but go ahead
     }
 
-    if (layers[il].getRadius() > maxRadius) {
+    if (layer.radius > maxRadius) {
       if (lastLayerReached == -1) {
         // This means that we didn't reach the first layer
         return -9;
@@ -345,19 +430,19 @@ int FastTracker::FastTrack(o2::track::TrackParCov inputTrack, o2::track::TrackPa
 
     // check if layer is reached
     float targetX = 1e+3;
-    inputTrack.getXatLabR(layers[il].getRadius(), targetX, magneticField);
+    inputTrack.getXatLabR(layer.radius, targetX, magneticField);
     if (targetX > 999.f) {
-      LOGF(debug, "Failed to find intercept for layer %d at radius %.2f cm", il, layers[il].getRadius());
+      LOGF(debug, "Failed to find intercept for layer %d at radius %.2f cm", il, layer.radius);
       break; // failed to find intercept
     }
 
     bool ok = inputTrack.propagateTo(targetX, magneticField);
-    if (ok && mApplyMSCorrection && layers[il].getRadiationLength() > 0) {
-      ok = inputTrack.correctForMaterial(layers[il].getRadiationLength(), 0, applyAngularCorrection);
+    if (ok && mApplyMSCorrection && layer.x0 > 0) {
+      ok = inputTrack.correctForMaterial(layer.x0, 0, applyAngularCorrection);
     }
-    if (ok && mApplyElossCorrection && layers[il].getDensity() > 0) { // correct in small steps
+    if (ok && mApplyElossCorrection && layer.xrho > 0) { // correct in small steps
       for (int ise = xrhosteps; ise--;) {
-        ok = inputTrack.correctForMaterial(0, -layers[il].getDensity() / xrhosteps, applyAngularCorrection);
+        ok = inputTrack.correctForMaterial(0, -layer.xrho / xrhosteps, applyAngularCorrection);
         if (!ok)
           break;
       }
@@ -367,7 +452,7 @@ int FastTracker::FastTrack(o2::track::TrackParCov inputTrack, o2::track::TrackPa
     // was there a problem on this layer?
     if (!ok && il > 0) { // may fail to reach target layer due to the eloss
       float rad2 = inputTrack.getX() * inputTrack.getX() + inputTrack.getY() * inputTrack.getY();
-      float maxR = layers[il - 1].getRadius() + kTrackingMargin * 2;
+      float maxR = mLayerConstants[il - 1].radius + kTrackingMargin * 2;
       float minRad = (fMinRadTrack > 0 && fMinRadTrack < maxR) ? fMinRadTrack : maxR;
       if (rad2 - minRad * minRad < kTrackingMargin * kTrackingMargin) { // check previously reached layer
         return -5;                                                      // did not reach min requested layer
@@ -376,18 +461,18 @@ int FastTracker::FastTrack(o2::track::TrackParCov inputTrack, o2::track::TrackPa
       }
     }
 
-    if (std::abs(inputTrack.getZ()) > layers[il].getZ() && mApplyZacceptance) {
+    if (std::abs(inputTrack.getZ()) > layer.z && mApplyZacceptance) {
       break; // out of acceptance bounds
     }
 
-    if (layers[il].isInert()) {
+    if (layer.inert) {
       if (mVerboseLevel > 0) {
-        LOG(info) << "Skipping inert layer: " << layers[il].getName() << " at radius " << layers[il].getRadius() << " cm";
+        LOG(info) << "Skipping inert layer: " << layers[il].getName() << " at radius " << layer.radius << " cm";
       }
       continue; // inert layer, skip
     }
 
-    if (layers[il].isInDeadPhiRegion(inputTrack.getPhi())) {
+    if (layer.hasDeadPhiRegions && layers[il].isInDeadPhiRegion(inputTrack.getPhi())) {
       LOGF(debug, "Track is in dead region of layer %d", il);
       continue; // dead region, skip
     }
@@ -398,7 +483,7 @@ int FastTracker::FastTrack(o2::track::TrackParCov inputTrack, o2::track::TrackPa
       firstLayerReached = il;
     }
     lastLayerReached = il;
-    nIntercepts++;
+    scratch.nIntercepts++;
   }
 
   // +-~-<*>-~-+-~-<*>-~-+-~-<*>-~-+-~-<*>-~-+-~-<*>-~-+
@@ -427,9 +512,10 @@ int FastTracker::FastTrack(o2::track::TrackParCov inputTrack, o2::track::TrackPa
   // +-~-<*>-~-+-~-<*>-~-+-~-<*>-~-+-~-<*>-~-+-~-<*>-~-+
   // Inward pass to calculate covariances
   for (int il = lastLayerReached; il >= firstLayerReached; il--) {
+    const LayerConstants& layer = mLayerConstants[il];
 
     float targetX = 1e+3;
-    inputTrack.getXatLabR(layers[il].getRadius(), targetX, magneticField);
+    inputTrack.getXatLabR(layer.radius, targetX, magneticField);
     if (targetX > 999)
       continue; // failed to find intercept
 
@@ -437,14 +523,13 @@ int FastTracker::FastTrack(o2::track::TrackParCov inputTrack, o2::track::TrackPa
       continue; // failed to propagate
     }
 
-    if (std::abs(inputTrack.getZ()) > layers[il].getZ() && mApplyZacceptance) {
+    if (std::abs(inputTrack.getZ()) > layer.z && mApplyZacceptance) {
       continue; // out of acceptance bounds but continue inwards
     }
 
     // get perfect data point position
     std::array<float, 3> spacePoint;
     inputTrack.getXYZGlo(spacePoint);
-    std::vector<float> thisHit = {spacePoint[0], spacePoint[1], spacePoint[2]};
 
     // towards adding cluster: move to track alpha
     float alpha = inwardTrack.getAlpha();
@@ -457,47 +542,49 @@ int FastTracker::FastTrack(o2::track::TrackParCov inputTrack, o2::track::TrackPa
       continue;
     }
 
-    if (!layers[il].isInert()) { // only update covm for tracker hits
+    if (!layer.inert) { // only update covm for tracker hits
       const o2::track::TrackParametrization<float>::dim2_t hitpoint = {
         static_cast<float>(xyz1[1]),
         static_cast<float>(xyz1[2])};
-      const o2::track::TrackParametrization<float>::dim3_t hitpointcov = {layers[il].getResolutionRPhi() * layers[il].getResolutionRPhi(), 0.f, layers[il].getResolutionZ() * layers[il].getResolutionZ()};
+      const o2::track::TrackParametrization<float>::dim3_t hitpointcov = {layer.resRPhi2, 0.f, layer.resZ2};
 
       inwardTrack.update(hitpoint, hitpointcov);
       inwardTrack.checkCovariance();
     }
 
-    if (mApplyMSCorrection && layers[il].getRadiationLength() > 0) {
-      if (!inputTrack.correctForMaterial(layers[il].getRadiationLength(), 0, applyAngularCorrection)) {
+    if (mApplyMSCorrection && layer.x0 > 0) {
+      if (!inputTrack.correctForMaterial(layer.x0, 0, applyAngularCorrection)) {
         return -6;
       }
-      if (!inwardTrack.correctForMaterial(layers[il].getRadiationLength(), 0, applyAngularCorrection)) {
+      if (!inwardTrack.correctForMaterial(layer.x0, 0, applyAngularCorrection)) {
         return -6;
       }
     }
-    if (mApplyElossCorrection && layers[il].getDensity() > 0) {
+    if (mApplyElossCorrection && layer.xrho > 0) {
       for (int ise = xrhosteps; ise--;) { // correct in small steps
-        if (!inputTrack.correctForMaterial(0, layers[il].getDensity() / xrhosteps, applyAngularCorrection)) {
+        if (!inputTrack.correctForMaterial(0, layer.xrho / xrhosteps, applyAngularCorrection)) {
           return -7;
         }
-        if (!inwardTrack.correctForMaterial(0, layers[il].getDensity() / xrhosteps, applyAngularCorrection)) {
+        if (!inwardTrack.correctForMaterial(0, layer.xrho / xrhosteps, applyAngularCorrection)) {
           return -7;
         }
       }
     }
 
-    if (layers[il].isSilicon()) {
-      nSiliconPoints++; // count silicon hits
+    if (layer.silicon) {
+      scratch.nSiliconPoints++; // count silicon hits
     }
-    if (layers[il].isGas()) {
-      nGasPoints++; // count TPC/gas hits
+    if (layer.gas) {
+      scratch.nGasPoints++; // count TPC/gas hits
     }
 
-    hits.push_back(thisHit);
-    if (!layers[il].isInert()) { // good hit probability calculation
-      float sigYCmb = o2::math_utils::sqrt(inwardTrack.getSigmaY2() + layers[il].getResolutionRPhi() * layers[il].getResolutionRPhi());
-      float sigZCmb = o2::math_utils::sqrt(inwardTrack.getSigmaZ2() + layers[il].getResolutionZ() * layers[il].getResolutionZ());
-      goodHitProbability[il] = ProbGoodChiSqHit(layers[il].getRadius() * 100, sigYCmb * 100, sigZCmb * 100);
+    scratch.hits.push_back({spacePoint[0], spacePoint[1], spacePoint[2]});
+    if (!layer.inert) { // good hit probability calculation
+      float sigYCmb = o2::math_utils::sqrt(inwardTrack.getSigmaY2() + layer.resRPhi2);
+      float sigZCmb = o2::math_utils::sqrt(inwardTrack.getSigmaZ2() + layer.resZ2);
+      // as ProbGoodChiSqHit, with the hit density of the layer computed once per call
+      float sx = o2::constants::math::TwoPI * (sigYCmb * 100) * (sigZCmb * 100) * layer.hitDensity;
+      goodHitProbability[il] = 1. / (1 + sx);
       goodHitProbability[0] *= goodHitProbability[il];
     }
   }
@@ -515,8 +602,8 @@ int FastTracker::FastTrack(o2::track::TrackParCov inputTrack, o2::track::TrackPa
   }
 
   // only attempt to continue if intercepts are at least four
-  if (nIntercepts < 4) {
-    return nIntercepts;
+  if (scratch.nIntercepts < 4) {
+    return scratch.nIntercepts;
   }
 
   // generate efficiency
@@ -530,7 +617,7 @@ int FastTracker::FastTrack(o2::track::TrackParCov inputTrack, o2::track::TrackPa
     eff *= iGoodHit;
   }
   if (mApplyEffCorrection) {
-    if (gRandom->Uniform() > eff) {
+    if (random->Uniform() > eff) {
       return -8;
     }
   }
@@ -584,15 +671,15 @@ int FastTracker::FastTrack(o2::track::TrackParCov inputTrack, o2::track::TrackPa
     if (mVerboseLevel > 0) {
       LOG(info) << "WARNING: this diagonalization (at pt = " << inputTrack.getPt() << ") has negative eigenvalues despite Ruben's fix! Please be careful!";
       LOG(info) << "Printing info:";
-      LOG(info) << "Kalman updates: " << nIntercepts;
+      LOG(info) << "Kalman updates: " << scratch.nIntercepts;
       LOG(info) << "Cov matrix: ";
       m.Print();
     }
-    covMatNotOK++;
-    nIntercepts = -1; // mark as problematic so that it isn't used
+    scratch.covMatNotOK++;
+    scratch.nIntercepts = -1; // mark as problematic so that it isn't used
     return -1;
   }
-  covMatOK++;
+  scratch.covMatOK++;
 
   // transform parameter vector and smear
   float params_[5];
@@ -601,7 +688,7 @@ int FastTracker::FastTrack(o2::track::TrackParCov inputTrack, o2::track::TrackPa
     for (int j = 0; j < 5; ++j)
       val += eigVec[j][ii] * outputTrack.getParam(j);
     // smear parameters according to eigenvalues
-    params_[ii] = gRandom->Gaus(val, sqrt(eigVal[ii]));
+    params_[ii] = random->Gaus(val, sqrt(eigVal[ii]));
   }
 
   // invert eigenvector matrix
@@ -619,7 +706,7 @@ int FastTracker::FastTrack(o2::track::TrackParCov inputTrack, o2::track::TrackPa
     return -2;
   }
 
-  return nIntercepts;
+  return scratch.nIntercepts;
 }
 // +-~-<*>-~-+-~-<*>-~-+-~-<*>-~-+-~-<*>-~-+-~-<*>-~-+-~-<*>-~-+-~-<*>-~-+-~-<*>-~-+
 
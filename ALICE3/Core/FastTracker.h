@@ -20,7 +20,12 @@
 #include <Framework/Logger.h>
 #include <ReconstructionDataFormats/Track.h>
 
+#include <TRandom3.h>
+
+#include <array>
+#include <cstdint>
 #include <map>
+#include <span>
 #include <string>
 #include <vector>
 
@@ -55,11 +60,31 @@ class FastTracker
   int GetLayerIndex(const std::string& name) const;
   size_t GetNLayers() const { return layers.size(); }
   bool IsLayerInert(const int layer) const { return layers[layer].isInert(); }
-  void ClearLayers() { layers.clear(); }
-  void SetRadiationLength(const std::string layerName, float x0) { layers[GetLayerIndex(layerName)].setRadiationLength(x0); }
-  void SetRadius(const std::string layerName, float r) { layers[GetLayerIndex(layerName)].setRadius(r); }
-  void SetResolutionRPhi(const std::string layerName, float resRPhi) { layers[GetLayerIndex(layerName)].setResolutionRPhi(resRPhi); }
-  void SetResolutionZ(const std::string layerName, float resZ) { layers[GetLayerIndex(layerName)].setResolutionZ(resZ); }
+  void ClearLayers()
+  {
+    layers.clear();
+    mLayerConstantsValid = false;
+  }
+  void SetRadiationLength(const std::string layerName, float x0)
+  {
+    layers[GetLayerIndex(layerName)].setRadiationLength(x0);
+    mLayerConstantsValid = false;
+  }
+  void SetRadius(const std::string layerName, float r)
+  {
+    layers[GetLayerIndex(layerName)].setRadius(r);
+    mLayerConstantsValid = false;
+  }
+  void SetResolutionRPhi(const std::string layerName, float resRPhi)
+  {
+    layers[GetLayerIndex(layerName)].setResolutionRPhi(resRPhi);
+    mLayerConstantsValid = false;
+  }
+  void SetResolutionZ(const std::string layerName, float resZ)
+  {
+    layers[GetLayerIndex(layerName)].setResolutionZ(resZ);
+    mLayerConstantsValid = false;
+  }
   void SetResolution(const std::string layerName, float resRPhi, float resZ)
   {
     SetResolutionRPhi(layerName, resRPhi);
@@ -94,6 +119,31 @@ class FastTracker
    */
   int FastTrack(o2::track::TrackParCov inputTrack, o2::track::TrackParCov& outputTrack, const float nch, const float maxRadius = 100.f);
 
+  /// Output of FastTrackBatch, one element per input track
+  struct BatchOutput {
+    std::vector<o2::track::TrackParCov> tracks; // output tracks, as filled by FastTrack
+    std::vector<int> status;                    // return value of FastTrack
+    std::vector<int> nSiliconPoints;            // silicon-based space points added to the track
+    std::vector<int> nGasPoints;                // tpc-based space points added to the track
+    std::vector<float> goodHitProbability;      // good hit probability accumulated in layer zero, see GetGoodHitProb(0)
+  };
+
+  /**
+   * @brief Performs fast tracking on a batch of input tracks.
+   *
+   * The per-layer constants are computed once for the whole batch and the per-track scratch is reused.
+   * With nThreads = 1 the tracks are processed in order with gRandom, giving the same results as calling
+   * FastTrack on each of them. With nThreads > 1 the batch is split in contiguous chunks, each smeared with
+   * its own TRandom3 seeded from gRandom. The layer configuration must not change during the call.
+   *
+   * @param inputTracks The input track parameters and covariances.
+   * @param output Output of the batch, resized to the number of input tracks.
+   * @param nch Charged particle multiplicity (used for hit density calculations).
+   * @param maxRadius Maximum radius up to which the tracks are propagated.
+   * @param nThreads Number of threads over which the tracks are distributed.
+   */
+  void FastTrackBatch(std::span<const o2::track::TrackParCov> inputTracks, BatchOutput& output, const float nch, const float maxRadius = 100.f, const int nThreads = 1);
+
   // For efficiency calculation
   float Dist(float z, float radius);
   float OneEventHitDensity(float multiplicity, float radius);
@@ -103,11 +153,31 @@ class FastTracker
   float ProbGoodChiSqHit(float radius, float searchRadiusRPhi, float searchRadiusZ);
 
   // Setters and getters for configuration
-  void SetIntegrationTime(float t) { integrationTime = t; }
-  void SetMaxRadiusOfSlowDetectors(float r) { maxRadiusSlowDet = r; }
-  void SetAvgRapidity(float y) { avgRapidity = y; }
-  void SetdNdEtaCent(int d) { dNdEtaCent = d; }
-  void SetLhcUPCscale(float s) { lhcUPCScale = s; }
+  void SetIntegrationTime(float t)
+  {
+    integrationTime = t;
+    mLayerConstantsValid = false;
+  }
+  void SetMaxRadiusOfSlowDetectors(float r)
+  {
+    maxRadiusSlowDet = r;
+    mLayerConstantsValid = false;
+  }
+  void SetAvgRapidity(float y)
+  {
+    avgRapidity = y;
+    mLayerConstantsValid = false;
+  }
+  void SetdNdEtaCent(int d)
+  {
+    dNdEtaCent = d;
+    mLayerConstantsValid = false;
+  }
+  void SetLhcUPCscale(float s)
+  {
+    lhcUPCScale = s;
+    mLayerConstantsValid = false;
+  }
   void SetBField(float b) { magneticField = b; }
   void SetMinRadTrack(float r) { fMinRadTrack = r; }
   void SetMagneticField(float b) { magneticField = b; }
@@ -117,24 +187,59 @@ class FastTracker
   void SetApplyEffCorrection(bool b) { mApplyEffCorrection = b; }
 
   // Getters for the last track
-  int GetNIntercepts() const { return nIntercepts; }
-  int GetNSiliconPoints() const { return nSiliconPoints; }
-  int GetNGasPoints() const { return nGasPoints; }
+  int GetNIntercepts() const { return mLastTrack.nIntercepts; }
+  int GetNSiliconPoints() const { return mLastTrack.nSiliconPoints; }
+  int GetNGasPoints() const { return mLastTrack.nGasPoints; }
   float GetGoodHitProb(int layer) const
   {
-    return (layer >= 0 && static_cast<size_t>(layer) < goodHitProbability.size()) ? goodHitProbability[layer] : 0.0f;
+    return (layer >= 0 && static_cast<size_t>(layer) < mLastTrack.goodHitProbability.size()) ? mLastTrack.goodHitProbability[layer] : 0.0f;
   }
-  std::size_t GetNHits() const { return hits.size(); }
-  float GetHitX(const int i) const { return hits[i][0]; }
-  float GetHitY(const int i) const { return hits[i][1]; }
-  float GetHitZ(const int i) const { return hits[i][2]; }
+  std::size_t GetNHits() const { return mLastTrack.hits.size(); }
+  float GetHitX(const int i) const { return mLastTrack.hits[i][0]; }
+  float GetHitY(const int i) const { return mLastTrack.hits[i][1]; }
+  float GetHitZ(const int i) const { return mLastTrack.hits[i][2]; }
   uint64_t GetCovMatOK() const { return covMatOK; }
   uint64_t GetCovMatNotOK() const { return covMatNotOK; }
 
  private:
+  // constants of a layer used while tracking, recomputed only when the layer setup or the multiplicity changes
+  // (layers modified through the pointer returned by AddLayer after the first call are not detected)
+  struct LayerConstants {
+    float radius = 0.f;     // radius in centimeters
+    float z = 0.f;          // half length in centimeters
+    float x0 = 0.f;         // radiation length
+    float xrho = 0.f;       // density
+    float resRPhi2 = 0.f;   // squared RPhi resolution
+    float resZ2 = 0.f;      // squared Z resolution
+    float hitDensity = 0.f; // HitDensity of the layer for the current multiplicity
+    bool inert = true;
+    bool silicon = false;
+    bool gas = false;
+    bool hasDeadPhiRegions = false;
+  };
+
+  // per-track state, reused between tracks
+  struct TrackScratch {
+    std::vector<std::array<float, 3>> hits; // added hits
+    std::vector<float> goodHitProbability;  // good hit probability per layer, layer 0 accumulates
+    int nIntercepts = 0;                    // found in first outward propagation
+    int nSiliconPoints = 0;                 // silicon-based space points added to track
+    int nGasPoints = 0;                     // tpc-based space points added to track
+    uint64_t covMatOK = 0;                  // cov mat has positive eigenvals
+    uint64_t covMatNotOK = 0;               // cov mat has negative eigenvals
+    TRandom3 random;                        // generator of the thread, when running multi-threaded
+  };
+
+  void updateLayerConstants(const float nch);
+  int fastTrack(o2::track::TrackParCov& inputTrack, o2::track::TrackParCov& outputTrack, const float maxRadius, TrackScratch& scratch, TRandom* random);
+
   // Definition of detector layers
   std::vector<DetLayer> layers;
-  std::vector<std::vector<float>> hits; // bookkeep last added hits
+  std::vector<LayerConstants> mLayerConstants; //! constants of the layers for the current setup and multiplicity
+  bool mLayerConstantsValid = false;           //! whether mLayerConstants match the current setup
+  int mFirstActiveLayer = -1;                  //! first layer that is not inert
+  TrackScratch mLastTrack;                     //! state of the last track
+  std::vector<TrackScratch> mThreadScratch;    //! state of the threads of FastTrackBatch
 
   /// configuration parameters
   bool mApplyZacceptance = false;       /// check z acceptance or not
@@ -161,13 +266,7 @@ class FastTracker
   uint64_t covMatOK = 0;    /// cov mat has positive eigenvals
   uint64_t covMatNotOK = 0; /// cov mat has negative eigenvals
 
-  /// last track information
-  int nIntercepts = 0;    /// found in first outward propagation
-  int nSiliconPoints = 0; /// silicon-based space points added to track
-  int nGasPoints = 0;     /// tpc-based space points added to track
-  std::vector<float> goodHitProbability;
-
-  ClassDef(FastTracker, 1);
+  ClassDef(FastTracker, 2);
 };
 
 // +-~-<*>-~-+-~-<*>-~-+-~-<*>-~-+-~-<*>-~-+-~-<*>-~-+-~-<*>-~-+-~-<*>-~-+-~-<*>-~-+
@@ -153,6 +153,7 @@ struct OnTheFlyTracker {
     Configurable<bool> applyZacceptance{"applyZacceptance", false, "apply z limits to detector layers or not"};
     Configurable<bool> applyMSCorrection{"applyMSCorrection", true, "apply ms corrections for secondaries or not"};
     Configurable<bool> applyElossCorrection{"applyElossCorrection", true, "apply eloss corrections for secondaries or not"};
+    Configurable<int> batchThreads{"batchThreads", 0, "dev configuration: fast-track the secondaries of an event in one batch over this number of threads (0: track by track)"};
   } fastTrackerSettings; // allows for gap between peak and bg in case someone wants to
 
   struct : ConfigurableGroup {
@@ -1833,6 +1834,17 @@ struct OnTheFlyTracker {
     }
   }
 
+  // particles fast-tracked in one batch by processConfigurationDev
+  struct BatchParticle {
+    int64_t globalIndex; // index of the MC particle
+    int pdgCode;
+    float time;
+    bool isDecayDaughter;
+  };
+  std::vector<o2::track::TrackParCov> batchInput;
+  std::vector<BatchParticle> batchParticles;
+  o2::fastsim::FastTracker::BatchOutput batchOutput;
+
   void processConfigurationDev(aod::McCollision const& mcCollision, aod::McPartsWithDau const& mcParticles, const int icfg)
   {
     // const int lastTrackIndex = tableStoredTracksCov.lastIndex() + 1; // bookkeep the last added track
@@ -1884,6 +1896,44 @@ struct OnTheFlyTracker {
     uint32_t multiplicityCounter = 0;
     getHist(TH1, histPath + "hLUTMultiplicity")->Fill(dNdEta);
 
+    const float timeResolutionNs = 100.f; // ns
+    const float nsToMus = 1e-3f;
+    const float timeResolutionUs = timeResolutionNs * nsToMus; // us
+
+    // stores a smeared or fast-tracked particle, with the QA of the reconstructed tracks
+    auto addTrack = [&](o2::track::TrackParCov const& trackParCov, BatchParticle const& particle, const bool reconstructed, const int nTrkHits) {
+      if (!reconstructed && processUnreconstructedTracks) {
+        return; // failed to reconstruct track
+      }
+
+      if (std::isnan(trackParCov.getZ())) {
+        histos.fill(HIST("hNaNBookkeeping"), 0.0f, 0.0f);
+        return; // capture smearing mistakes
+      }
+
+      histos.fill(HIST("hNaNBookkeeping"), 0.0f, 1.0f);
+      if (enablePrimarySmearing) {
+        getHist(TH1, histPath + "hPtReconstructed")->Fill(trackParCov.getPt());
+        if (std::abs(particle.pdgCode) == kElectron)
+          getHist(TH1, histPath + "hPtReconstructedEl")->Fill(trackParCov.getPt());
+        if (std::abs(particle.pdgCode) == kPiPlus)
+          getHist(TH1, histPath + "hPtReconstructedPi")->Fill(trackParCov.getPt());
+        if (std::abs(particle.pdgCode) == kKPlus)
+          getHist(TH1, histPath + "hPtReconstructedKa")->Fill(trackParCov.getPt());
+        if (std::abs(particle.pdgCode) == kProton)
+          getHist(TH1, histPath + "hPtReconstructedPr")->Fill(trackParCov.getPt());
+      }
+
+      if (reconstructed) {
+        tracksAlice3.push_back(TrackAlice3{trackParCov, particle.globalIndex, particle.time, timeResolutionUs, particle.isDecayDaughter, false, 0, nTrkHits});
+      } else {
+        ghostTracksAlice3.push_back(TrackAlice3{trackParCov, particle.globalIndex, particle.time, timeResolutionUs, particle.isDecayDaughter});
+      }
+    };
+    const bool useBatch = fastTrackerSettings.batchThreads > 0;
+    batchInput.clear();
+    batchParticles.clear();
+
     // Now that the multiplicity is known, we can process the particles to smear them
     for (const auto& mcParticle : mcParticles) {
       const bool longLivedToBeHandled = std::find(longLivedHandledPDGs.begin(), longLivedHandledPDGs.end(), std::abs(mcParticle.pdgCode())) != longLivedHandledPDGs.end();
@@ -1923,9 +1973,6 @@ struct OnTheFlyTracker {
       multiplicityCounter++;
       o2::track::TrackParCov trackParCov;
       const bool isDecayDaughter = (mcParticle.getProcess() == TMCProcess::kPDecay);
-      const float timeResolutionNs = 100.f; // ns
-      const float nsToMus = 1e-3f;
-      const float timeResolutionUs = timeResolutionNs * nsToMus; // us
       const float time = (eventCollisionTimeNS + gRandom->Gaus(0., timeResolutionNs)) * nsToMus;
 
       bool reconstructed = false;
@@ -1938,6 +1985,11 @@ struct OnTheFlyTracker {
         o2::track::TrackParCov perfectTrackParCov;
         o2::upgrade::convertMCParticleToO2Track(mcParticle, perfectTrackParCov, pdgDB);
         perfectTrackParCov.setPID(pdgCodeToPID(mcParticle.pdgCode()));
+        if (useBatch) {
+          batchInput.push_back(perfectTrackParCov);
+          batchParticles.push_back({mcParticle.globalIndex(), mcParticle.pdgCode(), time, isDecayDaughter});
+          continue; // fast-tracked after the particle loop
+        }
         nTrkHits = fastTracker[icfg]->FastTrack(perfectTrackParCov, trackParCov, dNdEta);
         if (nTrkHits < fastTrackerSettings.minSiliconHits) {
           reconstructed = false;
@@ -1946,32 +1998,15 @@ struct OnTheFlyTracker {
         }
       }
 
-      if (!reconstructed && processUnreconstructedTracks) {
-        continue; // failed to reconstruct track
-      }
-
-      if (std::isnan(trackParCov.getZ())) {
-        histos.fill(HIST("hNaNBookkeeping"), 0.0f, 0.0f);
-        continue; // capture smearing mistakes
-      }
-
-      histos.fill(HIST("hNaNBookkeeping"), 0.0f, 1.0f);
-      if (enablePrimarySmearing) {
-        getHist(TH1, histPath + "hPtReconstructed")->Fill(trackParCov.getPt());
-        if (std::abs(mcParticle.pdgCode()) == kElectron)
-          getHist(TH1, histPath + "hPtReconstructedEl")->Fill(trackParCov.getPt());
-        if (std::abs(mcParticle.pdgCode()) == kPiPlus)
-          getHist(TH1, histPath + "hPtReconstructedPi")->Fill(trackParCov.getPt());
-        if (std::abs(mcParticle.pdgCode()) == kKPlus)
-          getHist(TH1, histPath + "hPtReconstructedKa")->Fill(trackParCov.getPt());
-        if (std::abs(mcParticle.pdgCode()) == kProton)
-          getHist(TH1, histPath + "hPtReconstructedPr")->Fill(trackParCov.getPt());
-      }
+      addTrack(trackParCov, {mcParticle.globalIndex(), mcParticle.pdgCode(), time, isDecayDaughter}, reconstructed, nTrkHits);
+    }
 
-      if (reconstructed) {
-        tracksAlice3.push_back(TrackAlice3{trackParCov, mcParticle.globalIndex(), time, timeResolutionUs, isDecayDaughter, false, 0, nTrkHits});
-      } else {
-        ghostTracksAlice3.push_back(TrackAlice3{trackParCov, mcParticle.globalIndex(), time, timeResolutionUs, isDecayDaughter});
+    if (useBatch && !batchInput.empty()) {
+      // the random numbers of the batch are drawn after those of the particle loop
+      fastTracker[icfg]->FastTrackBatch(batchInput, batchOutput, dNdEta, 100.f, fastTrackerSettings.batchThreads);
+      for (size_t i = 0; i < batchInput.size(); ++i) {
+        const int nTrkHits = batchOutput.status[i];
+        addTrack(batchOutput.tracks[i], batchParticles[i], nTrkHits >= fastTrackerSettings.minSiliconHits, nTrkHits);
       }
     }
 
@@ -18,11 +18,13 @@
 #include <DataFormatsParameters/GRPLHCIFData.h>
 #include <Framework/Logger.h>
 
+#include <algorithm>
 #include <cmath>
 #include <cstddef>
 #include <cstdint>
+#include <limits>
 #include <map>
-#include <ostream>
+#include <span>
 #include <string>
 #include <vector>
 
@@ -60,44 +62,80 @@ double ctpRateFetcher::fetch(o2::ccdb::BasicCCDBManager* ccdb, uint64_t timeStam
   return -1.;
 }
 
+std::vector<double> ctpRateFetcher::fetch(o2::ccdb::BasicCCDBManager* ccdb, std::span<const uint64_t> timeStamps, int runNumber, const std::string& sourceName, bool fCrashOnNull)
+{
+  std::vector<double> rates;
+  rates.reserve(timeStamps.size());
+  for (const auto timeStamp : timeStamps) {
+    rates.push_back(fetch(ccdb, timeStamp, runNumber, sourceName, fCrashOnNull));
+  }
+  return rates;
+}
+
 double ctpRateFetcher::fetchCTPratesClasses(o2::ccdb::BasicCCDBManager* /*ccdb*/, uint64_t timeStamp, int /*runNumber*/, const std::string& className, int inputType)
 {
-  std::vector<ctp::CTPClass> ctpcls = mConfig->getCTPClasses();
-  std::vector<int> clslist = mConfig->getTriggerClassList();
-  int classIndex = -1;
-  for (size_t i = 0; i < clslist.size(); i++) {
-    if (ctpcls[i].name.find(className) != std::string::npos) {
-      classIndex = i;
-      break;
+  auto series = mClassRates.find(className);
+  if (series == mClassRates.end()) {
+    series = mClassRates.emplace(className, RateSeries{}).first;
+    series->second.inputType = inputType;
+    const auto& ctpcls = mConfig->getCTPClasses();
+    const auto clslist = mConfig->getTriggerClassList();
+    for (size_t i = 0; i < clslist.size(); i++) {
+      if (ctpcls[i].name.find(className) != std::string::npos) {
+        series->second.index = i;
+        break;
+      }
     }
   }
-  if (classIndex == -1) {
+  if (series->second.index == -1) {
     LOG(warn) << "Trigger class " << className << " not found in CTPConfiguration";
     return -1.;
   }
-  auto rate{mScalers->getRateGivenT(timeStamp * 1.e-3, classIndex, inputType, 1)};
-  return pileUpCorrection(rate.second);
+  return getRate(series->second, timeStamp);
 }
 
 double ctpRateFetcher::fetchCTPratesInputs(o2::ccdb::BasicCCDBManager* /*ccdb*/, uint64_t timeStamp, int /*runNumber*/, int input)
 {
-  std::vector<ctp::CTPScalerRecordO2> recs = mScalers->getScalerRecordO2();
-  if (recs[0].scalersInps.size() == 48) {
-    return pileUpCorrection(mScalers->getRateGivenT(timeStamp * 1.e-3, input, 7, 1).second);
+  if (mInputsAvailable) {
+    auto& series = mInputRates[input];
+    series.index = input;
+    series.inputType = 7;
+    return getRate(series, timeStamp);
   } else {
     LOG(error) << "Inputs not available";
     return -1.;
   }
 }
 
-double ctpRateFetcher::pileUpCorrection(double triggerRate)
+double ctpRateFetcher::getRate(RateSeries& series, uint64_t timeStamp)
 {
-  if (mLHCIFdata == nullptr) {
-    LOG(fatal) << "No filling" << std::endl;
+  // the scalers give the rate between the two records bracketing the timestamp: the corrected rate is
+  // computed once per interval, found with a binary search unless it is the one of the previous request
+  const double time = timeStamp * 1.e-3;
+  std::size_t interval = mLastInterval;
+  if (interval + 1 >= mScalerTimes.size() || !(mScalerTimes[interval] <= time && time < mScalerTimes[interval + 1])) {
+    const auto next = std::upper_bound(mScalerTimes.begin(), mScalerTimes.end(), time);
+    if (next == mScalerTimes.begin() || next == mScalerTimes.end()) { // out of the scaler records, left to getRateGivenT
+      return pileUpCorrection(mScalers->getRateGivenT(time, series.index, series.inputType, 1).second);
+    }
+    interval = next - mScalerTimes.begin() - 1;
+    mLastInterval = interval;
   }
-  auto bfilling = mLHCIFdata->getBunchFilling();
-  std::vector<int> bcs = bfilling.getFilledBCs();
-  double nbc = bcs.size();
+  if (series.rates.empty()) {
+    series.rates.assign(mScalerTimes.size() - 1, std::numeric_limits<double>::quiet_NaN());
+  }
+  double& rate = series.rates[interval];
+  if (std::isnan(rate)) {
+    // queried at the middle of the interval, so that the cached rate does not depend on the bracketing of a boundary timestamp
+    const double timeMiddle = 0.5 * (mScalerTimes[interval] + mScalerTimes[interval + 1]);
+    rate = pileUpCorrection(mScalers->getRateGivenT(timeMiddle, series.index, series.inputType, 1).second);
+  }
+  return rate;
+}
+
+double ctpRateFetcher::pileUpCorrection(double triggerRate)
+{
+  double nbc = mNfilledBCs;
   double nTriggersPerFilledBC = triggerRate / nbc / constants::lhc::LHCRevFreq;
   double mu = -std::log(1 - nTriggersPerFilledBC);
   return mu * nbc * constants::lhc::LHCRevFreq;
@@ -130,6 +168,21 @@ void ctpRateFetcher::setupRun(int runNumber, o2::ccdb::BasicCCDBManager* ccdb, u
     LOG(fatal) << "CTPRunScalers not in database, timestamp:" << timeStamp;
   }
   mScalers->convertRawToO2();
+
+  auto bfilling = mLHCIFdata->getBunchFilling();
+  mNfilledBCs = bfilling.getFilledBCs().size();
+  const auto& recs = mScalers->getScalerRecordO2();
+  mInputsAvailable = !recs.empty() && recs[0].scalersInps.size() == 48;
+  mScalerTimes.clear();
+  for (const auto& rec : recs) {
+    mScalerTimes.push_back(rec.epochTime);
+  }
+  if (!std::is_sorted(mScalerTimes.begin(), mScalerTimes.end())) { // the interval search needs time-ordered records, fall back to getRateGivenT
+    mScalerTimes.clear();
+  }
+  mLastInterval = 0;
+  mClassRates.clear();
+  mInputRates.clear();
 }
 
 } // namespace o2
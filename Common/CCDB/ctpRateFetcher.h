@@ -14,8 +14,12 @@
 
 #include <CCDB/BasicCCDBManager.h>
 
+#include <cstddef>
 #include <cstdint>
+#include <map>
+#include <span>
 #include <string>
+#include <vector>
 
 namespace o2
 {
@@ -36,6 +40,8 @@ class ctpRateFetcher
  public:
   ctpRateFetcher() = default;
   double fetch(o2::ccdb::BasicCCDBManager* ccdb, uint64_t timeStamp, int runNumber, const std::string& sourceName, bool fCrashOnNull = true);
+  /// Rates for a list of timestamps of the same run, fastest when the timestamps are sorted
+  std::vector<double> fetch(o2::ccdb::BasicCCDBManager* ccdb, std::span<const uint64_t> timeStamps, int runNumber, const std::string& sourceName, bool fCrashOnNull = true);
 
   void setManualCleanup(bool manualCleanup = true) { mManualCleanup = manualCleanup; }
 
@@ -45,11 +51,26 @@ class ctpRateFetcher
   double pileUpCorrection(double rate);
   void setupRun(int runNumber, o2::ccdb::BasicCCDBManager* ccdb, uint64_t timeStamp);
 
+  /// Pile-up corrected rates of one class or input, per interval between consecutive scaler records
+  struct RateSeries {
+    int index = -1;            // class or input index in the scaler records, -1 if not available
+    int inputType = 1;         // scaler type passed to CTPRunScalers::getRateGivenT
+    std::vector<double> rates; // rate per scaler interval, NaN until first requested
+  };
+  double getRate(RateSeries& series, uint64_t timeStamp);
+
   bool mManualCleanup = false;
   int mRunNumber = -1;
   ctp::CTPConfiguration* mConfig = nullptr;
   ctp::CTPRunScalers* mScalers = nullptr;
   parameters::GRPLHCIFData* mLHCIFdata = nullptr;
+
+  double mNfilledBCs = 0.;                       // number of filled BCs of the run
+  bool mInputsAvailable = false;                 // scaler records contain the CTP inputs
+  std::vector<double> mScalerTimes;              // epoch time (s) of the scaler records, empty if not sorted
+  std::size_t mLastInterval = 0;                 // scaler interval of the previous request
+  std::map<std::string, RateSeries> mClassRates; // per trigger class, for the current run
+  std::map<int, RateSeries> mInputRates;         // per CTP input, for the current run
 };
 } // namespace o2
 
@@ -18,3 +18,69 @@
 /// \author Maurice Coquet <maurice.louis.coquet@cern.ch>, CEA-Saclay/Irfu
 
 #include "Common/Core/CollisionAssociation.h" // IWYU pragma: keep
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+using namespace o2::aod::track_association;
+
+void TimeAssociator::run(std::vector<TrackTime> const& tracks, std::vector<CollisionTime> const& collisions, bool fillPerTrack)
+{
+  const int nTracks = tracks.size();
+  const int nCollisions = collisions.size();
+  const int64_t bcOffsetMax = getBcOffsetMax();
+
+  // sort the tracks with a valid BC by their corrected BC, ties keep the track order
+  mSortedTracks.clear();
+  for (int iTrack = 0; iTrack < nTracks; ++iTrack) {
+    if (tracks[iTrack].bc >= 0) {
+      mSortedTracks.emplace_back(tracks[iTrack].bcCorrected, iTrack);
+    }
+  }
+  std::sort(mSortedTracks.begin(), mSortedTracks.end());
+  mSortedBCs.resize(mSortedTracks.size());
+  for (std::size_t i = 0; i < mSortedTracks.size(); ++i) {
+    mSortedBCs[i] = mSortedTracks[i].first;
+  }
+
+  // per collision, test only the tracks within +-bcOffsetMax of the collision BC
+  mCollisionOffsets.assign(nCollisions + 1, 0);
+  mTracksPerCollision.clear();
+  for (int iColl = 0; iColl < nCollisions; ++iColl) {
+    const auto& collision = collisions[iColl];
+    const auto first = std::lower_bound(mSortedBCs.begin(), mSortedBCs.end(), collision.bc - bcOffsetMax) - mSortedBCs.begin();
+    const auto last = std::upper_bound(mSortedBCs.begin() + first, mSortedBCs.end(), collision.bc + bcOffsetMax) - mSortedBCs.begin();
+    const std::size_t begin = mTracksPerCollision.size();
+    for (auto i = first; i < last; ++i) {
+      const int iTrack = mSortedTracks[i].second;
+      if (isCompatible(tracks[iTrack], collision)) {
+        mTracksPerCollision.push_back(iTrack);
+      }
+    }
+    std::sort(mTracksPerCollision.begin() + begin, mTracksPerCollision.end());
+    mCollisionOffsets[iColl + 1] = mTracksPerCollision.size();
+  }
+
+  // reverse index, filled in increasing collision index
+  mTrackOffsets.assign(nTracks + 1, 0);
+  mCollisionsPerTrack.clear();
+  if (!fillPerTrack) {
+    return;
+  }
+  for (const auto iTrack : mTracksPerCollision) {
+    ++mTrackOffsets[iTrack + 1];
+  }
+  for (int iTrack = 0; iTrack < nTracks; ++iTrack) {
+    mTrackOffsets[iTrack + 1] += mTrackOffsets[iTrack];
+  }
+  mCollisionsPerTrack.resize(mTracksPerCollision.size());
+  std::vector<int> fill(mTrackOffsets.begin(), mTrackOffsets.end() - 1);
+  for (int iColl = 0; iColl < nCollisions; ++iColl) {
+    for (int i = mCollisionOffsets[iColl]; i < mCollisionOffsets[iColl + 1]; ++i) {
+      mCollisionsPerTrack[fill[mTracksPerCollision[i]]++] = iColl;
+    }
+  }
+}
@@ -30,7 +30,6 @@
 #include <cmath>
 #include <cstdint>
 #include <cstdlib>
-#include <memory>
 #include <utility>
 #include <vector>
 
@@ -46,6 +45,96 @@ enum TrackSelection {
   QualityTracksITS = 2
 };
 
+/// \class TimeAssociator
+/// \brief Time-based association of tracks to collisions with a sweep over the tracks sorted in BC
+///
+/// Each track with a valid BC is a time interval of +-bcOffsetMax BCs around its BC corrected by the track time,
+/// the tracks are sorted once by it and for each collision only the tracks whose interval contains the collision BC
+/// are tested for time compatibility. The compatible pairs are stored in a flat CSR layout both per collision
+/// (tracks in increasing index) and per track (collisions in increasing index), the latter being the reverse index.
+class TimeAssociator
+{
+ public:
+  /// how the track time resolution enters the compatibility threshold
+  enum TimeResType : uint8_t {
+    Gaussian = 0,  // gaussian resolution, combined in quadrature with the collision one
+    Range,         // the resolution is a range, added to the collision one
+    PvContributor, // track contributing to a vertex, the resolution is the threshold
+    Incompatible   // never compatible
+  };
+
+  struct TrackTime {
+    int64_t bc = -1;          // BC of the track, negative if the track has none
+    int64_t bcCorrected = -1; // BC corrected by the track time
+    float time = 0.f;         // time relative to the BC in ns
+    float timeRes = 0.f;      // time resolution in ns
+    uint8_t resType = Gaussian;
+  };
+
+  struct CollisionTime {
+    int64_t bc = 0;      // BC of the collision
+    float time = 0.f;    // time relative to the BC in ns
+    float timeRes = 0.f; // time resolution in ns
+  };
+
+  void setNumSigmaForTimeCompat(float nSigma) { mNumSigmaForTimeCompat = nSigma; }
+  void setTimeMargin(float timeMargin) { mTimeMargin = timeMargin; }
+  void setBcWindow(int bcWindow) { mBcWindowForOneSigma = bcWindow; }
+
+  /// Finds all time-compatible track-collision pairs
+  /// \param tracks tracks, indices in the output refer to positions in this vector
+  /// \param collisions collisions, indices in the output refer to positions in this vector
+  /// \param fillPerTrack whether to also fill the collisions per track
+  void run(std::vector<TrackTime> const& tracks, std::vector<CollisionTime> const& collisions, bool fillPerTrack);
+
+  /// Tracks compatible with a collision, in increasing track index
+  const int* tracksBegin(int collision) const { return mTracksPerCollision.data() + mCollisionOffsets[collision]; }
+  const int* tracksEnd(int collision) const { return mTracksPerCollision.data() + mCollisionOffsets[collision + 1]; }
+  /// Collisions compatible with a track, in increasing collision index (only if fillPerTrack)
+  const int* collisionsBegin(int track) const { return mCollisionsPerTrack.data() + mTrackOffsets[track]; }
+  const int* collisionsEnd(int track) const { return mCollisionsPerTrack.data() + mTrackOffsets[track + 1]; }
+  std::size_t getNumPairs() const { return mTracksPerCollision.size(); }
+
+  /// Maximum BC distance between a track and a collision to be tested for compatibility
+  int64_t getBcOffsetMax() const { return static_cast<int64_t>(mBcWindowForOneSigma * mNumSigmaForTimeCompat + mTimeMargin / o2::constants::lhc::LHCBunchSpacingNS); }
+
+  /// Time compatibility of a track with a collision
+  bool isCompatible(TrackTime const& track, CollisionTime const& collision) const
+  {
+    const float collTimeRes2 = collision.timeRes * collision.timeRes;
+    const int64_t bcOffset = track.bc - collision.bc;
+    const float deltaTime = track.time - collision.time + bcOffset * o2::constants::lhc::LHCBunchSpacingNS;
+    float sigmaTimeRes2 = collTimeRes2 + track.timeRes * track.timeRes;
+    float thresholdTime = 0.;
+    switch (track.resType) {
+      case PvContributor:
+        thresholdTime = track.timeRes;
+        break;
+      case Range:
+        thresholdTime = track.timeRes + mNumSigmaForTimeCompat * std::sqrt(collTimeRes2) + mTimeMargin;
+        break;
+      case Gaussian:
+        thresholdTime = mNumSigmaForTimeCompat * std::sqrt(sigmaTimeRes2) + mTimeMargin;
+        break;
+      default:
+        break;
+    }
+    return std::abs(deltaTime) < thresholdTime;
+  }
+
+ private:
+  float mNumSigmaForTimeCompat{4.}; // number of sigma for time compatibility
+  float mTimeMargin{500.};          // additional time margin in ns
+  int mBcWindowForOneSigma{115};    // BC window to be multiplied by the number of sigmas to define maximum window to be considered
+
+  std::vector<std::pair<int64_t, int>> mSortedTracks; // corrected BC and index of the tracks with a valid BC, sorted
+  std::vector<int64_t> mSortedBCs;                    // corrected BC of the sorted tracks
+  std::vector<int> mCollisionOffsets;                 // CSR offsets of the tracks per collision
+  std::vector<int> mTracksPerCollision;               // compatible tracks per collision
+  std::vector<int> mTrackOffsets;                     // CSR offsets of the collisions per track
+  std::vector<int> mCollisionsPerTrack;               // compatible collisions per track
+};
+
 } // namespace track_association
 } // namespace o2::aod
 
@@ -53,6 +142,8 @@ template <bool isCentralBarrel>
 class CollisionAssociation
 {
  public:
+  using TimeAssociator = o2::aod::track_association::TimeAssociator;
+
   /// Default constructor
   CollisionAssociation() = default;
 
@@ -132,172 +223,118 @@ class CollisionAssociation
                         Assoc& association,
                         RevIndices& reverseIndices)
   {
-    // cache globalBC and track time in BC for optimization
-    std::vector<int64_t> globalBC;
-    std::vector<int64_t> trackBCCache;
-    std::vector<std::pair<typename TTracks::iterator, typename TTracks::iterator>> trackIterationWindows; // continous regions in which we can count on increasing globalBC numbers
-    globalBC.reserve(tracks.size());
-    trackBCCache.reserve(tracks.size());
-    auto trackBegin = tracks.begin();
-    int lastCollisionId = 0;
-    if (tracks.size() > 0) {
-      lastCollisionId = trackBegin.collisionId();
-    }
-    auto track = trackBegin;
-    for (; track != tracks.end(); ++track) {
-      int64_t trackBC = -1;
-      if (track.has_collision()) {
-        trackBC = track.collision().bc().globalBC();
-      } else if (mIncludeUnassigned) {
-        for (const auto& ambTrack : ambiguousTracks) {
-          if constexpr (isCentralBarrel) { // FIXME: to be removed as soon as it is possible to use getId<Table>() for joined tables
-            if (ambTrack.trackId() == track.globalIndex()) {
-              // special check to avoid crashes (in particular on some MC datasets)
-              // related to shifts in ambiguous tracks association to bc slices (off by 1) - see https://mattermost.web.cern.ch/alice/pl/g9yaaf3tn3g4pgn7c1yex9copy
-              if (ambTrack.bcIds()[0] >= bcs.size() || ambTrack.bcIds()[1] >= bcs.size()) {
-                break;
-              }
-              if (!ambTrack.has_bc() || ambTrack.bc().size() == 0) {
-                break;
-              }
-              trackBC = ambTrack.bc().begin().globalBC();
-              break;
-            }
-          } else {
-            if (ambTrack.template getId<TTracks>() == track.globalIndex()) {
-              trackBC = ambTrack.bc().begin().globalBC();
-              break;
-            }
+    // BC of the ambiguous tracks, indexed by track, taking the first ambiguous track entry of each track
+    constexpr int64_t NotAmbiguous = INT64_MIN;
+    mAmbiguousTrackBC.assign(mIncludeUnassigned ? tracksUnfiltered.size() : 0, NotAmbiguous);
+    if (mIncludeUnassigned) {
+      for (const auto& ambTrack : ambiguousTracks) {
+        int64_t trackId = -1;
+        if constexpr (isCentralBarrel) { // FIXME: to be removed as soon as it is possible to use getId<Table>() for joined tables
+          trackId = ambTrack.trackId();
+        } else {
+          trackId = ambTrack.template getId<TTracks>();
+        }
+        if (trackId < 0 || trackId >= static_cast<int64_t>(mAmbiguousTrackBC.size()) || mAmbiguousTrackBC[trackId] != NotAmbiguous) {
+          continue;
+        }
+        int64_t trackBC = -1;
+        if constexpr (isCentralBarrel) {
+          // special check to avoid crashes (in particular on some MC datasets)
+          // related to shifts in ambiguous tracks association to bc slices (off by 1) - see https://mattermost.web.cern.ch/alice/pl/g9yaaf3tn3g4pgn7c1yex9copy
+          if (ambTrack.bcIds()[0] < bcs.size() && ambTrack.bcIds()[1] < bcs.size() && ambTrack.has_bc() && ambTrack.bc().size() != 0) {
+            trackBC = ambTrack.bc().begin().globalBC();
           }
+        } else {
+          trackBC = ambTrack.bc().begin().globalBC();
         }
+        mAmbiguousTrackBC[trackId] = trackBC;
       }
-      globalBC.push_back(trackBC);
-      trackBCCache.push_back(trackBC + track.trackTime() / o2::constants::lhc::LHCBunchSpacingNS);
-      // find uniform blocks
-      if ((track.collisionId() < lastCollisionId) || (lastCollisionId < 0 && track.collisionId() >= 0)) {
-        if (lastCollisionId >= 0 || mIncludeUnassigned) {
-          LOGP(debug, "Found track block from {} to {}, current id {}, last id {}", trackBegin.filteredIndex(), track.filteredIndex() - 1, track.collisionId(), lastCollisionId);
-          trackIterationWindows.push_back(std::make_pair(trackBegin, track));
+    }
+
+    // cache BC, time and resolution of the tracks, so that the association runs on flat arrays
+    mTrackTimes.clear();
+    mTrackTimes.reserve(tracks.size());
+    mTrackIds.clear();
+    mTrackIds.reserve(tracks.size());
+    for (const auto& track : tracks) {
+      TimeAssociator::TrackTime trackTime;
+      if (track.has_collision()) {
+        trackTime.bc = track.collision().bc().globalBC();
+      } else if (mIncludeUnassigned && mAmbiguousTrackBC[track.globalIndex()] != NotAmbiguous) {
+        trackTime.bc = mAmbiguousTrackBC[track.globalIndex()];
+      }
+      trackTime.bcCorrected = trackTime.bc + track.trackTime() / o2::constants::lhc::LHCBunchSpacingNS;
+      trackTime.time = track.trackTime();
+      trackTime.timeRes = track.trackTimeRes();
+      if constexpr (isCentralBarrel) {
+        if (mUsePvAssociation && track.isPVContributor()) {
+          trackTime.time = track.collision().collisionTime();        // if PV contributor, we assume the time to be the one of the collision
+          trackTime.timeRes = o2::constants::lhc::LHCBunchSpacingNS; // 1 BC
+          trackTime.resType = TimeAssociator::PvContributor;
+        } else if (TESTBIT(track.flags(), o2::aod::track::TrackTimeResIsRange)) {
+          // the track time resolution is a range, not a gaussian resolution
+          trackTime.resType = TimeAssociator::Range;
+        } else {
+          trackTime.resType = TimeAssociator::Gaussian;
+        }
+      } else {
+        // the track is not a central track
+        if constexpr (TTracks::template contains<o2::aod::MFTTracks>()) {
+          // then the track is an MFT track, or an MFT track with additionnal joined info
+          // in this case TrackTimeResIsRange
+          trackTime.resType = TimeAssociator::Range;
+        } else if constexpr (TTracks::template contains<o2::aod::FwdTracks>()) {
+          // the track is a fwd track, with a gaussian time resolution
+          trackTime.resType = TimeAssociator::Gaussian;
+        } else {
+          trackTime.resType = TimeAssociator::Incompatible;
         }
-        trackBegin = track;
       }
-      lastCollisionId = track.collisionId();
+      mTrackTimes.push_back(trackTime);
+      mTrackIds.push_back(track.globalIndex());
     }
-    // trackIterationWindows.push_back(std::make_pair(trackBegin, tracks.end()));
-    if (lastCollisionId >= 0 || mIncludeUnassigned) {
-      LOGP(debug, "Found track block from {} to {}", trackBegin.filteredIndex(), tracks.size() - 1);
-      trackIterationWindows.push_back(std::make_pair(trackBegin, track));
-    }
-
-    // define vector of vectors to store indices of compatible collisions per track
-    std::vector<std::unique_ptr<std::vector<int>>> collsPerTrack(tracksUnfiltered.size());
 
-    // loop over collisions to find time-compatible tracks
-    int64_t bcOffsetMax = mBcWindowForOneSigma * mNumSigmaForTimeCompat + mTimeMargin / o2::constants::lhc::LHCBunchSpacingNS;
+    mCollisionTimes.clear();
+    mCollisionTimes.reserve(collisions.size());
+    mCollisionIds.clear();
+    mCollisionIds.reserve(collisions.size());
     for (const auto& collision : collisions) {
-      const float collTime = collision.collisionTime();
-      const float collTimeRes2 = collision.collisionTimeRes() * collision.collisionTimeRes();
-      uint64_t collBC = collision.bc().globalBC();
-
-      // This is done per block to allow optimization below. Within each block the globalBC increase continously
-      for (auto& iterationWindow : trackIterationWindows) { // o2-linter: disable=const-ref-in-for-loop (iterationWindow is modified)
-        bool iteratorMoved = false;
-        const bool isAssignedTrackWindow = (iterationWindow.first != iterationWindow.second) ? iterationWindow.first.has_collision() : false;
-        for (auto trackInWindow = iterationWindow.first; trackInWindow != iterationWindow.second; ++trackInWindow) {
-          int64_t trackBC = globalBC[trackInWindow.filteredIndex()];
-          if (trackBC < 0) {
-            continue;
-          }
-
-          // Optimization to avoid looping over the full track list each time. This builds on that tracks are sorted by BCs (which they should be because collisions are sorted by BCs)
-          const int64_t bcOffset = trackBC - static_cast<int64_t>(collBC);
-          if constexpr (isCentralBarrel) {
-            // only for blocks with collision association
-            if (isAssignedTrackWindow) {
-              constexpr int margin = 200;
-              if (!iteratorMoved && bcOffset > -bcOffsetMax - margin) {
-                iterationWindow.first.setCursor(trackInWindow.filteredIndex());
-                iteratorMoved = true;
-                LOGP(debug, "Moving iterator begin {}", trackInWindow.filteredIndex());
-              } else if (bcOffset > bcOffsetMax + margin) {
-                LOGP(debug, "Stopping iterator {}", trackInWindow.filteredIndex());
-                break;
-              }
-            }
-          }
-
-          int64_t bcOffsetWindow = trackBCCache[trackInWindow.filteredIndex()] - static_cast<int64_t>(collBC);
-          if (std::abs(bcOffsetWindow) > bcOffsetMax) {
-            continue;
-          }
-
-          float trackTime = 0;
-          float trackTimeRes = 0;
-          if constexpr (isCentralBarrel) {
-            if (mUsePvAssociation && trackInWindow.isPVContributor()) {
-              trackTime = trackInWindow.collision().collisionTime(); // if PV contributor, we assume the time to be the one of the collision
-              trackTimeRes = o2::constants::lhc::LHCBunchSpacingNS;  // 1 BC
-            } else {
-              trackTime = trackInWindow.trackTime();
-              trackTimeRes = trackInWindow.trackTimeRes();
-            }
-          } else {
-            trackTime = trackInWindow.trackTime();
-            trackTimeRes = trackInWindow.trackTimeRes();
-          }
+      mCollisionTimes.push_back({static_cast<int64_t>(collision.bc().globalBC()), collision.collisionTime(), collision.collisionTimeRes()});
+      mCollisionIds.push_back(collision.globalIndex());
+    }
 
-          const float deltaTime = trackTime - collTime + bcOffset * o2::constants::lhc::LHCBunchSpacingNS;
-          float sigmaTimeRes2 = collTimeRes2 + trackTimeRes * trackTimeRes;
-          LOGP(debug, "collision time={}, collision time res={}, track time={}, track time res={}, bc collision={}, bc track={}, delta time={}", collTime, collision.collisionTimeRes(), trackInWindow.trackTime(), trackInWindow.trackTimeRes(), collBC, trackBC, deltaTime);
+    // find all time-compatible pairs at once, tracks are sorted in BC and each collision only tests the tracks in its BC window
+    mTimeAssociator.setNumSigmaForTimeCompat(mNumSigmaForTimeCompat);
+    mTimeAssociator.setTimeMargin(mTimeMargin);
+    mTimeAssociator.setBcWindow(mBcWindowForOneSigma);
+    mTimeAssociator.run(mTrackTimes, mCollisionTimes, mFillTableOfCollIdsPerTrack);
 
-          float thresholdTime = 0.;
-          if constexpr (isCentralBarrel) {
-            if (mUsePvAssociation && trackInWindow.isPVContributor()) {
-              thresholdTime = trackTimeRes;
-            } else if (TESTBIT(trackInWindow.flags(), o2::aod::track::TrackTimeResIsRange)) {
-              // the track time resolution is a range, not a gaussian resolution
-              thresholdTime = trackTimeRes + mNumSigmaForTimeCompat * std::sqrt(collTimeRes2) + mTimeMargin;
-            } else {
-              thresholdTime = mNumSigmaForTimeCompat * std::sqrt(sigmaTimeRes2) + mTimeMargin;
-            }
-          } else {
-            // the track is not a central track
-            if constexpr (TTracks::template contains<o2::aod::MFTTracks>()) {
-              // then the track is an MFT track, or an MFT track with additionnal joined info
-              // in this case TrackTimeResIsRange
-              thresholdTime = trackTimeRes + mNumSigmaForTimeCompat * std::sqrt(collTimeRes2) + mTimeMargin;
-            } else if constexpr (TTracks::template contains<o2::aod::FwdTracks>()) {
-              // the track is a fwd track, with a gaussian time resolution
-              thresholdTime = mNumSigmaForTimeCompat * std::sqrt(sigmaTimeRes2) + mTimeMargin;
-            }
-          }
-
-          if (std::abs(deltaTime) < thresholdTime) {
-            const auto collIdx = collision.globalIndex();
-            const auto trackIdx = trackInWindow.globalIndex();
-            LOGP(debug, "Filling track id {} for coll id {}", trackIdx, collIdx);
-            association(collIdx, trackIdx);
-            if (mFillTableOfCollIdsPerTrack) {
-              if (collsPerTrack[trackIdx] == nullptr) {
-                collsPerTrack[trackIdx] = std::make_unique<std::vector<int>>();
-              }
-              collsPerTrack[trackIdx].get()->push_back(collIdx);
-            }
-          }
-        }
+    // the associator works on positions in mCollisionTimes and mTrackTimes, mapped back to global indices here
+    for (std::size_t iColl = 0; iColl < mCollisionIds.size(); ++iColl) {
+      const auto collIdx = mCollisionIds[iColl];
+      for (const int* iTrack = mTimeAssociator.tracksBegin(iColl); iTrack != mTimeAssociator.tracksEnd(iColl); ++iTrack) {
+        const auto trackIdx = mTrackIds[*iTrack];
+        LOGP(debug, "Filling track id {} for coll id {}", trackIdx, collIdx);
+        association(collIdx, trackIdx);
       }
     }
+
     // create reverse index track to collisions if enabled
     if (mFillTableOfCollIdsPerTrack) {
-      std::vector<int> empty{};
+      std::vector<int> filteredIndex(tracksUnfiltered.size(), -1);
+      for (std::size_t iTrack = 0; iTrack < mTrackIds.size(); ++iTrack) {
+        filteredIndex[mTrackIds[iTrack]] = iTrack;
+      }
+      std::vector<int> collIds{};
       for (const auto& trackUnfiltered : tracksUnfiltered) {
-
-        const auto trackId = trackUnfiltered.globalIndex();
-        if (collsPerTrack[trackId] == nullptr) {
-          reverseIndices(empty);
-        } else {
-          reverseIndices(*collsPerTrack[trackId].get());
+        collIds.clear();
+        const auto iTrack = filteredIndex[trackUnfiltered.globalIndex()];
+        if (iTrack >= 0) {
+          for (const int* iColl = mTimeAssociator.collisionsBegin(iTrack); iColl != mTimeAssociator.collisionsEnd(iTrack); ++iColl) {
+            collIds.push_back(mCollisionIds[*iColl]);
+          }
         }
+        reverseIndices(collIds);
       }
     }
   }
@@ -310,6 +347,13 @@ class CollisionAssociation
   bool mIncludeUnassigned{true};                                                     // include tracks that were originally not assigned to any collision
   bool mFillTableOfCollIdsPerTrack{false};                                           // fill additional table with vectors of compatible collisions per track
   int mBcWindowForOneSigma{115};                                                     // BC window to be multiplied by the number of sigmas to define maximum window to be considered
+
+  TimeAssociator mTimeAssociator{};                             // sweep-line engine of the time-based association
+  std::vector<TimeAssociator::TrackTime> mTrackTimes{};         // BC, time and resolution of the tracks
+  std::vector<TimeAssociator::CollisionTime> mCollisionTimes{}; // BC, time and resolution of the collisions
+  std::vector<int64_t> mTrackIds{};                             // global index of the tracks
+  std::vector<int64_t> mCollisionIds{};                         // global index of the collisions
+  std::vector<int64_t> mAmbiguousTrackBC{};                     // BC of the ambiguous tracks per track, INT64_MIN if not ambiguous
 };
 
 #endif // COMMON_CORE_COLLISIONASSOCIATION_H_
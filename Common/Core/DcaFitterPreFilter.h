@@ -0,0 +1,146 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file   DcaFitterPreFilter.h
+/// \brief  Geometric pre-filter of track pairs to be handed to o2::vertexing::DCAFitterN
+///
+/// The DCAFitterN seeds its minimisation with the crossings of the circles of the first two tracks
+/// in the transverse plane and drops seeds that are too far apart in XY, beyond the maximum radius
+/// or too far apart in Z. The same checks are done here analytically on the track parameters, with
+/// a tolerance, so that a pair rejected by the pre-filter cannot give any candidate in the fitter
+/// configured with the same cuts. The fit itself and the material corrections are not emulated.
+///
+
+#ifndef COMMON_CORE_DCAFITTERPREFILTER_H_
+#define COMMON_CORE_DCAFITTERPREFILTER_H_
+
+#include <MathUtils/Primitive2D.h>
+#include <ReconstructionDataFormats/TrackParametrization.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+
+namespace o2::common::core
+{
+
+class DcaFitterPreFilter
+{
+ public:
+  // outcome of the pre-filter, one bin per stage in the monitoring histograms
+  enum Status : uint8_t {
+    Accepted = 0,
+    RejectedDistXY, // circles in the transverse plane further apart than maxDXYIni
+    RejectedR,      // all circle crossings beyond maxR
+    RejectedDZ,     // tracks further apart than maxDZIni in Z at all circle crossings within maxR
+    NStatus
+  };
+
+  void setBz(float bz) { mBz = bz; }
+  void setMaxDXYIni(float maxDXYIni) { mMaxDXYIni = maxDXYIni; }
+  void setMaxDZIni(float maxDZIni) { mMaxDZIni = maxDZIni; }
+  void setMaxR(float maxR) { mMaxR = maxR; }
+  void setTolerance(float tolerance) { mTolerance = tolerance; }
+
+  /// Configures the cuts from those of a DCAFitterN
+  template <typename TFitter>
+  void setFromFitter(const TFitter& fitter)
+  {
+    mBz = fitter.getBz();
+    mMaxDXYIni = fitter.getMaxDXYIni();
+    mMaxDZIni = fitter.getMaxDZIni();
+    mMaxR = fitter.getMaxR();
+  }
+
+  /// Checks whether the fitter can find a vertex seed for a pair of tracks
+  /// \param track0 parameters of the first track handed to the fitter
+  /// \param track1 parameters of the second track handed to the fitter
+  /// \return Accepted or the first stage rejecting the pair
+  template <typename TTrackPar>
+  Status check(const TTrackPar& track0, const TTrackPar& track1)
+  {
+    const auto status = evaluate(track0, track1);
+    ++mCounters[status];
+    return status;
+  }
+
+  /// Number of pairs per outcome since the last reset
+  const std::array<uint64_t, NStatus>& getCounters() const { return mCounters; }
+  void resetCounters() { mCounters.fill(0); }
+
+ private:
+  float mBz = 0.f;         // magnetic field (kG), as for the fitter
+  float mMaxDXYIni = 4.f;  // maximum XY distance of the circles, DCAFitterN default
+  float mMaxDZIni = 1.e9f; // maximum Z distance of the tracks at the seed, applied if > 0
+  float mMaxR = 200.f;     // maximum radius of the seed
+  float mTolerance = 0.5f; // margin added to all cuts (cm), absorbs rounding and field-map differences
+  std::array<uint64_t, NStatus> mCounters{};
+
+  template <typename TTrackPar>
+  Status evaluate(const TTrackPar& track0, const TTrackPar& track1) const
+  {
+    o2::math_utils::CircleXYf_t circle0, circle1;
+    float sna0, csa0, sna1, csa1;
+    track0.getCircleParams(mBz, circle0, sna0, csa0);
+    track1.getCircleParams(mBz, circle1, sna1, csa1);
+    if (!(circle0.rC > 0.f && circle1.rC > 0.f)) {
+      return Accepted; // straight tracks (neutral, very high pT or no field), not emulated
+    }
+    const auto& circleA = circle0.rC > circle1.rC ? circle0 : circle1; // largest circle
+    const auto& circleB = circle0.rC > circle1.rC ? circle1 : circle0;
+    const float xDist = circleB.xC - circleA.xC, yDist = circleB.yC - circleA.yC;
+    const float dist = std::sqrt(xDist * xDist + yDist * yDist);
+    if (!(dist > 1.e-6f)) {
+      return Accepted; // concentric circles, left to the fitter
+    }
+
+    // circles not touching: single seed in between, only its XY distance is checked
+    if (dist > circleA.rC + circleB.rC) {
+      return dist - circleA.rC - circleB.rC > mMaxDXYIni + mTolerance ? RejectedDistXY : Accepted;
+    }
+    if (dist + circleB.rC < circleA.rC) {
+      return circleA.rC - dist - circleB.rC > mMaxDXYIni + mTolerance ? RejectedDistXY : Accepted;
+    }
+
+    // two crossings: each of them is a seed, tested for the radius and the Z distance of the tracks
+    const float a = (circleA.rC * circleA.rC - circleB.rC * circleB.rC + dist * dist) / (2.f * dist);
+    const float h = std::sqrt(std::max(circleA.rC * circleA.rC - a * a, 0.f));
+    const float xMid = circleA.xC + a * xDist / dist, yMid = circleA.yC + a * yDist / dist;
+    const float maxR2 = (mMaxR + mTolerance) * (mMaxR + mTolerance);
+    bool isInR = false;
+    for (const float sign : {-1.f, 1.f}) {
+      const float xSeed = xMid - sign * h * yDist / dist, ySeed = yMid + sign * h * xDist / dist;
+      if (xSeed * xSeed + ySeed * ySeed > maxR2) {
+        continue;
+      }
+      isInR = true;
+      if (mMaxDZIni <= 0.f) {
+        return Accepted;
+      }
+      // the fitter propagates each track to the X of the seed in its own frame
+      auto trackAtSeed0 = o2::track::TrackPar(track0);
+      auto trackAtSeed1 = o2::track::TrackPar(track1);
+      if (!trackAtSeed0.propagateParamTo(csa0 * xSeed + sna0 * ySeed, mBz) || !trackAtSeed1.propagateParamTo(csa1 * xSeed + sna1 * ySeed, mBz)) {
+        return Accepted; // not decided analytically
+      }
+      if (std::abs(trackAtSeed0.getZ() - trackAtSeed1.getZ()) <= mMaxDZIni + mTolerance) {
+        return Accepted;
+      }
+    }
+    return isInR ? RejectedDZ : RejectedR;
+  }
+};
+
+} // namespace o2::common::core
+
+#endif // COMMON_CORE_DCAFITTERPREFILTER_H_
@@ -12,6 +12,16 @@
 #ifndef ANALYSIS_CORE_EVENTMIXING_H_
 #define ANALYSIS_CORE_EVENTMIXING_H_
 
+#include <TH1.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+
 namespace eventmixing
 {
 /// Calculate hash for an element based on 2 properties and their bins.
@@ -33,18 +43,279 @@ static int getMixingBin(const T1& vtxBins, const T1& multBins, const T2& vtx, co
     return -1;
   }
 
-  for (unsigned int i = 1; i < vtxBins.size(); i++) {
-    if (vtx < vtxBins.at(i)) {
-      for (unsigned int j = 1; j < multBins.size(); j++) {
-        if (mult < multBins.at(j)) {
-          return i + j * (vtxBins.size() + 1);
-        }
-      }
-    }
+  // first bin edge above the value, found by binary search in the (sorted) bin edges
+  const auto i = std::upper_bound(vtxBins.begin(), vtxBins.end(), vtx) - vtxBins.begin();
+  const auto j = std::upper_bound(multBins.begin(), multBins.end(), mult) - multBins.begin();
+  if (i < static_cast<std::ptrdiff_t>(vtxBins.size()) && j < static_cast<std::ptrdiff_t>(multBins.size())) {
+    return i + j * (vtxBins.size() + 1);
   }
   // overflow
   return -1;
 }
+
+/// Binning axis of a mixing variable, with bins [edges[i], edges[i+1])
+/// The bin is computed directly for equidistant edges and by binary search otherwise
+class MixingAxis
+{
+ public:
+  MixingAxis() = default;
+  template <typename T>
+  explicit MixingAxis(const T& edges) : mEdges(edges.begin(), edges.end())
+  {
+    const int nBins = getNBins();
+    if (nBins < 1) {
+      return;
+    }
+    const double width = (mEdges.back() - mEdges.front()) / nBins;
+    mUniform = width > 0.;
+    for (int i = 1; i < nBins && mUniform; i++) {
+      mUniform = std::abs(mEdges[i] - (mEdges.front() + i * width)) < 1.e-6 * width;
+    }
+    mInvWidth = mUniform ? 1. / width : 0.;
+  }
+
+  int getNBins() const { return static_cast<int>(mEdges.size()) - 1; }
+
+  /// \return index of the bin containing the value, -1 for underflow, overflow and NaN
+  int findBin(double value) const
+  {
+    const int nBins = getNBins();
+    if (!(value >= mEdges.front() && value < mEdges.back())) {
+      return -1;
+    }
+    if (mUniform) {
+      int bin = std::min(static_cast<int>((value - mEdges.front()) * mInvWidth), nBins - 1);
+      // protection against rounding at the bin edges
+      if (value < mEdges[bin]) {
+        bin--;
+      } else if (value >= mEdges[bin + 1]) {
+        bin++;
+      }
+      return bin;
+    }
+    return std::upper_bound(mEdges.begin(), mEdges.end(), value) - mEdges.begin() - 1;
+  }
+
+ private:
+  std::vector<double> mEdges; ///< bin edges
+  bool mUniform = false;      ///< whether the bins are equidistant
+  double mInvWidth = 0.;      ///< inverse of the bin width, for equidistant bins
+};
+
+/// N-dimensional binning of the events for mixing (e.g. z-vertex, multiplicity, event plane)
+class MixingBinning
+{
+ public:
+  MixingBinning() = default;
+
+  /// Add an axis; the global bin index runs fastest along the first axis
+  template <typename T>
+  void addAxis(const T& edges)
+  {
+    mAxes.emplace_back(edges);
+  }
+
+  int getNDimensions() const { return mAxes.size(); }
+  int getNBins() const
+  {
+    int nBins = mAxes.empty() ? 0 : 1;
+    for (const auto& axis : mAxes) {
+      nBins *= axis.getNBins();
+    }
+    return nBins;
+  }
+
+  /// \param values values of the event for each axis, in the order in which the axes were added
+  /// \return global bin index, -1 if any value is outside the binning
+  template <typename... Ts>
+  int getBin(Ts... values) const
+  {
+    static_assert(sizeof...(Ts) > 0, "getBin needs one value per axis");
+    if (sizeof...(Ts) != mAxes.size()) {
+      return -1;
+    }
+    const double valueArray[] = {static_cast<double>(values)...};
+    int bin = 0;
+    int stride = 1;
+    for (std::size_t i = 0; i < mAxes.size(); i++) {
+      const int axisBin = mAxes[i].findBin(valueArray[i]);
+      if (axisBin < 0) {
+        return -1;
+      }
+      bin += axisBin * stride;
+      stride *= mAxes[i].getNBins();
+    }
+    return bin;
+  }
+
+ private:
+  std::vector<MixingAxis> mAxes; ///< axes of the binning
+};
+
+/// Event stored in a mixing pool, with the lightweight records of its particles stored contiguously
+template <typename TRecord>
+struct PooledEvent {
+  int runNumber = -1;           ///< run of the event
+  int64_t collisionId = -1;     ///< identifier of the collision (e.g. global index)
+  std::vector<TRecord> records; ///< particles of the event
+
+  std::span<const TRecord> particles() const { return records; }
+};
+
+/// Event-mixing engine with one bounded-depth pool of events per mixing bin
+/// Each pool is a ring buffer whose particle buffers are recycled when the oldest event is evicted,
+/// so that no memory is allocated once the pools are full.
+/// \tparam TRecord lightweight particle record (e.g. pt, eta, phi, charge) copied into the pools
+template <typename TRecord>
+class EventMixingEngine
+{
+ public:
+  EventMixingEngine() = default;
+
+  /// \param depth maximum number of events per pool
+  /// \param sameRunOnly mix only events from the same run
+  /// \param flushOnRunChange empty all the pools when an event from a new run is added
+  void setStrategy(int depth, bool sameRunOnly = true, bool flushOnRunChange = false)
+  {
+    mDepth = std::max(depth, 1);
+    mSameRunOnly = sameRunOnly;
+    mFlushOnRunChange = flushOnRunChange;
+    mPools.clear();
+  }
+
+  MixingBinning& getBinning() { return mBinning; }
+  const MixingBinning& getBinning() const { return mBinning; }
+
+  template <typename... Ts>
+  int getBin(Ts... values) const
+  {
+    return mBinning.getBin(values...);
+  }
+
+  /// Loop over the events of the pool of a bin, from the oldest one, calling func(const PooledEvent<TRecord>&)
+  /// Events from other runs are skipped if the mixing is restricted to the same run
+  template <typename F>
+  void mixWithPool(int bin, int runNumber, F&& func) const
+  {
+    if (bin < 0 || bin >= static_cast<int>(mPools.size())) {
+      return;
+    }
+    const auto& pool = mPools[bin];
+    for (int i = 0; i < pool.size; i++) {
+      const auto& event = pool.events[(pool.first + i) % mDepth];
+      if (mSameRunOnly && event.runNumber != runNumber) {
+        continue;
+      }
+      func(event);
+    }
+  }
+
+  /// Add an event to the pool of a bin, evicting the oldest event if the pool is full
+  /// \return particle buffer of the new event, empty, to be filled by the caller
+  std::vector<TRecord>& addEvent(int bin, int runNumber, int64_t collisionId)
+  {
+    if (mFlushOnRunChange && runNumber != mLastRunNumber) {
+      clear();
+    }
+    mLastRunNumber = runNumber;
+    if (bin < 0) {
+      mDiscarded.records.clear();
+      return mDiscarded.records;
+    }
+    if (bin >= static_cast<int>(mPools.size())) {
+      mPools.resize(std::max(bin + 1, mBinning.getNBins()));
+    }
+    auto& pool = mPools[bin];
+    if (pool.events.empty()) {
+      pool.events.resize(mDepth);
+    }
+    int slot;
+    if (pool.size < mDepth) {
+      slot = (pool.first + pool.size) % mDepth;
+      pool.size++;
+    } else {
+      slot = pool.first;
+      pool.first = (pool.first + 1) % mDepth;
+    }
+    auto& event = pool.events[slot];
+    event.runNumber = runNumber;
+    event.collisionId = collisionId;
+    event.records.clear(); // keep the capacity of the evicted event
+    return event.records;
+  }
+
+  /// Remove all the events from the pools, keeping the allocated memory
+  void clear()
+  {
+    for (auto& pool : mPools) {
+      for (auto& event : pool.events) {
+        event.records.clear();
+      }
+      pool.first = 0;
+      pool.size = 0;
+    }
+  }
+
+  /// Memory accounting
+  int getNEvents(int bin) const { return (bin >= 0 && bin < static_cast<int>(mPools.size())) ? mPools[bin].size : 0; }
+  std::size_t getNRecords(int bin) const
+  {
+    std::size_t nRecords = 0;
+    mixWithPoolAllRuns(bin, [&nRecords](const PooledEvent<TRecord>& event) { nRecords += event.records.size(); });
+    return nRecords;
+  }
+  std::size_t getAllocatedBytes() const
+  {
+    std::size_t bytes = mPools.capacity() * sizeof(Pool);
+    for (const auto& pool : mPools) {
+      bytes += pool.events.capacity() * sizeof(PooledEvent<TRecord>);
+      for (const auto& event : pool.events) {
+        bytes += event.records.capacity() * sizeof(TRecord);
+      }
+    }
+    return bytes;
+  }
+
+  /// Fill the number of events and particle records stored in each pool, with bin i+1 corresponding to the mixing bin i
+  void fillAccountingHistograms(TH1* hEventsPerBin, TH1* hRecordsPerBin = nullptr) const
+  {
+    for (int bin = 0; bin < static_cast<int>(mPools.size()); bin++) {
+      if (hEventsPerBin) {
+        hEventsPerBin->SetBinContent(bin + 1, getNEvents(bin));
+      }
+      if (hRecordsPerBin) {
+        hRecordsPerBin->SetBinContent(bin + 1, getNRecords(bin));
+      }
+    }
+  }
+
+ private:
+  struct Pool {
+    std::vector<PooledEvent<TRecord>> events; ///< ring buffer of events
+    int first = 0;                            ///< index of the oldest event
+    int size = 0;                             ///< number of events in the pool
+  };
+
+  template <typename F>
+  void mixWithPoolAllRuns(int bin, F&& func) const
+  {
+    if (bin < 0 || bin >= static_cast<int>(mPools.size())) {
+      return;
+    }
+    const auto& pool = mPools[bin];
+    for (int i = 0; i < pool.size; i++) {
+      func(pool.events[(pool.first + i) % mDepth]);
+    }
+  }
+
+  MixingBinning mBinning;          ///< binning of the events
+  std::vector<Pool> mPools;        ///< one pool per mixing bin
+  PooledEvent<TRecord> mDiscarded; ///< buffer returned for events outside the binning
+  int mDepth = 5;                  ///< maximum number of events per pool
+  bool mSameRunOnly = true;        ///< mix only events from the same run
+  bool mFlushOnRunChange = false;  ///< empty the pools when the run changes
+  int mLastRunNumber = -1;         ///< run of the last added event
+};
 }; // namespace eventmixing
 
 #endif /* ANALYSIS_CORE_EVENTMIXING_H_ */
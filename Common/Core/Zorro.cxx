@@ -30,11 +30,13 @@
 #include <RtypesCore.h>
 
 #include <algorithm>
+#include <bit>
 #include <bitset>
 #include <cstddef>
 #include <cstdint>
 #include <map>
 #include <memory>
+#include <span>
 #include <string>
 #include <vector>
 
@@ -230,17 +232,27 @@ std::bitset<128> Zorro::fetch(uint64_t bcGlobalId, uint64_t tolerance)
   }
   uint64_t lastSelectedIdx = mLastSelectedIdx;
   mLastBCglobalId = bcGlobalId;
-  for (size_t i = mLastSelectedIdx; i < mBCranges.size(); i++) {
+
+  /// Ranges are sorted by their start and none is longer than mMaxBCrangeLength, so all the ranges starting before
+  /// bcFrame.getMin() - mMaxBCrangeLength end before the frame: jump over them with a binary search, the last one
+  /// would have been the last selected index of the linear scan. No search needed for increasing BCs.
+  const int64_t firstCandidateBC = bcFrame.getMin().toLong() - mMaxBCrangeLength;
+  size_t firstCandidate = mLastSelectedIdx;
+  if (firstCandidate < mBCrangesMin.size() && mBCrangesMin[firstCandidate] < firstCandidateBC) {
+    firstCandidate = std::lower_bound(mBCrangesMin.begin() + firstCandidate, mBCrangesMin.end(), firstCandidateBC) - mBCrangesMin.begin();
+    mLastSelectedIdx = firstCandidate - 1;
+  }
+  for (size_t i = firstCandidate; i < mBCranges.size(); i++) {
     if (!mBCranges[i].isOutside(bcFrame)) {
-      for (int iMask{0}; iMask < 2; ++iMask) {
-        for (int iTOI{0}; iTOI < 64; ++iTOI) {
-          if (mZorroHelpers->at(i).selMask[iMask] & (1ull << iTOI)) {
-            mLastResult.set(iMask * 64 + iTOI, 1);
-            if (!mAccountedBCranges[i]) {
-              mATcounts[iMask * 64 + iTOI]++;
-              if (mAnalysedTriggers) {
-                mAnalysedTriggers->Fill(iMask * 64 + iTOI);
-              }
+      const auto& helper = (*mZorroHelpers)[i];
+      mLastResult |= std::bitset<128>(helper.selMask[0]) | (std::bitset<128>(helper.selMask[1]) << 64);
+      if (!mAccountedBCranges[i]) {
+        for (int iMask{0}; iMask < 2; ++iMask) {
+          for (uint64_t mask{helper.selMask[iMask]}; mask; mask &= mask - 1) { /// Only loop over the set bits
+            const int iTOI = iMask * 64 + std::countr_zero(mask);
+            mATcounts[iTOI]++;
+            if (mAnalysedTriggers) {
+              mAnalysedTriggers->Fill(iTOI);
             }
           }
         }
@@ -256,6 +268,16 @@ std::bitset<128> Zorro::fetch(uint64_t bcGlobalId, uint64_t tolerance)
   return mLastResult;
 }
 
+std::vector<std::bitset<128>> Zorro::fetch(std::span<const uint64_t> bcGlobalIds, uint64_t tolerance)
+{
+  std::vector<std::bitset<128>> results;
+  results.reserve(bcGlobalIds.size());
+  for (const auto bcGlobalId : bcGlobalIds) {
+    results.push_back(fetch(bcGlobalId, tolerance));
+  }
+  return results;
+}
+
 bool Zorro::isSelected(uint64_t bcGlobalId, uint64_t tolerance, TH2* ToiHisto)
 {
   uint64_t lastSelectedIdx = mLastSelectedIdx;
@@ -318,8 +340,12 @@ void Zorro::setupHelpers(int64_t timestamp)
   std::sort(mZorroHelpers->begin(), mZorroHelpers->end(), [](const auto& a, const auto& b) { return std::min(a.bcAOD, a.bcEvSel) < std::min(b.bcAOD, b.bcEvSel); });
   mBCranges.clear();
   mAccountedBCranges.clear();
+  mBCrangesMin.clear();
+  mMaxBCrangeLength = 0;
   for (const auto& helper : *mZorroHelpers) {
     mBCranges.emplace_back(InteractionRecord::long2IR(std::min(helper.bcAOD, helper.bcEvSel)), InteractionRecord::long2IR(std::max(helper.bcAOD, helper.bcEvSel)));
+    mBCrangesMin.push_back(mBCranges.back().getMin().toLong());
+    mMaxBCrangeLength = std::max(mMaxBCrangeLength, mBCranges.back().getMax().toLong() - mBCrangesMin.back());
   }
   mAccountedBCranges.resize(mBCranges.size(), false);
 }
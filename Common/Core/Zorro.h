@@ -30,6 +30,7 @@
 
 #include <bitset>
 #include <cstdint>
+#include <span>
 #include <string>
 #include <utility>
 #include <vector>
@@ -48,6 +49,7 @@ class Zorro
   Zorro() = default;
   std::vector<int> initCCDB(o2::ccdb::BasicCCDBManager* ccdb, int runNumber, uint64_t timestamp, std::string tois, int bcTolerance = 500);
   std::bitset<128> fetch(uint64_t bcGlobalId, uint64_t tolerance = 100);
+  std::vector<std::bitset<128>> fetch(std::span<const uint64_t> bcGlobalIds, uint64_t tolerance = 100);
   bool isSelected(uint64_t bcGlobalId, uint64_t tolerance = 100, TH2* toiHisto = nullptr);
   bool isNotSelectedByAny(uint64_t bcGlobalId, uint64_t tolerance = 100);
 
@@ -95,6 +97,8 @@ class Zorro
   std::bitset<128> mLastResult;
   std::vector<bool> mAccountedBCranges; /// Avoid double accounting of inspected BC ranges
   std::vector<o2::dataformats::IRFrame> mBCranges;
+  std::vector<int64_t> mBCrangesMin; /// Start of the BC ranges, sorted, for the binary search
+  int64_t mMaxBCrangeLength = 0;     /// Length of the longest BC range
   std::vector<ZorroHelper>* mZorroHelpers = nullptr;
   std::vector<std::string> mTOIs;
   std::vector<int> mTOIidx;
@@ -377,7 +377,7 @@ struct tpcPid {
         if ((in_batch_counter == track_prop_size) || (total_input_count == total_eval_size)) { // If the batch size is reached, reset the counter
           int32_t fill_shift = (exec_counter * track_prop_size - ((total_input_count == total_eval_size) ? (total_input_count % track_prop_size) : 0)) * output_dimensions;
           auto start_network_eval = std::chrono::high_resolution_clock::now();
-          const float* output_network = network.evalModel(track_properties);
+          const float* output_network = network.isIoBindingPossible<float>() ? network.evalModelBound(track_properties) : network.evalModel(track_properties);
           auto stop_network_eval = std::chrono::high_resolution_clock::now();
           duration_network += std::chrono::duration<float, std::ratio<1, 1000000000>>(stop_network_eval - start_network_eval).count();
 
@@ -29,6 +29,7 @@
 #include <Framework/AnalysisHelpers.h>
 #include <Framework/AnalysisTask.h>
 #include <Framework/Configurable.h>
+#include <Framework/HistogramRegistry.h>
 #include <Framework/InitContext.h>
 #include <Framework/runDataProcessing.h>
 
@@ -52,6 +53,8 @@ struct pidTpcService {
   o2::aod::pid::pidTPCConfigurables pidTPCopts;
   o2::aod::pid::pidTPCModule pidTPC;
 
+  HistogramRegistry registry{"registry"};
+
   void init(o2::framework::InitContext& initContext)
   {
     // CCDB boilerplate init
@@ -63,6 +66,7 @@ struct pidTpcService {
 
     // task-specific
     pidTPC.init(ccdb, initContext, pidTPCopts, metadataInfo);
+    pidTPC.initNetworkMonitoring(registry);
   }
 
   void processTracksIU(soa::Join<aod::Collisions, aod::EvSels> const& collisions, soa::Join<aod::TracksIU, aod::TracksCovIU, aod::TracksExtra> const& tracks, aod::BCsWithTimestamps const& bcs)
@@ -29,6 +29,7 @@
 #include <Framework/AnalysisHelpers.h>
 #include <Framework/AnalysisTask.h>
 #include <Framework/Configurable.h>
+#include <Framework/HistogramRegistry.h>
 #include <Framework/InitContext.h>
 #include <Framework/runDataProcessing.h>
 
@@ -52,6 +53,8 @@ struct pidTpcServiceRun2 {
   o2::aod::pid::pidTPCConfigurables pidTPCopts;
   o2::aod::pid::pidTPCModule pidTPC;
 
+  HistogramRegistry registry{"registry"};
+
   void init(o2::framework::InitContext& initContext)
   {
     // CCDB boilerplate init
@@ -63,6 +66,7 @@ struct pidTpcServiceRun2 {
 
     // task-specific
     pidTPC.init(ccdb, initContext, pidTPCopts, metadataInfo);
+    pidTPC.initNetworkMonitoring(registry);
   }
 
   void processTracks(soa::Join<aod::Collisions, aod::EvSels> const& collisions, soa::Join<aod::Tracks, aod::TracksExtra> const& tracks, aod::BCsWithTimestamps const& bcs)
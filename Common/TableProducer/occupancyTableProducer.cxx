@@ -136,6 +136,7 @@ struct OccupancyTableProducer {
 
   std::vector<int> tfList;
   std::vector<std::vector<int64_t>> bcTFMap;
+  std::vector<std::vector<int64_t>> sortedBcTFMap;
 
   std::vector<std::vector<float>> occPrimUnfm80;
   std::vector<std::vector<float>> occFV0AUnfm80;
@@ -187,6 +188,7 @@ struct OccupancyTableProducer {
     // outer vector resized at runtime
     tfList.resize(occVecArraySize);
     bcTFMap.resize(occVecArraySize);
+    sortedBcTFMap.resize(occVecArraySize);
 
     if (buildFullOccTableProducer || buildOnlyOccsPrim || buildOnlyOccsT0V0Prim || buildOnlyOccsFDDT0V0Prim || buildOnlyOccsNtrackDet || buildOnlyOccsMultExtra) {
       occPrimUnfm80.resize(occVecArraySize);
@@ -305,30 +307,63 @@ struct OccupancyTableProducer {
     std::transform(OriginalVec.begin(), OriginalVec.end(), OriginalVec.begin(), [scaleFactor](float x) { return x * scaleFactor; });
   }
 
+  // Replaces the per-bin contributions by their sum over the nBinsInWindow bins up to each bin, cyclic in the TF.
+  // Uses prefix sums, so that the cost is linear in the number of bins whatever the window size
+  std::vector<double> prefixSum;
+  void sumOverDriftWindow(std::vector<float>& vec, const int& nBinsInWindow)
+  {
+    const int nBins = vec.size();
+    if (nBins == 0) {
+      return;
+    }
+    prefixSum.resize(nBins + 1);
+    prefixSum[0] = 0.;
+    for (int i = 0; i < nBins; i++) {
+      prefixSum[i + 1] = prefixSum[i] + vec[i];
+    }
+    const int nFullCycles = nBinsInWindow / nBins;
+    const int nBinsRemaining = nBinsInWindow % nBins;
+    for (int i = 0; i < nBins; i++) {
+      const int first = i - nBinsRemaining + 1;
+      double sum = nFullCycles * prefixSum[nBins];
+      if (first >= 0) {
+        sum += prefixSum[i + 1] - prefixSum[first];
+      } else {
+        sum += prefixSum[i + 1] + prefixSum[nBins] - prefixSum[nBins + first];
+      }
+      vec[i] = sum;
+    }
+  }
+
   template <typename... Vecs>
   void getMedianOccVect(
     std::vector<float>& medianVector,
     std::vector<std::array<int, 2>>& medianPosVec,
     const Vecs&... vectors)
   {
-    const int n = sizeof...(Vecs);                             // Number of vectors
+    constexpr int n = sizeof...(Vecs);                         // Number of vectors
     const int size = std::get<0>(std::tie(vectors...)).size(); // Size of the first vector
 
+    std::array<std::array<double, 2>, n> data; // first element is entry, second is index
     for (int i = 0; i < size; i++) {
-      std::vector<std::array<double, 2>> data; // first element is entry, second is index
       int iEntry = 0;
 
       // Lambda to iterate over all vectors
       auto collect = [&](const auto& vec) {
-        data.push_back({vec[i], static_cast<double>(iEntry)});
+        data[iEntry] = {vec[i], static_cast<double>(iEntry)};
         iEntry++;
       };
       (collect(vectors), ...); // Unpack variadic arguments and apply lambda
 
-      // Sort the data
-      std::sort(data.begin(), data.end(), [](const std::array<double, 2>& a, const std::array<double, 2>& b) {
-        return a[0] < b[0];
-      });
+      // Sort the data, insertion sort for the few estimators, equal entries keep their order
+      for (int j = 1; j < n; j++) {
+        const auto entry = data[j];
+        int k = j;
+        for (; k > 0 && entry[0] < data[k - 1][0]; k--) {
+          data[k] = data[k - 1];
+        }
+        data[k] = entry;
+      }
 
       double median;
       int two = 2;
@@ -727,52 +762,94 @@ struct OccupancyTableProducer {
           fNTrackITSTPCC = nTrackITSTPCC;
         }
         // Processing for bcGrouping of 80 BCs
-        for (int deltaBin = 0; deltaBin < nBCinDrift / bcGrouping; deltaBin++) {
+        // the contribution is only added to the bin of the collision, the sum over the drift time is done per TF below
+        const int binInTF = bin80Zero % (nBCinTF / bcGrouping);
 
-          if constexpr (processMode == kProcessFullOccTableProducer || processMode == kProcessOnlyOccPrim || processMode == kProcessOnlyOccT0V0Prim || processMode == kProcessOnlyOccFDDT0V0Prim || processMode == kProcessOnlyOccNtrackDet || processMode == kProcessOnlyOccMultExtra) {
-            (*tfOccPrimUnfm80)[(bin80Zero + deltaBin) % (nBCinTF / bcGrouping)] += fNumContrib * 1;
-          }
-          if constexpr (processMode == kProcessFullOccTableProducer || processMode == kProcessOnlyOccT0V0Prim || processMode == kProcessOnlyOccFDDT0V0Prim) {
-            (*tfOccFV0AUnfm80)[(bin80Zero + deltaBin) % (nBCinTF / bcGrouping)] += fMultFV0A * 1;
-            (*tfOccFV0CUnfm80)[(bin80Zero + deltaBin) % (nBCinTF / bcGrouping)] += fMultFV0C * 1;
-            (*tfOccFT0AUnfm80)[(bin80Zero + deltaBin) % (nBCinTF / bcGrouping)] += fMultFT0A * 1;
-            (*tfOccFT0CUnfm80)[(bin80Zero + deltaBin) % (nBCinTF / bcGrouping)] += fMultFT0C * 1;
-          }
-          if constexpr (processMode == kProcessFullOccTableProducer || processMode == kProcessOnlyOccFDDT0V0Prim) {
-            (*tfOccFDDAUnfm80)[(bin80Zero + deltaBin) % (nBCinTF / bcGrouping)] += fMultFDDA * 1;
-            (*tfOccFDDCUnfm80)[(bin80Zero + deltaBin) % (nBCinTF / bcGrouping)] += fMultFDDC * 1;
-          }
-          if constexpr (processMode == kProcessFullOccTableProducer || processMode == kProcessOnlyOccNtrackDet) {
-            (*tfOccNTrackITSUnfm80)[(bin80Zero + deltaBin) % (nBCinTF / bcGrouping)] += fNTrackITS * 1;
-            (*tfOccNTrackTPCUnfm80)[(bin80Zero + deltaBin) % (nBCinTF / bcGrouping)] += fNTrackTPC * 1;
-            (*tfOccNTrackTRDUnfm80)[(bin80Zero + deltaBin) % (nBCinTF / bcGrouping)] += fNTrackTRD * 1;
-            (*tfOccNTrackTOFUnfm80)[(bin80Zero + deltaBin) % (nBCinTF / bcGrouping)] += fNTrackTOF * 1;
-            (*tfOccNTrackSizeUnfm80)[(bin80Zero + deltaBin) % (nBCinTF / bcGrouping)] += fNTrackSize * 1;
-            (*tfOccNTrackTPCAUnfm80)[(bin80Zero + deltaBin) % (nBCinTF / bcGrouping)] += fNTrackTPCA * 1;
-            (*tfOccNTrackTPCCUnfm80)[(bin80Zero + deltaBin) % (nBCinTF / bcGrouping)] += fNTrackTPCC * 1;
-            (*tfOccNTrackITSTPCAUnfm80)[(bin80Zero + deltaBin) % (nBCinTF / bcGrouping)] += fNTrackITSTPCA * 1;
-            (*tfOccNTrackITSTPCCUnfm80)[(bin80Zero + deltaBin) % (nBCinTF / bcGrouping)] += fNTrackITSTPCC * 1;
-          }
-          if constexpr (processMode == kProcessFullOccTableProducer || processMode == kProcessOnlyOccNtrackDet || processMode == kProcessOnlyOccMultExtra) {
-            (*tfOccNTrackITSTPCUnfm80)[(bin80Zero + deltaBin) % (nBCinTF / bcGrouping)] += fNTrackITSTPC * 1;
-          }
+        if constexpr (processMode == kProcessFullOccTableProducer || processMode == kProcessOnlyOccPrim || processMode == kProcessOnlyOccT0V0Prim || processMode == kProcessOnlyOccFDDT0V0Prim || processMode == kProcessOnlyOccNtrackDet || processMode == kProcessOnlyOccMultExtra) {
+          (*tfOccPrimUnfm80)[binInTF] += fNumContrib * 1;
+        }
+        if constexpr (processMode == kProcessFullOccTableProducer || processMode == kProcessOnlyOccT0V0Prim || processMode == kProcessOnlyOccFDDT0V0Prim) {
+          (*tfOccFV0AUnfm80)[binInTF] += fMultFV0A * 1;
+          (*tfOccFV0CUnfm80)[binInTF] += fMultFV0C * 1;
+          (*tfOccFT0AUnfm80)[binInTF] += fMultFT0A * 1;
+          (*tfOccFT0CUnfm80)[binInTF] += fMultFT0C * 1;
+        }
+        if constexpr (processMode == kProcessFullOccTableProducer || processMode == kProcessOnlyOccFDDT0V0Prim) {
+          (*tfOccFDDAUnfm80)[binInTF] += fMultFDDA * 1;
+          (*tfOccFDDCUnfm80)[binInTF] += fMultFDDC * 1;
+        }
+        if constexpr (processMode == kProcessFullOccTableProducer || processMode == kProcessOnlyOccNtrackDet) {
+          (*tfOccNTrackITSUnfm80)[binInTF] += fNTrackITS * 1;
+          (*tfOccNTrackTPCUnfm80)[binInTF] += fNTrackTPC * 1;
+          (*tfOccNTrackTRDUnfm80)[binInTF] += fNTrackTRD * 1;
+          (*tfOccNTrackTOFUnfm80)[binInTF] += fNTrackTOF * 1;
+          (*tfOccNTrackSizeUnfm80)[binInTF] += fNTrackSize * 1;
+          (*tfOccNTrackTPCAUnfm80)[binInTF] += fNTrackTPCA * 1;
+          (*tfOccNTrackTPCCUnfm80)[binInTF] += fNTrackTPCC * 1;
+          (*tfOccNTrackITSTPCAUnfm80)[binInTF] += fNTrackITSTPCA * 1;
+          (*tfOccNTrackITSTPCCUnfm80)[binInTF] += fNTrackITSTPCC * 1;
+        }
+        if constexpr (processMode == kProcessFullOccTableProducer || processMode == kProcessOnlyOccNtrackDet || processMode == kProcessOnlyOccMultExtra) {
+          (*tfOccNTrackITSTPCUnfm80)[binInTF] += fNTrackITSTPC * 1;
+        }
 
-          if constexpr (processMode == kProcessFullOccTableProducer || processMode == kProcessOnlyOccMultExtra) {
-            (*tfOccMultNTracksHasITSUnfm80)[(bin80Zero + deltaBin) % (nBCinTF / bcGrouping)] += collision.multNTracksHasITS() * 1;
-            (*tfOccMultNTracksHasTPCUnfm80)[(bin80Zero + deltaBin) % (nBCinTF / bcGrouping)] += collision.multNTracksHasTPC() * 1;
-            (*tfOccMultNTracksHasTOFUnfm80)[(bin80Zero + deltaBin) % (nBCinTF / bcGrouping)] += collision.multNTracksHasTOF() * 1;
-            (*tfOccMultNTracksHasTRDUnfm80)[(bin80Zero + deltaBin) % (nBCinTF / bcGrouping)] += collision.multNTracksHasTRD() * 1;
-            (*tfOccMultNTracksITSOnlyUnfm80)[(bin80Zero + deltaBin) % (nBCinTF / bcGrouping)] += collision.multNTracksITSOnly() * 1;
-            (*tfOccMultNTracksTPCOnlyUnfm80)[(bin80Zero + deltaBin) % (nBCinTF / bcGrouping)] += collision.multNTracksTPCOnly() * 1;
-            (*tfOccMultNTracksITSTPCUnfm80)[(bin80Zero + deltaBin) % (nBCinTF / bcGrouping)] += collision.multNTracksITSTPC() * 1;
-            (*tfOccMultAllTracksTPCOnlyUnfm80)[(bin80Zero + deltaBin) % (nBCinTF / bcGrouping)] += collision.multAllTracksTPCOnly() * 1;
-          }
+        if constexpr (processMode == kProcessFullOccTableProducer || processMode == kProcessOnlyOccMultExtra) {
+          (*tfOccMultNTracksHasITSUnfm80)[binInTF] += collision.multNTracksHasITS() * 1;
+          (*tfOccMultNTracksHasTPCUnfm80)[binInTF] += collision.multNTracksHasTPC() * 1;
+          (*tfOccMultNTracksHasTOFUnfm80)[binInTF] += collision.multNTracksHasTOF() * 1;
+          (*tfOccMultNTracksHasTRDUnfm80)[binInTF] += collision.multNTracksHasTRD() * 1;
+          (*tfOccMultNTracksITSOnlyUnfm80)[binInTF] += collision.multNTracksITSOnly() * 1;
+          (*tfOccMultNTracksTPCOnlyUnfm80)[binInTF] += collision.multNTracksTPCOnly() * 1;
+          (*tfOccMultNTracksITSTPCUnfm80)[binInTF] += collision.multNTracksITSTPC() * 1;
+          (*tfOccMultAllTracksTPCOnlyUnfm80)[binInTF] += collision.multAllTracksTPCOnly() * 1;
         }
       }
       // collision Loop is over
 
       occupancyQA.fill(HIST("h_TF_in_DataFrame"), tfCounted);
 
+      // Sum the contributions over the drift time following each collision, linear in the number of bins
+      const int nBinsInDrift = nBCinDrift / bcGrouping;
+      for (uint i = 0; i < tfCounted; i++) {
+        if constexpr (processMode == kProcessFullOccTableProducer || processMode == kProcessOnlyOccPrim || processMode == kProcessOnlyOccT0V0Prim || processMode == kProcessOnlyOccFDDT0V0Prim || processMode == kProcessOnlyOccNtrackDet || processMode == kProcessOnlyOccMultExtra) {
+          sumOverDriftWindow(occPrimUnfm80[i], nBinsInDrift);
+        }
+        if constexpr (processMode == kProcessFullOccTableProducer || processMode == kProcessOnlyOccT0V0Prim || processMode == kProcessOnlyOccFDDT0V0Prim) {
+          sumOverDriftWindow(occFV0AUnfm80[i], nBinsInDrift);
+          sumOverDriftWindow(occFV0CUnfm80[i], nBinsInDrift);
+          sumOverDriftWindow(occFT0AUnfm80[i], nBinsInDrift);
+          sumOverDriftWindow(occFT0CUnfm80[i], nBinsInDrift);
+        }
+        if constexpr (processMode == kProcessFullOccTableProducer || processMode == kProcessOnlyOccFDDT0V0Prim) {
+          sumOverDriftWindow(occFDDAUnfm80[i], nBinsInDrift);
+          sumOverDriftWindow(occFDDCUnfm80[i], nBinsInDrift);
+        }
+        if constexpr (processMode == kProcessFullOccTableProducer || processMode == kProcessOnlyOccNtrackDet) {
+          sumOverDriftWindow(occNTrackITSUnfm80[i], nBinsInDrift);
+          sumOverDriftWindow(occNTrackTPCUnfm80[i], nBinsInDrift);
+          sumOverDriftWindow(occNTrackTRDUnfm80[i], nBinsInDrift);
+          sumOverDriftWindow(occNTrackTOFUnfm80[i], nBinsInDrift);
+          sumOverDriftWindow(occNTrackSizeUnfm80[i], nBinsInDrift);
+          sumOverDriftWindow(occNTrackTPCAUnfm80[i], nBinsInDrift);
+          sumOverDriftWindow(occNTrackTPCCUnfm80[i], nBinsInDrift);
+          sumOverDriftWindow(occNTrackITSTPCAUnfm80[i], nBinsInDrift);
+          sumOverDriftWindow(occNTrackITSTPCCUnfm80[i], nBinsInDrift);
+        }
+        if constexpr (processMode == kProcessFullOccTableProducer || processMode == kProcessOnlyOccNtrackDet || processMode == kProcessOnlyOccMultExtra) {
+          sumOverDriftWindow(occNTrackITSTPCUnfm80[i], nBinsInDrift);
+        }
+        if constexpr (processMode == kProcessFullOccTableProducer || processMode == kProcessOnlyOccMultExtra) {
+          sumOverDriftWindow(occMultNTracksHasITSUnfm80[i], nBinsInDrift);
+          sumOverDriftWindow(occMultNTracksHasTPCUnfm80[i], nBinsInDrift);
+          sumOverDriftWindow(occMultNTracksHasTOFUnfm80[i], nBinsInDrift);
+          sumOverDriftWindow(occMultNTracksHasTRDUnfm80[i], nBinsInDrift);
+          sumOverDriftWindow(occMultNTracksITSOnlyUnfm80[i], nBinsInDrift);
+          sumOverDriftWindow(occMultNTracksTPCOnlyUnfm80[i], nBinsInDrift);
+          sumOverDriftWindow(occMultNTracksITSTPCUnfm80[i], nBinsInDrift);
+          sumOverDriftWindow(occMultAllTracksTPCOnlyUnfm80[i], nBinsInDrift);
+        }
+      }
+
       std::vector<int64_t> sortedTfIDList = tfIDList;
       std::sort(sortedTfIDList.begin(), sortedTfIDList.end());
       auto last = std::unique(sortedTfIDList.begin(), sortedTfIDList.end());
@@ -1018,6 +1095,11 @@ struct OccupancyTableProducer {
       }
 
       // Create a BC index table.
+      // sorted copies of the BC lists, to look the BCs up with a binary search
+      for (int i = 0; i < occVecArraySize; i++) {
+        sortedBcTFMap[i] = bcTFMap[i];
+        std::sort(sortedBcTFMap[i].begin(), sortedBcTFMap[i].end());
+      }
       int64_t occIDX = -1;
       int idx = -1;
       for (auto const& bc : BCs) {
@@ -1031,8 +1113,7 @@ struct OccupancyTableProducer {
           LOG(error) << "DEBUG :: SEVERE :: BC  Timeframe not in the list";
         }
 
-        auto it = std::find(bcTFMap[idx].begin(), bcTFMap[idx].end(), bc.globalIndex()); // will find the iterator where object is placed.
-        if (it != bcTFMap[idx].end()) {
+        if (std::binary_search(sortedBcTFMap[idx].begin(), sortedBcTFMap[idx].end(), bc.globalIndex())) {
           occIDX = idx; // Element is in the vector
         } else {
           occIDX = -1; // Element is not in the vector
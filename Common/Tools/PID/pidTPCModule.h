@@ -33,14 +33,17 @@
 #include <Framework/AnalysisDataModel.h>
 #include <Framework/AnalysisHelpers.h>
 #include <Framework/Configurable.h>
+#include <Framework/HistogramSpec.h>
 #include <Framework/RunningWorkflowInfo.h>
 #include <Framework/runDataProcessing.h>
 #include <ReconstructionDataFormats/PID.h>
 
+#include <TH1.h>
 #include <TMatrixD.h> // IWYU pragma: keep (do not replace with TMatrixDfwd.h)
 #include <TMatrixDfwd.h>
 #include <TRandom.h>
 
+#include <algorithm>
 #include <chrono>
 #include <cstddef>
 #include <cstdint>
@@ -49,6 +52,7 @@
 #include <memory>
 #include <ratio>
 #include <string>
+#include <utility>
 #include <vector>
 
 namespace o2::aod
@@ -98,6 +102,8 @@ struct pidTPCConfigurables : o2::framework::ConfigurableGroup {
   o2::framework::Configurable<std::string> networkPathCCDB{"networkPathCCDB", "Analysis/PID/TPC/ML", "Path on CCDB"};
   o2::framework::Configurable<bool> enableNetworkOptimizations{"enableNetworkOptimizations", 1, "(bool) If the neural network correction is used, this enables GraphOptimizationLevel::ORT_ENABLE_EXTENDED in the ONNX session"};
   o2::framework::Configurable<int> networkSetNumThreads{"networkSetNumThreads", 0, "Especially important for running on a SLURM cluster. Sets the number of threads used for execution."};
+  o2::framework::Configurable<int> networkChunkSize{"networkChunkSize", 0, "(int) If > 0, all mass hypotheses are evaluated in one stream of chunks of this many entries, reusing the bound network buffers. 0: one evaluation per mass hypothesis"};
+  o2::framework::Configurable<int> networkCacheSize{"networkCacheSize", 0, "(int) Number of autofetched networks for different validity ranges kept in memory, to avoid downloading them again. 0: no cache"};
   // Configuration flags to include and exclude particle hypotheses
   o2::framework::Configurable<int> savedEdxsCorrected{"savedEdxsCorrected", -1, {"Save table with corrected dE/dx calculated on the spot. 0: off, 1: on, -1: auto"}};
   o2::framework::Configurable<bool> useCorrecteddEdx{"useCorrecteddEdx", false, "(bool) If true, use corrected dEdx value in Nsigma calculation instead of the one in the AO2D"};
@@ -212,6 +218,16 @@ class pidTPCModule
   std::map<std::string, std::string> headers;
   std::vector<int> speciesNetworkFlags = std::vector<int>(9);
   std::string networkVersion;
+  std::vector<float> networkTrackFeatures; // input features of the tracks, without the mass hypothesis
+  std::vector<float> networkInput;         // network input if the model cannot be evaluated on pre-bound buffers
+  std::shared_ptr<TH1> hNetworkChunkTime;  // evaluation time per chunk of the streamed network correction
+
+  // Networks of other validity ranges kept in memory, the most recently used last
+  struct CachedNetwork {
+    ml::OnnxModel model; // initialised model, with its validity range
+    std::string version; // NN-Version of the model
+  };
+  std::vector<CachedNetwork> networkCache;
 
   // To get automatically the proper Hadronic Rate
   std::string irSource = "";
@@ -434,6 +450,45 @@ class pidTPCModule
     }
   } // end init
 
+  //__________________________________________________
+  template <typename THistoRegistry>
+  void initNetworkMonitoring(THistoRegistry& registry)
+  {
+    if (pidTPCopts.useNetworkCorrection && pidTPCopts.networkChunkSize.value > 0) {
+      hNetworkChunkTime = registry.template add<TH1>("hNetworkChunkTime", "Network evaluation time per chunk;#it{t} (#mus);chunks", o2::framework::kTH1F, {{2000, 0., 20000.}});
+    }
+  }
+
+  //__________________________________________________
+  /// Swaps in a cached network valid for the timestamp, the current one taking its place in the cache
+  bool loadCachedNetwork(const uint64_t timestamp)
+  {
+    auto cached = std::find_if(networkCache.begin(), networkCache.end(), [timestamp](const auto& entry) { return timestamp >= entry.model.getValidityFrom() && timestamp <= entry.model.getValidityUntil(); });
+    if (cached == networkCache.end()) {
+      return false;
+    }
+    std::swap(network, cached->model);
+    std::swap(networkVersion, cached->version);
+    std::rotate(cached, cached + 1, networkCache.end());
+    LOG(info) << "Using cached network for timestamp " << timestamp << ", validity " << network.getValidityFrom() << " - " << network.getValidityUntil();
+    return true;
+  }
+
+  //__________________________________________________
+  /// Moves the current network to the cache before a new one is loaded, dropping the least recently used one if the cache is full
+  void cacheNetwork()
+  {
+    if (pidTPCopts.networkCacheSize.value <= 0 || !network.getSession()) {
+      return;
+    }
+    networkCache.emplace_back();
+    std::swap(network, networkCache.back().model);
+    std::swap(networkVersion, networkCache.back().version);
+    if (networkCache.size() > static_cast<std::size_t>(pidTPCopts.networkCacheSize.value)) {
+      networkCache.erase(networkCache.begin());
+    }
+  }
+
   //__________________________________________________
   template <typename TCCDB, typename M, typename T, typename B>
   std::vector<float> createNetworkPrediction(TCCDB& ccdb, soa::Join<aod::Collisions, aod::EvSels> const& collisions, M const& mults, T const& tracks, B const& bcs, const size_t size)
@@ -477,8 +532,9 @@ class pidTPCModule
         response->PrintAll();
       }
 
-      if (bc.timestamp() < network.getValidityFrom() || bc.timestamp() > network.getValidityUntil()) { // fetches network only if the runnumbers change
+      if ((bc.timestamp() < network.getValidityFrom() || bc.timestamp() > network.getValidityUntil()) && !loadCachedNetwork(bc.timestamp())) { // fetches network only if the runnumbers change
         LOG(info) << "Fetching network for timestamp: " << bc.timestamp();
+        cacheNetwork();
         bool retrieveSuccess = ccdb->getCCDBAccessor().retrieveBlob(pidTPCopts.networkPathCCDB.value, ".", metadata, bc.timestamp(), false, pidTPCopts.networkPathLocally.value, "", "", &headers);
         networkVersion = headers["NN-Version"];
         if (retrieveSuccess) {
@@ -502,9 +558,7 @@ class pidTPCModule
     const float nNclNormalization = response->GetNClNormalization();
     float duration_network = 0;
 
-    std::vector<float> track_properties(track_prop_size);
     uint64_t counter_track_props = 0;
-    int loop_counter = 0;
 
     // To load the Hadronic rate once for each collision
     float hadronicRateBegin = 0.;
@@ -535,78 +589,111 @@ class pidTPCModule
     constexpr auto NetworkVersionV2 = "2";
     constexpr auto NetworkVersionV3 = "3";
     constexpr auto NetworkVersionV4 = "4";
-    for (int j = 0; j < NParticleTypes; j++) { // Loop over particle number for which network correction is used
-      for (auto const& trk : tracks) {
-        if (!trk.hasTPC()) {
+    // The input features do not depend on the mass hypothesis apart from the mass itself: they are filled once per track
+    networkTrackFeatures.assign(track_prop_size, 0.f);
+    float* track_properties = networkTrackFeatures.data();
+    for (auto const& trk : tracks) {
+      if (!trk.hasTPC()) {
+        continue;
+      }
+      if (pidTPCopts.skipTPCOnly) {
+        if (!trk.hasITS() && !trk.hasTRD() && !trk.hasTOF()) {
           continue;
         }
-        if (pidTPCopts.skipTPCOnly) {
-          if (!trk.hasITS() && !trk.hasTRD() && !trk.hasTOF()) {
-            continue;
+      }
+      track_properties[counter_track_props] = trk.tpcInnerParam();
+      track_properties[counter_track_props + 1] = trk.tgl();
+      track_properties[counter_track_props + 2] = trk.signed1Pt();
+      track_properties[counter_track_props + 4] = trk.has_collision() ? mults[trk.collisionId()] / 11000. : 1.;
+      track_properties[counter_track_props + 5] = std::sqrt(nNclNormalization / trk.tpcNClsFound());
+      if (input_dimensions == ExpectedInputDimensionsNNV2 && networkVersion == NetworkVersionV2) {
+        track_properties[counter_track_props + 6] = trk.has_collision() ? collisions.iteratorAt(trk.collisionId()).ft0cOccupancyInTimeRange() / 60000. : 1.;
+      }
+      if (input_dimensions == ExpectedInputDimensionsNNV3 && networkVersion == NetworkVersionV3) {
+        track_properties[counter_track_props + 6] = trk.has_collision() ? collisions.iteratorAt(trk.collisionId()).ft0cOccupancyInTimeRange() / 60000. : 1.;
+        if (trk.has_collision()) {
+          if (collsys == CollisionSystemType::kCollSyspp) {
+            track_properties[counter_track_props + 7] = hadronicRateForCollision[trk.collisionId()] / 1500.;
+          } else {
+            track_properties[counter_track_props + 7] = hadronicRateForCollision[trk.collisionId()] / 50.;
           }
-        }
-        track_properties[counter_track_props] = trk.tpcInnerParam();
-        track_properties[counter_track_props + 1] = trk.tgl();
-        track_properties[counter_track_props + 2] = trk.signed1Pt();
-        track_properties[counter_track_props + 3] = o2::track::pid_constants::sMasses[j];
-        track_properties[counter_track_props + 4] = trk.has_collision() ? mults[trk.collisionId()] / 11000. : 1.;
-        track_properties[counter_track_props + 5] = std::sqrt(nNclNormalization / trk.tpcNClsFound());
-        if (input_dimensions == ExpectedInputDimensionsNNV2 && networkVersion == NetworkVersionV2) {
-          track_properties[counter_track_props + 6] = trk.has_collision() ? collisions.iteratorAt(trk.collisionId()).ft0cOccupancyInTimeRange() / 60000. : 1.;
-        }
-        if (input_dimensions == ExpectedInputDimensionsNNV3 && networkVersion == NetworkVersionV3) {
-          track_properties[counter_track_props + 6] = trk.has_collision() ? collisions.iteratorAt(trk.collisionId()).ft0cOccupancyInTimeRange() / 60000. : 1.;
-          if (trk.has_collision()) {
-            if (collsys == CollisionSystemType::kCollSyspp) {
-              track_properties[counter_track_props + 7] = hadronicRateForCollision[trk.collisionId()] / 1500.;
-            } else {
-              track_properties[counter_track_props + 7] = hadronicRateForCollision[trk.collisionId()] / 50.;
-            }
+        } else {
+          // asign Hadronic Rate at beginning of run  if track does not belong to a collision
+          if (collsys == CollisionSystemType::kCollSyspp) {
+            track_properties[counter_track_props + 7] = hadronicRateBegin / 1500.;
           } else {
-            // asign Hadronic Rate at beginning of run  if track does not belong to a collision
-            if (collsys == CollisionSystemType::kCollSyspp) {
-              track_properties[counter_track_props + 7] = hadronicRateBegin / 1500.;
-            } else {
-              track_properties[counter_track_props + 7] = hadronicRateBegin / 50.;
-            }
+            track_properties[counter_track_props + 7] = hadronicRateBegin / 50.;
           }
         }
+      }
 
-        if (input_dimensions == ExpectedInputDimensionsNNV4 && networkVersion == NetworkVersionV4) {
-          track_properties[counter_track_props + 6] = trk.has_collision() ? collisions.iteratorAt(trk.collisionId()).ft0cOccupancyInTimeRange() / 60000. : 1.;
-          if (trk.has_collision()) {
-            if (collsys == CollisionSystemType::kCollSyspp) {
-              track_properties[counter_track_props + 7] = hadronicRateForCollision[trk.collisionId()] / 1500.;
-            } else {
-              track_properties[counter_track_props + 7] = hadronicRateForCollision[trk.collisionId()] / 50.;
-            }
+      if (input_dimensions == ExpectedInputDimensionsNNV4 && networkVersion == NetworkVersionV4) {
+        track_properties[counter_track_props + 6] = trk.has_collision() ? collisions.iteratorAt(trk.collisionId()).ft0cOccupancyInTimeRange() / 60000. : 1.;
+        if (trk.has_collision()) {
+          if (collsys == CollisionSystemType::kCollSyspp) {
+            track_properties[counter_track_props + 7] = hadronicRateForCollision[trk.collisionId()] / 1500.;
           } else {
-            // asign Hadronic Rate at beginning of run  if track does not belong to a collision
-            if (collsys == CollisionSystemType::kCollSyspp) {
-              track_properties[counter_track_props + 7] = hadronicRateBegin / 1500.;
-            } else {
-              track_properties[counter_track_props + 7] = hadronicRateBegin / 50.;
-            }
+            track_properties[counter_track_props + 7] = hadronicRateForCollision[trk.collisionId()] / 50.;
+          }
+        } else {
+          // asign Hadronic Rate at beginning of run  if track does not belong to a collision
+          if (collsys == CollisionSystemType::kCollSyspp) {
+            track_properties[counter_track_props + 7] = hadronicRateBegin / 1500.;
+          } else {
+            track_properties[counter_track_props + 7] = hadronicRateBegin / 50.;
           }
-          track_properties[counter_track_props + 8] = std::fmod(std::fmod(trk.phi(), 2 * M_PI) + 2 * M_PI, M_PI / 9.0);
         }
-        counter_track_props += input_dimensions;
+        track_properties[counter_track_props + 8] = std::fmod(std::fmod(trk.phi(), 2 * M_PI) + 2 * M_PI, M_PI / 9.0);
       }
+      counter_track_props += input_dimensions;
+    }
 
-      auto start_network_eval = std::chrono::high_resolution_clock::now();
-      float* output_network = network.evalModel(track_properties);
-      auto stop_network_eval = std::chrono::high_resolution_clock::now();
-      duration_network += std::chrono::duration<float, std::ratio<1, 1000000000>>(stop_network_eval - start_network_eval).count();
-      for (uint64_t k = 0; k < prediction_size; k += output_dimensions) {
-        for (int l = 0; l < output_dimensions; l++) {
-          network_prediction[k + l + prediction_size * loop_counter] = output_network[k + l];
+    // pre-bound buffers if the network allows it, otherwise a session run on networkInput
+    const bool useIoBinding = network.isIoBindingPossible<float>();
+    auto getNetworkInput = [&](const uint64_t nEntries) -> float* {
+      if (useIoBinding) {
+        return network.getBoundInput<float>(nEntries);
+      }
+      networkInput.resize(nEntries * input_dimensions);
+      return networkInput.data();
+    };
+    auto evalNetwork = [&]() -> const float* { return useIoBinding ? network.evalModelBound<float>() : network.evalModel(networkInput); };
+
+    if (size > 0 && pidTPCopts.networkChunkSize.value > 0) {
+      // Streaming: the entries of all mass hypotheses, in the order of network_prediction, are evaluated in chunks of fixed size
+      const uint64_t nEntries = NParticleTypes * size;
+      const uint64_t chunkSize = pidTPCopts.networkChunkSize.value;
+      for (uint64_t firstEntry = 0; firstEntry < nEntries; firstEntry += chunkSize) {
+        const uint64_t nChunkEntries = std::min(chunkSize, nEntries - firstEntry);
+        float* input = getNetworkInput(nChunkEntries);
+        for (uint64_t k = 0; k < nChunkEntries; k++) {
+          std::copy_n(track_properties + ((firstEntry + k) % size) * input_dimensions, input_dimensions, input + k * input_dimensions);
+          input[k * input_dimensions + 3] = o2::track::pid_constants::sMasses[(firstEntry + k) / size];
+        }
+        auto start_network_eval = std::chrono::high_resolution_clock::now();
+        const float* output_network = evalNetwork();
+        auto stop_network_eval = std::chrono::high_resolution_clock::now();
+        const float duration_chunk = std::chrono::duration<float, std::ratio<1, 1000000000>>(stop_network_eval - start_network_eval).count();
+        duration_network += duration_chunk;
+        if (hNetworkChunkTime) {
+          hNetworkChunkTime->Fill(duration_chunk * 1.e-3);
         }
+        std::copy_n(output_network, nChunkEntries * output_dimensions, network_prediction.data() + firstEntry * output_dimensions);
+      }
+    } else if (size > 0) {
+      for (int j = 0; j < NParticleTypes; j++) { // Loop over particle number for which network correction is used
+        float* input = getNetworkInput(size);
+        std::copy_n(track_properties, track_prop_size, input);
+        for (uint64_t k = 0; k < size; k++) {
+          input[k * input_dimensions + 3] = o2::track::pid_constants::sMasses[j];
+        }
+        auto start_network_eval = std::chrono::high_resolution_clock::now();
+        const float* output_network = evalNetwork();
+        auto stop_network_eval = std::chrono::high_resolution_clock::now();
+        duration_network += std::chrono::duration<float, std::ratio<1, 1000000000>>(stop_network_eval - start_network_eval).count();
+        std::copy_n(output_network, prediction_size, network_prediction.data() + prediction_size * j);
       }
-
-      counter_track_props = 0;
-      loop_counter += 1;
     }
-    track_properties.clear();
 
     auto stop_network_total = std::chrono::high_resolution_clock::now();
     LOG(debug) << "Neural Network for the TPC PID response correction: Time per track (eval ONNX): " << duration_network / (size * 9) << "ns ; Total time (eval ONNX): " << duration_network / 1000000000 << " s";
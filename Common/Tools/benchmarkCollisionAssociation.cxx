@@ -0,0 +1,186 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file     benchmarkCollisionAssociation.cxx
+///
+/// \brief    exec to benchmark the time-based track-to-collision association on a synthetic time frame,
+///           comparing the sweep over BC-sorted tracks with the brute-force test of all track-collision pairs
+///
+
+#include "Common/Core/CollisionAssociation.h"
+
+#include <CommonConstants/LHCConstants.h>
+#include <Framework/Logger.h>
+
+#include <boost/program_options.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace bpo = boost::program_options;
+using o2::aod::track_association::TimeAssociator;
+
+int main(int argc, char* argv[])
+{
+  bpo::options_description options("Allowed options");
+  options.add_options()(
+    "orbits,o", bpo::value<int>()->default_value(32), "Number of orbits in the time frame")(
+    "rate,r", bpo::value<float>()->default_value(50.f), "Interaction rate in kHz")(
+    "tracks,t", bpo::value<int>()->default_value(500), "Mean number of tracks per collision")(
+    "unassigned,u", bpo::value<float>()->default_value(0.1f), "Fraction of tracks without a collision, given the BC of an ambiguous track")(
+    "brute-force", bpo::value<bool>()->default_value(true), "Run the brute-force association for comparison")(
+    "help,h", "Produce help message.");
+  bpo::variables_map arguments;
+  try {
+    bpo::store(parse_command_line(argc, argv, options), arguments);
+    if (arguments.count("help")) {
+      LOG(info) << options;
+      return 0;
+    }
+    bpo::notify(arguments);
+  } catch (const bpo::error& e) {
+    LOG(error) << e.what();
+    LOG(error) << options;
+    return 1;
+  }
+
+  // synthetic time frame: collisions with Poisson spacing, tracks with the BC of their collision and
+  // the time measured by ITS-TPC (gaussian) or ITS only (range), some of them PV contributors
+  const int64_t nBCs = static_cast<int64_t>(arguments["orbits"].as<int>()) * o2::constants::lhc::LHCMaxBunches;
+  const double collisionsPerBC = arguments["rate"].as<float>() * 1.e3 * o2::constants::lhc::LHCBunchSpacingNS * 1.e-9;
+  const float fractionUnassigned = arguments["unassigned"].as<float>();
+  std::mt19937 generator(42);
+  std::exponential_distribution<double> spacing(collisionsPerBC);
+  std::poisson_distribution<int> multiplicity(arguments["tracks"].as<int>());
+  std::normal_distribution<float> gaus(0.f, 1.f);
+  std::uniform_real_distribution<float> uniform(0.f, 1.f);
+
+  std::vector<TimeAssociator::CollisionTime> collisions;
+  std::vector<TimeAssociator::TrackTime> tracks;
+  for (double bc = spacing(generator); bc < nBCs; bc += spacing(generator)) {
+    TimeAssociator::CollisionTime collision;
+    collision.bc = static_cast<int64_t>(bc);
+    collision.timeRes = 10.f + 40.f * uniform(generator);
+    collision.time = collision.timeRes * gaus(generator);
+    collisions.push_back(collision);
+    const float trueTime = (bc - collision.bc) * o2::constants::lhc::LHCBunchSpacingNS;
+    const int nTracks = multiplicity(generator);
+    for (int iTrack = 0; iTrack < nTracks; ++iTrack) {
+      TimeAssociator::TrackTime track;
+      track.bc = collision.bc;
+      const float type = uniform(generator);
+      if (type < 0.3f) {
+        track.resType = TimeAssociator::PvContributor;
+        track.time = collision.time;
+        track.timeRes = o2::constants::lhc::LHCBunchSpacingNS;
+      } else if (type < 0.6f) {
+        track.resType = TimeAssociator::Range;
+        track.timeRes = 1500.f;
+        track.time = trueTime + track.timeRes * (2.f * uniform(generator) - 1.f);
+      } else {
+        track.resType = TimeAssociator::Gaussian;
+        track.timeRes = 50.f + 150.f * uniform(generator);
+        track.time = trueTime + track.timeRes * gaus(generator);
+      }
+      if (uniform(generator) < fractionUnassigned) {
+        if (track.resType == TimeAssociator::PvContributor) {
+          track.resType = TimeAssociator::Gaussian;
+        }
+        if (uniform(generator) < 0.5f) {
+          track.bc = -1; // without ambiguous track
+        }
+      }
+      track.bcCorrected = track.bc + track.time / o2::constants::lhc::LHCBunchSpacingNS;
+      tracks.push_back(track);
+    }
+  }
+
+  TimeAssociator associator;
+  auto start = std::chrono::high_resolution_clock::now();
+  associator.run(tracks, collisions, true);
+  const double timeSweep = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+  LOG(info) << "Time frame: " << nBCs << " BCs, " << collisions.size() << " collisions, " << tracks.size() << " tracks";
+  LOG(info) << "Sweep association: " << associator.getNumPairs() << " pairs in " << timeSweep * 1.e3 << " ms";
+
+  if (!arguments["brute-force"].as<bool>()) {
+    return 0;
+  }
+
+  // brute force testing the time compatibility of all track-collision pairs, collisions and tracks in index order,
+  // without the BC window pre-selection of the sweep, so that pairs lost by the window are found as well
+  std::vector<int> bruteForcePairs;
+  std::vector<bool> bruteForceInWindow;
+  const int64_t bcOffsetMax = associator.getBcOffsetMax();
+  start = std::chrono::high_resolution_clock::now();
+  for (std::size_t iColl = 0; iColl < collisions.size(); ++iColl) {
+    for (std::size_t iTrack = 0; iTrack < tracks.size(); ++iTrack) {
+      if (tracks[iTrack].bc < 0) {
+        continue;
+      }
+      if (associator.isCompatible(tracks[iTrack], collisions[iColl])) {
+        bruteForcePairs.push_back(iColl);
+        bruteForcePairs.push_back(iTrack);
+        bruteForceInWindow.push_back(std::abs(tracks[iTrack].bcCorrected - collisions[iColl].bc) <= bcOffsetMax);
+      }
+    }
+  }
+  const double timeBruteForce = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+  // every sweep pair must be compatible, every compatible pair within the BC window must be found by the sweep
+  std::size_t nDifferent = 0;
+  std::size_t nOutsideWindow = 0;
+  std::size_t iPair = 0;
+  auto skipOutsideWindow = [&](std::size_t iColl, int iTrack) {
+    while (iPair + 1 < bruteForcePairs.size() && (bruteForcePairs[iPair] < static_cast<int>(iColl) || (bruteForcePairs[iPair] == static_cast<int>(iColl) && bruteForcePairs[iPair + 1] < iTrack))) {
+      if (bruteForceInWindow[iPair / 2]) {
+        ++nDifferent; // compatible pair within the window missed by the sweep
+      } else {
+        ++nOutsideWindow;
+      }
+      iPair += 2;
+    }
+  };
+  for (std::size_t iColl = 0; iColl < collisions.size(); ++iColl) {
+    for (const int* iTrack = associator.tracksBegin(iColl); iTrack != associator.tracksEnd(iColl); ++iTrack) {
+      skipOutsideWindow(iColl, *iTrack);
+      if (iPair + 1 >= bruteForcePairs.size() || bruteForcePairs[iPair] != static_cast<int>(iColl) || bruteForcePairs[iPair + 1] != *iTrack) {
+        ++nDifferent; // sweep pair not compatible
+        continue;
+      }
+      iPair += 2;
+    }
+  }
+  skipOutsideWindow(collisions.size(), 0);
+  // the reverse index must hold the same pairs, in increasing collision index per track
+  std::size_t nReverse = 0;
+  for (std::size_t iTrack = 0; iTrack < tracks.size(); ++iTrack) {
+    for (const int* iColl = associator.collisionsBegin(iTrack); iColl != associator.collisionsEnd(iTrack); ++iColl, ++nReverse) {
+      if (iColl != associator.collisionsBegin(iTrack) && *iColl <= *(iColl - 1)) {
+        ++nDifferent;
+      }
+    }
+  }
+  if (nReverse != associator.getNumPairs()) {
+    ++nDifferent;
+  }
+
+  LOG(info) << "Brute-force association: " << bruteForcePairs.size() / 2 << " pairs in " << timeBruteForce * 1.e3 << " ms (x" << timeBruteForce / timeSweep << ")";
+  LOG(info) << "Compatible pairs outside the BC window of " << bcOffsetMax << " BCs: " << nOutsideWindow;
+  LOG(info) << "Differences to the brute-force association: " << nDifferent;
+
+  return nDifferent == 0 ? 0 : 2;
+}
@@ -68,6 +68,7 @@
 #include <array>
 #include <chrono>
 #include <cmath>
+#include <cstddef>
 #include <cstdint>
 #include <cstdlib>
 #include <memory>
@@ -92,6 +93,7 @@ struct HfFilter { // Main struct for HF triggers
 
   Configurable<int> activateQA{"activateQA", 0, "flag to enable QA histos (0 no QA, 1 basic QA, 2 extended QA, 3 very extended QA)"};
   Configurable<bool> activateSecVtxForB{"activateSecVtxForB", false, "flag to enable 2nd vertex fitting - only beauty hadrons"};
+  Configurable<bool> activateTiming{"activateTiming", false, "flag to enable the histogram of the CPU time spent per group of triggers"};
 
   // parameters for all triggers
   // event selection
@@ -234,7 +236,28 @@ struct HfFilter { // Main struct for HF triggers
   o2::vertexing::DCAFitterN<2> dfStrangeness;  // fitter for V0s and cascades (2-prong vertex fitter)
   o2::vertexing::DCAFitterN<3> dfStrangeness3; // fitter for Xic+ -> XiPiPi
 
+  // track associated to the current collision, with kinematics at its PV and bachelor selections computed once per collision
+  struct TrackAtPv {
+    o2::track::TrackParCov trackPar{};
+    std::array<float, 2> dca{};
+    std::array<float, 3> pVec{};
+    int64_t globalIndex{-1};
+    int sign{0};
+    bool isFromThisCollision{false}; // not re-associated by the track-to-collision associator
+    int16_t selBeauty3P{kRejected};  // isSelectedTrackForSoftPionOrBeauty<kBeauty3P>, soft-pion bit valid for all triggers but SigmaC
+    int16_t selBeauty4P{kRejected};  // isSelectedTrackForSoftPionOrBeauty<kBeauty4P>
+    int16_t selBtoJPsi{kRejected};   // isSelectedTrackForSoftPionOrBeauty<kBtoJPsiKa>, same for all B -> J/psi channels
+    int16_t selSigmaC{kRejected};    // isSelectedTrackForSoftPionOrBeauty<kSigmaCPPK>, same for all SigmaC triggers
+  };
+  std::vector<TrackAtPv> tracksAtPv;
+  std::vector<std::size_t> softPions;                // indices in tracksAtPv of the D*+ soft pions
+  std::vector<std::size_t> bachelorsForBeauty3P;     // indices in tracksAtPv of the bachelors for B0 -> D*- pi+
+  std::vector<std::size_t> bachelorsForBeautyToJPsi; // indices in tracksAtPv of the bachelors for B -> J/psi X
+  std::vector<std::size_t> softPionsForSigmaC;       // indices in tracksAtPv of the SigmaC soft pions
+  int64_t collisionIdTracksAtPv{-1};                 // collision of the tracks in tracksAtPv, -1 if not filled
+
   std::shared_ptr<TH1> hProcessedEvents;
+  std::shared_ptr<TH2> hTriggerGroupTime;
 
   // QA histos
   std::shared_ptr<TH1> hN2ProngCharmCand, hN3ProngCharmCand;
@@ -353,6 +376,18 @@ struct HfFilter { // Main struct for HF triggers
         hProcessedEvents->GetXaxis()->SetBinLabel(iBin + 1, hfTriggerNames[iBin - 2].data());
     }
 
+    if (activateTiming) {
+      hTriggerGroupTime = registry.add<TH2>("fTriggerGroupTime", "HF - CPU time per collision and group of triggers;;#it{t} (#mus);counts", HistType::kTH2D, {{kNTriggerGroups, -0.5, +kNTriggerGroups - 0.5}, {1000, 0., 10000.}});
+      std::string labels[kNTriggerGroups];
+      labels[kTriggerGroup2Prong] = "2-prong";
+      labels[kTriggerGroup3Prong] = "3-prong";
+      labels[kTriggerGroupCascades] = "#Xi + bachelor(s)";
+      labels[kTriggerGroupDoubleCharm] = "double charm";
+      for (int iBin = 0; iBin < kNTriggerGroups; iBin++) {
+        hTriggerGroupTime->GetXaxis()->SetBinLabel(iBin + 1, labels[iBin].data());
+      }
+    }
+
     if (activateQA) {
       hN2ProngCharmCand = registry.add<TH1>("fN2ProngCharmCand", "Number of 2-prong charm candidates per event;#it{N}_{candidates};counts", HistType::kTH1D, {{50, -0.5, 49.5}});
       hN3ProngCharmCand = registry.add<TH1>("fN3ProngCharmCand", "Number of 3-prong charm candidates per event;#it{N}_{candidates};counts", HistType::kTH1D, {{50, -0.5, 49.5}});
@@ -466,6 +501,57 @@ struct HfFilter { // Main struct for HF triggers
     thresholdBDTScores = {thresholdsBDT.thresholdBDTScoreD0ToKPi, thresholdsBDT.thresholdBDTScoreDPlusToPiKPi, thresholdsBDT.thresholdBDTScoreDSToPiKK, thresholdsBDT.thresholdBDTScoreLcToPiKP, thresholdsBDT.thresholdBDTScoreXicToPiKP};
   }
 
+  /// Propagates the tracks associated to a collision to its PV and evaluates their bachelor selections, only once per collision
+  /// \param collision collision
+  /// \param trackIdsThisCollision indices of the tracks associated to the collision
+  /// \param tracks tracks
+  template <typename TCollision, typename TTrackIndices, typename TTracks>
+  void fillTracksAtPv(TCollision const& collision, TTrackIndices const& trackIdsThisCollision, TTracks const& tracks)
+  {
+    if (collisionIdTracksAtPv == collision.globalIndex()) {
+      return;
+    }
+    collisionIdTracksAtPv = collision.globalIndex();
+    tracksAtPv.clear();
+    softPions.clear();
+    bachelorsForBeauty3P.clear();
+    bachelorsForBeautyToJPsi.clear();
+    softPionsForSigmaC.clear();
+
+    for (const auto& trackId : trackIdsThisCollision) {
+      auto track = tracks.rawIteratorAt(trackId.trackId());
+      auto& trackAtPv = tracksAtPv.emplace_back();
+      trackAtPv.trackPar = getTrackParCov(track);
+      trackAtPv.dca = {track.dcaXY(), track.dcaZ()};
+      trackAtPv.pVec = track.pVector();
+      trackAtPv.globalIndex = track.globalIndex();
+      trackAtPv.sign = track.sign();
+      trackAtPv.isFromThisCollision = track.collisionId() == collision.globalIndex();
+      if (!trackAtPv.isFromThisCollision) {
+        o2::base::Propagator::Instance()->propagateToDCABxByBz({collision.posX(), collision.posY(), collision.posZ()}, trackAtPv.trackPar, 2.f, noMatCorr, &trackAtPv.dca);
+        getPxPyPz(trackAtPv.trackPar, trackAtPv.pVec);
+      }
+      trackAtPv.selBeauty3P = helper.isSelectedTrackForSoftPionOrBeauty<kBeauty3P>(track, trackAtPv.trackPar, trackAtPv.dca);
+      trackAtPv.selBeauty4P = helper.isSelectedTrackForSoftPionOrBeauty<kBeauty4P>(track, trackAtPv.trackPar, trackAtPv.dca);
+      trackAtPv.selBtoJPsi = helper.isSelectedTrackForSoftPionOrBeauty<kBtoJPsiKa>(track, trackAtPv.trackPar, trackAtPv.dca);
+      trackAtPv.selSigmaC = helper.isSelectedTrackForSoftPionOrBeauty<kSigmaCPPK>(track, trackAtPv.trackPar, trackAtPv.dca);
+
+      const auto iTrack = tracksAtPv.size() - 1;
+      if (TESTBIT(trackAtPv.selBeauty3P, kSoftPion)) {
+        softPions.push_back(iTrack);
+      }
+      if (TESTBIT(trackAtPv.selBeauty3P, kForBeauty)) {
+        bachelorsForBeauty3P.push_back(iTrack);
+      }
+      if (TESTBIT(trackAtPv.selBtoJPsi, kForBeauty)) {
+        bachelorsForBeautyToJPsi.push_back(iTrack);
+      }
+      if (TESTBIT(trackAtPv.selSigmaC, kSoftPionForSigmaC)) {
+        softPionsForSigmaC.push_back(iTrack);
+      }
+    }
+  }
+
   void process(CollsWithEvSel const& collisions,
                aod::BCsWithTimestamps const&,
                aod::V0s const& v0s,
@@ -479,6 +565,11 @@ struct HfFilter { // Main struct for HF triggers
                aod::V0PhotonsKF const& photons,
                aod::V0Legs const&)
   {
+    // triggers already decided are not evaluated further, unless QA histograms or optimisation trees are filled for all candidates
+    const bool skipDecidedTriggers = !activateQA && !applyOptimisation;
+    auto tracksWithItsPid = soa::Attach<BigTracksPID, aod::pidits::ITSNSigmaPr, aod::pidits::ITSNSigmaDe>(tracks);
+    collisionIdTracksAtPv = -1; // collision indices restart in each time frame
+
     for (const auto& collision : collisions) {
 
       bool keepEvent[kNtriggersHF]{false};
@@ -529,6 +620,18 @@ struct HfFilter { // Main struct for HF triggers
 
       hProcessedEvents->Fill(0);
 
+      auto timeStart = std::chrono::high_resolution_clock::now();
+      auto fillTriggerGroupTime = [&](const TriggerGroup triggerGroup) {
+        if (activateTiming) {
+          const auto timeNow = std::chrono::high_resolution_clock::now();
+          hTriggerGroupTime->Fill(triggerGroup, std::chrono::duration<double, std::micro>(timeNow - timeStart).count());
+          timeStart = timeNow;
+        }
+      };
+
+      // tracks associated to this collision, propagated to the PV only when a candidate needs them
+      auto trackIdsThisCollision = trackIndices.sliceBy(trackIndicesPerCollision, thisCollId);
+
       std::vector<std::vector<int64_t>> indicesDau2Prong{}, indicesDau2ProngPrompt{};
 
       auto cand2ProngsThisColl = cand2Prongs.sliceBy(hf2ProngPerCollision, thisCollId);
@@ -634,26 +737,29 @@ struct HfFilter { // Main struct for HF triggers
           massD0BarCand = RecoDecay::m(std::array{pVecPos, pVecNeg}, std::array{massKa, massPi});
         }
 
-        auto trackIdsThisCollision = trackIndices.sliceBy(trackIndicesPerCollision, thisCollId);
-        auto tracksWithItsPid = soa::Attach<BigTracksPID, aod::pidits::ITSNSigmaPr, aod::pidits::ITSNSigmaDe>(tracks);
-        for (const auto& trackId : trackIdsThisCollision) { // start loop over tracks
-          auto track = tracksWithItsPid.rawIteratorAt(trackId.trackId());
-
-          if (track.globalIndex() == trackPos.globalIndex() || track.globalIndex() == trackNeg.globalIndex()) {
-            continue;
+        // the loop over tracks stops as soon as all the triggers built from it are decided
+        auto isTrackLoopNeeded2Prong = [&]() {
+          return !skipDecidedTriggers ||
+                 (isD0BeautyTagged && !keepEvent[kBeauty3P]) ||
+                 (isD0CharmTagged && !keepEvent[kFemto2P] && (enableFemtoChannels->get(0u, 0u) || enableFemtoChannels->get(1u, 0u))) ||
+                 (preselJPsiToMuMu && !(keepEvent[kBtoJPsiKa] && keepEvent[kBtoJPsiPi] && keepEvent[kBtoJPsiKstar] && keepEvent[kBtoJPsiPhi] && keepEvent[kBtoJPsiPrKa]));
+        };
+        fillTracksAtPv(collision, trackIdsThisCollision, tracks);
+        for (const auto& trackAtPv : tracksAtPv) { // start loop over tracks
+          if (!isTrackLoopNeeded2Prong()) {
+            break;
           }
-
-          auto trackParThird = getTrackParCov(track);
-          std::array<float, 2> dcaThird{track.dcaXY(), track.dcaZ()};
-          std::array<float, 3> pVecThird = track.pVector();
-          if (track.collisionId() != thisCollId) {
-            o2::base::Propagator::Instance()->propagateToDCABxByBz({collision.posX(), collision.posY(), collision.posZ()}, trackParThird, 2.f, noMatCorr, &dcaThird);
-            getPxPyPz(trackParThird, pVecThird);
+          if (trackAtPv.globalIndex == trackPos.globalIndex() || trackAtPv.globalIndex == trackNeg.globalIndex()) {
+            continue;
           }
+          auto track = tracksWithItsPid.rawIteratorAt(trackAtPv.globalIndex);
+          const auto& trackParThird = trackAtPv.trackPar;
+          const auto& dcaThird = trackAtPv.dca;
+          const auto& pVecThird = trackAtPv.pVec;
 
           // Beauty with D0
           if (!keepEvent[kBeauty3P] && isD0BeautyTagged) {
-            int16_t isTrackSelected = helper.isSelectedTrackForSoftPionOrBeauty<kBeauty3P>(track, trackParThird, dcaThird);
+            int16_t isTrackSelected = trackAtPv.selBeauty3P;
             if (TESTBIT(isTrackSelected, kForBeauty) && ((TESTBIT(selD0InMass, 0) && track.sign() < 0) || (TESTBIT(selD0InMass, 1) && track.sign() > 0))) { // D0 pi-/K- and D0bar pi+/K+
               auto massCandD0Pi = RecoDecay::m(std::array{pVec2Prong, pVecThird}, std::array{massD0, massPi});
               auto massCandD0K = RecoDecay::m(std::array{pVec2Prong, pVecThird}, std::array{massD0, massKa});
@@ -760,21 +866,19 @@ struct HfFilter { // Main struct for HF triggers
                 if (activateQA) {
                   hMassVsPtC[kNCharmParticles]->Fill(ptCand, massDiffDstar);
                 }
-                for (const auto& trackIdB : trackIdsThisCollision) { // start loop over tracks
-                  auto trackB = tracks.rawIteratorAt(trackIdB.trackId());
-                  if (track.globalIndex() == trackB.globalIndex()) {
-                    continue;
+                for (const auto iTrackB : bachelorsForBeauty3P) { // start loop over tracks selected for beauty
+                  if (skipDecidedTriggers && keepEvent[kBeauty3P]) {
+                    break;
                   }
-                  auto trackParFourth = getTrackParCov(trackB);
-                  std::array<float, 2> dcaFourth{trackB.dcaXY(), trackB.dcaZ()};
-                  std::array<float, 3> pVecFourth = trackB.pVector();
-                  if (trackB.collisionId() != thisCollId) {
-                    o2::base::Propagator::Instance()->propagateToDCABxByBz({collision.posX(), collision.posY(), collision.posZ()}, trackParFourth, 2.f, noMatCorr, &dcaFourth);
-                    getPxPyPz(trackParFourth, pVecFourth);
+                  const auto& trackAtPvB = tracksAtPv[iTrackB];
+                  if (track.globalIndex() == trackAtPvB.globalIndex) {
+                    continue;
                   }
+                  const auto& trackParFourth = trackAtPvB.trackPar;
+                  const auto& dcaFourth = trackAtPvB.dca;
+                  const auto& pVecFourth = trackAtPvB.pVec;
 
-                  auto isTrackFourthSelected = helper.isSelectedTrackForSoftPionOrBeauty<kBeauty3P>(trackB, trackParFourth, dcaFourth);
-                  if (track.sign() * trackB.sign() < 0 && TESTBIT(isTrackFourthSelected, kForBeauty)) {
+                  if (track.sign() * trackAtPvB.sign < 0) {
                     auto massCandB0 = RecoDecay::m(std::array{pVecBeauty3Prong, pVecFourth}, std::array{massDStar, massPi});
                     auto pVecBeauty4Prong = RecoDecay::pVec(pVec2Prong, pVecThird, pVecFourth);
                     auto ptCandBeauty4Prong = RecoDecay::pt(pVecBeauty4Prong);
@@ -847,10 +951,13 @@ struct HfFilter { // Main struct for HF triggers
           } // end beauty selection
 
           // 2-prong femto
-          bool isProtonForCharm2Prong = helper.isSelectedTrack4Corr(track, trackParThird, activateQA, hPrDePID[0], hPrDePID[1], kProtonForFemto);
-          bool isDeuteronForCharm2Prong = helper.isSelectedTrack4Corr(track, trackParThird, activateQA, hPrDePID[2], hPrDePID[3], kDeuteronForFemto);
+          bool isProtonForCharm2Prong{false}, isDeuteronForCharm2Prong{false};
+          if (!skipDecidedTriggers || (isD0CharmTagged && !keepEvent[kFemto2P] && trackAtPv.isFromThisCollision)) {
+            isProtonForCharm2Prong = helper.isSelectedTrack4Corr(track, trackParThird, activateQA, hPrDePID[0], hPrDePID[1], kProtonForFemto);
+            isDeuteronForCharm2Prong = helper.isSelectedTrack4Corr(track, trackParThird, activateQA, hPrDePID[2], hPrDePID[3], kDeuteronForFemto);
+          }
 
-          if (track.collisionId() == thisCollId) {
+          if (trackAtPv.isFromThisCollision) {
             if (isProtonForCharm2Prong && !keepEvent[kFemto2P] && enableFemtoChannels->get(0u, 0u) && isD0CharmTagged) {
               float relativeMomentum = helper.computeRelativeMomentum(pVecThird, pVec2Prong, massD0);
               if (applyOptimisation) {
@@ -880,7 +987,7 @@ struct HfFilter { // Main struct for HF triggers
 
           // Beauty with JPsi
           if (preselJPsiToMuMu) {
-            if (!TESTBIT(helper.isSelectedTrackForSoftPionOrBeauty<kBtoJPsiKa>(track, trackParThird, dcaThird), kForBeauty)) { // same for all channels
+            if (!TESTBIT(trackAtPv.selBtoJPsi, kForBeauty)) { // same for all channels
               continue;
             }
             std::array<float, 3> pVecPosVtx{}, pVecNegVtx{}, pVecThirdVtx{}, pVecFourthVtx{};
@@ -909,24 +1016,16 @@ struct HfFilter { // Main struct for HF triggers
             }
             // 4-prong vertices
             if (!keepEvent[kBtoJPsiKstar] || !keepEvent[kBtoJPsiPhi] || !keepEvent[kBtoJPsiPrKa]) {
-              for (const auto& trackIdB : trackIdsThisCollision) { // start loop over tracks
+              for (const auto iTrackB : bachelorsForBeautyToJPsi) { // start loop over tracks selected for beauty to J/psi
                 if (keepEvent[kBtoJPsiKstar] && keepEvent[kBtoJPsiPhi] && keepEvent[kBtoJPsiPrKa]) {
                   break;
                 }
-                auto trackFourth = tracksWithItsPid.rawIteratorAt(trackIdB.trackId());
-                if (trackFourth.globalIndex() == track.globalIndex() || trackFourth.globalIndex() == trackPos.globalIndex() || trackFourth.globalIndex() == trackNeg.globalIndex() || trackFourth.sign() * track.sign() > 0) {
-                  continue;
-                }
-                auto trackParFourth = getTrackParCov(trackFourth);
-                std::array<float, 2> dcaFourth{trackFourth.dcaXY(), trackFourth.dcaZ()};
-                std::array<float, 3> pVecFourth = trackFourth.pVector();
-                if (trackFourth.collisionId() != thisCollId) {
-                  o2::base::Propagator::Instance()->propagateToDCABxByBz({collision.posX(), collision.posY(), collision.posZ()}, trackParFourth, 2.f, noMatCorr, &dcaFourth);
-                  getPxPyPz(trackParFourth, pVecFourth);
-                }
-                if (!TESTBIT(helper.isSelectedTrackForSoftPionOrBeauty<kBtoJPsiKa>(trackFourth, trackParFourth, dcaFourth), kForBeauty)) { // same for all channels
+                const auto& trackAtPvB = tracksAtPv[iTrackB];
+                if (trackAtPvB.globalIndex == track.globalIndex() || trackAtPvB.globalIndex == trackPos.globalIndex() || trackAtPvB.globalIndex == trackNeg.globalIndex() || trackAtPvB.sign * track.sign() > 0) {
                   continue;
                 }
+                auto trackFourth = tracksWithItsPid.rawIteratorAt(trackAtPvB.globalIndex);
+                const auto& trackParFourth = trackAtPvB.trackPar;
                 int nVtxB{0};
                 try {
                   nVtxB = df4.process(trackParPos, trackParNeg, trackParThird, trackParFourth);
@@ -1021,25 +1120,17 @@ struct HfFilter { // Main struct for HF triggers
             if (!keepEvent[kV0Charm2P] && TESTBIT(selV0, kK0S)) {
 
               // we first look for a D*+
-              for (const auto& trackBachelorId : trackIdsThisCollision) { // start loop over tracks
-                auto trackBachelor = tracks.rawIteratorAt(trackBachelorId.trackId());
-                if (trackBachelor.globalIndex() == trackPos.globalIndex() || trackBachelor.globalIndex() == trackNeg.globalIndex() || trackBachelor.globalIndex() == v0.posTrackId() || trackBachelor.globalIndex() == v0.negTrackId()) {
+              for (const auto iTrackBachelor : softPions) { // start loop over tracks selected as soft pions
+                const auto& trackBachelor = tracksAtPv[iTrackBachelor];
+                if (trackBachelor.globalIndex == trackPos.globalIndex() || trackBachelor.globalIndex == trackNeg.globalIndex() || trackBachelor.globalIndex == v0.posTrackId() || trackBachelor.globalIndex == v0.negTrackId()) {
                   continue;
                 }
+                const auto& pVecBachelor = trackBachelor.pVec;
 
-                auto trackParBachelor = getTrackPar(trackBachelor);
-                std::array<float, 2> dcaBachelor{trackBachelor.dcaXY(), trackBachelor.dcaZ()};
-                std::array<float, 3> pVecBachelor = trackBachelor.pVector();
-                if (trackBachelor.collisionId() != thisCollId) {
-                  o2::base::Propagator::Instance()->propagateToDCABxByBz({collision.posX(), collision.posY(), collision.posZ()}, trackParBachelor, 2.f, noMatCorr, &dcaBachelor);
-                  getPxPyPz(trackParBachelor, pVecBachelor);
-                }
-
-                auto isTrackSelected = helper.isSelectedTrackForSoftPionOrBeauty<kV0Charm2P>(trackBachelor, trackParBachelor, dcaBachelor);
-                if (TESTBIT(isTrackSelected, kSoftPion) && ((TESTBIT(selD0InMass, 0) && trackBachelor.sign() > 0) || (TESTBIT(selD0InMass, 1) && trackBachelor.sign() < 0))) {
+                if ((TESTBIT(selD0InMass, 0) && trackBachelor.sign > 0) || (TESTBIT(selD0InMass, 1) && trackBachelor.sign < 0)) {
                   std::array<float, 2> massDausD0{massPi, massKa};
                   auto massD0dau = massD0Cand;
-                  if (trackBachelor.sign() < 0) {
+                  if (trackBachelor.sign < 0) {
                     massDausD0[0] = massKa;
                     massDausD0[1] = massPi;
                     massD0dau = massD0BarCand;
@@ -1120,43 +1211,34 @@ struct HfFilter { // Main struct for HF triggers
         // 2-prong (D0 or D*) with proton for Lc resonances and ThetaC (3100)
         if (!keepEvent[kPrCharm2P] && isD0SignalTagged && (TESTBIT(selD0InMass, 0) || TESTBIT(selD0InMass, 1))) {
           for (const auto& trackProtonId : trackIdsThisCollision) { // start loop over tracks selecting only protons
+            if (skipDecidedTriggers && keepEvent[kPrCharm2P]) {
+              break;
+            }
             auto trackProton = tracks.rawIteratorAt(trackProtonId.trackId());
-            auto trackParBachelorProton = getTrackPar(trackProton);
             if (trackProton.globalIndex() == trackPos.globalIndex() || trackProton.globalIndex() == trackNeg.globalIndex()) {
               continue;
             }
-            std::array<float, 2> dcaInfoBachProton;
-            if (trackProton.collisionId() != thisCollId) {
-              o2::base::Propagator::Instance()->propagateToDCABxByBz({collision.posX(), collision.posY(), collision.posZ()}, trackParBachelorProton, 2.f, noMatCorr, &dcaInfoBachProton);
-            }
             std::array<float, 3> pVecProton = trackProton.pVector();
             bool isSelPIDProton = helper.isSelectedProton4CharmOrBeautyBaryons<false>(trackProton);
             if (isSelPIDProton) {
               if (!keepEvent[kPrCharm2P]) {
                 // we first look for a D*+
-                for (const auto& trackBachelorId : trackIdsThisCollision) { // start loop over tracks to find bachelor pion
+                for (const auto iTrackBachelor : softPions) { // start loop over tracks selected as soft pions to find bachelor pion
                   if (!helper.isSelectedProtonFromLcResoOrThetaC<true>(trackProton)) {
-                    continue;
+                    break;
                   } // stop here if proton below pT threshold for thetaC to avoid computational losses
-                  auto trackBachelor = tracks.rawIteratorAt(trackBachelorId.trackId());
-                  if (trackBachelor.globalIndex() == trackPos.globalIndex() || trackBachelor.globalIndex() == trackNeg.globalIndex() || trackBachelor.globalIndex() == trackProton.globalIndex()) {
+                  const auto& trackBachelor = tracksAtPv[iTrackBachelor];
+                  if (trackBachelor.globalIndex == trackPos.globalIndex() || trackBachelor.globalIndex == trackNeg.globalIndex() || trackBachelor.globalIndex == trackProton.globalIndex()) {
                     continue;
                   }
-                  auto trackParBachelor = getTrackPar(trackBachelor);
-                  std::array<float, 2> dcaBachelor{trackBachelor.dcaXY(), trackBachelor.dcaZ()};
-                  std::array<float, 3> pVecBachelor = trackBachelor.pVector();
-                  if (trackBachelor.collisionId() != thisCollId) {
-                    o2::base::Propagator::Instance()->propagateToDCABxByBz({collision.posX(), collision.posY(), collision.posZ()}, trackParBachelor, 2.f, noMatCorr, &dcaBachelor);
-                    getPxPyPz(trackParBachelor, pVecBachelor);
-                  }
-                  auto isTrackSelected = helper.isSelectedTrackForSoftPionOrBeauty<kPrCharm2P>(trackBachelor, trackParBachelor, dcaBachelor);
-                  if (TESTBIT(isTrackSelected, kSoftPion) && ((TESTBIT(selD0InMass, 0) && trackBachelor.sign() > 0) || (TESTBIT(selD0InMass, 1) && trackBachelor.sign() < 0))) {
+                  const auto& pVecBachelor = trackBachelor.pVec;
+                  if ((TESTBIT(selD0InMass, 0) && trackBachelor.sign > 0) || (TESTBIT(selD0InMass, 1) && trackBachelor.sign < 0)) {
                     if (pt2Prong < cutsPtDeltaMassCharmReso->get(3u, 12u)) {
                       continue;
                     }
                     std::array<float, 2> massDausD0{massPi, massKa};
                     auto massD0dau = massD0Cand;
-                    if (trackBachelor.sign() < 0) {
+                    if (trackBachelor.sign < 0) {
                       massDausD0[0] = massKa;
                       massDausD0[1] = massPi;
                       massD0dau = massD0BarCand;
@@ -1269,6 +1351,7 @@ struct HfFilter { // Main struct for HF triggers
         } // end Lc resonances via D0-proton decays
 
       } // end loop over 2-prong candidates
+      fillTriggerGroupTime(kTriggerGroup2Prong);
 
       std::vector<std::vector<int64_t>> indicesDau3Prong{}, indicesDau3ProngPrompt{};
       auto cand3ProngsThisColl = cand3Prongs.sliceBy(hf3ProngPerCollision, thisCollId);
@@ -1422,27 +1505,33 @@ struct HfFilter { // Main struct for HF triggers
           }
         } // end high-pT selection
 
-        auto trackIdsThisCollision = trackIndices.sliceBy(trackIndicesPerCollision, thisCollId);
-        auto tracksWithItsPid = soa::Attach<BigTracksPID, aod::pidits::ITSNSigmaPr, aod::pidits::ITSNSigmaDe>(tracks);
-
-        for (const auto& trackId : trackIdsThisCollision) { // start loop over track indices as associated to this collision in HF code
-          auto track = tracksWithItsPid.rawIteratorAt(trackId.trackId());
-          if (track.globalIndex() == trackFirst.globalIndex() || track.globalIndex() == trackSecond.globalIndex() || track.globalIndex() == trackThird.globalIndex()) {
-            continue;
+        // the loop over tracks stops as soon as all the triggers built from it are decided
+        const bool isBeautyTaggedAny = std::accumulate(isBeautyTagged.begin(), isBeautyTagged.end(), 0) > 0;
+        const bool isCharmTaggedAny = std::accumulate(isCharmTagged.begin(), isCharmTagged.end(), 0) > 0;
+        const bool isGoodLcForSigmaC = is3Prong[2] > 0 && is3ProngInMass[2] > 0 && isSignalTagged[2] > 0;
+        auto isTrackLoopNeeded3Prong = [&]() {
+          return !skipDecidedTriggers ||
+                 (isBeautyTaggedAny && !keepEvent[kBeauty4P]) ||
+                 (isCharmTaggedAny && !keepEvent[kFemto3P]) ||
+                 (isGoodLcForSigmaC && (!keepEvent[kSigmaCPPK] || !keepEvent[kSigmaCPr]));
+        };
+        fillTracksAtPv(collision, trackIdsThisCollision, tracks);
+        for (const auto& trackAtPv : tracksAtPv) { // start loop over track indices as associated to this collision in HF code
+          if (!isTrackLoopNeeded3Prong()) {
+            break;
           }
-
-          auto trackParFourth = getTrackParCov(track);
-          std::array<float, 2> dcaFourth{track.dcaXY(), track.dcaZ()};
-          std::array<float, 3> pVecFourth = track.pVector();
-          if (track.collisionId() != thisCollId) {
-            o2::base::Propagator::Instance()->propagateToDCABxByBz({collision.posX(), collision.posY(), collision.posZ()}, trackParFourth, 2.f, noMatCorr, &dcaFourth);
-            getPxPyPz(trackParFourth, pVecFourth);
+          if (trackAtPv.globalIndex == trackFirst.globalIndex() || trackAtPv.globalIndex == trackSecond.globalIndex() || trackAtPv.globalIndex == trackThird.globalIndex()) {
+            continue;
           }
+          auto track = tracksWithItsPid.rawIteratorAt(trackAtPv.globalIndex);
+          const auto& trackParFourth = trackAtPv.trackPar;
+          const auto& dcaFourth = trackAtPv.dca;
+          const auto& pVecFourth = trackAtPv.pVec;
 
           int charmParticleID[kNBeautyParticles - 3] = {o2::constants::physics::Pdg::kDPlus, o2::constants::physics::Pdg::kDS, o2::constants::physics::Pdg::kLambdaCPlus, o2::constants::physics::Pdg::kXiCPlus};
 
           float massCharmHypos[kNBeautyParticles - 3] = {massDPlus, massDs, massLc, massXic};
-          auto isTrackSelected = helper.isSelectedTrackForSoftPionOrBeauty<kBeauty4P>(track, trackParFourth, dcaFourth);
+          auto isTrackSelected = trackAtPv.selBeauty4P;
           if (track.sign() * sign3Prong < 0 && TESTBIT(isTrackSelected, kForBeauty)) {
             for (int iHypo{0}; iHypo < kNBeautyParticles - 3 && !keepEvent[kBeauty4P]; ++iHypo) {
               if (isBeautyTagged[iHypo] && (TESTBIT(is3ProngInMass[iHypo], 0) || TESTBIT(is3ProngInMass[iHypo], 1))) {
@@ -1518,10 +1607,13 @@ struct HfFilter { // Main struct for HF triggers
           } // end beauty selection
 
           // 3-prong femto
-          bool isProton = helper.isSelectedTrack4Corr(track, trackParFourth, activateQA, hPrDePID[0], hPrDePID[1], kProtonForFemto);
-          bool isDeuteron = helper.isSelectedTrack4Corr(track, trackParFourth, activateQA, hPrDePID[2], hPrDePID[3], kDeuteronForFemto);
+          bool isProton{false}, isDeuteron{false};
+          if (!skipDecidedTriggers || (isCharmTaggedAny && !keepEvent[kFemto3P] && trackAtPv.isFromThisCollision)) {
+            isProton = helper.isSelectedTrack4Corr(track, trackParFourth, activateQA, hPrDePID[0], hPrDePID[1], kProtonForFemto);
+            isDeuteron = helper.isSelectedTrack4Corr(track, trackParFourth, activateQA, hPrDePID[2], hPrDePID[3], kDeuteronForFemto);
+          }
 
-          if (isProton && track.collisionId() == thisCollId) {
+          if (isProton && trackAtPv.isFromThisCollision) {
             for (int iHypo{0}; iHypo < kNCharmParticles - 1 && !keepEvent[kFemto3P]; ++iHypo) {
               if (isCharmTagged[iHypo] && enableFemtoChannels->get(0u, iHypo + 1)) {
                 float relativeMomentum = helper.computeRelativeMomentum(pVecFourth, pVec3Prong, massCharmHypos[iHypo]);
@@ -1537,7 +1629,7 @@ struct HfFilter { // Main struct for HF triggers
               }
             }
           }
-          if (isDeuteron && track.collisionId() == thisCollId) {
+          if (isDeuteron && trackAtPv.isFromThisCollision) {
             for (int iHypo{0}; iHypo < kNCharmParticles - 1 && !keepEvent[kFemto3P]; ++iHypo) {
               if (isCharmTagged[iHypo] && enableFemtoChannels->get(1u, iHypo + 1)) {
                 float relativeMomentum = helper.computeRelativeMomentum(pVecFourth, pVec3Prong, massCharmHypos[iHypo]);
@@ -1556,18 +1648,24 @@ struct HfFilter { // Main struct for HF triggers
 
           // SigmaC++ K-  and SigmaC++,0 - p trigger
 
-          bool isTrackKaon = helper.isSelectedKaonFromXicResoToSigmaC<true>(track);
-          bool isTrackProton = helper.isSelectedTrack4Corr(track, trackParFourth, activateQA, hPrDePID[4], hPrDePID[5], kProtonForScPrCorr);
+          bool isTrackKaon{false}, isTrackProton{false};
+          if (!skipDecidedTriggers || (isGoodLcForSigmaC && (!keepEvent[kSigmaCPPK] || !keepEvent[kSigmaCPr]))) {
+            isTrackKaon = helper.isSelectedKaonFromXicResoToSigmaC<true>(track);
+            isTrackProton = helper.isSelectedTrack4Corr(track, trackParFourth, activateQA, hPrDePID[4], hPrDePID[5], kProtonForScPrCorr);
+          }
 
-          if ((!keepEvent[kSigmaCPPK] || !keepEvent[kSigmaCPr]) && is3Prong[2] > 0 && is3ProngInMass[2] > 0 && isSignalTagged[2] > 0 && (isTrackKaon || isTrackProton)) {
+          if ((!keepEvent[kSigmaCPPK] || !keepEvent[kSigmaCPr]) && isGoodLcForSigmaC && (isTrackKaon || isTrackProton)) {
             // we need a candidate Lc->pKpi and a candidate soft kaon, and also need a candidate of proton for sigmaC correlation
 
             // look for SigmaC++ candidates
-            for (const auto& trackSoftPiId : trackIdsThisCollision) { // start loop over tracks (soft pi)
+            for (const auto iTrackSoftPi : softPionsForSigmaC) { // start loop over tracks selected as soft pions for SigmaC
+              if (skipDecidedTriggers && keepEvent[kSigmaCPPK] && keepEvent[kSigmaCPr]) {
+                break;
+              }
 
               // soft pion candidates
-              auto trackSoftPi = tracks.rawIteratorAt(trackSoftPiId.trackId());
-              auto globalIndexSoftPi = trackSoftPi.globalIndex();
+              const auto& trackSoftPi = tracksAtPv[iTrackSoftPi];
+              auto globalIndexSoftPi = trackSoftPi.globalIndex;
 
               // exclude tracks already used to build the 3-prong candidate
               if (globalIndexSoftPi == trackFirst.globalIndex() || globalIndexSoftPi == trackSecond.globalIndex() || globalIndexSoftPi == trackThird.globalIndex()) {
@@ -1580,20 +1678,12 @@ struct HfFilter { // Main struct for HF triggers
               }
 
               // check the candidate SigmaC++ charge
-              std::array<int, 4> chargesSc = {trackFirst.sign(), trackSecond.sign(), trackThird.sign(), trackSoftPi.sign()};
+              std::array<int, 4> chargesSc = {trackFirst.sign(), trackSecond.sign(), trackThird.sign(), trackSoftPi.sign};
               int chargeSc = std::accumulate(chargesSc.begin(), chargesSc.end(), 0); // SIGNED electric charge of SigmaC candidate
 
-              // select soft pion candidates
-              auto trackParSoftPi = getTrackPar(trackSoftPi);
-              std::array<float, 2> dcaSoftPi{trackSoftPi.dcaXY(), trackSoftPi.dcaZ()};
-              std::array<float, 3> pVecSoftPi = trackSoftPi.pVector();
-              if (trackSoftPi.collisionId() != thisCollId) {
-                // This is a track reassociated to this PV by the track-to-collision-associator
-                // Let's propagate this track to it, and calculate dcaXY, dcaZ
-                o2::base::Propagator::Instance()->propagateToDCABxByBz({collision.posX(), collision.posY(), collision.posZ()}, trackParSoftPi, 2.f, noMatCorr, &dcaSoftPi);
-                getPxPyPz(trackParSoftPi, pVecSoftPi);
-              }
-              int16_t isSoftPionSelected = helper.isSelectedTrackForSoftPionOrBeauty<kSigmaCPPK>(trackSoftPi, trackParSoftPi, dcaSoftPi);
+              // select soft pion candidates, already propagated to this PV if reassociated by the track-to-collision-associator
+              const auto& pVecSoftPi = trackSoftPi.pVec;
+              int16_t isSoftPionSelected = trackSoftPi.selSigmaC;
               if (TESTBIT(isSoftPionSelected, kSoftPionForSigmaC) /*&& (TESTBIT(is3Prong[2], 0) || TESTBIT(is3Prong[2], 1))*/) {
 
                 // check the mass of the SigmaC++ candidate
@@ -1777,11 +1867,14 @@ struct HfFilter { // Main struct for HF triggers
             // we pair SigmaC0 with V0
             if (!keepEvent[kSigmaC0K0] && (isGoodLcToPKPi || isGoodLcToPiKP) && TESTBIT(selV0, kK0S)) {
               // look for SigmaC0 candidates
-              for (const auto& trackSoftPiId : trackIdsThisCollision) { // start loop over tracks (soft pi)
+              for (const auto iTrackSoftPi : softPionsForSigmaC) { // start loop over tracks selected as soft pions for SigmaC
+                if (skipDecidedTriggers && keepEvent[kSigmaC0K0]) {
+                  break;
+                }
 
                 // soft pion candidates
-                auto trackSoftPi = tracks.rawIteratorAt(trackSoftPiId.trackId());
-                auto globalIndexSoftPi = trackSoftPi.globalIndex();
+                const auto& trackSoftPi = tracksAtPv[iTrackSoftPi];
+                auto globalIndexSoftPi = trackSoftPi.globalIndex;
 
                 // exclude tracks already used to build the 3-prong candidate
                 if (globalIndexSoftPi == trackFirst.globalIndex() || globalIndexSoftPi == trackSecond.globalIndex() || globalIndexSoftPi == trackThird.globalIndex() || globalIndexSoftPi == v0.posTrackId() || globalIndexSoftPi == v0.negTrackId()) {
@@ -1790,23 +1883,15 @@ struct HfFilter { // Main struct for HF triggers
                 }
 
                 // check the candidate SigmaC0 charge
-                std::array<int, 4> chargesSc = {trackFirst.sign(), trackSecond.sign(), trackThird.sign(), trackSoftPi.sign()};
+                std::array<int, 4> chargesSc = {trackFirst.sign(), trackSecond.sign(), trackThird.sign(), trackSoftPi.sign};
                 int chargeSc = std::accumulate(chargesSc.begin(), chargesSc.end(), 0); // SIGNED electric charge of SigmaC candidate
                 if (chargeSc != 0) {
                   continue;
                 }
 
-                // select soft pion candidates
-                auto trackParSoftPi = getTrackPar(trackSoftPi);
-                std::array<float, 2> dcaSoftPi{trackSoftPi.dcaXY(), trackSoftPi.dcaZ()};
-                std::array<float, 3> pVecSoftPi = trackSoftPi.pVector();
-                if (trackSoftPi.collisionId() != thisCollId) {
-                  // This is a track reassociated to this PV by the track-to-collision-associator
-                  // Let's propagate this track to it, and calculate dcaXY, dcaZ
-                  o2::base::Propagator::Instance()->propagateToDCABxByBz({collision.posX(), collision.posY(), collision.posZ()}, trackParSoftPi, 2.f, noMatCorr, &dcaSoftPi);
-                  getPxPyPz(trackParSoftPi, pVecSoftPi);
-                }
-                int16_t isSoftPionSelected = helper.isSelectedTrackForSoftPionOrBeauty<kSigmaC0K0>(trackSoftPi, trackParSoftPi, dcaSoftPi);
+                // select soft pion candidates, already propagated to this PV if reassociated by the track-to-collision-associator
+                const auto& pVecSoftPi = trackSoftPi.pVec;
+                int16_t isSoftPionSelected = trackSoftPi.selSigmaC;
                 if (TESTBIT(isSoftPionSelected, kSoftPionForSigmaC) /*&& (TESTBIT(is3Prong[2], 0) || TESTBIT(is3Prong[2], 1))*/) {
 
                   // check the mass of the SigmaC0 candidate
@@ -1863,10 +1948,14 @@ struct HfFilter { // Main struct for HF triggers
           }
         }
       } // end loop over 3-prong candidates
+      fillTriggerGroupTime(kTriggerGroup3Prong);
 
       if (!keepEvent[kCharmBarToXiBach] || !keepEvent[kCharmBarToXi2Bach]) {
         auto cascThisColl = cascades.sliceBy(cascPerCollision, thisCollId);
         for (const auto& casc : cascThisColl) {
+          if (skipDecidedTriggers && keepEvent[kCharmBarToXiBach] && keepEvent[kCharmBarToXi2Bach]) {
+            break;
+          }
 
           bool hasStrangeTrack{false};
 
@@ -1920,8 +2009,10 @@ struct HfFilter { // Main struct for HF triggers
             o2::base::Propagator::Instance()->propagateToDCABxByBz({collision.posX(), collision.posY(), collision.posZ()}, trackParCascTrack, 2.f, matCorr, &dcaInfo);
           }
 
-          auto trackIdsThisCollision = trackIndices.sliceBy(trackIndicesPerCollision, thisCollId);
           for (const auto& trackId : trackIdsThisCollision) { // start loop over tracks (first bachelor)
+            if (skipDecidedTriggers && keepEvent[kCharmBarToXiBach] && keepEvent[kCharmBarToXi2Bach]) {
+              break;
+            }
             auto track = tracks.rawIteratorAt(trackId.trackId());
 
             // check if track is one of the Xi daughters
@@ -2002,6 +2093,7 @@ struct HfFilter { // Main struct for HF triggers
           }
         }
       }
+      fillTriggerGroupTime(kTriggerGroupCascades);
 
       auto n2Prongs = helper.computeNumberOfCandidates(indicesDau2Prong);
       auto n2ProngsPrompt = helper.computeNumberOfCandidates(indicesDau2ProngPrompt);
@@ -2044,6 +2136,7 @@ struct HfFilter { // Main struct for HF triggers
           }
         }
       }
+      fillTriggerGroupTime(kTriggerGroupDoubleCharm);
 
       // apply downscale factors, if required
       if (applyDownscale) {
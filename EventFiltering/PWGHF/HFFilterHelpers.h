@@ -174,6 +174,14 @@ enum HfVtxStage : uint8_t {
   kNHfVtxStage
 };
 
+enum TriggerGroup : uint8_t {
+  kTriggerGroup2Prong = 0, // triggers built from 2-prong candidates
+  kTriggerGroup3Prong,     // triggers built from 3-prong candidates
+  kTriggerGroupCascades,   // charm baryons to Xi + bachelor(s)
+  kTriggerGroupDoubleCharm,
+  kNTriggerGroups
+};
+
 // Helper struct to pass V0 informations
 struct V0Cand {
   std::array<float, 3> mom;
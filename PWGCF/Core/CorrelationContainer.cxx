@@ -27,6 +27,7 @@
 #include "TCanvas.h"
 #include "TF1.h"
 #include "THn.h"
+#include "TArray.h"
 #include "Framework/HistogramSpec.h"
 #include "CommonConstants/MathConstants.h"
 
@@ -118,6 +119,14 @@ CorrelationContainer::CorrelationContainer(const char* name, const char* objTitl
   mTrackHistEfficiency = HistFactory::createHist<StepTHnF>({"mTrackHistEfficiency", "Tracking efficiency", {HistType::kStepTHnF, {efficiencyAxis[0], efficiencyAxis[1], {5, -0.5, 4.5, "species"}, correlationAxis[3], efficiencyAxis[2]}, fgkCFSteps}}).release();
 
   mEventCount = HistFactory::createHist<TH2F>({"mEventCount", ";step;centrality;count", {HistType::kTH2F, {{fgkCFSteps + 2, -2.5, -0.5 + fgkCFSteps, "step"}, correlationAxis[3]}}}).release();
+
+  // binning for the buffered filling of the pair histogram, see beginPairEvent
+  if (userAxis.empty()) {
+    for (const auto& axis : correlationAxis) {
+      mPairBinEdges.push_back(axis.binEdges);
+      mPairNBins.push_back(axis.getNbins());
+    }
+  }
 }
 
 //_____________________________________________________________________________
@@ -1654,3 +1663,105 @@ void CorrelationContainer::fillEvent(Float_t centrality, CFStep step)
   // Fill per-event information
   mEventCount->Fill(step, centrality);
 }
+
+Bool_t CorrelationContainer::beginPairEvent(CFStep step, Float_t multiplicity, Float_t zVtx)
+{
+  // Starts the buffered filling of the pair histogram for one event
+  // Returns false if the event is outside of the multiplicity or vertex axis, in which case no pair is to be filled
+
+  if (mPairBinEdges.empty()) {
+    LOGF(fatal, "Buffered filling of the pair histogram is only available for containers created with the axes constructor and without user axes");
+  }
+  if (mPairLayoutChecked != mPairHist) {
+    // flushPairEvent writes directly into the arrays of the pair histogram, its binning has to be the one of the buffers
+    if (mPairHist->getNVar() != static_cast<Int_t>(mPairNBins.size())) {
+      LOGF(fatal, "Pair histogram has %d axes, %d expected for buffered filling", mPairHist->getNVar(), static_cast<Int_t>(mPairNBins.size()));
+    }
+    for (Int_t axis = 0; axis < static_cast<Int_t>(mPairNBins.size()); axis++) {
+      if (mPairHist->GetAxis(axis)->GetNbins() != mPairNBins[axis]) {
+        LOGF(fatal, "Axis %d of the pair histogram has %d bins, %d expected for buffered filling", axis, mPairHist->GetAxis(axis)->GetNbins(), mPairNBins[axis]);
+      }
+    }
+    mPairLayoutChecked = mPairHist;
+  }
+  if (mPairBuffer.empty()) {
+    Long64_t bins = static_cast<Long64_t>(mPairNBins[kPairAxisDeltaEta]) * mPairNBins[kPairAxisPtAssoc] * mPairNBins[kPairAxisPtTrigger] * mPairNBins[kPairAxisDeltaPhi];
+    LOGF(info, "Allocating buffers of %lld bins for the pair histogram (approx. %lld MB of memory)", bins, bins * 16 / 1024 / 1024);
+    mPairBuffer.assign(bins, 0);
+    mPairBufferSumw2.assign(bins, 0);
+  }
+
+  mPairEventStep = step;
+  mPairEventBinMultiplicity = findPairBin(kPairAxisMultiplicity, multiplicity);
+  mPairEventBinVertex = findPairBin(kPairAxisVertex, zVtx);
+  return mPairEventBinMultiplicity >= 1 && mPairEventBinMultiplicity <= mPairNBins[kPairAxisMultiplicity] && mPairEventBinVertex >= 1 && mPairEventBinVertex <= mPairNBins[kPairAxisVertex];
+}
+
+void CorrelationContainer::flushPairEvent()
+{
+  // Adds the pairs accumulated since beginPairEvent to the value and sumw2 arrays of the pair histogram
+
+  if (mPairBufferFilled.empty()) {
+    return;
+  }
+
+  // the arrays of a step are created by StepTHn::Fill on its first entry, a fill with zero weight creates both without changing the content
+  if (!mPairHist->getValues(mPairEventStep) || !mPairHist->getSumw2(mPairEventStep)) {
+    mPairHist->Fill(mPairEventStep, getPairBinCenter(kPairAxisDeltaEta, 1), getPairBinCenter(kPairAxisPtAssoc, 1), getPairBinCenter(kPairAxisPtTrigger, 1),
+                    getPairBinCenter(kPairAxisMultiplicity, mPairEventBinMultiplicity), getPairBinCenter(kPairAxisDeltaPhi, 1), getPairBinCenter(kPairAxisVertex, mPairEventBinVertex), 0.);
+  }
+  TArray* values = mPairHist->getValues(mPairEventStep);
+  TArray* sumw2 = mPairHist->getSumw2(mPairEventStep);
+  if (!values || !sumw2) {
+    LOGF(fatal, "Arrays of step %d of the pair histogram not available for buffered filling", mPairEventStep);
+  }
+  const Long64_t nBinsTotal = static_cast<Long64_t>(mPairBuffer.size()) * mPairNBins[kPairAxisMultiplicity] * mPairNBins[kPairAxisVertex];
+  if (values->GetSize() != nBinsTotal || sumw2->GetSize() != nBinsTotal) {
+    LOGF(fatal, "Arrays of step %d of the pair histogram have %d bins, %lld expected for buffered filling", mPairEventStep, values->GetSize(), nBinsTotal);
+  }
+
+  for (const auto index : mPairBufferFilled) {
+    const Double_t weight = mPairBuffer[index];
+    const Double_t weight2 = mPairBufferSumw2[index];
+    if (weight == 0 && weight2 == 0) {
+      continue; // bin listed twice
+    }
+    mPairBuffer[index] = 0;
+    mPairBufferSumw2[index] = 0;
+
+    Long64_t rest = index;
+    const Int_t binDeltaPhi = rest % mPairNBins[kPairAxisDeltaPhi] + 1;
+    rest /= mPairNBins[kPairAxisDeltaPhi];
+    const Int_t binPtTrigger = rest % mPairNBins[kPairAxisPtTrigger] + 1;
+    rest /= mPairNBins[kPairAxisPtTrigger];
+    const Int_t binPtAssoc = rest % mPairNBins[kPairAxisPtAssoc] + 1;
+    const Int_t binDeltaEta = rest / mPairNBins[kPairAxisPtAssoc] + 1;
+
+    // Layout assumption: StepTHn keeps one flat array per step without under- and overflow bins, the global bin being
+    // the row-major index over the axes in the order of creation (first axis slowest) with 0-based bins, as in StepTHn::Fill.
+    // The number of axes and bins is checked in beginPairEvent and the array size above, a change of this layout
+    // in StepTHn requires to adapt the formula below.
+    Long64_t bin = binDeltaEta - 1;
+    bin = bin * mPairNBins[kPairAxisPtAssoc] + binPtAssoc - 1;
+    bin = bin * mPairNBins[kPairAxisPtTrigger] + binPtTrigger - 1;
+    bin = bin * mPairNBins[kPairAxisMultiplicity] + mPairEventBinMultiplicity - 1;
+    bin = bin * mPairNBins[kPairAxisDeltaPhi] + binDeltaPhi - 1;
+    bin = bin * mPairNBins[kPairAxisVertex] + mPairEventBinVertex - 1;
+
+    values->SetAt(values->GetAt(bin) + weight, bin);
+    sumw2->SetAt(sumw2->GetAt(bin) + weight2, bin);
+  }
+  mPairBufferFilled.clear();
+}
+
+Double_t CorrelationContainer::getPairBinCenter(Int_t axis, Int_t bin) const
+{
+  // center of a bin of the pair histogram axes, as TAxis::GetBinCenter
+
+  const auto& edges = mPairBinEdges[axis];
+  if (edges.size() == 2) {
+    const Double_t binWidth = (edges.back() - edges.front()) / mPairNBins[axis];
+    return edges.front() + (bin - 1) * binWidth + 0.5 * binWidth;
+  }
+  return 0.5 * (edges[bin - 1] + edges[bin]);
+}
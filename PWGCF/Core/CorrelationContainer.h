@@ -18,6 +18,9 @@
 #include "TString.h"
 #include "Framework/HistogramSpec.h"
 
+#include <algorithm>
+#include <vector>
+
 class TH1;
 class TH1F;
 class TH3;
@@ -53,6 +56,14 @@ class CorrelationContainer : public TNamed
                 kCFStepBiasStudy2,
                 kCFStepCorrected };
 
+  // axes of the pair histogram, as given in correlationAxis
+  enum PairAxis { kPairAxisDeltaEta = 0,
+                  kPairAxisPtAssoc,
+                  kPairAxisPtTrigger,
+                  kPairAxisMultiplicity,
+                  kPairAxisDeltaPhi,
+                  kPairAxisVertex };
+
   enum EfficiencyStep { MC = 0,
                         RecoPrimaries,
                         RecoAll,
@@ -103,6 +114,43 @@ class CorrelationContainer : public TNamed
 
   void fillEvent(Float_t centrality, CFStep step);
 
+  // Filling of the pair histogram with bins resolved once per track and event (see findPairBin). The weights and squared
+  // weights of the pairs of one event are accumulated in dense buffers over delta eta, pt assoc, pt trig and delta phi and
+  // added to the value and sumw2 arrays of the pair histogram by flushPairEvent, with the same content and errors as per-pair fills.
+  // Only available for objects created with the axes constructor and without user axes.
+  Int_t findPairBin(Int_t axis, Double_t value) const
+  {
+    // same convention as TAxis::FindBin: 0 for underflow, number of bins + 1 for overflow
+    const auto& edges = mPairBinEdges[axis];
+    const Int_t nBins = mPairNBins[axis];
+    if (value < edges.front()) {
+      return 0;
+    }
+    if (!(value < edges.back())) {
+      return nBins + 1;
+    }
+    if (edges.size() == 2) {
+      return 1 + static_cast<Int_t>(nBins * (value - edges.front()) / (edges.back() - edges.front()));
+    }
+    return static_cast<Int_t>(std::upper_bound(edges.begin(), edges.end(), value) - edges.begin());
+  }
+  Bool_t beginPairEvent(CFStep step, Float_t multiplicity, Float_t zVtx);
+  void fillPairBins(Int_t binDeltaEta, Int_t binPtAssoc, Int_t binPtTrigger, Int_t binDeltaPhi, Double_t weight)
+  {
+    // bins outside of the axes are dropped, as in StepTHn::Fill
+    if (binDeltaEta < 1 || binDeltaEta > mPairNBins[kPairAxisDeltaEta] || binPtAssoc < 1 || binPtAssoc > mPairNBins[kPairAxisPtAssoc] ||
+        binPtTrigger < 1 || binPtTrigger > mPairNBins[kPairAxisPtTrigger] || binDeltaPhi < 1 || binDeltaPhi > mPairNBins[kPairAxisDeltaPhi]) {
+      return;
+    }
+    const Long64_t index = ((static_cast<Long64_t>(binDeltaEta - 1) * mPairNBins[kPairAxisPtAssoc] + binPtAssoc - 1) * mPairNBins[kPairAxisPtTrigger] + binPtTrigger - 1) * mPairNBins[kPairAxisDeltaPhi] + binDeltaPhi - 1;
+    if (mPairBuffer[index] == 0 && mPairBufferSumw2[index] == 0) {
+      mPairBufferFilled.push_back(index);
+    }
+    mPairBuffer[index] += weight;
+    mPairBufferSumw2[index] += weight * weight;
+  }
+  void flushPairEvent();
+
   void extendTrackingEfficiency(Bool_t verbose = kFALSE);
 
   void setEtaRange(Float_t etaMin, Float_t etaMax)
@@ -152,6 +200,7 @@ class CorrelationContainer : public TNamed
  protected:
   void weightHistogram(TH3* hist1, TH1* hist2);
   void multiplyHistograms(THnBase* grid, THnBase* target, TH1* histogram, Int_t var1, Int_t var2);
+  Double_t getPairBinCenter(Int_t axis, Int_t bin) const;
 
   StepTHn* mPairHist;            // container for pair level distributions at all analysis steps
   StepTHn* mTriggerHist;         // container for "trigger" particle (single-particle) level distribution at all analysis steps
@@ -178,6 +227,16 @@ class CorrelationContainer : public TNamed
   Bool_t mGetMultCacheOn; //! cache for getHistsZVtxMult function active
   THnBase* mGetMultCache; //! cache for getHistsZVtxMult function
 
+  std::vector<std::vector<Double_t>> mPairBinEdges; //! bin edges of the pair histogram axes ({min, max} for fixed bins), empty if buffered filling is not available
+  std::vector<Int_t> mPairNBins;                    //! number of bins of the pair histogram axes
+  std::vector<Double_t> mPairBuffer;                //! sum of the pair weights of the current event, dense over delta eta, pt assoc, pt trig and delta phi
+  std::vector<Double_t> mPairBufferSumw2;           //! sum of the squared pair weights of the current event, same layout as mPairBuffer
+  std::vector<Long64_t> mPairBufferFilled;          //! indices of the non-empty bins of mPairBuffer
+  CFStep mPairEventStep = kCFStepAll;               //! step of the current event
+  Int_t mPairEventBinMultiplicity = 0;              //! multiplicity / centrality bin of the current event
+  Int_t mPairEventBinVertex = 0;                    //! z-vtx bin of the current event
+  StepTHn* mPairLayoutChecked = nullptr;            //! pair histogram whose binning was checked against the buffers
+
   ClassDef(CorrelationContainer, 2) // underlying event histogram container
 };
 
@@ -28,6 +28,7 @@
 #include <chrono>
 #include <cmath>
 #include <cstddef>
+#include <cstdint>
 #include <map>
 #include <numeric>
 #include <random>
@@ -251,11 +252,13 @@ class CloseTrackRejection
 
     mDeta = t1.eta() - t2.eta();
 
+    // phistar at all radii is computed once per track and then taken from the cache
+    // copy the first one, both tracks may map to the same cache entry
+    const PhistarCacheEntry phistar1 = getPhistar(t1.globalIndex(), mChargeAbsTrack1 * t1.signedPt(), t1.phi());
+    const PhistarCacheEntry& phistar2 = getPhistar(t2.globalIndex(), mChargeAbsTrack2 * t2.signedPt(), t2.phi());
     for (size_t i = 0; i < TpcRadii.size(); i++) {
-      auto phistar1 = phistar(mMagField, TpcRadii[i], mChargeAbsTrack1 * t1.signedPt(), t1.phi());
-      auto phistar2 = phistar(mMagField, TpcRadii[i], mChargeAbsTrack2 * t2.signedPt(), t2.phi());
-      if (phistar1 && phistar2) {
-        mDphistar.at(i) = RecoDecay::constrainAngle(phistar1.value() - phistar2.value(), -o2::constants::math::PI); // constrain angular difference between -pi and pi
+      if (phistar1.mask[i] && phistar2.mask[i]) {
+        mDphistar.at(i) = RecoDecay::constrainAngle(phistar1.phistar[i] - phistar2.phistar[i], -o2::constants::math::PI); // constrain angular difference between -pi and pi
         mDphistarMask.at(i) = true;
         count++;
       }
@@ -359,6 +362,17 @@ class CloseTrackRejection
   bool isActivated() const { return mIsActivated; }
 
  private:
+  // phistar of a track at all tpc radii, together with the inputs it was computed from
+  struct PhistarCacheEntry {
+    int64_t index = -1;
+    float signedPt = 0.f;
+    float phi = 0.f;
+    float magField = 0.f;
+    std::array<float, Nradii> phistar = {0.f};
+    std::array<bool, Nradii> mask = {false}; // false if the track does not reach the radius
+  };
+  static constexpr int64_t PhistarCacheSize = 1024; // power of 2
+
   std::optional<float> phistar(float magfield, float radius, float signedPt, float phi)
   {
     double arg = 0.3 * (0.1 * magfield) * (0.01 * radius) / (2. * signedPt);
@@ -369,6 +383,26 @@ class CloseTrackRejection
     return std::nullopt;
   }
 
+  // the cache is indexed with the global index of the track and the inputs are checked,
+  // so entries stay valid across events (same- and mixed-event pairs) and dataframes
+  const PhistarCacheEntry& getPhistar(int64_t index, float signedPt, float phi)
+  {
+    auto& entry = mPhistarCache[index & (PhistarCacheSize - 1)];
+    if (entry.index == index && entry.signedPt == signedPt && entry.phi == phi && entry.magField == mMagField) {
+      return entry;
+    }
+    entry.index = index;
+    entry.signedPt = signedPt;
+    entry.phi = phi;
+    entry.magField = mMagField;
+    for (size_t i = 0; i < TpcRadii.size(); i++) {
+      auto value = phistar(mMagField, TpcRadii[i], signedPt, phi);
+      entry.phistar[i] = value.value_or(0.f);
+      entry.mask[i] = value.has_value();
+    }
+    return entry;
+  }
+
   o2::framework::HistogramRegistry* mHistogramRegistry = nullptr;
   bool mPlotAllRadii = false;
   bool mPlotAverage = false;
@@ -401,6 +435,8 @@ class CloseTrackRejection
   std::array<float, Nradii> mDphistar = {0.f};
   std::array<bool, Nradii> mDphistarMask = {false};
 
+  std::array<PhistarCacheEntry, PhistarCacheSize> mPhistarCache = {};
+
   bool mRandomizeTracks = false;
   std::mt19937 mRng;
   std::uniform_int_distribution<int> mSwapDist{0, 1};
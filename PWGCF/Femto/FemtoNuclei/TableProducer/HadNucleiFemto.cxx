@@ -21,6 +21,7 @@
 #include "PWGLF/DataModel/LFHypernucleiTables.h"
 #include "PWGLF/Utils/svPoolCreator.h"
 
+#include "Common/Core/EventMixing.h"
 #include "Common/Core/PID/PIDTOF.h"
 #include "Common/Core/PID/TPCPIDResponse.h"
 #include "Common/Core/RecoDecay.h"
@@ -65,7 +66,6 @@
 #include <array>
 #include <cmath>
 #include <cstdlib>
-#include <deque>
 #include <iterator> // std::prev
 #include <string>
 #include <vector>
@@ -325,23 +325,16 @@ struct HadNucleiFemto {
   float Vz_high = 10.0f;
   float Vz_step = (Vz_high - Vz_low) / numOfVertexZBins;
 
-  struct EventRef {
-    uint64_t collisionId;
-  };
-
-  struct PoolBin {
-    std::deque<EventRef> events;
-  };
-
-  std::vector<PoolBin> All_Event_pool;
+  // pools of the previous collisions per (z-vertex, centrality) bin, only the collision ids are stored,
+  // the hypertriton candidates of a pooled collision are sliced again when mixing
+  eventmixing::EventMixingEngine<int64_t> mHyperEventPools;
   bool isInitialized = false;
 
   int nPoolBins() const { return numOfVertexZBins * numOfCentBins; }
 
   void initializePools()
   {
-    All_Event_pool.clear();
-    All_Event_pool.resize(nPoolBins());
+    mHyperEventPools.setStrategy(settingNoMixedEvents, false, false);
     isInitialized = true;
   }
 
@@ -1302,7 +1295,7 @@ PROCESS_SWITCH(HadNucleiFemto, processMixedEventHyper, "Process Mixed event", fa
     mTrackHypPairs.clear();
     if (!isInitialized) {
       initializePools();
-      LOG(info) << "Initialized event pool with size = " << All_Event_pool.size();
+      LOG(info) << "Initialized event pools for " << nPoolBins() << " bins with depth " << settingNoMixedEvents.value;
     }
     for (auto const& collision : collisions) {
       if (!collision.sel8()) {
@@ -1314,21 +1307,21 @@ PROCESS_SWITCH(HadNucleiFemto, processMixedEventHyper, "Process Mixed event", fa
       mQaRegistry.fill(HIST("hVtxZ"), collision.posZ());
 
       int poolIndexHad = where_pool(collision.posZ(), collision.centFT0C());
-      if (poolIndexHad < 0 || static_cast<size_t>(poolIndexHad) >= All_Event_pool.size()) {
+      if (poolIndexHad < 0 || poolIndexHad >= nPoolBins()) {
         continue;
       }
-      auto& pool = All_Event_pool[poolIndexHad];
 
       const uint64_t collIdxHad = collision.globalIndex();
       auto trackTableThisCollision = hadtracks.sliceBy(mPerCol, collIdxHad);
       trackTableThisCollision.bindExternalIndices(&hadtracks);
 
-      for (auto const& storedEvent : pool.events) {
+      // the pools are kept across runs, as before, so the run number is not used
+      mHyperEventPools.mixWithPool(poolIndexHad, 0, [&](const eventmixing::PooledEvent<int64_t>& storedEvent) {
         const uint64_t collIdxHyp = storedEvent.collisionId;
         if (settingSaferME) {
           if (static_cast<int64_t>(collIdxHyp) > collisions.size()) {
             mQaRegistry.fill(HIST("hSkipReasons"), 4);
-            continue;
+            return;
           }
         }
 
@@ -1336,24 +1329,21 @@ PROCESS_SWITCH(HadNucleiFemto, processMixedEventHyper, "Process Mixed event", fa
         hypdTablepreviousCollision.bindExternalIndices(&V0Hypers);
         if (hypdTablepreviousCollision.size() == 0) {
           mQaRegistry.fill(HIST("hSkipReasons"), 1);
-          continue;
+          return;
         }
 
         auto firstHyp = hypdTablepreviousCollision.iteratorAt(0);
         int poolIndexHyp = where_pool(firstHyp.zPrimVtx(), firstHyp.centralityFT0C());
         if (poolIndexHyp != poolIndexHad) {
           mQaRegistry.fill(HIST("hSkipReasons"), 2);
-          continue;
+          return;
         }
         mQaRegistry.fill(HIST("hNHypsPerPrevColl"), collIdxHyp, hypdTablepreviousCollision.size());
 
         pairHyperEventMixing(trackTableThisCollision, hypdTablepreviousCollision);
-      }
+      });
 
-      if (static_cast<int>(pool.events.size()) >= settingNoMixedEvents) {
-        pool.events.pop_front();
-      }
-      pool.events.push_back({collIdxHad});
+      mHyperEventPools.addEvent(poolIndexHad, 0, collIdxHad);
     }
     fillPairsHyper(collisions, hadtracks, V0Hypers, /*isMixedEvent*/ true);
   }
@@ -20,9 +20,10 @@
 
 #include "Framework/HistogramRegistry.h"
 
+#include <array>
+#include <cstdint>
 #include <memory>
 #include <string>
-#include <vector>
 
 using namespace o2;
 using namespace o2::framework;
@@ -58,6 +59,7 @@ class FemtoDreamDetaDphiStar
     atWhichRadiiToSelect = atWhichRadiiToCut;
     radiiTPC = radiiTPCtoCut;
     fillQA = fillTHSparse;
+    phiStarCache.fill(PhiStarCacheEntry{}); // cached values depend on runOldVersion and radiiTPC
 
     if constexpr (mPartOneType == o2::aod::femtodreamparticle::ParticleType::kTrack && (mPartTwoType == o2::aod::femtodreamparticle::ParticleType::kTrack || mPartTwoType == o2::aod::femtodreamparticle::ParticleType::kCascadeV0Child || mPartTwoType == o2::aod::femtodreamparticle::ParticleType::kCascadeBachelor)) {
       std::string dirName = static_cast<std::string>(dirNames[0]);
@@ -788,15 +790,25 @@ class FemtoDreamDetaDphiStar
   std::array<std::shared_ptr<THnSparse>, 3> histdetadpi_eta{};
   std::array<std::shared_ptr<THnSparse>, 3> histdetadpi_phi{};
 
-  ///  Calculate phi at all required radii stored in tmpRadiiTPC
-  /// Magnetic field to be provided in Tesla
+  /// Cached phi* of a particle at tmpRadiiTPC and radiiTPC, valid while index, phi, pt, magfield and charge match
+  struct PhiStarCacheEntry {
+    int64_t index = -1;             ///< global index of the particle
+    float phi = 0.f;                ///< inputs the values were computed with
+    float pt = 0.f;
+    float magfield = 0.f;
+    int charge = 0;
+    std::array<float, 9> phiStar{}; ///< phi* at tmpRadiiTPC
+    float phiStarAtRadiiTPC = 0.f;  ///< phi* at radiiTPC
+  };
+
+  static constexpr int64_t kPhiStarCacheSize = 1024; ///< number of cached particles, power of 2
+  std::array<PhiStarCacheEntry, kPhiStarCacheSize> phiStarCache{};
+
+  ///  Get the charge from cutcontainer using masks
   template <typename T>
-  int PhiAtRadiiTPC(const T& part, std::vector<float>& tmpVec)
+  int ChargeFromCut(const T& part) const
   {
-
-    float phi0 = part.phi();
-    // Start: Get the charge from cutcontainer using masks
-    int charge = 0.;
+    int charge = 0;
     if ((part.cut() & kSignMinusMask) == kValue0 && (part.cut() & kSignPlusMask) == kValue0) {
       charge = 0;
     } else if ((part.cut() & kSignPlusMask) == kSignPlusMask) {
@@ -806,23 +818,52 @@ class FemtoDreamDetaDphiStar
     } else {
       LOG(fatal) << "FemtoDreamDetaDphiStar: Charge bits are set wrong!";
     }
-    // End: Get the charge from cutcontainer using masks
-    float pt = part.pt();
-    for (size_t i = 0; i < 9; i++) {
-      if (runOldVersion) {
-        tmpVec.push_back(phi0 - std::asin(0.3 * charge * 0.1 * magfield * tmpRadiiTPC[i] * 0.01 / (2. * pt)));
-      }
-      if (!runOldVersion) {
-        auto arg = 0.3 * charge * magfield * tmpRadiiTPC[i] * 0.01 / (2. * pt);
-        // for very low pT particles, this value goes outside of range -1 to 1 at at large tpc radius; asin fails
-        if (std::fabs(arg) < 1) {
-          tmpVec.push_back(phi0 - std::asin(0.3 * charge * magfield * tmpRadiiTPC[i] * 0.01 / (2. * pt)));
-        } else {
-          tmpVec.push_back(999);
-        }
+    return charge;
+  }
+
+  ///  Calculate phi at a given radius, 999 if the particle does not reach it
+  /// Magnetic field to be provided in Tesla
+  float PhiAtRadius(int charge, float phi0, float pt, float radii) const
+  {
+    float phiAtRadii = 0;
+    if (runOldVersion) {
+      phiAtRadii = phi0 - std::asin(0.3 * charge * 0.1 * magfield * radii * 0.01 / (2. * pt));
+    }
+    if (!runOldVersion) {
+      auto arg = 0.3 * charge * magfield * radii * 0.01 / (2. * pt);
+      // for very low pT particles, this value goes outside of range -1 to 1 at at large tpc radius; asin fails
+      if (std::fabs(arg) < 1) {
+        phiAtRadii = phi0 - std::asin(0.3 * charge * magfield * radii * 0.01 / (2. * pt));
+      } else {
+        phiAtRadii = 999.;
       }
     }
-    return charge;
+    return phiAtRadii;
+  }
+
+  ///  Calculate phi at all required radii stored in tmpRadiiTPC, or take it from the cache
+  /// Magnetic field to be provided in Tesla
+  template <typename T>
+  const PhiStarCacheEntry& PhiAtRadiiTPC(const T& part)
+  {
+    const int64_t index = part.globalIndex();
+    const float phi0 = part.phi();
+    const float pt = part.pt();
+    const int charge = ChargeFromCut(part);
+    auto& entry = phiStarCache[index & (kPhiStarCacheSize - 1)];
+    if (entry.index == index && entry.phi == phi0 && entry.pt == pt && entry.magfield == magfield && entry.charge == charge) {
+      return entry;
+    }
+    entry.index = index;
+    entry.phi = phi0;
+    entry.pt = pt;
+    entry.magfield = magfield;
+    entry.charge = charge;
+    for (size_t i = 0; i < 9; i++) {
+      entry.phiStar[i] = PhiAtRadius(charge, phi0, pt, tmpRadiiTPC[i]);
+    }
+    entry.phiStarAtRadiiTPC = PhiAtRadius(charge, phi0, pt, radiiTPC);
+    return entry;
   }
 
   ///  Calculate phi at specific radii
@@ -852,39 +893,18 @@ class FemtoDreamDetaDphiStar
         pt = part.prong2Pt();
       }
     } else {
-      phi0 = part.phi();
-      // Start: Get the charge from cutcontainer using masks
-      if ((part.cut() & kSignMinusMask) == kValue0 && (part.cut() & kSignPlusMask) == kValue0) {
-        charge = 0;
-      } else if ((part.cut() & kSignPlusMask) == kSignPlusMask) {
-        charge = 1;
-      } else if ((part.cut() & kSignMinusMask) == kSignMinusMask) {
-        charge = -1;
-      } else {
-        LOG(fatal) << "FemtoDreamDetaDphiStar: Charge bits are set wrong!";
+      if (radii == radiiTPC) {
+        return PhiAtRadiiTPC(part).phiStarAtRadiiTPC;
       }
+      phi0 = part.phi();
+      charge = ChargeFromCut(part);
       pt = part.pt();
     }
-    // End: Get the charge from cutcontainer using masks
-    float phiAtRadii = 0;
-    if (runOldVersion) {
-      phiAtRadii = phi0 - std::asin(0.3 * charge * 0.1 * magfield * radii * 0.01 / (2. * pt));
-    }
-    if (!runOldVersion) {
-      auto arg = 0.3 * charge * magfield * radii * 0.01 / (2. * pt);
-      // for very low pT particles, this value goes outside of range -1 to 1 at at large tpc radius; asin fails
-      if (std::fabs(arg) < 1) {
-        phiAtRadii = phi0 - std::asin(0.3 * charge * magfield * radii * 0.01 / (2. * pt));
-      } else {
-        phiAtRadii = 999.;
-      }
-    }
-
-    return phiAtRadii;
+    return PhiAtRadius(charge, phi0, pt, radii);
   }
 
   template <typename T>
-  int PhiAtRadiiTPCForHF(const T& part, std::vector<float>& tmpVec, int prong)
+  int PhiAtRadiiTPCForHF(const T& part, std::array<float, 9>& phiStar, int prong)
   {
     int charge = 0;
     if constexpr (mPartTwoType == o2::aod::femtodreamparticle::kCharmHadron3Prong) {
@@ -897,11 +917,11 @@ class FemtoDreamDetaDphiStar
       }
       for (size_t i = 0; i < 9; ++i) {
         if (prong == 0) {
-          tmpVec.push_back(PhiAtSpecificRadiiTPC<true, 0>(part, tmpRadiiTPC[i]));
+          phiStar[i] = PhiAtSpecificRadiiTPC<true, 0>(part, tmpRadiiTPC[i]);
         } else if (prong == 1) {
-          tmpVec.push_back(PhiAtSpecificRadiiTPC<true, 1>(part, tmpRadiiTPC[i]));
+          phiStar[i] = PhiAtSpecificRadiiTPC<true, 1>(part, tmpRadiiTPC[i]);
         } else { // prong == 2
-          tmpVec.push_back(PhiAtSpecificRadiiTPC<true, 2>(part, tmpRadiiTPC[i]));
+          phiStar[i] = PhiAtSpecificRadiiTPC<true, 2>(part, tmpRadiiTPC[i]);
         }
       }
 
@@ -916,9 +936,9 @@ class FemtoDreamDetaDphiStar
 
       for (size_t i = 0; i < 9; ++i) {
         if (prong == 0) {
-          tmpVec.push_back(PhiAtSpecificRadiiTPC<true, 0>(part, tmpRadiiTPC[i]));
+          phiStar[i] = PhiAtSpecificRadiiTPC<true, 0>(part, tmpRadiiTPC[i]);
         } else { // prong == 1
-          tmpVec.push_back(PhiAtSpecificRadiiTPC<true, 1>(part, tmpRadiiTPC[i]));
+          phiStar[i] = PhiAtSpecificRadiiTPC<true, 1>(part, tmpRadiiTPC[i]);
         }
       }
     }
@@ -930,33 +950,41 @@ class FemtoDreamDetaDphiStar
   template <bool isHF = false, typename T1, typename T2>
   float AveragePhiStar(const T1& part1, const T2& part2, int iHist, bool* sameCharge)
   {
-    std::vector<float> tmpVec1;
-    std::vector<float> tmpVec2;
-    auto charge1 = PhiAtRadiiTPC(part1, tmpVec1);
+    // copies, the two particles may share a cache entry
+    std::array<float, 9> phiStar1{};
+    std::array<float, 9> phiStar2{};
+    const auto& entry1 = PhiAtRadiiTPC(part1);
+    auto charge1 = entry1.charge;
+    phiStar1 = entry1.phiStar;
     if constexpr (!isHF) {
-      auto charge2 = PhiAtRadiiTPC(part2, tmpVec2);
-      if (charge1 == charge2) {
+      const auto& entry2 = PhiAtRadiiTPC(part2);
+      phiStar2 = entry2.phiStar;
+      if (charge1 == entry2.charge) {
         *sameCharge = true;
       }
     } else {
-      PhiAtRadiiTPCForHF(part2, tmpVec2, iHist);
+      PhiAtRadiiTPCForHF(part2, phiStar2, iHist);
       *sameCharge = true; // always true as we checked the condition in the HF task
     }
-    int num = tmpVec1.size();
-    int meaningfulEntries = num;
-    float dPhiAvg = 0;
-    float dphi;
-    for (int i = 0; i < num; i++) {
-      if (tmpVec1.at(i) != 999 && tmpVec2.at(i) != 999) {
-        dphi = tmpVec1.at(i) - tmpVec2.at(i);
+    int meaningfulEntries = 9;
+    std::array<float, 9> dphi{};
+    for (size_t i = 0; i < 9; i++) {
+      if (phiStar1[i] != 999 && phiStar2[i] != 999) {
+        dphi[i] = phiStar1[i] - phiStar2[i];
       } else {
-        dphi = 0;
+        dphi[i] = 0;
         meaningfulEntries = meaningfulEntries - 1;
       }
-      dphi = TVector2::Phi_mpi_pi(dphi);
-      dPhiAvg += dphi;
-      if (plotForEveryRadii) {
-        histdetadpiRadii[iHist][i]->Fill(part1.eta() - part2.eta(), dphi);
+      dphi[i] = TVector2::Phi_mpi_pi(dphi[i]);
+    }
+    float dPhiAvg = 0;
+    for (size_t i = 0; i < 9; i++) {
+      dPhiAvg += dphi[i];
+    }
+    if (plotForEveryRadii) {
+      const float deta = part1.eta() - part2.eta();
+      for (size_t i = 0; i < 9; i++) {
+        histdetadpiRadii[iHist][i]->Fill(deta, dphi[i]);
       }
     }
     return dPhiAvg / static_cast<float>(meaningfulEntries);
@@ -29,6 +29,8 @@
 
 #include "TMath.h"
 
+#include <array>
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <vector>
@@ -792,59 +794,82 @@ class FemtoUniverseDetaDphiStar
   std::shared_ptr<TH3> histdetadpiqlcmssame{};
   std::shared_ptr<TH3> histdetadpiqlcmsmixed{};
 
-  ///  Calculate phi at all required radii stored in TmpRadiiTPC
+  /// phi* cache entry: phiStar at TmpRadiiTPC, reused as long as the particle and its kinematics are unchanged
+  struct PhiStarCacheEntry {
+    int64_t index = -1;             ///< global index of the particle
+    float phi = 0.f;                ///< inputs the values were computed with
+    float pt = 0.f;
+    float magfield = 0.f;
+    float charge = 0.f;
+    std::array<float, 9> phiStar{}; ///< phi* at TmpRadiiTPC, 999 if the particle does not reach the radius
+  };
+
+  static constexpr int64_t kPhiStarCacheSize = 1024; ///< number of cached particles, power of 2
+  std::array<PhiStarCacheEntry, kPhiStarCacheSize> phiStarCache{};
+
+  ///  Calculate phi at all required radii stored in TmpRadiiTPC, or take it from the cache
   /// Magnetic field to be provided in Tesla
   template <typename T>
-  void phiAtRadiiTPC(const T& part, std::vector<float>& tmpVec)
+  const std::array<float, 9>& phiAtRadiiTPC(const T& part)
   {
-
-    float phi0 = part.phi();
-    // Start: Get the charge from cutcontainer using masks
-    float charge = 0.;
-    if ((part.cut() & kSignMinusMask) == kValue0 && (part.cut() & kSignPlusMask) == kValue0) {
-      charge = 0;
-    } else if ((part.cut() & kSignPlusMask) == kSignPlusMask) {
-      charge = 1;
-    } else if ((part.cut() & kSignMinusMask) == kSignMinusMask) {
-      charge = -1;
-    } else {
-      LOG(fatal) << "FemtoUniverseDetaDphiStar: Charge bits are set wrong!";
+    const int64_t index = part.globalIndex();
+    const float phi0 = part.phi();
+    const float pt = part.pt();
+    const float charge = getCharge(part);
+    auto& entry = phiStarCache[index & (kPhiStarCacheSize - 1)];
+    if (entry.index == index && entry.phi == phi0 && entry.pt == pt && entry.magfield == magfield && entry.charge == charge) {
+      return entry.phiStar;
     }
-    // End: Get the charge from cutcontainer using masks
-    float pt = part.pt();
+    entry.index = index;
+    entry.phi = phi0;
+    entry.pt = pt;
+    entry.magfield = magfield;
+    entry.charge = charge;
     for (size_t i = 0; i < 9; i++) {
       double arg = 0.3 * charge * magfield * TmpRadiiTPC[i] * 0.01 / (2. * pt);
       if (std::abs(arg) < 1.0) {
-        tmpVec.push_back(phi0 - std::asin(arg));
+        entry.phiStar[i] = phi0 - std::asin(arg);
       } else {
-        tmpVec.push_back(999.0);
+        entry.phiStar[i] = 999.0;
       }
     }
+    return entry.phiStar;
   }
 
-  ///  Calculate average phi
+  ///  Calculate dphi* at all radii stored in TmpRadiiTPC, 0 where one of the particles does not reach the radius
+  /// \return number of radii reached by both particles
   template <typename T1, typename T2>
-  float averagePhiStar(const T1& part1, const T2& part2, int iHist)
+  int deltaPhiStarAtRadiiTPC(const T1& part1, const T2& part2, std::array<float, 9>& dphi)
   {
-    std::vector<float> tmpVec1;
-    std::vector<float> tmpVec2;
-    phiAtRadiiTPC(part1, tmpVec1);
-    phiAtRadiiTPC(part2, tmpVec2);
-    int num = tmpVec1.size();
-    float dPhiAvg = 0;
-    float dphi = 0;
+    const std::array<float, 9> phiStar1 = phiAtRadiiTPC(part1); // copy, the two particles may share a cache entry
+    const std::array<float, 9>& phiStar2 = phiAtRadiiTPC(part2);
     int entries = 0;
-    for (int i = 0; i < num; i++) {
-      if (tmpVec1.at(i) != 999 && tmpVec2.at(i) != 999) {
-        dphi = tmpVec1.at(i) - tmpVec2.at(i);
+    for (size_t i = 0; i < 9; i++) {
+      if (phiStar1[i] != 999 && phiStar2[i] != 999) {
+        dphi[i] = phiStar1[i] - phiStar2[i];
         entries++;
       } else {
-        dphi = 0;
+        dphi[i] = 0;
       }
-      dphi = TVector2::Phi_mpi_pi(dphi);
-      dPhiAvg += dphi;
-      if (plotForEveryRadii) {
-        histdetadpiRadii[iHist][i]->Fill(part1.eta() - part2.eta(), dphi);
+      dphi[i] = TVector2::Phi_mpi_pi(dphi[i]);
+    }
+    return entries;
+  }
+
+  ///  Calculate average phi
+  template <typename T1, typename T2>
+  float averagePhiStar(const T1& part1, const T2& part2, int iHist)
+  {
+    std::array<float, 9> dphi{};
+    const int entries = deltaPhiStarAtRadiiTPC(part1, part2, dphi);
+    float dPhiAvg = 0;
+    for (size_t i = 0; i < 9; i++) {
+      dPhiAvg += dphi[i];
+    }
+    if (plotForEveryRadii) {
+      const float deta = part1.eta() - part2.eta();
+      for (size_t i = 0; i < 9; i++) {
+        histdetadpiRadii[iHist][i]->Fill(deta, dphi[i]);
       }
     }
     return dPhiAvg / static_cast<float>(entries);
@@ -854,25 +879,13 @@ class FemtoUniverseDetaDphiStar
   template <typename T1, typename T2>
   float averagePhiStarFrac(const T1& part1, const T2& part2, float maxdist)
   {
-    std::vector<float> tmpVec1;
-    std::vector<float> tmpVec2;
-    phiAtRadiiTPC(part1, tmpVec1);
-    phiAtRadiiTPC(part2, tmpVec2);
-    int num = tmpVec1.size();
-    float dphi = 0;
-    int entries = 0;
+    std::array<float, 9> dphi{};
+    const int entries = deltaPhiStarAtRadiiTPC(part1, part2, dphi);
     double distance = 0;
     int badpoints = 0;
 
-    for (int i = 0; i < num; i++) {
-      if (tmpVec1.at(i) != 999 && tmpVec2.at(i) != 999) {
-        dphi = tmpVec1.at(i) - tmpVec2.at(i);
-        entries++;
-      } else {
-        dphi = 0;
-      }
-      dphi = TVector2::Phi_mpi_pi(dphi);
-      distance = 2 * TMath::Sin(TMath::Abs(dphi) * 0.5) * TmpRadiiTPC[i];
+    for (size_t i = 0; i < 9; i++) {
+      distance = 2 * TMath::Sin(TMath::Abs(dphi[i]) * 0.5) * TmpRadiiTPC[i];
       if (distance < maxdist) {
         badpoints++;
       }
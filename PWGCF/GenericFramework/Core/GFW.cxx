@@ -11,6 +11,8 @@
 
 #include "GFW.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cstdio>
 #include <string>
 #include <utility>
@@ -21,7 +23,11 @@ using std::pair;
 using std::string;
 using std::vector;
 
-GFW::GFW() : fInitialized(false) {}
+GFW::GFW() : fInitialized(false)
+{
+  static std::atomic<uint64_t> lastPlanOwnerId{0};
+  fPlanOwnerId = ++lastPlanOwnerId;
+}
 
 GFW::~GFW()
 {
@@ -79,6 +85,7 @@ int GFW::CreateRegions()
   for (auto pItr = fCumulants.begin(); pItr != fCumulants.end(); ++pItr)
     pItr->DestroyComplexVectorArray();
   fCumulants.clear();
+  ++fEventCounter;
   InitializePowerArrays();
   if (fRegions.size() < 1) {
     printf("No regions set. Skipping...\n");
@@ -98,11 +105,32 @@ int GFW::CreateRegions()
 void GFW::Fill(double eta, int ptin, double phi, double weight, int mask, double SecondWeight)
 {
   // if(!fInitialized) return;
+  ++fEventCounter;
   for (int i = 0; i < static_cast<int>(fRegions.size()); ++i) {
     if (fRegions.at(i).EtaMin < eta && fRegions.at(i).EtaMax > eta && (fRegions.at(i).BitMask & mask))
       fCumulants.at(i).FillArray(ptin, phi, weight, SecondWeight);
   }
 };
+void GFW::Fill(int nParticles, const double* eta, const int* ptin, const double* phi, const double* weight, const int* mask, double SecondWeight)
+{
+  ++fEventCounter;
+  fBatchPtin.resize(nParticles);
+  fBatchPhi.resize(nParticles);
+  fBatchWeight.resize(nParticles);
+  for (int i = 0; i < static_cast<int>(fRegions.size()); ++i) {
+    const Region& lRegion = fRegions.at(i);
+    int nSelected = 0;
+    for (int j = 0; j < nParticles; ++j) {
+      if (lRegion.EtaMin < eta[j] && lRegion.EtaMax > eta[j] && (lRegion.BitMask & mask[j])) {
+        fBatchPtin[nSelected] = ptin[j];
+        fBatchPhi[nSelected] = phi[j];
+        fBatchWeight[nSelected] = weight[j];
+        ++nSelected;
+      }
+    }
+    fCumulants.at(i).FillArray(nSelected, fBatchPtin.data(), fBatchPhi.data(), fBatchWeight.data(), SecondWeight);
+  }
+};
 complex<double> GFW::TwoRec(int n1, int n2, int p1, int p2, int ptbin, GFWCumulant* r1, GFWCumulant* r2, GFWCumulant* r3)
 {
   complex<double> part1 = r1->Vec(n1, p1, ptbin);
@@ -165,6 +193,7 @@ void GFW::Clear()
     CreateRegions();
   for (auto ptr = fCumulants.begin(); ptr != fCumulants.end(); ++ptr)
     ptr->ResetQs();
+  ++fEventCounter;
 };
 GFW::CorrConfig GFW::GetCorrelatorConfig(string config, string head, bool ptdif)
 {
@@ -246,6 +275,8 @@ GFW::CorrConfig GFW::GetCorrelatorConfig(string config, string head, bool ptdif)
   ReturnConfig.Head = head;
   ReturnConfig.pTDif = ptdif;
   // ReturnConfig.pTbin = ptbin;
+  ReturnConfig.planIndex = CompileConfig(ReturnConfig);
+  ReturnConfig.planOwner = fPlanOwnerId;
   fListOfCFGs.push_back(ReturnConfig);
   return ReturnConfig;
 };
@@ -293,6 +324,13 @@ complex<double> GFW::Calculate(CorrConfig corconf, int ptbin, bool SetHarmsToZer
       qovl = &fCumulants.at(ovl);
     else if (ref == poi)
       qovl = qref; // If ref and poi are the same, then the same is for overlap. Only, when OL not explicitly defined
+    if (corconf.planOwner == fPlanOwnerId && corconf.planIndex >= 0 && corconf.planIndex < static_cast<int>(fPlanConfigs.size())) {
+      // evaluate the compiled plan, sharing the sub-expressions with the other correlators;
+      // configs compiled by another GFW instance are evaluated recursively below
+      const int nSubevents = static_cast<int>(corconf.Regs.size());
+      retval *= EvaluatePlan(fPlanConfigs[corconf.planIndex].at((SetHarmsToZero ? nSubevents : 0) + i), ptInd);
+      continue;
+    }
     if (SetHarmsToZero) {
       for (int j = 0; j < static_cast<int>(corconf.Hars.at(i).size()); j++) {
         corconf.Hars.at(i).at(j) = 0;
@@ -302,6 +340,152 @@ complex<double> GFW::Calculate(CorrConfig corconf, int ptbin, bool SetHarmsToZer
   }
   return retval;
 };
+int GFW::CompileConfig(const CorrConfig& corconf)
+{
+  // Compile the recursive expansion of each subevent, with the harmonics as configured and set to zero, into plan programs
+  int nSubevents = static_cast<int>(corconf.Regs.size());
+  if (nSubevents == 0 || static_cast<int>(corconf.Hars.size()) != nSubevents || static_cast<int>(corconf.Overlap.size()) != nSubevents)
+    return -1;
+  for (int i = 0; i < nSubevents; i++)
+    if (corconf.Regs.at(i).size() == 0 || corconf.Hars.at(i).size() == 0)
+      return -1;
+  vector<int> programs(2 * nSubevents);
+  for (int lZero = 0; lZero < 2; lZero++) {
+    for (int i = 0; i < nSubevents; i++) {
+      // same choice of regions as in Calculate
+      int poi = corconf.Regs.at(i).at(0);
+      int ref = (corconf.Regs.at(i).size() > 1) ? corconf.Regs.at(i).at(1) : corconf.Regs.at(i).at(0);
+      int ovl = corconf.Overlap.at(i);
+      if (ovl < 0 && ref == poi)
+        ovl = ref;
+      vector<int> hars = corconf.Hars.at(i);
+      if (lZero)
+        std::fill(hars.begin(), hars.end(), 0);
+      vector<int> pows(hars.size(), 1);
+      PlanProgram lProgram;
+      lProgram.root = CompileCorr(poi, ref, ovl, hars, pows);
+      vector<bool> visited(fPlanNodes.size(), false);
+      CollectPlanNodes(lProgram.root, lProgram.nodes, visited);
+      programs[lZero * nSubevents + i] = static_cast<int>(fPlanPrograms.size());
+      fPlanPrograms.push_back(lProgram);
+    }
+  }
+  fPlanValues.resize(fPlanNodes.size());
+  fPlanValueEvent.resize(fPlanNodes.size(), 0);
+  fPlanValuePtBin.resize(fPlanNodes.size(), 0);
+  fPlanConfigs.push_back(programs);
+  return static_cast<int>(fPlanConfigs.size()) - 1;
+};
+int GFW::CompileLeaf(int region, int har, int pow, bool atPtBin)
+{
+  auto lKey = std::make_tuple(region, har, pow, atPtBin);
+  auto lItr = fPlanLeafIndex.find(lKey);
+  if (lItr != fPlanLeafIndex.end())
+    return lItr->second;
+  PlanNode lNode;
+  lNode.region = region;
+  lNode.har = har;
+  lNode.pow = pow;
+  lNode.atPtBin = atPtBin;
+  lNode.ptDependent = atPtBin;
+  fPlanNodes.push_back(lNode);
+  fPlanLeafIndex[lKey] = static_cast<int>(fPlanNodes.size()) - 1;
+  return static_cast<int>(fPlanNodes.size()) - 1;
+};
+int GFW::CompileCorr(int poi, int ref, int ovl, vector<int>& hars, vector<int>& pows)
+{
+  // Same expansion as RecursiveCorr, but building nodes instead of evaluating them; regions are given by index, -1 for no overlap
+  if ((pows.at(0) != 1) && ovl > -1)
+    poi = ovl; // if the power of POI is not unity, then always use overlap (if defined).
+  auto lKey = std::make_tuple(poi, ref, ovl, hars, pows);
+  auto lItr = fPlanProductIndex.find(lKey);
+  if (lItr != fPlanProductIndex.end())
+    return lItr->second;
+  int lIndex;
+  if (hars.size() < 2) {
+    lIndex = CompileLeaf(poi, hars.at(0), pows.at(0), true);
+  } else {
+    PlanNode lNode;
+    vector<PlanTerm> lTerms;
+    if (hars.size() < 3) {
+      lNode.factor1 = CompileLeaf(poi, hars.at(0), pows.at(0), true);
+      lNode.factor2 = CompileLeaf(ref, hars.at(1), pows.at(1), true);
+      if (ovl > -1)
+        lTerms.push_back({CompileLeaf(ovl, hars.at(0) + hars.at(1), pows.at(0) + pows.at(1), true), 1.});
+    } else {
+      int harlast = hars.at(hars.size() - 1);
+      int powlast = pows.at(pows.size() - 1);
+      hars.erase(hars.end() - 1);
+      pows.erase(pows.end() - 1);
+      lNode.factor1 = CompileCorr(poi, ref, ovl, hars, pows);
+      lNode.factor2 = CompileLeaf(ref, harlast, powlast, false);
+      int lDegeneracy = 1;
+      int harSize = static_cast<int>(hars.size());
+      for (int i = harSize - 1; i >= 0; i--) {
+        if (i > 2) {
+          if (hars.at(i) == hars.at(i - 1) && pows.at(i) == pows.at(i - 1)) {
+            lDegeneracy++;
+            continue;
+          }
+        }
+        hars.at(i) += harlast;
+        pows.at(i) += powlast;
+        lTerms.push_back({CompileCorr(poi, ref, ovl, hars, pows), static_cast<double>(lDegeneracy)});
+        lDegeneracy = 1;
+        hars.at(i) -= harlast;
+        pows.at(i) -= powlast;
+      }
+      hars.push_back(harlast);
+      pows.push_back(powlast);
+    }
+    lNode.firstTerm = static_cast<int>(fPlanTerms.size());
+    lNode.nTerms = static_cast<int>(lTerms.size());
+    lNode.ptDependent = fPlanNodes[lNode.factor1].ptDependent || fPlanNodes[lNode.factor2].ptDependent;
+    for (const auto& lTerm : lTerms) {
+      fPlanTerms.push_back(lTerm);
+      lNode.ptDependent = lNode.ptDependent || fPlanNodes[lTerm.node].ptDependent;
+    }
+    fPlanNodes.push_back(lNode);
+    lIndex = static_cast<int>(fPlanNodes.size()) - 1;
+  }
+  fPlanProductIndex[lKey] = lIndex;
+  return lIndex;
+};
+void GFW::CollectPlanNodes(int node, vector<int>& nodes, vector<bool>& visited)
+{
+  if (visited[node])
+    return;
+  visited[node] = true;
+  const PlanNode& lNode = fPlanNodes[node];
+  if (lNode.region < 0) {
+    CollectPlanNodes(lNode.factor1, nodes, visited);
+    CollectPlanNodes(lNode.factor2, nodes, visited);
+    for (int t = lNode.firstTerm; t < lNode.firstTerm + lNode.nTerms; t++)
+      CollectPlanNodes(fPlanTerms[t].node, nodes, visited);
+  }
+  nodes.push_back(node);
+};
+complex<double> GFW::EvaluatePlan(int program, int ptbin)
+{
+  const PlanProgram& lProgram = fPlanPrograms[program];
+  for (const int lIndex : lProgram.nodes) {
+    const PlanNode& lNode = fPlanNodes[lIndex];
+    if (fPlanValueEvent[lIndex] == fEventCounter && (!lNode.ptDependent || fPlanValuePtBin[lIndex] == ptbin))
+      continue; // already evaluated for this event (and pT bin)
+    complex<double> lValue;
+    if (lNode.region >= 0) {
+      lValue = fCumulants[lNode.region].Vec(lNode.har, lNode.pow, lNode.atPtBin ? ptbin : 0);
+    } else {
+      lValue = fPlanValues[lNode.factor1] * fPlanValues[lNode.factor2];
+      for (int t = lNode.firstTerm; t < lNode.firstTerm + lNode.nTerms; t++)
+        lValue -= fPlanValues[fPlanTerms[t].node] * fPlanTerms[t].factor;
+    }
+    fPlanValues[lIndex] = lValue;
+    fPlanValueEvent[lIndex] = fEventCounter;
+    fPlanValuePtBin[lIndex] = ptbin;
+  }
+  return fPlanValues[lProgram.root];
+};
 vector<pair<int, vector<int>>> GFW::GetHarmonicsSingleConfig(const CorrConfig& incfg)
 {
   vector<pair<int, vector<int>>> retPair;
@@ -21,8 +21,11 @@
 
 #include <algorithm>
 #include <complex>
+#include <cstdint>
 #include <cstdio>
+#include <map>
 #include <string>
+#include <tuple>
 #include <utility>
 #include <vector>
 
@@ -50,6 +53,8 @@ class GFW
     std::vector<int> ptInd;
     bool pTDif = false;
     std::string Head = "";
+    int planIndex = -1;     // index of the compiled evaluation plan, -1 if not compiled
+    uint64_t planOwner = 0; // id of the GFW instance whose plan planIndex refers to
   };
   GFW();
   ~GFW();
@@ -61,6 +66,7 @@ class GFW
   void AddRegion(std::string refName, int lNhar, int* lNparVec, double lEtaMin, double lEtaMax, int lNpT, int BitMask);  // Legacy support, array instead of a vector
   int CreateRegions();
   void Fill(double eta, int ptin, double phi, double weight, int mask, double secondWeight = -1);
+  void Fill(int nParticles, const double* eta, const int* ptin, const double* phi, const double* weight, const int* mask, double secondWeight = -1); // Batch of particles
   void Clear();
   GFWCumulant GetCumulant(int index) { return fCumulants.at(index); }
   CorrConfig GetCorrelatorConfig(std::string config, std::string head = "", bool ptdif = false);
@@ -69,6 +75,50 @@ class GFW
 
  protected:
   bool fInitialized;
+  // Scratch buffers for the batch filling of one region
+  std::vector<int> fBatchPtin;      //!
+  std::vector<double> fBatchPhi;    //!
+  std::vector<double> fBatchWeight; //!
+  // Evaluation plan: the recursive expansions of all configured correlators are compiled once into a DAG of nodes,
+  // either Q-vectors or products of nodes minus a sum of nodes, with identical sub-expressions shared among correlators.
+  // Each node is evaluated at most once per event and pT bin.
+  struct PlanNode {
+    int region = -1;         // leaf: region of the Q-vector, -1 for a product node
+    int har = 0;             // leaf: harmonic
+    int pow = 0;             // leaf: power
+    bool atPtBin = true;     // leaf: take the Q-vector in the requested pT bin (otherwise, in the first one)
+    int factor1 = -1;        // product: first factor
+    int factor2 = -1;        // product: second factor
+    int firstTerm = 0;       // product: first subtracted term in fPlanTerms
+    int nTerms = 0;          // product: number of subtracted terms
+    bool ptDependent = true; // whether the value depends on the requested pT bin
+  };
+  struct PlanTerm {
+    int node;      // subtracted node
+    double factor; // multiplicity of the term
+  };
+  struct PlanProgram {
+    int root;               // node holding the correlator of one subevent
+    std::vector<int> nodes; // nodes to be evaluated, in dependency order
+  };
+  std::vector<PlanNode> fPlanNodes;           //! nodes of all compiled correlators
+  std::vector<PlanTerm> fPlanTerms;           //! subtracted terms of the product nodes
+  std::vector<PlanProgram> fPlanPrograms;     //! one program per subevent of each compiled correlator
+  std::vector<std::vector<int>> fPlanConfigs; //! programs of each compiled config: [subevent] for the harmonics, then [nSubevents + subevent] with harmonics set to zero
+
+  std::map<std::tuple<int, int, int, bool>, int> fPlanLeafIndex;                                  //! (region, har, pow, atPtBin) -> node
+  std::map<std::tuple<int, int, int, std::vector<int>, std::vector<int>>, int> fPlanProductIndex; //! (poi, ref, overlap, hars, pows) -> node
+
+  std::vector<std::complex<double>> fPlanValues; //! values of the nodes
+  std::vector<uint64_t> fPlanValueEvent;         //! event counter at which each node was evaluated
+  std::vector<int> fPlanValuePtBin;              //! pT bin in which each node was evaluated
+  uint64_t fEventCounter = 1;                    //! incremented whenever the Q-vectors change
+  uint64_t fPlanOwnerId;                         //! unique id of this instance, for the configs compiled into its plan
+  int CompileConfig(const CorrConfig& corconf);
+  int CompileLeaf(int region, int har, int pow, bool atPtBin);
+  int CompileCorr(int poi, int ref, int ovl, std::vector<int>& hars, std::vector<int>& pows);
+  void CollectPlanNodes(int node, std::vector<int>& nodes, std::vector<bool>& visited);
+  std::complex<double> EvaluatePlan(int program, int ptbin);
   std::vector<CorrConfig> fListOfCFGs;
   std::complex<double> TwoRec(int n1, int n2, int p1, int p2, int ptbin, GFWCumulant*, GFWCumulant*, GFWCumulant*);
   std::complex<double> RecursiveCorr(GFWCumulant* qpoi, GFWCumulant* qref, GFWCumulant* qol, int ptbin, std::vector<int>& hars, std::vector<int>& pows); // POI, Ref. flow, overlapping region
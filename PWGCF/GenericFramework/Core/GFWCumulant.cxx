@@ -11,21 +11,35 @@
 
 #include "GFWCumulant.h"
 
+#include <algorithm>
 #include <vector>
 
 using std::complex;
 using std::vector;
 
-GFWCumulant::GFWCumulant() : fQvector(0),
+GFWCumulant::GFWCumulant() : fQvector(),
                              fUsed(kBlank),
                              fNEntries(-1),
                              fN(1),
                              fPow(1),
                              fPt(1),
-                             fFilledPts(0),
+                             fMaxPow(0),
+                             fQStride(0),
+                             fFilledPts(),
                              fInitialized(false) {}
 
 GFWCumulant::~GFWCumulant() {}
+void GFWCumulant::FillPrefactors(double weight, double SecondWeight, double* prefactors, int stride) const
+{
+  // Weight powers computed incrementally; multiplication is cheaper that power
+  // If second weight is specified, then keep the first weight with power no more than 1, and us the other weight otherwise
+  // this is important when POIs are a subset of REFs and have different weights than REFs
+  double lPrefactor = 1;
+  for (int lPow = 0; lPow < fMaxPow; lPow++) {
+    prefactors[lPow * stride] = lPrefactor;
+    lPrefactor *= (SecondWeight > 0 && lPow > 0) ? SecondWeight : weight;
+  }
+}
 void GFWCumulant::FillArray(int ptin, double phi, double weight, double SecondWeight)
 {
   if (!fInitialized)
@@ -35,53 +49,98 @@ void GFWCumulant::FillArray(int ptin, double phi, double weight, double SecondWe
   else if (ptin < 0 || ptin >= fPt)
     return;
   fFilledPts[ptin] = true;
+  double* lPrefactors = fBatchPrefactor.data();
+  FillPrefactors(weight, SecondWeight, lPrefactors);
+  // Higher harmonics from the first one by complex multiplication: e^{i(n+1)phi} = e^{in*phi} * e^{i*phi}
+  const double lCos1 = cos(phi);
+  const double lSin1 = sin(phi);
+  double lCos = 1;
+  double lSin = 0;
+  complex<double>* lQ = fQvector.data() + ptin * fQStride;
   for (int lN = 0; lN < fN; lN++) {
-    double lSin = sin(lN * phi); // No need to recalculate for each power
-    double lCos = cos(lN * phi); // No need to recalculate for each power
+    complex<double>* lQn = lQ + fHarOffset[lN];
     for (int lPow = 0; lPow < PW(lN); lPow++) {
-      double lPrefactor = 0;
-      // Dont calculate it twice; multiplication is cheaper that power
-      // Also, if second weight is specified, then keep the first weight with power no more than 1, and us the other weight otherwise
-      // this is important when POIs are a subset of REFs and have different weights than REFs
-      if (SecondWeight > 0 && lPow > 1)
-        lPrefactor = pow(SecondWeight, lPow - 1) * weight;
-      else
-        lPrefactor = pow(weight, lPow);
-      double qsin = lPrefactor * lSin;
-      double qcos = lPrefactor * lCos;
-      fQvector[ptin][lN][lPow] += complex<double>(qcos, qsin);
+      lQn[lPow] += complex<double>(lPrefactors[lPow] * lCos, lPrefactors[lPow] * lSin);
     }
+    const double lCosNext = lCos * lCos1 - lSin * lSin1;
+    lSin = lSin * lCos1 + lCos * lSin1;
+    lCos = lCosNext;
   }
   Inc();
 };
-void GFWCumulant::ResetQs()
+void GFWCumulant::FillArray(int nParticles, const int* ptin, const double* phi, const double* weight, double SecondWeight)
 {
-  if (!fNEntries)
-    return; // If 0 entries, then no need to reset. Otherwise, if -1, then just initialized and need to set to 0.
-  for (int i = 0; i < fPt; i++) {
-    fFilledPts[i] = false;
-    for (int lN = 0; lN < fN; lN++) {
-      for (int lPow = 0; lPow < PW(lN); lPow++) {
-        fQvector[i][lN][lPow] = fNullQ;
+  if (!fInitialized)
+    CreateComplexVectorArray(1, 1, 1);
+  if (nParticles <= 0)
+    return;
+  fBatchBin.resize(nParticles);
+  fBatchCos.resize(nParticles);
+  fBatchSin.resize(nParticles);
+  fBatchRe.resize(nParticles);
+  fBatchIm.resize(nParticles);
+  fBatchPrefactor.resize(static_cast<size_t>(fMaxPow) * nParticles);
+  // Per-particle quantities, stored as structure of arrays
+  for (int i = 0; i < nParticles; i++) {
+    int lBin = (fPt == 1) ? 0 : ptin[i];
+    if (lBin < 0 || lBin >= fPt)
+      lBin = -1;
+    fBatchBin[i] = lBin;
+    if (lBin >= 0) {
+      fFilledPts[lBin] = true;
+      Inc();
+    }
+  }
+  for (int i = 0; i < nParticles; i++) {
+    fBatchCos[i] = cos(phi[i]);
+    fBatchSin[i] = sin(phi[i]);
+    fBatchRe[i] = 1;
+    fBatchIm[i] = 0;
+  }
+  for (int i = 0; i < nParticles; i++)
+    FillPrefactors(weight[i], SecondWeight, fBatchPrefactor.data() + i, nParticles);
+  // Accumulate harmonic by harmonic; each Q-vector still receives the particles in their input order
+  for (int lN = 0; lN < fN; lN++) {
+    for (int lPow = 0; lPow < PW(lN); lPow++) {
+      const double* lPrefactors = fBatchPrefactor.data() + static_cast<size_t>(lPow) * nParticles;
+      if (fPt == 1) {
+        double lQcos = 0, lQsin = 0;
+        for (int i = 0; i < nParticles; i++) {
+          lQcos += lPrefactors[i] * fBatchRe[i];
+          lQsin += lPrefactors[i] * fBatchIm[i];
+        }
+        fQvector[fHarOffset[lN] + lPow] += complex<double>(lQcos, lQsin);
+      } else {
+        for (int i = 0; i < nParticles; i++) {
+          if (fBatchBin[i] < 0)
+            continue;
+          fQvector[fBatchBin[i] * fQStride + fHarOffset[lN] + lPow] += complex<double>(lPrefactors[i] * fBatchRe[i], lPrefactors[i] * fBatchIm[i]);
+        }
       }
     }
+    // next harmonic: e^{i(n+1)phi} = e^{in*phi} * e^{i*phi}
+    for (int i = 0; i < nParticles; i++) {
+      const double lRe = fBatchRe[i] * fBatchCos[i] - fBatchIm[i] * fBatchSin[i];
+      fBatchIm[i] = fBatchIm[i] * fBatchCos[i] + fBatchRe[i] * fBatchSin[i];
+      fBatchRe[i] = lRe;
+    }
   }
+};
+void GFWCumulant::ResetQs()
+{
+  if (!fNEntries)
+    return; // If 0 entries, then no need to reset. Otherwise, if -1, then just initialized and need to set to 0.
+  std::fill(fFilledPts.begin(), fFilledPts.end(), false);
+  std::fill(fQvector.begin(), fQvector.end(), fNullQ);
   fNEntries = 0;
 };
 void GFWCumulant::DestroyComplexVectorArray()
 {
   if (!fInitialized)
     return;
-  for (int l_n = 0; l_n < fN; l_n++) {
-    for (int i = 0; i < fPt; i++) {
-      delete[] fQvector[i][l_n];
-    }
-  }
-  for (int i = 0; i < fPt; i++) {
-    delete[] fQvector[i];
-  }
-  delete[] fQvector;
-  delete[] fFilledPts;
+  fQvector.clear();
+  fQvector.shrink_to_fit();
+  fFilledPts.clear();
   fInitialized = false;
   fNEntries = -1;
 };
@@ -100,17 +159,18 @@ void GFWCumulant::CreateComplexVectorArrayVarPower(int N, vector<int> PowVec, in
   fN = N;
   fPow = 0;
   fPt = Pt;
-  fFilledPts = new bool[Pt];
   fPowVec = PowVec;
-  fQvector = new complex<double>**[fPt];
-  for (int i = 0; i < fPt; i++) {
-    fQvector[i] = new complex<double>*[fN];
-  }
+  fHarOffset.resize(fN);
+  fQStride = 0;
+  fMaxPow = 0;
   for (int l_n = 0; l_n < fN; l_n++) {
-    for (int i = 0; i < fPt; i++) {
-      fQvector[i][l_n] = new complex<double>[PW(l_n)];
-    }
+    fHarOffset[l_n] = fQStride;
+    fQStride += PW(l_n);
+    fMaxPow = std::max(fMaxPow, PW(l_n));
   }
+  fFilledPts.assign(fPt, false);
+  fQvector.assign(static_cast<size_t>(fPt) * fQStride, fNullQ);
+  fBatchPrefactor.resize(fMaxPow);
   ResetQs();
   fInitialized = true;
 };
@@ -121,12 +181,12 @@ complex<double> GFWCumulant::Vec(int n, int p, int ptbin)
   if (ptbin >= fPt || ptbin < 0)
     ptbin = 0;
   if (n >= 0)
-    return fQvector[ptbin][n][p];
-  return conj(fQvector[ptbin][-n][p]);
+    return fQvector[ptbin * fQStride + fHarOffset[n] + p];
+  return conj(fQvector[ptbin * fQStride + fHarOffset[-n] + p]);
 };
 bool GFWCumulant::IsPtBinFilled(int ptb)
 {
-  if (!fFilledPts)
+  if (fFilledPts.empty())
     return false;
   if (ptb > 0) {
     if (fPt == 1)
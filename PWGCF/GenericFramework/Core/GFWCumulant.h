@@ -27,6 +27,8 @@ class GFWCumulant
   ~GFWCumulant();
   void ResetQs();
   void FillArray(int ptin, double phi, double weight = 1, double SecondWeight = -1);
+  // Fill a batch of particles; equivalent to calling FillArray for each particle
+  void FillArray(int nParticles, const int* ptin, const double* phi, const double* weight, double SecondWeight = -1);
   enum UsedFlags_t { kBlank = 0,
                      kFull = 1,
                      kPt = 2 };
@@ -44,17 +46,29 @@ class GFWCumulant
   void DestroyComplexVectorArray();
   std::complex<double> Vec(int, int, int ptbin = 0); // envelope class to summarize pt-dif. Q-vec getter
  protected:
-  std::complex<double>*** fQvector;
+  // Q-vectors, stored contiguously: index = ptbin * fQStride + fHarOffset[harmonic] + power
+  std::vector<std::complex<double>> fQvector;
   uint fUsed;
   int fNEntries;
   // Q-vectors. Could be done recursively, but maybe defining each one of them explicitly is easier to read
-  int fN;                   //! Harmonics
-  int fPow;                 //! Power
-  std::vector<int> fPowVec; //! Powers array
-  int fPt;                  //! fPt bins
-  bool* fFilledPts;
+  int fN;                      //! Harmonics
+  int fPow;                    //! Power
+  std::vector<int> fPowVec;    //! Powers array
+  int fPt;                     //! fPt bins
+  int fMaxPow;                 //! Maximum power over all harmonics
+  int fQStride;                //! Number of Q-vectors per pT bin
+  std::vector<int> fHarOffset; //! Offset of each harmonic within a pT bin
+  std::vector<bool> fFilledPts;
   bool fInitialized; // Arrays are initialized
   std::complex<double> fNullQ = 0;
+  // Scratch buffers for the batch filling
+  std::vector<int> fBatchBin;          //! pT bin of each particle, -1 if not filled
+  std::vector<double> fBatchCos;       //! cos(phi) of each particle
+  std::vector<double> fBatchSin;       //! sin(phi) of each particle
+  std::vector<double> fBatchRe;        //! cos(n*phi) of each particle for the current harmonic
+  std::vector<double> fBatchIm;        //! sin(n*phi) of each particle for the current harmonic
+  std::vector<double> fBatchPrefactor; //! weight prefactors, stored per power: [power * nParticles + particle]
+  void FillPrefactors(double weight, double SecondWeight, double* prefactors, int stride = 1) const;
 };
 
 #endif // PWGCF_GENERICFRAMEWORK_CORE_GFWCUMULANT_H_
@@ -105,6 +105,7 @@ struct CorrelationTask {
   O2_DEFINE_CONFIGURABLE(cfgDecayParticleMask, int, 0, "Selection bitmask for the decay particles: 0 = no selection")
   O2_DEFINE_CONFIGURABLE(cfgV0RapidityMax, float, 0.8, "Maximum rapidity for the decay particles (0 = no selection)")
   O2_DEFINE_CONFIGURABLE(cfgMassAxis, int, 0, "Use invariant mass axis (0 = OFF, 1 = ON)")
+  O2_DEFINE_CONFIGURABLE(cfgPairBinCache, bool, false, "Fill pairs from bins resolved once per track and event, accumulated per event (not with mass axes)")
   O2_DEFINE_CONFIGURABLE(cfgMcTriggerPDGs, std::vector<int>, {}, "MC PDG codes to use exclusively as trigger particles and exclude from associated particles. Empty = no selection.")
 
   O2_DEFINE_CONFIGURABLE(cfgPtDepMLbkg, std::vector<float>, {}, "pT interval for ML training")
@@ -149,6 +150,7 @@ struct CorrelationTask {
 
   // persistent caches
   std::vector<float> efficiencyAssociatedCache;
+  std::vector<int> ptAssocBinCache;
   std::vector<int> p2indexCache;
 
   std::unique_ptr<TFormula> multCutFormula;
@@ -280,6 +282,9 @@ struct CorrelationTask {
     if (doprocessMixed2Prong2Prong || doprocessMixed2Prong2ProngML)
       userMixingAxis.emplace_back(axisInvMass, "m (GeV/c^2)");
 
+    if (cfgPairBinCache && (!userAxis.empty() || !userMixingAxis.empty()))
+      LOGF(fatal, "Can not fill pairs from cached bins with mass axes. Disable {}.", cfgPairBinCache.name);
+
     same.setObject(new CorrelationContainer("sameEvent", "sameEvent", corrAxis, effAxis, userAxis));
     mixed.setObject(new CorrelationContainer("mixedEvent", "mixedEvent", corrAxis, effAxis, userMixingAxis));
 
@@ -541,6 +546,19 @@ struct CorrelationTask {
       }
     }
 
+    // Resolve the bins of the event and the pt bins of the associated particles once instead of for each pair
+    bool pairEventInRange = false;
+    if (cfgPairBinCache) {
+      pairEventInRange = target->beginPairEvent(step, multiplicity, posZ);
+      ptAssocBinCache.clear();
+      if (pairEventInRange) {
+        ptAssocBinCache.reserve(tracks2.size());
+        for (const auto& track : tracks2) {
+          ptAssocBinCache.push_back(target->findPairBin(CorrelationContainer::kPairAxisPtAssoc, track.pt()));
+        }
+      }
+    }
+
     for (const auto& track1 : tracks1) {
       // LOGF(info, "Track %f | %f | %f  %d %d", track1.eta(), track1.phi(), track1.pt(), track1.isGlobalTrack(), track1.isGlobalTrackSDD());
 
@@ -616,7 +634,16 @@ struct CorrelationTask {
         target->getTriggerHist()->Fill(step, track1.pt(), multiplicity, posZ, triggerWeight);
       }
 
+      int binPtTrigger = 0;
+      if (cfgPairBinCache) {
+        if (!pairEventInRange)
+          continue; // pairs would be outside of the pair histogram
+        binPtTrigger = target->findPairBin(CorrelationContainer::kPairAxisPtTrigger, track1.pt());
+      }
+
+      int iTrack2 = -1;
       for (const auto& track2 : tracks2) {
+        ++iTrack2;
         if constexpr (std::is_same<TTracks1, TTracks2>::value) {
           if (track1.globalIndex() == track2.globalIndex()) {
             // LOGF(info, "Track identical: %f | %f | %f || %f | %f | %f", track1.eta(), track1.phi(), track1.pt(),  track2.eta(), track2.phi(), track2.pt());
@@ -752,7 +779,10 @@ struct CorrelationTask {
         } // ML selection
 
         // last param is the weight
-        if (cfgMassAxis && (doprocessSame2Prong2Prong || doprocessMixed2Prong2Prong || doprocessSame2Prong2ProngML || doprocessMixed2Prong2ProngML) && !(doprocessSame2ProngDerived || doprocessSame2ProngDerivedML || doprocessMixed2ProngDerived || doprocessMixed2ProngDerivedML)) {
+        if (cfgPairBinCache) {
+          target->fillPairBins(target->findPairBin(CorrelationContainer::kPairAxisDeltaEta, track1.eta() - track2.eta()), ptAssocBinCache[iTrack2], binPtTrigger,
+                               target->findPairBin(CorrelationContainer::kPairAxisDeltaPhi, deltaPhi), associatedWeight);
+        } else if (cfgMassAxis && (doprocessSame2Prong2Prong || doprocessMixed2Prong2Prong || doprocessSame2Prong2ProngML || doprocessMixed2Prong2ProngML) && !(doprocessSame2ProngDerived || doprocessSame2ProngDerivedML || doprocessMixed2ProngDerived || doprocessMixed2ProngDerivedML)) {
           if constexpr (std::experimental::is_detected<HasInvMass, typename TTracks1::iterator>::value && std::experimental::is_detected<HasInvMass, typename TTracks2::iterator>::value)
             target->getPairHist()->Fill(step, track1.eta() - track2.eta(), track2.pt(), track1.pt(), multiplicity, deltaPhi, posZ, track2.invMass(), track1.invMass(), associatedWeight);
           else
@@ -771,6 +801,10 @@ struct CorrelationTask {
         }
       }
     }
+
+    if (pairEventInRange) {
+      target->flushPairEvent();
+    }
   }
 
   void loadEfficiency(uint64_t timestamp)
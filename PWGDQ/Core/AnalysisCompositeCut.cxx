@@ -11,6 +11,8 @@
 
 #include "PWGDQ/Core/AnalysisCompositeCut.h"
 
+#include <algorithm>
+
 ClassImp(AnalysisCompositeCut)
 
   //____________________________________________________________________________
@@ -96,3 +98,33 @@ bool AnalysisCompositeCut::IsSelected(float* values)
     return false;
   }
 }
+
+void AnalysisCompositeCut::IsSelectedBatch(const float* const* columns, int nCandidates, uint8_t* selected)
+{
+  //
+  // apply cuts on a batch of candidates
+  //
+  std::fill(selected, selected + nCandidates, fOptionUseAND ? 1 : 0);
+  fBatchSelected.resize(nCandidates);
+
+  auto combine = [&]() {
+    if (fOptionUseAND) {
+      for (int i = 0; i < nCandidates; ++i) {
+        selected[i] &= fBatchSelected[i];
+      }
+    } else {
+      for (int i = 0; i < nCandidates; ++i) {
+        selected[i] |= fBatchSelected[i];
+      }
+    }
+  };
+
+  for (std::vector<AnalysisCut>::iterator it = fCutList.begin(); it < fCutList.end(); ++it) {
+    (*it).IsSelectedBatch(columns, nCandidates, fBatchSelected.data());
+    combine();
+  }
+  for (std::vector<AnalysisCompositeCut>::iterator it = fCompositeCutList.begin(); it < fCompositeCutList.end(); ++it) {
+    (*it).IsSelectedBatch(columns, nCandidates, fBatchSelected.data());
+    combine();
+  }
+}
@@ -43,11 +43,13 @@ class AnalysisCompositeCut : public AnalysisCut
   int GetNCuts() const { return fCutList.size() + fCompositeCutList.size(); }
 
   bool IsSelected(float* values) override;
+  void IsSelectedBatch(const float* const* columns, int nCandidates, uint8_t* selected) override;
 
  protected:
   bool fOptionUseAND;                                  // true (default): apply AND on all cuts; false: use OR
   std::vector<AnalysisCut> fCutList;                   // list of cuts
   std::vector<AnalysisCompositeCut> fCompositeCutList; // list of composite cuts
+  std::vector<uint8_t> fBatchSelected;                 //! decisions of the current sub-cut for the current batch
 
   ClassDef(AnalysisCompositeCut, 2);
 };
@@ -11,6 +11,8 @@
 
 #include "PWGDQ/Core/AnalysisCut.h"
 
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <vector>
 
@@ -39,6 +41,8 @@ AnalysisCut& AnalysisCut::operator=(const AnalysisCut& c)
   if (this != &c) {
     TNamed::operator=(c);
     fCuts = c.fCuts;
+    fTabulatedLow.clear();
+    fTabulatedHigh.clear();
   }
   return (*this);
 }
@@ -62,3 +66,133 @@ void AnalysisCut::PrintCuts()
 {
   cout << "**************** AnalysisCut::PrintCuts" << endl;
 }
+
+//____________________________________________________________________________
+void AnalysisCut::TabulateFunction(TF1* func, TabulatedLimit& table)
+{
+  //
+  // tabulate a limit function over its range
+  //
+  table.fValues.clear();
+  if (!func) {
+    return;
+  }
+  double xMin = func->GetXmin();
+  double xMax = func->GetXmax();
+  if (!(xMax > xMin)) {
+    return;
+  }
+  double step = (xMax - xMin) / (kNTabulationPoints - 1);
+  table.fXmin = xMin;
+  table.fInvStep = 1.0 / step;
+  table.fValues.resize(kNTabulationPoints);
+  float valueMin = 0.f, valueMax = 0.f;
+  for (int i = 0; i < kNTabulationPoints; ++i) {
+    table.fValues[i] = func->Eval(xMin + i * step);
+    valueMin = (i == 0 ? table.fValues[i] : std::min(valueMin, table.fValues[i]));
+    valueMax = (i == 0 ? table.fValues[i] : std::max(valueMax, table.fValues[i]));
+  }
+  // the interpolation error is largest in the middle of the intervals: if it exceeds kTabulationTolerance
+  // of the function range anywhere, the table is dropped and the function is always evaluated directly
+  const double maxError = kTabulationTolerance * (valueMax - valueMin);
+  for (int i = 0; i < kNTabulationPoints - 1; ++i) {
+    const double error = std::abs(0.5 * (table.fValues[i] + table.fValues[i + 1]) - func->Eval(xMin + (i + 0.5) * step));
+    if (!(error <= maxError)) {
+      table.fValues.clear();
+      return;
+    }
+  }
+}
+
+//____________________________________________________________________________
+void AnalysisCut::TabulateLimits()
+{
+  //
+  // tabulate the limit functions of all cuts, if not already done
+  //
+  if (fTabulatedLow.size() == fCuts.size()) {
+    return;
+  }
+  fTabulatedLow.resize(fCuts.size());
+  fTabulatedHigh.resize(fCuts.size());
+  for (size_t iCut = 0; iCut < fCuts.size(); ++iCut) {
+    TabulateFunction(fCuts[iCut].fFuncLow, fTabulatedLow[iCut]);
+    TabulateFunction(fCuts[iCut].fFuncHigh, fTabulatedHigh[iCut]);
+  }
+}
+
+//____________________________________________________________________________
+void AnalysisCut::EvalTabulated(TF1* func, const TabulatedLimit& table, const float* x, int n, float* result)
+{
+  //
+  // evaluate a limit function for a batch of values of the dependent variable, using linear interpolation in the table
+  //
+  const int nBins = table.fValues.size() - 1;
+  for (int i = 0; i < n; ++i) {
+    float u = (x[i] - table.fXmin) * table.fInvStep;
+    if (nBins > 0 && u >= 0.0f && u < nBins) {
+      int bin = static_cast<int>(u);
+      float frac = u - bin;
+      result[i] = table.fValues[bin] + frac * (table.fValues[bin + 1] - table.fValues[bin]);
+    } else {
+      result[i] = func->Eval(x[i]);
+    }
+  }
+}
+
+//____________________________________________________________________________
+void AnalysisCut::IsSelectedBatch(const float* const* columns, int nCandidates, uint8_t* selected)
+{
+  //
+  // apply the configured cuts on a batch of candidates
+  //
+  std::fill(selected, selected + nCandidates, 1);
+  TabulateLimits();
+
+  for (size_t iCut = 0; iCut < fCuts.size(); ++iCut) {
+    const CutContainer& cut = fCuts[iCut];
+    const float* x = columns[cut.fVar];
+
+    // obtain the low and high cut values (either directly as a value or from a function of the first dependent variable)
+    const float* cutLow = nullptr;
+    const float* cutHigh = nullptr;
+    if (cut.fFuncLow) {
+      fBatchLow.resize(nCandidates);
+      EvalTabulated(cut.fFuncLow, fTabulatedLow[iCut], columns[cut.fDepVar], nCandidates, fBatchLow.data());
+      cutLow = fBatchLow.data();
+    }
+    if (cut.fFuncHigh) {
+      fBatchHigh.resize(nCandidates);
+      EvalTabulated(cut.fFuncHigh, fTabulatedHigh[iCut], columns[cut.fDepVar], nCandidates, fBatchHigh.data());
+      cutHigh = fBatchHigh.data();
+    }
+
+    // the cut is applied only on the candidates for which the dependent variables satisfy their selection
+    const float* dep = (cut.fDepVar != -1 ? columns[cut.fDepVar] : nullptr);
+    const float* dep2 = (cut.fDepVar2 != -1 ? columns[cut.fDepVar2] : nullptr);
+
+    if (!dep && !dep2 && !cutLow && !cutHigh) {
+      // fixed limits without dependent variables
+      for (int i = 0; i < nCandidates; ++i) {
+        bool inRange = (x[i] >= cut.fLow && x[i] <= cut.fHigh);
+        selected[i] &= (inRange != cut.fExclude);
+      }
+      continue;
+    }
+    for (int i = 0; i < nCandidates; ++i) {
+      bool applied = true;
+      if (dep) {
+        bool inRange = (dep[i] > cut.fDepLow && dep[i] <= cut.fDepHigh);
+        applied = (inRange != cut.fDepExclude);
+      }
+      if (dep2) {
+        bool inRange = (dep2[i] > cut.fDep2Low && dep2[i] <= cut.fDep2High);
+        applied = applied && (inRange != cut.fDep2Exclude);
+      }
+      float low = (cutLow ? cutLow[i] : cut.fLow);
+      float high = (cutHigh ? cutHigh[i] : cut.fHigh);
+      bool inRange = (x[i] >= low && x[i] <= high);
+      selected[i] &= (!applied || (inRange != cut.fExclude));
+    }
+  }
+}
@@ -18,6 +18,7 @@
 #define AnalysisCut_H
 
 #include <TF1.h>
+#include <cstdint>
 #include <vector>
 
 //_________________________________________________________________________
@@ -40,7 +41,21 @@ class AnalysisCut : public TNamed
 
   virtual bool IsSelected(float* values);
 
+  // Apply the cuts on a batch of candidates stored as a structure of arrays: columns[var] points to the values of the variable "var"
+  // for all the nCandidates candidates (only the variables used by the cuts need to be provided).
+  // selected[i] is set to 1 if the i-th candidate passes the cuts, 0 otherwise
+  // NOTE: The limits given as TF1 are tabulated in kNTabulationPoints points over the function range and linearly interpolated,
+  // NOTE:   while the function is evaluated directly outside its range, or everywhere if the interpolation error
+  // NOTE:   exceeds kTabulationTolerance of the function range (e.g. steep functions)
+  virtual void IsSelectedBatch(const float* const* columns, int nCandidates, uint8_t* selected);
+
+  // Apply a list of cuts on a batch of candidates and set for each candidate the bit i of its filter map if the i-th cut is passed
+  template <typename TCut, typename TMap>
+  static void FillFilterMapsBatch(std::vector<TCut>& cuts, const float* const* columns, int nCandidates, TMap* filterMaps);
+
   static std::vector<int> fgUsedVars; //! vector of used variables
+  static constexpr int kNTabulationPoints = 1000;
+  static constexpr double kTabulationTolerance = 1.e-4;
 
   void PrintCuts();
 
@@ -67,6 +82,20 @@ class AnalysisCut : public TNamed
  protected:
   std::vector<CutContainer> fCuts;
 
+  struct TabulatedLimit {
+    float fXmin;                // lower edge of the function range
+    float fInvStep;             // inverse of the tabulation step
+    std::vector<float> fValues; // function values on the tabulation points, empty if there is no function
+  };
+  std::vector<TabulatedLimit> fTabulatedLow;  //! tabulated lower limit functions, one per cut
+  std::vector<TabulatedLimit> fTabulatedHigh; //! tabulated upper limit functions, one per cut
+  std::vector<float> fBatchLow;               //! lower limits of the current batch
+  std::vector<float> fBatchHigh;              //! upper limits of the current batch
+
+  void TabulateLimits();
+  static void TabulateFunction(TF1* func, TabulatedLimit& table);
+  static void EvalTabulated(TF1* func, const TabulatedLimit& table, const float* x, int n, float* result);
+
   ClassDef(AnalysisCut, 1);
 };
 
@@ -176,4 +205,20 @@ inline bool AnalysisCut::IsSelected(float* values)
   return true;
 }
 
+template <typename TCut, typename TMap>
+void AnalysisCut::FillFilterMapsBatch(std::vector<TCut>& cuts, const float* const* columns, int nCandidates, TMap* filterMaps)
+{
+  //
+  // evaluate each cut over the whole batch and encode the decisions in the filter maps
+  //
+  std::vector<uint8_t> selected(nCandidates);
+  int iCut = 0;
+  for (auto cut = cuts.begin(); cut != cuts.end(); ++cut, ++iCut) {
+    (*cut).IsSelectedBatch(columns, nCandidates, selected.data());
+    for (int i = 0; i < nCandidates; ++i) {
+      filterMaps[i] |= (static_cast<TMap>(selected[i]) << iCut);
+    }
+  }
+}
+
 #endif
@@ -17,6 +17,8 @@
 #include <list>
 #include <vector>
 #include <algorithm>
+#include <string>
+#include <string_view>
 #include "Framework/Logger.h"
 using namespace std;
 
@@ -741,155 +743,207 @@ void HistogramManager::AddHistogram(const char* histClass, const char* hname, co
 }
 
 //__________________________________________________________________
-void HistogramManager::FillHistClass(const char* className, Float_t* values)
+int HistogramManager::GetHistClassHandle(const char* className)
 {
   //
-  //  fill a class of histograms
+  // get the handle of a histogram class, compiling its fill plan on first request
   //
+  auto handleIt = fCompiledHandles.find(std::string_view(className));
+  if (handleIt != fCompiledHandles.end()) {
+    return handleIt->second;
+  }
 
-  // get the needed histogram list
   auto* hList = reinterpret_cast<TList*>(fMainList->FindObject(className));
   if (!hList) {
-    // TODO: add some meaningfull error message
-    /*LOG(warn) << "HistogramManager::FillHistClass(): Histogram list " << className << " not found!";
-    LOG(warn) << "         Histogram list not filled" << endl; */
-    return;
+    return kNothing;
   }
+  int handle = fCompiledClasses.size();
+  fCompiledClasses.push_back({hList, className, 0, 0, 0});
+  fCompiledHandles.emplace(className, handle);
+  CompileHistClass(handle);
+  return handle;
+}
 
-  // get the corresponding std::list containng identifiers to the needed variables to be filled
-  auto const& varList = fVariablesMap[className];
-
-  TIter next(hList);
-
-  TObject* h = nullptr;
-  bool isProfile;
-  bool isTHn;
-  int dimension = 0;
-  bool isSparse = kFALSE;
-  bool isFillLabelx = kFALSE;
-  // TODO: At the moment, maximum 20 dimensions are foreseen for the THn histograms. We should make this more dynamic
-  //       But maybe its better to have it like to avoid dynamically allocating this array in the histogram loop
-  double fillValues[20] = {0.0};
-  int varX = -1, varY = -1, varZ = -1, varT = -1, varW = -1;
+//____________________________________________________________________________________
+void HistogramManager::CompileHistClass(int handle)
+{
+  //
+  // resolve once the histograms of a class and the variables needed to fill them into a flat array of fill records
+  // NOTE: the records are appended, such that the records of each class stay contiguous also when a class is recompiled
+  //
+  auto& histClass = fCompiledClasses[handle];
+  auto const& varList = fVariablesMap[histClass.name];
+  histClass.firstRecord = fCompiledRecords.size();
+  histClass.nRecords = 0;
+  histClass.listSize = histClass.list->GetSize();
 
+  TIter next(histClass.list);
   // loop over the histogram and std::list
   // NOTE: these two should contain the same number of elements and be synchronized, otherwise its a mess
   for (auto varIter = varList.begin(); varIter != varList.end(); varIter++) {
-    h = next(); // get the histogram
-    // decode information from the vector of indices
-    isProfile = ((*varIter)[0] == 1 ? true : false);
-    isTHn = ((*varIter)[1] > 0 ? true : false);
-    if (isTHn) {
-      dimension = (*varIter)[1];
-    } else {
-      dimension = (reinterpret_cast<TH1*>(h))->GetDimension();
+    TObject* h = next();
+    if (!h) {
+      break;
     }
-
-    // get the various variable indices
-    varW = (*varIter)[2];
-    if (isTHn) {
-      for (int i = 0; i < dimension; i++) {
-        fillValues[i] = values[(*varIter)[3 + i]];
+    FillRecord record{h, kFillTH1, (*varIter)[2], {kNothing, kNothing, kNothing, kNothing}, 0, 0};
+    bool isProfile = ((*varIter)[0] == 1 ? true : false);
+    if ((*varIter)[1] > 0) {
+      record.kind = kFillTHn;
+      record.nDimensions = (*varIter)[1];
+      record.thnOffset = fCompiledTHnVars.size();
+      for (int i = 0; i < record.nDimensions; i++) {
+        fCompiledTHnVars.push_back((*varIter)[3 + i]);
       }
     } else {
-      varX = (*varIter)[3];
-      varY = (*varIter)[4];
-      varZ = (*varIter)[5];
-      varT = (*varIter)[6];
-      isFillLabelx = ((*varIter)[7] == 1 ? true : false);
-    }
-
-    if (!isTHn) {
-      switch (dimension) {
+      for (int i = 0; i < 4; i++) {
+        record.vars[i] = (*varIter)[3 + i];
+      }
+      bool isFillLabelx = ((*varIter)[7] == 1 ? true : false);
+      switch ((reinterpret_cast<TH1*>(h))->GetDimension()) {
         case 1:
           if (isProfile) {
-            if (varW > kNothing) {
-              if (isFillLabelx) {
-                (reinterpret_cast<TProfile*>(h))->Fill(Form("%d", static_cast<int>(values[varX])), values[varY], values[varW]);
-              } else {
-                (reinterpret_cast<TProfile*>(h))->Fill(values[varX], values[varY], values[varW]);
-              }
-            } else {
-              if (isFillLabelx) {
-                (reinterpret_cast<TProfile*>(h))->Fill(Form("%d", static_cast<int>(values[varX])), values[varY]);
-              } else {
-                (reinterpret_cast<TProfile*>(h))->Fill(values[varX], values[varY]);
-              }
-            }
+            record.kind = isFillLabelx ? kFillProfileLabel : kFillProfile;
           } else {
-            if (varW > kNothing) {
-              if (isFillLabelx) {
-                (reinterpret_cast<TH1*>(h))->Fill(Form("%d", static_cast<int>(values[varX])), values[varW]);
-              } else {
-                (reinterpret_cast<TH1*>(h))->Fill(values[varX], values[varW]);
-              }
-            } else {
-              if (isFillLabelx) {
-                (reinterpret_cast<TH1*>(h))->Fill(Form("%d", static_cast<int>(values[varX])), 1.);
-              } else {
-                (reinterpret_cast<TH1*>(h))->Fill(values[varX]);
-              }
-            }
+            record.kind = isFillLabelx ? kFillTH1Label : kFillTH1;
           }
           break;
         case 2:
           if (isProfile) {
-            if (varW > kNothing) {
-              (reinterpret_cast<TProfile2D*>(h))->Fill(values[varX], values[varY], values[varZ], values[varW]);
-            } else {
-              (reinterpret_cast<TProfile2D*>(h))->Fill(values[varX], values[varY], values[varZ]);
-            }
+            record.kind = kFillProfile2D;
           } else {
-            if (varW > kNothing) {
-              if (isFillLabelx) {
-                (reinterpret_cast<TH2*>(h))->Fill(Form("%d", static_cast<int>(values[varX])), values[varY], values[varW]);
-              } else {
-                (reinterpret_cast<TH2*>(h))->Fill(values[varX], values[varY], values[varW]);
-              }
-            } else {
-              if (isFillLabelx) {
-                (reinterpret_cast<TH2*>(h))->Fill(Form("%d", static_cast<int>(values[varX])), values[varY], 1.);
-              } else {
-                (reinterpret_cast<TH2*>(h))->Fill(values[varX], values[varY]);
-              }
-            }
+            record.kind = isFillLabelx ? kFillTH2Label : kFillTH2;
           }
           break;
         case 3:
-          if (isProfile) {
-            if (varW > kNothing) {
-              (reinterpret_cast<TProfile3D*>(h))->Fill(values[varX], values[varY], values[varZ], values[varT], values[varW]);
-            } else {
-              (reinterpret_cast<TProfile3D*>(h))->Fill(values[varX], values[varY], values[varZ], values[varT]);
-            }
-          } else {
-            if (varW > kNothing) {
-              (reinterpret_cast<TH3*>(h))->Fill(values[varX], values[varY], values[varZ], values[varW]);
-            } else {
-              (reinterpret_cast<TH3*>(h))->Fill(values[varX], values[varY], values[varZ]);
-            }
-          }
+          record.kind = isProfile ? kFillProfile3D : kFillTH3;
           break;
-
         default:
-          break;
-      } // end switch
-      // end if(!isTHn)
-    } else {
-      if (varW > kNothing) {
-        if (isSparse) {
-          (reinterpret_cast<THnSparse*>(h))->Fill(fillValues, values[varW]);
+          continue;
+      }
+    }
+    fCompiledRecords.push_back(record);
+    histClass.nRecords++;
+  }
+}
+
+//____________________________________________________________________________________
+void HistogramManager::FillHistClass(const char* className, Float_t* values)
+{
+  //
+  // fill a class of histograms
+  //
+  int handle = GetHistClassHandle(className);
+  if (handle == kNothing) {
+    // TODO: add some meaningfull error message
+    /*LOG(warn) << "HistogramManager::FillHistClass(): Histogram list " << className << " not found!";
+    LOG(warn) << "         Histogram list not filled" << endl; */
+    return;
+  }
+  FillHistClass(handle, values);
+}
+
+//____________________________________________________________________________________
+void HistogramManager::FillHistClass(int handle, Float_t* values)
+{
+  //
+  // fill a class of histograms using its compiled fill plan
+  //
+  if (handle < 0 || handle >= static_cast<int>(fCompiledClasses.size())) {
+    return;
+  }
+  // histograms added to the class after its compilation
+  if (fCompiledClasses[handle].list->GetSize() != fCompiledClasses[handle].listSize) {
+    CompileHistClass(handle);
+  }
+  const auto& histClass = fCompiledClasses[handle];
+
+  // TODO: At the moment, maximum 20 dimensions are foreseen for the THn histograms. We should make this more dynamic
+  //       But maybe its better to have it like to avoid dynamically allocating this array in the histogram loop
+  double fillValues[20] = {0.0};
+
+  const FillRecord* record = fCompiledRecords.data() + histClass.firstRecord;
+  const FillRecord* lastRecord = record + histClass.nRecords;
+  for (; record != lastRecord; ++record) {
+    TObject* h = record->hist;
+    const int varX = record->vars[0];
+    const int varY = record->vars[1];
+    const int varZ = record->vars[2];
+    const int varT = record->vars[3];
+    const int varW = record->varW;
+    const bool isWeighted = (varW > kNothing);
+
+    switch (record->kind) {
+      case kFillTH1:
+        if (isWeighted) {
+          (reinterpret_cast<TH1*>(h))->Fill(values[varX], values[varW]);
         } else {
-          (reinterpret_cast<THn*>(h))->Fill(fillValues, values[varW]);
+          (reinterpret_cast<TH1*>(h))->Fill(values[varX]);
         }
-      } else {
-        if (isSparse) {
-          (reinterpret_cast<THnSparse*>(h))->Fill(fillValues);
+        break;
+      case kFillTH1Label:
+        (reinterpret_cast<TH1*>(h))->Fill(Form("%d", static_cast<int>(values[varX])), isWeighted ? values[varW] : 1.);
+        break;
+      case kFillProfile:
+        if (isWeighted) {
+          (reinterpret_cast<TProfile*>(h))->Fill(values[varX], values[varY], values[varW]);
+        } else {
+          (reinterpret_cast<TProfile*>(h))->Fill(values[varX], values[varY]);
+        }
+        break;
+      case kFillProfileLabel:
+        if (isWeighted) {
+          (reinterpret_cast<TProfile*>(h))->Fill(Form("%d", static_cast<int>(values[varX])), values[varY], values[varW]);
+        } else {
+          (reinterpret_cast<TProfile*>(h))->Fill(Form("%d", static_cast<int>(values[varX])), values[varY]);
+        }
+        break;
+      case kFillTH2:
+        if (isWeighted) {
+          (reinterpret_cast<TH2*>(h))->Fill(values[varX], values[varY], values[varW]);
+        } else {
+          (reinterpret_cast<TH2*>(h))->Fill(values[varX], values[varY]);
+        }
+        break;
+      case kFillTH2Label:
+        (reinterpret_cast<TH2*>(h))->Fill(Form("%d", static_cast<int>(values[varX])), values[varY], isWeighted ? values[varW] : 1.);
+        break;
+      case kFillProfile2D:
+        if (isWeighted) {
+          (reinterpret_cast<TProfile2D*>(h))->Fill(values[varX], values[varY], values[varZ], values[varW]);
+        } else {
+          (reinterpret_cast<TProfile2D*>(h))->Fill(values[varX], values[varY], values[varZ]);
+        }
+        break;
+      case kFillTH3:
+        if (isWeighted) {
+          (reinterpret_cast<TH3*>(h))->Fill(values[varX], values[varY], values[varZ], values[varW]);
+        } else {
+          (reinterpret_cast<TH3*>(h))->Fill(values[varX], values[varY], values[varZ]);
+        }
+        break;
+      case kFillProfile3D:
+        if (isWeighted) {
+          (reinterpret_cast<TProfile3D*>(h))->Fill(values[varX], values[varY], values[varZ], values[varT], values[varW]);
         } else {
-          (reinterpret_cast<THn*>(h))->Fill(fillValues);
+          (reinterpret_cast<TProfile3D*>(h))->Fill(values[varX], values[varY], values[varZ], values[varT]);
         }
+        break;
+      case kFillTHn: {
+        const int* thnVars = fCompiledTHnVars.data() + record->thnOffset;
+        for (int i = 0; i < record->nDimensions; i++) {
+          fillValues[i] = values[thnVars[i]];
+        }
+        // THn and THnSparse share the filling interface of THnBase
+        if (isWeighted) {
+          (reinterpret_cast<THnBase*>(h))->Fill(fillValues, values[varW]);
+        } else {
+          (reinterpret_cast<THnBase*>(h))->Fill(fillValues);
+        }
+        break;
       }
-    } // end else
+      default:
+        break;
+    }
   } // end loop over histograms
 }
 
@@ -24,6 +24,7 @@
 #include <TAxis.h>
 #include <TArrayD.h>
 
+#include <functional>
 #include <string>
 #include <map>
 #include <vector>
@@ -47,6 +48,11 @@ class HistogramManager : public TNamed
       delete fMainList;
     }
     fMainList = list;
+    // previously resolved histogram class handles refer to the old list
+    fCompiledRecords.clear();
+    fCompiledTHnVars.clear();
+    fCompiledClasses.clear();
+    fCompiledHandles.clear();
   }
 
   // Create a new histogram class
@@ -84,7 +90,12 @@ class HistogramManager : public TNamed
                     int nDimensions, int* vars, TArrayD* binLimits,
                     TString* axLabels = nullptr, int varW = -1, bool useSparse = kFALSE, bool isdouble = false);
 
+  // Resolve a histogram class once into an integer handle holding a compiled fill plan
+  // Returns kNothing if the histogram class does not exist
+  int GetHistClassHandle(const char* className);
   void FillHistClass(const char* className, float* values);
+  // Fill a class of histograms from a handle obtained with GetHistClassHandle(), without any lookup by name
+  void FillHistClass(int handle, float* values);
 
   void SetUseDefaultVariableNames(bool flag) { fUseDefaultVariableNames = flag; }
   void SetDefaultVarNames(TString* vars, TString* units);
@@ -102,6 +113,41 @@ class HistogramManager : public TNamed
   bool* fUsedVars;                                                  //! flags of used variables
   std::map<std::string, std::list<std::vector<int>>> fVariablesMap; //!  map holding identifiers for all variables needed by histograms
 
+  // compiled fill plans: flat array of fill records, with one contiguous range of records per histogram class
+  enum FillKind {
+    kFillTH1 = 0,
+    kFillTH1Label,
+    kFillProfile,
+    kFillProfileLabel,
+    kFillTH2,
+    kFillTH2Label,
+    kFillProfile2D,
+    kFillTH3,
+    kFillProfile3D,
+    kFillTHn
+  };
+  struct FillRecord {
+    TObject* hist;   // histogram to be filled
+    int kind;        // fill kind, see FillKind
+    int varW;        // variable used for weighting
+    int vars[4];     // variables on each axis, and the profiled one for TProfile3D (not THn)
+    int thnOffset;   // first variable of the THn in fCompiledTHnVars
+    int nDimensions; // number of dimensions of the THn
+  };
+  struct CompiledHistClass {
+    TList* list;      // histogram list of the class
+    std::string name; // name of the class
+    int firstRecord;  // first fill record of the class
+    int nRecords;     // number of fill records of the class
+    int listSize;     // size of the histogram list when the class was compiled
+  };
+  std::vector<FillRecord> fCompiledRecords;                 //! fill records of all compiled classes
+  std::vector<int> fCompiledTHnVars;                        //! variables of the THn histograms
+  std::vector<CompiledHistClass> fCompiledClasses;          //! compiled classes, indexed by handle
+  std::map<std::string, int, std::less<>> fCompiledHandles; //! handles of the compiled classes
+
+  void CompileHistClass(int handle);
+
   // various
   bool fUseDefaultVariableNames;    //! toggle the usage of default variable names and units
   uint64_t fBinsAllocated;          //! number of allocated bins
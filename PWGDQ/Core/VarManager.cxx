@@ -26,13 +26,15 @@ ClassImp(VarManager);
 TString VarManager::fgVariableNames[VarManager::kNVars] = {""};
 TString VarManager::fgVariableUnits[VarManager::kNVars] = {""};
 std::map<TString, int> VarManager::fgVarNamesMap;
-bool VarManager::fgUsedVars[VarManager::kNVars] = {false};
+VarManager::Context VarManager::fgDefaultContext;
+thread_local VarManager::Context* VarManager::fgContext = &VarManager::fgDefaultContext;
+thread_local bool* VarManager::fgUsedVars = VarManager::fgDefaultContext.fUsedVars;
 bool VarManager::fgUsedKF = false;
 bool VarManager::fgPVrecalKF = true;
 float VarManager::fgMagField = 0.5;
 float VarManager::fgzMatching = -77.5;
 float VarManager::fgzShiftFwd = 0.0;
-float VarManager::fgValues[VarManager::kNVars] = {0.0f};
+thread_local float* VarManager::fgValues = VarManager::fgDefaultContext.fValues;
 float VarManager::fgTPCInterSectorBoundary = 1.0; // cm
 int VarManager::fgITSROFbias = 0;
 int VarManager::fgITSROFlength = 100;
@@ -48,10 +50,6 @@ o2::vertexing::DCAFitterN<4> VarManager::fgFitterFourProngBarrel;
 o2::vertexing::FwdDCAFitterN<2> VarManager::fgFitterTwoProngFwd;
 o2::vertexing::FwdDCAFitterN<3> VarManager::fgFitterThreeProngFwd;
 o2::globaltracking::MatchGlobalFwd VarManager::mMatching;
-std::map<VarManager::CalibObjects, TObject*> VarManager::fgCalibs;
-bool VarManager::fgRunTPCPostCalibration[4] = {false, false, false, false};
-int VarManager::fgCalibrationType = 0;                // 0 - no calibration, 1 - calibration vs (TPCncls,pIN,eta) typically for pp, 2 - calibration vs (eta,nPV,nLong,tLong) typically for PbPb
-bool VarManager::fgUseInterpolatedCalibration = true; // use interpolated calibration histograms (default: true)
 
 //__________________________________________________________________
 VarManager::VarManager() : TObject()
@@ -222,8 +220,9 @@ double VarManager::ComputePIDcalibration(int species, double nSigmaValue)
 {
   // species: 0 - electron, 1 - pion, 2 - kaon, 3 - proton
   // Depending on the PID calibration type, we use different types of calibration histograms
+  Context* context = fgContext;
 
-  if (fgCalibrationType == 1) {
+  if (context->fCalibrationType == 1) {
     // get the calibration histograms
     CalibObjects calibMean, calibSigma;
     switch (species) {
@@ -248,8 +247,8 @@ double VarManager::ComputePIDcalibration(int species, double nSigmaValue)
         return -999.0; // Return zero if species is invalid
     }
 
-    TH3F* calibMeanHist = reinterpret_cast<TH3F*>(fgCalibs[calibMean]);
-    TH3F* calibSigmaHist = reinterpret_cast<TH3F*>(fgCalibs[calibSigma]);
+    TH3F* calibMeanHist = reinterpret_cast<TH3F*>(context->fCalibs[calibMean]);
+    TH3F* calibSigmaHist = reinterpret_cast<TH3F*>(context->fCalibs[calibSigma]);
     if (!calibMeanHist || !calibSigmaHist) {
       LOG(fatal) << "Calibration histograms not found for species: " << species;
       return -999.0; // Return zero if histograms are not found
@@ -269,7 +268,7 @@ double VarManager::ComputePIDcalibration(int species, double nSigmaValue)
     double mean = calibMeanHist->GetBinContent(binTPCncls, binPin, binEta);
     double sigma = calibSigmaHist->GetBinContent(binTPCncls, binPin, binEta);
     return (nSigmaValue - mean) / sigma; // Return the calibrated nSigma value
-  } else if (fgCalibrationType == 2) {
+  } else if (context->fCalibrationType == 2) {
     // get the calibration histograms
     CalibObjects calibMean, calibSigma, calibStatus;
     switch (species) {
@@ -298,9 +297,9 @@ double VarManager::ComputePIDcalibration(int species, double nSigmaValue)
         return -999.0; // Return zero if species is invalid
     }
 
-    THnF* calibMeanHist = reinterpret_cast<THnF*>(fgCalibs[calibMean]);
-    THnF* calibSigmaHist = reinterpret_cast<THnF*>(fgCalibs[calibSigma]);
-    THnF* calibStatusHist = reinterpret_cast<THnF*>(fgCalibs[calibStatus]);
+    THnF* calibMeanHist = reinterpret_cast<THnF*>(context->fCalibs[calibMean]);
+    THnF* calibSigmaHist = reinterpret_cast<THnF*>(context->fCalibs[calibSigma]);
+    THnF* calibStatusHist = reinterpret_cast<THnF*>(context->fCalibs[calibStatus]);
     if (!calibMeanHist || !calibSigmaHist || !calibStatusHist) {
       LOG(fatal) << "Calibration histograms not found for species: " << species;
       return -999.0; // Return zero if histograms are not found
@@ -336,7 +335,7 @@ double VarManager::ComputePIDcalibration(int species, double nSigmaValue)
       case 2: // calibration constant has poor stat uncertainty, consider the user option for what to do
       case 3:
         // calibration constants have been interpolated
-        if (fgUseInterpolatedCalibration) {
+        if (context->fUseInterpolatedCalibration) {
           return (nSigmaValue - mean) / sigma;
         } else {
           // return the original nSigma value
@@ -353,7 +352,7 @@ double VarManager::ComputePIDcalibration(int species, double nSigmaValue)
     }
   } else {
     // unknown calibration type, return the original nSigma value
-    LOG(fatal) << "Unknown calibration type: " << fgCalibrationType;
+    LOG(fatal) << "Unknown calibration type: " << context->fCalibrationType;
     return nSigmaValue; // Return the original nSigma value
   }
 }
@@ -1107,6 +1107,45 @@ class VarManager : public TObject
     kToMatching
   };
 
+  // Context holding the buffer of computed variables, the flags of the variables to be computed and the calibration objects.
+  // The default context is used unless another one is activated with SetContext(), which allows to instantiate
+  // one context per task or thread and run the Fill functions concurrently.
+  // The DCA fitters and the KFParticle field are not part of the context and are shared by all threads: the vertexing fills
+  // (FillPairVertexing, FillTripletVertexing, FillDileptonTrackVertexing and the KF variables) are not context-safe.
+  struct Context {
+    float fValues[kNVars] = {0.0f};           // array holding all variables computed during analysis
+    bool fUsedVars[kNVars] = {false};         // flags for when the corresponding variable is needed
+    std::map<CalibObjects, TObject*> fCalibs; // map of calibration histograms
+    bool fRunTPCPostCalibration[4] = {false}; // 0-electron, 1-pion, 2-kaon, 3-proton
+    int fCalibrationType = 0;                 // 0 - no calibration, 1 - calibration vs (TPCncls,pIN,eta) typically for pp, 2 - calibration vs (eta,nPV,nLong,tLong) typically for PbPb
+    bool fUseInterpolatedCalibration = true;  // use interpolated calibration histograms (default: true)
+  };
+
+  // Activate a context in the calling thread: the Fill functions called afterwards from this thread without an explicit values array,
+  // and the used-variable and calibration setters, operate on it. A nullptr activates the default context. Returns the previously active context.
+  static Context* SetContext(Context* context)
+  {
+    Context* previous = fgContext;
+    fgContext = (context ? context : &fgDefaultContext);
+    fgValues = fgContext->fValues;
+    fgUsedVars = fgContext->fUsedVars;
+    return previous;
+  }
+  static Context* GetContext() { return fgContext; }
+
+  // Activates a context for the lifetime of the object, and restores the previously active one at destruction
+  class ContextScope
+  {
+   public:
+    explicit ContextScope(Context* context) : fPrevious(SetContext(context)) {}
+    ~ContextScope() { SetContext(fPrevious); }
+    ContextScope(const ContextScope&) = delete;
+    ContextScope& operator=(const ContextScope&) = delete;
+
+   private:
+    Context* fPrevious;
+  };
+
   static TString fgVariableNames[kNVars];      // variable names
   static TString fgVariableUnits[kNVars];      // variable units
   static std::map<TString, int> fgVarNamesMap; // key: variables short name, value: order in the Variables enum
@@ -1405,22 +1444,22 @@ class VarManager : public TObject
 
   static void SetCalibrationObject(CalibObjects calib, TObject* obj)
   {
-    fgCalibs[calib] = obj;
+    fgContext->fCalibs[calib] = obj;
     // Check whether all the needed objects for TPC postcalibration are available
-    if (fgCalibs.find(kTPCElectronMean) != fgCalibs.end() && fgCalibs.find(kTPCElectronSigma) != fgCalibs.end()) {
-      fgRunTPCPostCalibration[0] = true;
+    if (fgContext->fCalibs.find(kTPCElectronMean) != fgContext->fCalibs.end() && fgContext->fCalibs.find(kTPCElectronSigma) != fgContext->fCalibs.end()) {
+      fgContext->fRunTPCPostCalibration[0] = true;
       fgUsedVars[kTPCnSigmaEl_Corr] = true;
     }
-    if (fgCalibs.find(kTPCPionMean) != fgCalibs.end() && fgCalibs.find(kTPCPionSigma) != fgCalibs.end()) {
-      fgRunTPCPostCalibration[1] = true;
+    if (fgContext->fCalibs.find(kTPCPionMean) != fgContext->fCalibs.end() && fgContext->fCalibs.find(kTPCPionSigma) != fgContext->fCalibs.end()) {
+      fgContext->fRunTPCPostCalibration[1] = true;
       fgUsedVars[kTPCnSigmaPi_Corr] = true;
     }
-    if (fgCalibs.find(kTPCKaonMean) != fgCalibs.end() && fgCalibs.find(kTPCKaonSigma) != fgCalibs.end()) {
-      fgRunTPCPostCalibration[2] = true;
+    if (fgContext->fCalibs.find(kTPCKaonMean) != fgContext->fCalibs.end() && fgContext->fCalibs.find(kTPCKaonSigma) != fgContext->fCalibs.end()) {
+      fgContext->fRunTPCPostCalibration[2] = true;
       fgUsedVars[kTPCnSigmaKa_Corr] = true;
     }
-    if (fgCalibs.find(kTPCProtonMean) != fgCalibs.end() && fgCalibs.find(kTPCProtonSigma) != fgCalibs.end()) {
-      fgRunTPCPostCalibration[3] = true;
+    if (fgContext->fCalibs.find(kTPCProtonMean) != fgContext->fCalibs.end() && fgContext->fCalibs.find(kTPCProtonSigma) != fgContext->fCalibs.end()) {
+      fgContext->fRunTPCPostCalibration[3] = true;
       fgUsedVars[kTPCnSigmaPr_Corr] = true;
     }
   }
@@ -1430,15 +1469,15 @@ class VarManager : public TObject
     if (type < 0 || type > 2) {
       LOG(fatal) << "Invalid calibration type. Must be 0, 1, or 2.";
     }
-    fgCalibrationType = type;
-    fgUseInterpolatedCalibration = useInterpolation;
+    fgContext->fCalibrationType = type;
+    fgContext->fUseInterpolatedCalibration = useInterpolation;
   }
   static double ComputePIDcalibration(int species, double nSigmaValue);
 
   static TObject* GetCalibrationObject(CalibObjects calib)
   {
-    auto obj = fgCalibs.find(calib);
-    if (obj == fgCalibs.end()) {
+    auto obj = fgContext->fCalibs.find(calib);
+    if (obj == fgContext->fCalibs.end()) {
       return 0x0;
     } else {
       return obj->second;
@@ -1466,11 +1505,13 @@ class VarManager : public TObject
   VarManager();
   ~VarManager() override;
 
-  static float fgValues[kNVars]; // array holding all variables computed during analysis
+  static thread_local float* fgValues; // array holding all variables computed during analysis, from the context active in the current thread
   static void ResetValues(int startValue = 0, int endValue = kNVars, float* values = nullptr);
 
  private:
-  static bool fgUsedVars[kNVars]; // holds flags for when the corresponding variable is needed (e.g., in the histogram manager, in cuts, mixing handler, etc.)
+  static Context fgDefaultContext;        // context used unless another one is activated
+  static thread_local Context* fgContext; // context active in the current thread
+  static thread_local bool* fgUsedVars;   // holds flags for when the corresponding variable is needed (e.g., in the histogram manager, in cuts, mixing handler, etc.)
   static bool fgUsedKF;
   static bool fgPVrecalKF;
   static void SetVariableDependencies(); // toggle those variables on which other used variables might depend
@@ -1506,6 +1547,7 @@ class VarManager : public TObject
   template <typename T1, typename T2>
   static float LorentzTransformJpsihadroncosChi(TString Option, const T1& v1, const T2& v2);
 
+  // vertexing state shared by all contexts, the vertexing fills must not run concurrently
   static o2::vertexing::DCAFitterN<2> fgFitterTwoProngBarrel;
   static o2::vertexing::DCAFitterN<3> fgFitterThreeProngBarrel;
   static o2::vertexing::DCAFitterN<4> fgFitterFourProngBarrel;
@@ -1513,11 +1555,6 @@ class VarManager : public TObject
   static o2::vertexing::FwdDCAFitterN<3> fgFitterThreeProngFwd;
   static o2::globaltracking::MatchGlobalFwd mMatching;
 
-  static std::map<CalibObjects, TObject*> fgCalibs; // map of calibration histograms
-  static bool fgRunTPCPostCalibration[4];           // 0-electron, 1-pion, 2-kaon, 3-proton
-  static int fgCalibrationType;                     // 0 - no calibration, 1 - calibration vs (TPCncls,pIN,eta) typically for pp, 2 - calibration vs (eta,nPV,nLong,tLong) typically for PbPb
-  static bool fgUseInterpolatedCalibration;         // use interpolated calibration histograms (default: true)
-
   VarManager& operator=(const VarManager& c);
   VarManager(const VarManager& c);
 
@@ -1870,12 +1907,13 @@ void VarManager::FillEvent(T const& event, float* values)
   if (!values) {
     values = fgValues;
   }
+  const bool* usedVars = fgUsedVars; // local copy, avoids a thread_local lookup per access
 
   if constexpr ((fillMap & CollisionTimestamp) > 0) {
     values[kTimestamp] = event.timestamp();
   }
 
-  if (fgUsedVars[kCollisionRandom]) {
+  if (usedVars[kCollisionRandom]) {
     values[kCollisionRandom] = gRandom->Rndm();
   }
 
@@ -1883,82 +1921,82 @@ void VarManager::FillEvent(T const& event, float* values)
     // TODO: trigger info from the event selection requires a separate flag
     //       so that it can be switched off independently of the rest of Collision variables (e.g. if event selection is not available)
 
-    if (fgUsedVars[kIsNoITSROFBorder]) {
+    if (usedVars[kIsNoITSROFBorder]) {
       values[kIsNoITSROFBorder] = event.selection_bit(o2::aod::evsel::kNoITSROFrameBorder);
     }
-    if (fgUsedVars[kTrackOccupancyInTimeRange]) {
+    if (usedVars[kTrackOccupancyInTimeRange]) {
       values[kTrackOccupancyInTimeRange] = event.trackOccupancyInTimeRange();
     }
-    if (fgUsedVars[kFT0COccupancyInTimeRange]) {
+    if (usedVars[kFT0COccupancyInTimeRange]) {
       values[kFT0COccupancyInTimeRange] = event.ft0cOccupancyInTimeRange();
     }
-    if (fgUsedVars[kNoCollInTimeRangeStandard]) {
+    if (usedVars[kNoCollInTimeRangeStandard]) {
       values[kNoCollInTimeRangeStandard] = event.selection_bit(o2::aod::evsel::kNoCollInTimeRangeStandard);
     }
-    if (fgUsedVars[kIsTVXTriggered]) {
+    if (usedVars[kIsTVXTriggered]) {
       values[kIsTVXTriggered] = event.selection_bit(o2::aod::evsel::kIsTriggerTVX);
     }
-    if (fgUsedVars[kIsNoTFBorder]) {
+    if (usedVars[kIsNoTFBorder]) {
       values[kIsNoTFBorder] = event.selection_bit(o2::aod::evsel::kNoTimeFrameBorder);
     }
-    if (fgUsedVars[kIsTriggerZNAZNC]) {
+    if (usedVars[kIsTriggerZNAZNC]) {
       values[kIsTriggerZNAZNC] = event.selection_bit(o2::aod::evsel::kIsBBZNA) && event.selection_bit(o2::aod::evsel::kIsBBZNC);
     }
-    if (fgUsedVars[kIsNoSameBunch]) {
+    if (usedVars[kIsNoSameBunch]) {
       values[kIsNoSameBunch] = event.selection_bit(o2::aod::evsel::kNoSameBunchPileup);
     }
-    if (fgUsedVars[kIsGoodZvtxFT0vsPV]) {
+    if (usedVars[kIsGoodZvtxFT0vsPV]) {
       values[kIsGoodZvtxFT0vsPV] = event.selection_bit(o2::aod::evsel::kIsGoodZvtxFT0vsPV);
     }
-    if (fgUsedVars[kIsVertexITSTPC]) {
+    if (usedVars[kIsVertexITSTPC]) {
       values[kIsVertexITSTPC] = event.selection_bit(o2::aod::evsel::kIsVertexITSTPC);
     }
-    if (fgUsedVars[kIsVertexTOFmatched]) {
+    if (usedVars[kIsVertexTOFmatched]) {
       values[kIsVertexTOFmatched] = event.selection_bit(o2::aod::evsel::kIsVertexTOFmatched);
     }
-    if (fgUsedVars[kIsSel8]) {
+    if (usedVars[kIsSel8]) {
       values[kIsSel8] = event.selection_bit(o2::aod::evsel::kIsTriggerTVX) && event.selection_bit(o2::aod::evsel::kNoITSROFrameBorder) && event.selection_bit(o2::aod::evsel::kNoTimeFrameBorder);
     }
-    if (fgUsedVars[kIsGoodITSLayer3]) {
+    if (usedVars[kIsGoodITSLayer3]) {
       values[kIsGoodITSLayer3] = event.selection_bit(o2::aod::evsel::kIsGoodITSLayer3);
     }
-    if (fgUsedVars[kIsGoodITSLayer0123]) {
+    if (usedVars[kIsGoodITSLayer0123]) {
       values[kIsGoodITSLayer0123] = event.selection_bit(o2::aod::evsel::kIsGoodITSLayer0123);
     }
-    if (fgUsedVars[kIsGoodITSLayersAll]) {
+    if (usedVars[kIsGoodITSLayersAll]) {
       values[kIsGoodITSLayersAll] = event.selection_bit(o2::aod::evsel::kIsGoodITSLayersAll);
     }
-    if (fgUsedVars[kIsINT7]) {
+    if (usedVars[kIsINT7]) {
       values[kIsINT7] = (event.alias_bit(kINT7) > 0);
     }
-    if (fgUsedVars[kIsEMC7]) {
+    if (usedVars[kIsEMC7]) {
       values[kIsEMC7] = (event.alias_bit(kEMC7) > 0);
     }
-    if (fgUsedVars[kIsINT7inMUON]) {
+    if (usedVars[kIsINT7inMUON]) {
       values[kIsINT7inMUON] = (event.alias_bit(kINT7inMUON) > 0);
     }
-    if (fgUsedVars[kIsMuonSingleLowPt7]) {
+    if (usedVars[kIsMuonSingleLowPt7]) {
       values[kIsMuonSingleLowPt7] = (event.alias_bit(kMuonSingleLowPt7) > 0);
     }
-    if (fgUsedVars[kIsMuonSingleHighPt7]) {
+    if (usedVars[kIsMuonSingleHighPt7]) {
       values[kIsMuonSingleHighPt7] = (event.alias_bit(kMuonSingleHighPt7) > 0);
     }
-    if (fgUsedVars[kIsMuonUnlikeLowPt7]) {
+    if (usedVars[kIsMuonUnlikeLowPt7]) {
       values[kIsMuonUnlikeLowPt7] = (event.alias_bit(kMuonUnlikeLowPt7) > 0);
     }
-    if (fgUsedVars[kIsMuonLikeLowPt7]) {
+    if (usedVars[kIsMuonLikeLowPt7]) {
       values[kIsMuonLikeLowPt7] = (event.alias_bit(kMuonLikeLowPt7) > 0);
     }
-    if (fgUsedVars[kIsCUP8]) {
+    if (usedVars[kIsCUP8]) {
       values[kIsCUP8] = (event.alias_bit(kCUP8) > 0);
     }
-    if (fgUsedVars[kIsCUP9]) {
+    if (usedVars[kIsCUP9]) {
       values[kIsCUP9] = (event.alias_bit(kCUP9) > 0);
     }
-    if (fgUsedVars[kIsMUP10]) {
+    if (usedVars[kIsMUP10]) {
       values[kIsMUP10] = (event.alias_bit(kMUP10) > 0);
     }
-    if (fgUsedVars[kIsMUP11]) {
+    if (usedVars[kIsMUP11]) {
       values[kIsMUP11] = (event.alias_bit(kMUP11) > 0);
     }
     values[kVtxX] = event.posX();
@@ -2039,14 +2077,14 @@ void VarManager::FillEvent(T const& event, float* values)
     values[kVtxY] = event.posY();
     values[kVtxZ] = event.posZ();
     values[kVtxNcontrib] = event.numContrib();
-    if (fgUsedVars[kIsDoubleGap] || fgUsedVars[kIsSingleGap] || fgUsedVars[kIsSingleGapA] || fgUsedVars[kIsSingleGapC] || fgUsedVars[kIsNoGap]) {
+    if (usedVars[kIsDoubleGap] || usedVars[kIsSingleGap] || usedVars[kIsSingleGapA] || usedVars[kIsSingleGapC] || usedVars[kIsNoGap]) {
       values[kIsDoubleGap] = (event.tag_bit(56 + kDoubleGap) > 0);
       values[kIsSingleGapA] = (event.tag_bit(56 + kSingleGapA) > 0);
       values[kIsSingleGapC] = (event.tag_bit(56 + kSingleGapC) > 0);
       values[kIsSingleGap] = values[kIsSingleGapA] || values[kIsSingleGapC];
       values[kIsNoGap] = !values[kIsDoubleGap] && !values[kIsSingleGap];
     }
-    if (fgUsedVars[kIsITSUPCMode]) {
+    if (usedVars[kIsITSUPCMode]) {
       values[kIsITSUPCMode] = (event.tag_bit(56 + kITSUPCMode) > 0);
     }
     values[kCollisionTime] = event.collisionTime();
@@ -2060,77 +2098,77 @@ void VarManager::FillEvent(T const& event, float* values)
     values[kTimeFromSOR] = (fgSOR > 0 ? (event.timestamp() - fgSOR) / 60000. : -1.0);
     values[kCentVZERO] = event.centRun2V0M();
     values[kCentFT0C] = event.centFT0C();
-    if (fgUsedVars[kIsNoITSROFBorderRecomputed]) {
+    if (usedVars[kIsNoITSROFBorderRecomputed]) {
       uint16_t bcInITSROF = (event.globalBC() + 3564 - fgITSROFbias) % fgITSROFlength;
       values[kIsNoITSROFBorderRecomputed] = bcInITSROF > fgITSROFBorderMarginLow && bcInITSROF < fgITSROFlength - fgITSROFBorderMarginHigh ? 1.0 : 0.0;
     }
-    if (fgUsedVars[kIsNoITSROFBorder]) {
+    if (usedVars[kIsNoITSROFBorder]) {
       values[kIsNoITSROFBorder] = (event.selection_bit(o2::aod::evsel::kNoITSROFrameBorder) > 0);
     }
-    if (fgUsedVars[kIsTVXTriggered]) {
+    if (usedVars[kIsTVXTriggered]) {
       values[kIsTVXTriggered] = (event.selection_bit(o2::aod::evsel::kIsTriggerTVX) > 0);
     }
-    if (fgUsedVars[kIsNoTFBorder]) {
+    if (usedVars[kIsNoTFBorder]) {
       values[kIsNoTFBorder] = (event.selection_bit(o2::aod::evsel::kNoTimeFrameBorder) > 0);
     }
-    if (fgUsedVars[kNoCollInTimeRangeStandard]) {
+    if (usedVars[kNoCollInTimeRangeStandard]) {
       values[kNoCollInTimeRangeStandard] = (event.selection_bit(o2::aod::evsel::kNoCollInTimeRangeStandard) > 0);
     }
-    if (fgUsedVars[kIsNoSameBunch]) {
+    if (usedVars[kIsNoSameBunch]) {
       values[kIsNoSameBunch] = (event.selection_bit(o2::aod::evsel::kNoSameBunchPileup) > 0);
     }
-    if (fgUsedVars[kIsGoodZvtxFT0vsPV]) {
+    if (usedVars[kIsGoodZvtxFT0vsPV]) {
       values[kIsGoodZvtxFT0vsPV] = (event.selection_bit(o2::aod::evsel::kIsGoodZvtxFT0vsPV) > 0);
     }
-    if (fgUsedVars[kIsVertexITSTPC]) {
+    if (usedVars[kIsVertexITSTPC]) {
       values[kIsVertexITSTPC] = (event.selection_bit(o2::aod::evsel::kIsVertexITSTPC) > 0);
     }
-    if (fgUsedVars[kIsVertexTOFmatched]) {
+    if (usedVars[kIsVertexTOFmatched]) {
       values[kIsVertexTOFmatched] = (event.selection_bit(o2::aod::evsel::kIsVertexTOFmatched) > 0);
     }
-    if (fgUsedVars[kIsSel8]) {
+    if (usedVars[kIsSel8]) {
       values[kIsSel8] = event.selection_bit(o2::aod::evsel::kIsTriggerTVX) && event.selection_bit(o2::aod::evsel::kNoTimeFrameBorder) && event.selection_bit(o2::aod::evsel::kNoITSROFrameBorder);
     }
-    if (fgUsedVars[kIsGoodITSLayer3]) {
+    if (usedVars[kIsGoodITSLayer3]) {
       values[kIsGoodITSLayer3] = event.selection_bit(o2::aod::evsel::kIsGoodITSLayer3);
     }
-    if (fgUsedVars[kIsGoodITSLayer0123]) {
+    if (usedVars[kIsGoodITSLayer0123]) {
       values[kIsGoodITSLayer0123] = event.selection_bit(o2::aod::evsel::kIsGoodITSLayer0123);
     }
-    if (fgUsedVars[kIsGoodITSLayersAll]) {
+    if (usedVars[kIsGoodITSLayersAll]) {
       values[kIsGoodITSLayersAll] = event.selection_bit(o2::aod::evsel::kIsGoodITSLayersAll);
     }
-    if (fgUsedVars[kIsINT7]) {
+    if (usedVars[kIsINT7]) {
       values[kIsINT7] = (event.alias_bit(kINT7) > 0);
     }
-    if (fgUsedVars[kIsEMC7]) {
+    if (usedVars[kIsEMC7]) {
       values[kIsEMC7] = (event.alias_bit(kEMC7) > 0);
     }
-    if (fgUsedVars[kIsINT7inMUON]) {
+    if (usedVars[kIsINT7inMUON]) {
       values[kIsINT7inMUON] = (event.alias_bit(kINT7inMUON) > 0);
     }
-    if (fgUsedVars[kIsMuonSingleLowPt7]) {
+    if (usedVars[kIsMuonSingleLowPt7]) {
       values[kIsMuonSingleLowPt7] = (event.alias_bit(kMuonSingleLowPt7) > 0);
     }
-    if (fgUsedVars[kIsMuonSingleHighPt7]) {
+    if (usedVars[kIsMuonSingleHighPt7]) {
       values[kIsMuonSingleHighPt7] = (event.alias_bit(kMuonSingleHighPt7) > 0);
     }
-    if (fgUsedVars[kIsMuonUnlikeLowPt7]) {
+    if (usedVars[kIsMuonUnlikeLowPt7]) {
       values[kIsMuonUnlikeLowPt7] = (event.alias_bit(kMuonUnlikeLowPt7) > 0);
     }
-    if (fgUsedVars[kIsMuonLikeLowPt7]) {
+    if (usedVars[kIsMuonLikeLowPt7]) {
       values[kIsMuonLikeLowPt7] = (event.alias_bit(kMuonLikeLowPt7) > 0);
     }
-    if (fgUsedVars[kIsCUP8]) {
+    if (usedVars[kIsCUP8]) {
       values[kIsCUP8] = (event.alias_bit(kCUP8) > 0);
     }
-    if (fgUsedVars[kIsCUP9]) {
+    if (usedVars[kIsCUP9]) {
       values[kIsCUP9] = (event.alias_bit(kCUP9) > 0);
     }
-    if (fgUsedVars[kIsMUP10]) {
+    if (usedVars[kIsMUP10]) {
       values[kIsMUP10] = (event.alias_bit(kMUP10) > 0);
     }
-    if (fgUsedVars[kIsMUP11]) {
+    if (usedVars[kIsMUP11]) {
       values[kIsMUP11] = (event.alias_bit(kMUP11) > 0);
     }
   }
@@ -2688,6 +2726,8 @@ void VarManager::FillTrack(T const& track, float* values)
   if (!values) {
     values = fgValues;
   }
+  const bool* usedVars = fgUsedVars; // local copies, avoid a thread_local lookup per access
+  const Context* context = fgContext;
 
   if constexpr ((fillMap & TrackMFT) > 0) {
     values[kPt] = track.pt();
@@ -2712,25 +2752,25 @@ void VarManager::FillTrack(T const& track, float* values)
   if constexpr ((fillMap & Track) > 0 || (fillMap & Muon) > 0 || (fillMap & MuonRealign) > 0 || (fillMap & ReducedTrack) > 0 || (fillMap & ReducedMuon) > 0) {
     values[kPt] = track.pt();
     values[kSignedPt] = track.pt() * track.sign();
-    if (fgUsedVars[kP]) {
+    if (usedVars[kP]) {
       values[kP] = track.p();
     }
-    if (fgUsedVars[kPx]) {
+    if (usedVars[kPx]) {
       values[kPx] = track.px();
     }
-    if (fgUsedVars[kPy]) {
+    if (usedVars[kPy]) {
       values[kPy] = track.py();
     }
-    if (fgUsedVars[kPz]) {
+    if (usedVars[kPz]) {
       values[kPz] = track.pz();
     }
-    if (fgUsedVars[kInvPt]) {
+    if (usedVars[kInvPt]) {
       values[kInvPt] = 1. / track.pt();
     }
     values[kEta] = track.eta();
     values[kPhi] = track.phi();
     values[kCharge] = track.sign();
-    if (fgUsedVars[kPhiTPCOuter]) {
+    if (usedVars[kPhiTPCOuter]) {
       values[kPhiTPCOuter] = track.phi() - (track.sign() > 0 ? 1.0 : -1.0) * (TMath::PiOver2() - TMath::ACos(0.22 * fgMagField / track.pt()));
       if (values[kPhiTPCOuter] > TMath::TwoPi()) {
         values[kPhiTPCOuter] -= TMath::TwoPi();
@@ -2739,7 +2779,7 @@ void VarManager::FillTrack(T const& track, float* values)
         values[kPhiTPCOuter] += TMath::TwoPi();
       }
     }
-    if (fgUsedVars[kTrackIsInsideTPCModule]) {
+    if (usedVars[kTrackIsInsideTPCModule]) {
       float localSectorPhi = values[kPhiTPCOuter] - TMath::Floor(18.0 * values[kPhiTPCOuter] / TMath::TwoPi()) * (TMath::TwoPi() / 18.0);
       float edge = fgTPCInterSectorBoundary / 2.0 / 246.6; // minimal inter-sector boundary as angle
       float curvature = 3.0 * 3.33 * track.pt() / fgMagField * (1.0 - TMath::Sin(TMath::ACos(0.22 * fgMagField / track.pt())));
@@ -2769,7 +2809,7 @@ void VarManager::FillTrack(T const& track, float* values)
       }
     }
 
-    if (fgUsedVars[kM11REFoverMpsingle]) {
+    if (usedVars[kM11REFoverMpsingle]) {
       float m = o2::constants::physics::MassMuon;
       ROOT::Math::PtEtaPhiMVector v(track.pt(), track.eta(), track.phi(), m);
       complex<double> Q21(values[kQ2X0A] * values[kS11A], values[kQ2Y0A] * values[kS11A]);
@@ -2798,44 +2838,44 @@ void VarManager::FillTrack(T const& track, float* values)
   if constexpr ((fillMap & TrackExtra) > 0 || (fillMap & ReducedTrackBarrel) > 0) {
     values[kPin] = track.tpcInnerParam();
     values[kSignedPin] = track.tpcInnerParam() * track.sign();
-    if (fgUsedVars[kIsITSrefit]) {
+    if (usedVars[kIsITSrefit]) {
       values[kIsITSrefit] = (track.flags() & o2::aod::track::ITSrefit) > 0; // NOTE: This is just for Run-2
     }
-    if (fgUsedVars[kTrackTimeResIsRange]) {
+    if (usedVars[kTrackTimeResIsRange]) {
       values[kTrackTimeResIsRange] = (track.flags() & o2::aod::track::TrackTimeResIsRange) > 0; // NOTE: This is NOT for Run-2
     }
-    if (fgUsedVars[kIsTPCrefit]) {
+    if (usedVars[kIsTPCrefit]) {
       values[kIsTPCrefit] = (track.flags() & o2::aod::track::TPCrefit) > 0; // NOTE: This is just for Run-2
     }
-    if (fgUsedVars[kPVContributor]) {
+    if (usedVars[kPVContributor]) {
       values[kPVContributor] = (track.flags() & o2::aod::track::PVContributor) > 0; // NOTE: This is NOT for Run-2
     }
-    if (fgUsedVars[kIsGoldenChi2]) {
+    if (usedVars[kIsGoldenChi2]) {
       values[kIsGoldenChi2] = (track.flags() & o2::aod::track::GoldenChi2) > 0; // NOTE: This is just for Run-2
     }
-    if (fgUsedVars[kOrphanTrack]) {
+    if (usedVars[kOrphanTrack]) {
       values[kOrphanTrack] = (track.flags() & o2::aod::track::OrphanTrack) > 0; // NOTE: This is NOT for Run-2
     }
-    if (fgUsedVars[kIsSPDfirst]) {
+    if (usedVars[kIsSPDfirst]) {
       values[kIsSPDfirst] = (track.itsClusterMap() & uint8_t(1)) > 0;
     }
-    if (fgUsedVars[kIsSPDboth]) {
+    if (usedVars[kIsSPDboth]) {
       values[kIsSPDboth] = (track.itsClusterMap() & uint8_t(3)) > 0;
     }
-    if (fgUsedVars[kIsSPDany]) {
+    if (usedVars[kIsSPDany]) {
       values[kIsSPDany] = (track.itsClusterMap() & uint8_t(1)) || (track.itsClusterMap() & uint8_t(2));
     }
-    if (fgUsedVars[kITSClusterMap]) {
+    if (usedVars[kITSClusterMap]) {
       values[kITSClusterMap] = track.itsClusterMap();
     }
 
-    if (fgUsedVars[kIsITSibFirst]) {
+    if (usedVars[kIsITSibFirst]) {
       values[kIsITSibFirst] = (track.itsClusterMap() & uint8_t(1)) > 0;
     }
-    if (fgUsedVars[kIsITSibAny]) {
+    if (usedVars[kIsITSibAny]) {
       values[kIsITSibAny] = (track.itsClusterMap() & (1 << uint8_t(0))) > 0 || (track.itsClusterMap() & (1 << uint8_t(1))) > 0 || (track.itsClusterMap() & (1 << uint8_t(2))) > 0;
     }
-    if (fgUsedVars[kIsITSibAll]) {
+    if (usedVars[kIsITSibAll]) {
       values[kIsITSibAll] = (track.itsClusterMap() & (1 << uint8_t(0))) > 0 && (track.itsClusterMap() & (1 << uint8_t(1))) > 0 && (track.itsClusterMap() & (1 << uint8_t(2))) > 0;
     }
 
@@ -2860,13 +2900,13 @@ void VarManager::FillTrack(T const& track, float* values)
     values[kHasTPC] = track.hasTPC();
 
     if constexpr ((fillMap & TrackExtra) > 0) {
-      if (fgUsedVars[kTPCnCRoverFindCls]) {
+      if (usedVars[kTPCnCRoverFindCls]) {
         values[kTPCnCRoverFindCls] = track.tpcCrossedRowsOverFindableCls();
       }
-      if (fgUsedVars[kITSncls]) {
+      if (usedVars[kITSncls]) {
         values[kITSncls] = track.itsNCls(); // dynamic column
       }
-      if (fgUsedVars[kITSmeanClsSize]) {
+      if (usedVars[kITSmeanClsSize]) {
         values[kITSmeanClsSize] = 0.0;
         uint32_t clsizeflag = track.itsClusterSizes();
         float mcls = 0.;
@@ -2879,7 +2919,7 @@ void VarManager::FillTrack(T const& track, float* values)
       }
     }
     if constexpr ((fillMap & ReducedTrackBarrel) > 0) {
-      if (fgUsedVars[kITSncls]) {
+      if (usedVars[kITSncls]) {
         values[kITSncls] = 0.0;
         for (int i = 0; i < 7; ++i) {
           values[kITSncls] += ((track.itsClusterMap() & (1 << i)) ? 1 : 0);
@@ -2888,16 +2928,16 @@ void VarManager::FillTrack(T const& track, float* values)
       values[kTrackDCAxy] = track.dcaXY();
       values[kTrackDCAz] = track.dcaZ();
       if constexpr ((fillMap & ReducedTrackBarrelCov) > 0) {
-        if (fgUsedVars[kTrackDCAsigXY]) {
+        if (usedVars[kTrackDCAsigXY]) {
           values[kTrackDCAsigXY] = track.dcaXY() / std::sqrt(track.cYY());
         }
-        if (fgUsedVars[kTrackDCAsigZ]) {
+        if (usedVars[kTrackDCAsigZ]) {
           values[kTrackDCAsigZ] = track.dcaZ() / std::sqrt(track.cZZ());
         }
-        if (fgUsedVars[kTrackDCAresXY]) {
+        if (usedVars[kTrackDCAresXY]) {
           values[kTrackDCAresXY] = std::sqrt(track.cYY());
         }
-        if (fgUsedVars[kTrackDCAresZ]) {
+        if (usedVars[kTrackDCAresZ]) {
           values[kTrackDCAresZ] = std::sqrt(track.cZZ());
         }
       }
@@ -2909,16 +2949,16 @@ void VarManager::FillTrack(T const& track, float* values)
     values[kTrackDCAxy] = track.dcaXY();
     values[kTrackDCAz] = track.dcaZ();
     if constexpr ((fillMap & TrackCov) > 0) {
-      if (fgUsedVars[kTrackDCAsigXY]) {
+      if (usedVars[kTrackDCAsigXY]) {
         values[kTrackDCAsigXY] = track.dcaXY() / std::sqrt(track.cYY());
       }
-      if (fgUsedVars[kTrackDCAsigZ]) {
+      if (usedVars[kTrackDCAsigZ]) {
         values[kTrackDCAsigZ] = track.dcaZ() / std::sqrt(track.cZZ());
       }
-      if (fgUsedVars[kTrackDCAresXY]) {
+      if (usedVars[kTrackDCAresXY]) {
         values[kTrackDCAresXY] = std::sqrt(track.cYY());
       }
-      if (fgUsedVars[kTrackDCAresZ]) {
+      if (usedVars[kTrackDCAresZ]) {
         values[kTrackDCAresZ] = std::sqrt(track.cZZ());
       }
     }
@@ -2970,7 +3010,7 @@ void VarManager::FillTrack(T const& track, float* values)
       }
     }
     // compute TPC postcalibrated electron nsigma based on calibration histograms from CCDB
-    if (fgUsedVars[kTPCnSigmaEl_Corr] && fgRunTPCPostCalibration[0]) {
+    if (usedVars[kTPCnSigmaEl_Corr] && context->fRunTPCPostCalibration[0]) {
       if (!isTPCCalibrated) {
         values[kTPCnSigmaEl_Corr] = ComputePIDcalibration(0, values[kTPCnSigmaEl]);
       } else {
@@ -2980,7 +3020,7 @@ void VarManager::FillTrack(T const& track, float* values)
     }
 
     // compute TPC postcalibrated pion nsigma if required
-    if (fgUsedVars[kTPCnSigmaPi_Corr] && fgRunTPCPostCalibration[1]) {
+    if (usedVars[kTPCnSigmaPi_Corr] && context->fRunTPCPostCalibration[1]) {
       if (!isTPCCalibrated) {
         values[kTPCnSigmaPi_Corr] = ComputePIDcalibration(1, values[kTPCnSigmaPi]);
       } else {
@@ -2988,7 +3028,7 @@ void VarManager::FillTrack(T const& track, float* values)
         values[kTPCnSigmaPi_Corr] = track.tpcNSigmaPi();
       }
     }
-    if (fgUsedVars[kTPCnSigmaKa_Corr] && fgRunTPCPostCalibration[2]) {
+    if (usedVars[kTPCnSigmaKa_Corr] && context->fRunTPCPostCalibration[2]) {
       // compute TPC postcalibrated kaon nsigma if required
       if (!isTPCCalibrated) {
         values[kTPCnSigmaKa_Corr] = ComputePIDcalibration(2, values[kTPCnSigmaKa]);
@@ -2998,7 +3038,7 @@ void VarManager::FillTrack(T const& track, float* values)
       }
     }
     // compute TPC postcalibrated proton nsigma if required
-    if (fgUsedVars[kTPCnSigmaPr_Corr] && fgRunTPCPostCalibration[3]) {
+    if (usedVars[kTPCnSigmaPr_Corr] && context->fRunTPCPostCalibration[3]) {
       if (!isTPCCalibrated) {
         values[kTPCnSigmaPr_Corr] = ComputePIDcalibration(3, values[kTPCnSigmaPr]);
       } else {
@@ -3120,6 +3160,7 @@ void VarManager::FillTrackCollision(T const& track, C const& collision, float* v
   if (!values) {
     values = fgValues;
   }
+  const bool* usedVars = fgUsedVars;
   if constexpr ((fillMap & ReducedTrackBarrel) > 0 || (fillMap & TrackDCA) > 0) {
     auto trackPar = getTrackPar(track);
     std::array<float, 2> dca{1e10f, 1e10f};
@@ -3129,10 +3170,10 @@ void VarManager::FillTrackCollision(T const& track, C const& collision, float* v
     values[kTrackDCAz] = dca[1];
 
     if constexpr ((fillMap & ReducedTrackBarrelCov) > 0 || (fillMap & TrackCov) > 0) {
-      if (fgUsedVars[kTrackDCAsigXY]) {
+      if (usedVars[kTrackDCAsigXY]) {
         values[kTrackDCAsigXY] = dca[0] / std::sqrt(track.cYY());
       }
-      if (fgUsedVars[kTrackDCAsigZ]) {
+      if (usedVars[kTrackDCAsigZ]) {
         values[kTrackDCAsigZ] = dca[1] / std::sqrt(track.cZZ());
       }
     }
@@ -3154,6 +3195,7 @@ void VarManager::FillTrackCollisionMatCorr(T const& track, C const& collision, M
   if (!values) {
     values = fgValues;
   }
+  const bool* usedVars = fgUsedVars;
   if constexpr ((fillMap & ReducedTrackBarrel) > 0 || (fillMap & TrackDCA) > 0) {
     auto trackPar = getTrackPar(track);
     std::array<float, 2> dca{1e10f, 1e10f};
@@ -3166,10 +3208,10 @@ void VarManager::FillTrackCollisionMatCorr(T const& track, C const& collision, M
     values[kTrackDCAz] = dca[1];
 
     if constexpr ((fillMap & ReducedTrackBarrelCov) > 0 || (fillMap & TrackCov) > 0) {
-      if (fgUsedVars[kTrackDCAsigXY]) {
+      if (usedVars[kTrackDCAsigXY]) {
         values[kTrackDCAsigXY] = dca[0] / std::sqrt(track.cYY());
       }
-      if (fgUsedVars[kTrackDCAsigZ]) {
+      if (usedVars[kTrackDCAsigZ]) {
         values[kTrackDCAsigZ] = dca[1] / std::sqrt(track.cZZ());
       }
     }
@@ -3182,23 +3224,24 @@ void VarManager::FillPhoton(T const& track, float* values)
   if (!values) {
     values = fgValues;
   }
+  const bool* usedVars = fgUsedVars;
 
   // Quantities based on the basic table (contains just kine information and filter bits)
   if constexpr ((fillMap & Track) > 0 || (fillMap & ReducedTrack) > 0) {
     values[kPt] = track.pt();
-    if (fgUsedVars[kP]) {
+    if (usedVars[kP]) {
       values[kP] = track.p();
     }
-    if (fgUsedVars[kPx]) {
+    if (usedVars[kPx]) {
       values[kPx] = track.px();
     }
-    if (fgUsedVars[kPy]) {
+    if (usedVars[kPy]) {
       values[kPy] = track.py();
     }
-    if (fgUsedVars[kPz]) {
+    if (usedVars[kPz]) {
       values[kPz] = track.pz();
     }
-    if (fgUsedVars[kInvPt]) {
+    if (usedVars[kInvPt]) {
       values[kInvPt] = 1. / track.pt();
     }
     values[kEta] = track.eta();
@@ -3214,6 +3257,7 @@ void VarManager::FillTrackMC(const U& mcStack, T const& track, float* values)
   if (!values) {
     values = fgValues;
   }
+  const bool* usedVars = fgUsedVars;
 
   // Quantities based on the mc particle table
   values[kMCPdgCode] = track.pdgCode();
@@ -3230,7 +3274,7 @@ void VarManager::FillTrackMC(const U& mcStack, T const& track, float* values)
   values[kMCEta] = track.eta();
   values[kMCY] = -track.y();
   values[kMCParticleGeneratorId] = track.producedByGenerator();
-  if (fgUsedVars[kMCMotherPdgCode]) {
+  if (usedVars[kMCMotherPdgCode]) {
     if (track.has_mothers()) {
       auto motherId = track.mothersIds()[0];
       auto mother = mcStack.rawIteratorAt(motherId);
@@ -3391,6 +3435,7 @@ void VarManager::FillPair(T1 const& t1, T2 const& t2, float* values)
   if (!values) {
     values = fgValues;
   }
+  const bool* usedVars = fgUsedVars;
 
   float m1 = o2::constants::physics::MassElectron;
   float m2 = o2::constants::physics::MassElectron;
@@ -3439,7 +3484,7 @@ void VarManager::FillPair(T1 const& t1, T2 const& t2, float* values)
   values[kEta2] = t2.eta();
   values[kPhi2] = t2.phi();
 
-  if (fgUsedVars[kDeltaPhiPair2]) {
+  if (usedVars[kDeltaPhiPair2]) {
     double phipair2 = v1.Phi() - v2.Phi();
     if (phipair2 > 3 * TMath::Pi() / 2) {
       values[kDeltaPhiPair2] = phipair2 - 2 * TMath::Pi();
@@ -3450,17 +3495,17 @@ void VarManager::FillPair(T1 const& t1, T2 const& t2, float* values)
     }
   }
 
-  if (fgUsedVars[kDeltaEtaPair2]) {
+  if (usedVars[kDeltaEtaPair2]) {
     values[kDeltaEtaPair2] = v1.Eta() - v2.Eta();
   }
 
-  if (fgUsedVars[kPsiPair]) {
+  if (usedVars[kPsiPair]) {
     values[kDeltaPhiPair] = (t1.sign() * fgMagField > 0.) ? (v1.Phi() - v2.Phi()) : (v2.Phi() - v1.Phi());
     double xipair = TMath::ACos((v1.Px() * v2.Px() + v1.Py() * v2.Py() + v1.Pz() * v2.Pz()) / v1.P() / v2.P());
     values[kPsiPair] = (t1.sign() * fgMagField > 0.) ? TMath::ASin((v1.Theta() - v2.Theta()) / xipair) : TMath::ASin((v2.Theta() - v1.Theta()) / xipair);
   }
 
-  if (fgUsedVars[kOpeningAngle]) {
+  if (usedVars[kOpeningAngle]) {
     double scalar = v1.Px() * v2.Px() + v1.Py() * v2.Py() + v1.Pz() * v2.Pz();
     double Ptot12 = Ptot1 * Ptot2;
     if (Ptot12 <= 0) {
@@ -3476,10 +3521,10 @@ void VarManager::FillPair(T1 const& t1, T2 const& t2, float* values)
   }
 
   // polarization parameters
-  bool useHE = fgUsedVars[kCosThetaHE] || fgUsedVars[kPhiHE]; // helicity frame
-  bool useCS = fgUsedVars[kCosThetaCS] || fgUsedVars[kPhiCS]; // Collins-Soper frame
-  bool usePP = fgUsedVars[kCosThetaPP];                       // production plane frame
-  bool useRM = fgUsedVars[kCosThetaRM];                       // Random frame
+  bool useHE = usedVars[kCosThetaHE] || usedVars[kPhiHE]; // helicity frame
+  bool useCS = usedVars[kCosThetaCS] || usedVars[kPhiCS]; // Collins-Soper frame
+  bool usePP = usedVars[kCosThetaPP];                       // production plane frame
+  bool useRM = usedVars[kCosThetaRM];                       // Random frame
 
   if (useHE || useCS || usePP || useRM) {
     ROOT::Math::Boost boostv12{v12.BoostToCM()};
@@ -3495,16 +3540,16 @@ void VarManager::FillPair(T1 const& t1, T2 const& t2, float* values)
       ROOT::Math::XYZVectorF zaxis_HE{(v12.Vect()).Unit()};
       ROOT::Math::XYZVectorF yaxis_HE{(Beam1_CM.Cross(Beam2_CM)).Unit()};
       ROOT::Math::XYZVectorF xaxis_HE{(yaxis_HE.Cross(zaxis_HE)).Unit()};
-      if (fgUsedVars[kCosThetaHE])
+      if (usedVars[kCosThetaHE])
         values[kCosThetaHE] = zaxis_HE.Dot(v_CM);
-      if (fgUsedVars[kPhiHE]) {
+      if (usedVars[kPhiHE]) {
         values[kPhiHE] = TMath::ATan2(yaxis_HE.Dot(v_CM), xaxis_HE.Dot(v_CM));
         if (values[kPhiHE] < 0) {
           values[kPhiHE] += 2 * TMath::Pi(); // ensure phi is in [0, 2pi]
         }
       }
-      if (fgUsedVars[kPhiTildeHE]) {
-        if (fgUsedVars[kCosThetaHE] && fgUsedVars[kPhiHE]) {
+      if (usedVars[kPhiTildeHE]) {
+        if (usedVars[kCosThetaHE] && usedVars[kPhiHE]) {
           if (values[kCosThetaHE] > 0) {
             values[kPhiTildeHE] = values[kPhiHE] - 0.25 * TMath::Pi(); // phi_tilde = phi - pi/4
             if (values[kPhiTildeHE] < 0) {
@@ -3526,16 +3571,16 @@ void VarManager::FillPair(T1 const& t1, T2 const& t2, float* values)
       ROOT::Math::XYZVectorF zaxis_CS{(Beam1_CM - Beam2_CM).Unit()};
       ROOT::Math::XYZVectorF yaxis_CS{(Beam1_CM.Cross(Beam2_CM)).Unit()};
       ROOT::Math::XYZVectorF xaxis_CS{(yaxis_CS.Cross(zaxis_CS)).Unit()};
-      if (fgUsedVars[kCosThetaCS])
+      if (usedVars[kCosThetaCS])
         values[kCosThetaCS] = zaxis_CS.Dot(v_CM);
-      if (fgUsedVars[kPhiCS]) {
+      if (usedVars[kPhiCS]) {
         values[kPhiCS] = TMath::ATan2(yaxis_CS.Dot(v_CM), xaxis_CS.Dot(v_CM));
         if (values[kPhiCS] < 0) {
           values[kPhiCS] += 2 * TMath::Pi(); // ensure phi is in [0, 2pi]
         }
       }
-      if (fgUsedVars[kPhiTildeCS]) {
-        if (fgUsedVars[kCosThetaCS] && fgUsedVars[kPhiCS]) {
+      if (usedVars[kPhiTildeCS]) {
+        if (usedVars[kCosThetaCS] && usedVars[kPhiCS]) {
           if (values[kCosThetaCS] > 0) {
             values[kPhiTildeCS] = values[kPhiCS] - 0.25 * TMath::Pi(); // phi_tilde = phi - pi/4
             if (values[kPhiTildeCS] < 0) {
@@ -3557,17 +3602,17 @@ void VarManager::FillPair(T1 const& t1, T2 const& t2, float* values)
       ROOT::Math::XYZVector zaxis_PP = ROOT::Math::XYZVector(v12.Py(), -v12.Px(), 0.f);
       ROOT::Math::XYZVector yaxis_PP{(v12.Vect()).Unit()};
       ROOT::Math::XYZVector xaxis_PP{(yaxis_PP.Cross(zaxis_PP)).Unit()};
-      if (fgUsedVars[kCosThetaPP]) {
+      if (usedVars[kCosThetaPP]) {
         values[kCosThetaPP] = zaxis_PP.Dot(v_CM) / std::sqrt(zaxis_PP.Mag2());
       }
-      if (fgUsedVars[kPhiPP]) {
+      if (usedVars[kPhiPP]) {
         values[kPhiPP] = TMath::ATan2(yaxis_PP.Dot(v_CM), xaxis_PP.Dot(v_CM));
         if (values[kPhiPP] < 0) {
           values[kPhiPP] += 2 * TMath::Pi(); // ensure phi is in [0, 2pi]
         }
       }
-      if (fgUsedVars[kPhiTildePP]) {
-        if (fgUsedVars[kCosThetaPP] && fgUsedVars[kPhiPP]) {
+      if (usedVars[kPhiTildePP]) {
+        if (usedVars[kCosThetaPP] && usedVars[kPhiPP]) {
           if (values[kCosThetaPP] > 0) {
             values[kPhiTildePP] = values[kPhiPP] - 0.25 * TMath::Pi(); // phi_tilde = phi - pi/4
             if (values[kPhiTildePP] < 0) {
@@ -3589,14 +3634,14 @@ void VarManager::FillPair(T1 const& t1, T2 const& t2, float* values)
       double randomCostheta = gRandom->Uniform(-1., 1.);
       double randomPhi = gRandom->Uniform(0., 2. * TMath::Pi());
       ROOT::Math::XYZVectorF zaxis_RM(randomCostheta, std::sqrt(1 - randomCostheta * randomCostheta) * std::cos(randomPhi), std::sqrt(1 - randomCostheta * randomCostheta) * std::sin(randomPhi));
-      if (fgUsedVars[kCosThetaRM])
+      if (usedVars[kCosThetaRM])
         values[kCosThetaRM] = zaxis_RM.Dot(v_CM);
     }
   }
 
   if constexpr ((pairType == kDecayToEE) && ((fillMap & TrackCov) > 0 || (fillMap & ReducedTrackBarrelCov) > 0)) {
 
-    if (fgUsedVars[kQuadDCAabsXY] || fgUsedVars[kQuadDCAsigXY] || fgUsedVars[kQuadDCAabsZ] || fgUsedVars[kQuadDCAsigZ] || fgUsedVars[kQuadDCAsigXYZ] || fgUsedVars[kSignQuadDCAsigXY]) {
+    if (usedVars[kQuadDCAabsXY] || usedVars[kQuadDCAsigXY] || usedVars[kQuadDCAabsZ] || usedVars[kQuadDCAsigZ] || usedVars[kQuadDCAsigXYZ] || usedVars[kSignQuadDCAsigXY]) {
       // Quantities based on the barrel tables
       double dca1XY = t1.dcaXY();
       double dca2XY = t2.dcaXY();
@@ -3629,7 +3674,7 @@ void VarManager::FillPair(T1 const& t1, T2 const& t2, float* values)
     }
   }
   if constexpr ((pairType == kDecayToMuMu) && ((fillMap & Muon) > 0 || (fillMap & ReducedMuon) > 0)) {
-    if (fgUsedVars[kQuadDCAabsXY]) {
+    if (usedVars[kQuadDCAabsXY]) {
       double dca1X = t1.fwdDcaX();
       double dca1Y = t1.fwdDcaY();
       double dca1XY = std::sqrt(dca1X * dca1X + dca1Y * dca1Y);
@@ -3639,7 +3684,7 @@ void VarManager::FillPair(T1 const& t1, T2 const& t2, float* values)
       values[kQuadDCAabsXY] = std::sqrt((dca1XY * dca1XY + dca2XY * dca2XY) / 2.);
     }
   }
-  if (fgUsedVars[kPairPhiv]) {
+  if (usedVars[kPairPhiv]) {
     values[kPairPhiv] = calculatePhiV<pairType>(t1, t2);
   }
 }
@@ -3650,10 +3695,11 @@ void VarManager::FillPairCollision(const C& collision, T1 const& t1, T2 const& t
   if (!values) {
     values = fgValues;
   }
+  const bool* usedVars = fgUsedVars;
 
   if constexpr ((pairType == kDecayToEE) && ((fillMap & TrackCov) > 0 || (fillMap & ReducedTrackBarrelCov) > 0)) {
 
-    if (fgUsedVars[kQuadDCAabsXY] || fgUsedVars[kQuadDCAsigXY] || fgUsedVars[kQuadDCAabsZ] || fgUsedVars[kQuadDCAsigZ] || fgUsedVars[kQuadDCAsigXYZ] || fgUsedVars[kSignQuadDCAsigXY]) {
+    if (usedVars[kQuadDCAabsXY] || usedVars[kQuadDCAsigXY] || usedVars[kQuadDCAabsZ] || usedVars[kQuadDCAsigZ] || usedVars[kQuadDCAsigXYZ] || usedVars[kSignQuadDCAsigXY]) {
 
       auto trackPart1 = getTrackPar(t1);
       std::array<float, 2> dca1{1e10f, 1e10f};
@@ -3702,10 +3748,11 @@ void VarManager::FillPairCollisionMatCorr(C const& collision, T1 const& t1, T2 c
   if (!values) {
     values = fgValues;
   }
+  const bool* usedVars = fgUsedVars;
 
   if constexpr ((pairType == kDecayToEE) && ((fillMap & TrackCov) > 0 || (fillMap & ReducedTrackBarrelCov) > 0)) {
 
-    if (fgUsedVars[kQuadDCAabsXY] || fgUsedVars[kQuadDCAsigXY] || fgUsedVars[kQuadDCAabsZ] || fgUsedVars[kQuadDCAsigZ] || fgUsedVars[kQuadDCAsigXYZ] || fgUsedVars[kSignQuadDCAsigXY]) {
+    if (usedVars[kQuadDCAabsXY] || usedVars[kQuadDCAsigXY] || usedVars[kQuadDCAabsZ] || usedVars[kQuadDCAsigZ] || usedVars[kQuadDCAsigXYZ] || usedVars[kSignQuadDCAsigXY]) {
 
       auto trackPart1 = getTrackPar(t1);
       std::array<float, 2> dca1{1e10f, 1e10f};
@@ -3835,6 +3882,7 @@ void VarManager::FillPairME(T1 const& t1, T2 const& t2, float* values)
   if (!values) {
     values = fgValues;
   }
+  const bool* usedVars = fgUsedVars;
 
   float m1 = o2::constants::physics::MassElectron;
   float m2 = o2::constants::physics::MassElectron;
@@ -3862,7 +3910,7 @@ void VarManager::FillPairME(T1 const& t1, T2 const& t2, float* values)
   values[kPhi] = v12.Phi() > 0 ? v12.Phi() : v12.Phi() + 2. * M_PI;
   values[kRap] = -v12.Rapidity();
 
-  if (fgUsedVars[kDeltaPhiPair2]) {
+  if (usedVars[kDeltaPhiPair2]) {
     double phipair2ME = v1.Phi() - v2.Phi();
     if (phipair2ME > 3 * TMath::Pi() / 2) {
       values[kDeltaPhiPair2] = phipair2ME - 2 * TMath::Pi();
@@ -3873,15 +3921,15 @@ void VarManager::FillPairME(T1 const& t1, T2 const& t2, float* values)
     }
   }
 
-  if (fgUsedVars[kDeltaEtaPair2]) {
+  if (usedVars[kDeltaEtaPair2]) {
     values[kDeltaEtaPair2] = v1.Eta() - v2.Eta();
   }
 
   // polarization parameters
-  bool useHE = fgUsedVars[kCosThetaHE] || fgUsedVars[kPhiHE]; // helicity frame
-  bool useCS = fgUsedVars[kCosThetaCS] || fgUsedVars[kPhiCS]; // Collins-Soper frame
-  bool usePP = fgUsedVars[kCosThetaPP];                       // production plane frame
-  bool useRM = fgUsedVars[kCosThetaRM];                       // Random frame
+  bool useHE = usedVars[kCosThetaHE] || usedVars[kPhiHE]; // helicity frame
+  bool useCS = usedVars[kCosThetaCS] || usedVars[kPhiCS]; // Collins-Soper frame
+  bool usePP = usedVars[kCosThetaPP];                       // production plane frame
+  bool useRM = usedVars[kCosThetaRM];                       // Random frame
 
   if (useHE || useCS || usePP || useRM) {
     ROOT::Math::Boost boostv12{v12.BoostToCM()};
@@ -3897,16 +3945,16 @@ void VarManager::FillPairME(T1 const& t1, T2 const& t2, float* values)
       ROOT::Math::XYZVectorF zaxis_HE{(v12.Vect()).Unit()};
       ROOT::Math::XYZVectorF yaxis_HE{(Beam1_CM.Cross(Beam2_CM)).Unit()};
       ROOT::Math::XYZVectorF xaxis_HE{(yaxis_HE.Cross(zaxis_HE)).Unit()};
-      if (fgUsedVars[kCosThetaHE])
+      if (usedVars[kCosThetaHE])
         values[kCosThetaHE] = zaxis_HE.Dot(v_CM);
-      if (fgUsedVars[kPhiHE]) {
+      if (usedVars[kPhiHE]) {
         values[kPhiHE] = TMath::ATan2(yaxis_HE.Dot(v_CM), xaxis_HE.Dot(v_CM));
         if (values[kPhiHE] < 0) {
           values[kPhiHE] += 2 * TMath::Pi(); // ensure phi is in [0, 2pi]
         }
       }
-      if (fgUsedVars[kPhiTildeHE]) {
-        if (fgUsedVars[kCosThetaHE] && fgUsedVars[kPhiHE]) {
+      if (usedVars[kPhiTildeHE]) {
+        if (usedVars[kCosThetaHE] && usedVars[kPhiHE]) {
           if (values[kCosThetaHE] > 0) {
             values[kPhiTildeHE] = values[kPhiHE] - 0.25 * TMath::Pi(); // phi_tilde = phi - pi/4
             if (values[kPhiTildeHE] < 0) {
@@ -3928,16 +3976,16 @@ void VarManager::FillPairME(T1 const& t1, T2 const& t2, float* values)
       ROOT::Math::XYZVectorF zaxis_CS{(Beam1_CM - Beam2_CM).Unit()};
       ROOT::Math::XYZVectorF yaxis_CS{(Beam1_CM.Cross(Beam2_CM)).Unit()};
       ROOT::Math::XYZVectorF xaxis_CS{(yaxis_CS.Cross(zaxis_CS)).Unit()};
-      if (fgUsedVars[kCosThetaCS])
+      if (usedVars[kCosThetaCS])
         values[kCosThetaCS] = zaxis_CS.Dot(v_CM);
-      if (fgUsedVars[kPhiCS]) {
+      if (usedVars[kPhiCS]) {
         values[kPhiCS] = TMath::ATan2(yaxis_CS.Dot(v_CM), xaxis_CS.Dot(v_CM));
         if (values[kPhiCS] < 0) {
           values[kPhiCS] += 2 * TMath::Pi(); // ensure phi is in [0, 2pi]
         }
       }
-      if (fgUsedVars[kPhiTildeCS]) {
-        if (fgUsedVars[kCosThetaCS] && fgUsedVars[kPhiCS]) {
+      if (usedVars[kPhiTildeCS]) {
+        if (usedVars[kCosThetaCS] && usedVars[kPhiCS]) {
           if (values[kCosThetaCS] > 0) {
             values[kPhiTildeCS] = values[kPhiCS] - 0.25 * TMath::Pi(); // phi_tilde = phi - pi/4
             if (values[kPhiTildeCS] < 0) {
@@ -3959,17 +4007,17 @@ void VarManager::FillPairME(T1 const& t1, T2 const& t2, float* values)
       ROOT::Math::XYZVector zaxis_PP = ROOT::Math::XYZVector(v12.Py(), -v12.Px(), 0.f);
       ROOT::Math::XYZVector yaxis_PP{(v12.Vect()).Unit()};
       ROOT::Math::XYZVector xaxis_PP{(yaxis_PP.Cross(zaxis_PP)).Unit()};
-      if (fgUsedVars[kCosThetaPP]) {
+      if (usedVars[kCosThetaPP]) {
         values[kCosThetaPP] = zaxis_PP.Dot(v_CM) / std::sqrt(zaxis_PP.Mag2());
       }
-      if (fgUsedVars[kPhiPP]) {
+      if (usedVars[kPhiPP]) {
         values[kPhiPP] = TMath::ATan2(yaxis_PP.Dot(v_CM), xaxis_PP.Dot(v_CM));
         if (values[kPhiPP] < 0) {
           values[kPhiPP] += 2 * TMath::Pi(); // ensure phi is in [0, 2pi]
         }
       }
-      if (fgUsedVars[kPhiTildePP]) {
-        if (fgUsedVars[kCosThetaPP] && fgUsedVars[kPhiPP]) {
+      if (usedVars[kPhiTildePP]) {
+        if (usedVars[kCosThetaPP] && usedVars[kPhiPP]) {
           if (values[kCosThetaPP] > 0) {
             values[kPhiTildePP] = values[kPhiPP] - 0.25 * TMath::Pi(); // phi_tilde = phi - pi/4
             if (values[kPhiTildePP] < 0) {
@@ -3991,7 +4039,7 @@ void VarManager::FillPairME(T1 const& t1, T2 const& t2, float* values)
       double randomCostheta = gRandom->Uniform(-1., 1.);
       double randomPhi = gRandom->Uniform(0., 2. * TMath::Pi());
       ROOT::Math::XYZVectorF zaxis_RM(randomCostheta, std::sqrt(1 - randomCostheta * randomCostheta) * std::cos(randomPhi), std::sqrt(1 - randomCostheta * randomCostheta) * std::sin(randomPhi));
-      if (fgUsedVars[kCosThetaRM])
+      if (usedVars[kCosThetaRM])
         values[kCosThetaRM] = zaxis_RM.Dot(v_CM);
     }
   }
@@ -4051,7 +4099,7 @@ void VarManager::FillPairME(T1 const& t1, T2 const& t2, float* values)
     }
   }
   if constexpr (pairType == kDecayToMuMu) {
-    if (fgUsedVars[kQuadDCAabsXY]) {
+    if (usedVars[kQuadDCAabsXY]) {
       double dca1X = t1.fwdDcaX();
       double dca1Y = t1.fwdDcaY();
       double dca1XY = std::sqrt(dca1X * dca1X + dca1Y * dca1Y);
@@ -4061,7 +4109,7 @@ void VarManager::FillPairME(T1 const& t1, T2 const& t2, float* values)
       values[kQuadDCAabsXY] = std::sqrt((dca1XY * dca1XY + dca2XY * dca2XY) / 2.);
     }
   }
-  if (fgUsedVars[kPairPhiv]) {
+  if (usedVars[kPairPhiv]) {
     values[kPairPhiv] = calculatePhiV<pairType>(t1, t2);
   }
 }
@@ -4072,6 +4120,7 @@ void VarManager::FillPairMC(T1 const& t1, T2 const& t2, float* values)
   if (!values) {
     values = fgValues;
   }
+  const bool* usedVars = fgUsedVars;
 
   float m1 = o2::constants::physics::MassElectron;
   float m2 = o2::constants::physics::MassElectron;
@@ -4109,10 +4158,10 @@ void VarManager::FillPairMC(T1 const& t1, T2 const& t2, float* values)
   values[kMCEta2] = t2.eta();
 
   // polarization parameters
-  bool useHE = fgUsedVars[kMCCosThetaHE] || fgUsedVars[kMCPhiHE]; // helicity frame
-  bool useCS = fgUsedVars[kMCCosThetaCS] || fgUsedVars[kMCPhiCS]; // Collins-Soper frame
-  bool usePP = fgUsedVars[kMCCosThetaPP];                         // production plane frame
-  bool useRM = fgUsedVars[kMCCosThetaRM];                         // Random frame
+  bool useHE = usedVars[kMCCosThetaHE] || usedVars[kMCPhiHE]; // helicity frame
+  bool useCS = usedVars[kMCCosThetaCS] || usedVars[kMCPhiCS]; // Collins-Soper frame
+  bool usePP = usedVars[kMCCosThetaPP];                         // production plane frame
+  bool useRM = usedVars[kMCCosThetaRM];                         // Random frame
 
   if (useHE || useCS || usePP || useRM) {
     ROOT::Math::Boost boostv12{v12.BoostToCM()};
@@ -4128,16 +4177,16 @@ void VarManager::FillPairMC(T1 const& t1, T2 const& t2, float* values)
       ROOT::Math::XYZVectorF zaxis_HE{(v12.Vect()).Unit()};
       ROOT::Math::XYZVectorF yaxis_HE{(Beam1_CM.Cross(Beam2_CM)).Unit()};
       ROOT::Math::XYZVectorF xaxis_HE{(yaxis_HE.Cross(zaxis_HE)).Unit()};
-      if (fgUsedVars[kMCCosThetaHE])
+      if (usedVars[kMCCosThetaHE])
         values[kMCCosThetaHE] = zaxis_HE.Dot(v_CM);
-      if (fgUsedVars[kMCPhiHE]) {
+      if (usedVars[kMCPhiHE]) {
         values[kMCPhiHE] = TMath::ATan2(yaxis_HE.Dot(v_CM), xaxis_HE.Dot(v_CM));
         if (values[kMCPhiHE] < 0) {
           values[kMCPhiHE] += 2 * TMath::Pi(); // ensure phi is in [0, 2pi]
         }
       }
-      if (fgUsedVars[kMCPhiTildeHE]) {
-        if (fgUsedVars[kMCCosThetaHE] && fgUsedVars[kMCPhiHE]) {
+      if (usedVars[kMCPhiTildeHE]) {
+        if (usedVars[kMCCosThetaHE] && usedVars[kMCPhiHE]) {
           if (values[kMCCosThetaHE] > 0) {
             values[kMCPhiTildeHE] = values[kMCPhiHE] - 0.25 * TMath::Pi(); // phi_tilde = phi - pi/4
             if (values[kMCPhiTildeHE] < 0) {
@@ -4159,16 +4208,16 @@ void VarManager::FillPairMC(T1 const& t1, T2 const& t2, float* values)
       ROOT::Math::XYZVectorF zaxis_CS{(Beam1_CM - Beam2_CM).Unit()};
       ROOT::Math::XYZVectorF yaxis_CS{(Beam1_CM.Cross(Beam2_CM)).Unit()};
       ROOT::Math::XYZVectorF xaxis_CS{(yaxis_CS.Cross(zaxis_CS)).Unit()};
-      if (fgUsedVars[kMCCosThetaCS])
+      if (usedVars[kMCCosThetaCS])
         values[kMCCosThetaCS] = zaxis_CS.Dot(v_CM);
-      if (fgUsedVars[kMCPhiCS]) {
+      if (usedVars[kMCPhiCS]) {
         values[kMCPhiCS] = TMath::ATan2(yaxis_CS.Dot(v_CM), xaxis_CS.Dot(v_CM));
         if (values[kMCPhiCS] < 0) {
           values[kMCPhiCS] += 2 * TMath::Pi(); // ensure phi is in [0, 2pi]
         }
       }
-      if (fgUsedVars[kMCPhiTildeCS]) {
-        if (fgUsedVars[kMCCosThetaCS] && fgUsedVars[kMCPhiCS]) {
+      if (usedVars[kMCPhiTildeCS]) {
+        if (usedVars[kMCCosThetaCS] && usedVars[kMCPhiCS]) {
           if (values[kMCCosThetaCS] > 0) {
             values[kMCPhiTildeCS] = values[kMCPhiCS] - 0.25 * TMath::Pi(); // phi_tilde = phi - pi/4
             if (values[kMCPhiTildeCS] < 0) {
@@ -4190,17 +4239,17 @@ void VarManager::FillPairMC(T1 const& t1, T2 const& t2, float* values)
       ROOT::Math::XYZVector zaxis_PP = ROOT::Math::XYZVector(v12.Py(), -v12.Px(), 0.f);
       ROOT::Math::XYZVector yaxis_PP{v12.Vect().Unit()};
       ROOT::Math::XYZVector xaxis_PP{(yaxis_PP.Cross(zaxis_PP)).Unit()};
-      if (fgUsedVars[kMCCosThetaPP]) {
+      if (usedVars[kMCCosThetaPP]) {
         values[kMCCosThetaPP] = zaxis_PP.Dot(v_CM);
       }
-      if (fgUsedVars[kMCPhiPP]) {
+      if (usedVars[kMCPhiPP]) {
         values[kMCPhiPP] = TMath::ATan2(yaxis_PP.Dot(v_CM), xaxis_PP.Dot(v_CM));
         if (values[kMCPhiPP] < 0) {
           values[kMCPhiPP] += 2 * TMath::Pi(); // ensure phi is in [0, 2pi]
         }
       }
-      if (fgUsedVars[kMCPhiTildePP]) {
-        if (fgUsedVars[kMCCosThetaPP] && fgUsedVars[kMCPhiPP]) {
+      if (usedVars[kMCPhiTildePP]) {
+        if (usedVars[kMCCosThetaPP] && usedVars[kMCPhiPP]) {
           if (values[kMCCosThetaPP] > 0) {
             values[kMCPhiTildePP] = values[kMCPhiPP] - 0.25 * TMath::Pi(); // phi_tilde = phi - pi/4
             if (values[kMCPhiTildePP] < 0) {
@@ -4222,7 +4271,7 @@ void VarManager::FillPairMC(T1 const& t1, T2 const& t2, float* values)
       double randomCostheta = gRandom->Uniform(-1., 1.);
       double randomPhi = gRandom->Uniform(0., 2. * TMath::Pi());
       ROOT::Math::XYZVectorF zaxis_RM(randomCostheta, std::sqrt(1 - randomCostheta * randomCostheta) * std::cos(randomPhi), std::sqrt(1 - randomCostheta * randomCostheta) * std::sin(randomPhi));
-      if (fgUsedVars[kMCCosThetaRM])
+      if (usedVars[kMCCosThetaRM])
         values[kMCCosThetaRM] = zaxis_RM.Dot(v_CM);
     }
   }
@@ -4324,6 +4373,7 @@ void VarManager::FillPairVertexing(C const& collision, T const& t1, T const& t2,
   if (!values) {
     values = fgValues;
   }
+  const bool* usedVars = fgUsedVars;
   float m1 = o2::constants::physics::MassElectron;
   float m2 = o2::constants::physics::MassElectron;
   if constexpr (pairType == kDecayToKPi) {
@@ -4517,7 +4567,7 @@ void VarManager::FillPairVertexing(C const& collision, T const& t1, T const& t2,
       KFGeoTwoProng.AddDaughter(trk0KF);
       KFGeoTwoProng.AddDaughter(trk1KF);
     }
-    if (fgUsedVars[kKFMass]) {
+    if (usedVars[kKFMass]) {
       float mass = 0., massErr = 0.;
       if (!KFGeoTwoProng.GetMass(mass, massErr))
         values[kKFMass] = mass;
@@ -4532,7 +4582,7 @@ void VarManager::FillPairVertexing(C const& collision, T const& t1, T const& t2,
       double dxPair2PV = KFGeoTwoProng.GetX() - KFPV.GetX();
       double dyPair2PV = KFGeoTwoProng.GetY() - KFPV.GetY();
       double dzPair2PV = KFGeoTwoProng.GetZ() - KFPV.GetZ();
-      if (fgUsedVars[kVertexingLxy] || fgUsedVars[kVertexingLz] || fgUsedVars[kVertexingLxyz] || fgUsedVars[kVertexingLxyErr] || fgUsedVars[kVertexingLzErr] || fgUsedVars[kVertexingTauxy] || fgUsedVars[kVertexingLxyOverErr] || fgUsedVars[kVertexingLzOverErr] || fgUsedVars[kVertexingLxyzOverErr] || fgUsedVars[kCosPointingAngle]) {
+      if (usedVars[kVertexingLxy] || usedVars[kVertexingLz] || usedVars[kVertexingLxyz] || usedVars[kVertexingLxyErr] || usedVars[kVertexingLzErr] || usedVars[kVertexingTauxy] || usedVars[kVertexingLxyOverErr] || usedVars[kVertexingLzOverErr] || usedVars[kVertexingLxyzOverErr] || usedVars[kCosPointingAngle]) {
         values[kVertexingLxy] = std::sqrt(dxPair2PV * dxPair2PV + dyPair2PV * dyPair2PV);
         values[kVertexingLz] = std::sqrt(dzPair2PV * dzPair2PV);
         values[kVertexingLxyz] = std::sqrt(dxPair2PV * dxPair2PV + dyPair2PV * dyPair2PV + dzPair2PV * dzPair2PV);
@@ -4560,7 +4610,7 @@ void VarManager::FillPairVertexing(C const& collision, T const& t1, T const& t2,
                                     (v12.P() * values[VarManager::kVertexingLxyz]);
       }
       // As defined in Run 2 (projected onto momentum)
-      if (fgUsedVars[kVertexingLxyProjected] || fgUsedVars[kVertexingLxyzProjected] || fgUsedVars[kVertexingLzProjected]) {
+      if (usedVars[kVertexingLxyProjected] || usedVars[kVertexingLxyzProjected] || usedVars[kVertexingLzProjected]) {
         values[kVertexingLzProjected] = (dzPair2PV * KFGeoTwoProng.GetPz()) / TMath::Sqrt(KFGeoTwoProng.GetPz() * KFGeoTwoProng.GetPz());
         values[kVertexingLxyProjected] = (dxPair2PV * KFGeoTwoProng.GetPx()) + (dyPair2PV * KFGeoTwoProng.GetPy());
         values[kVertexingLxyProjected] = values[kVertexingLxyProjected] / TMath::Sqrt((KFGeoTwoProng.GetPx() * KFGeoTwoProng.GetPx()) + (KFGeoTwoProng.GetPy() * KFGeoTwoProng.GetPy()));
@@ -4572,56 +4622,56 @@ void VarManager::FillPairVertexing(C const& collision, T const& t1, T const& t2,
         values[kVertexingTauzProjected] = values[kVertexingLzProjected] * KFGeoTwoProng.GetMass() / TMath::Abs(KFGeoTwoProng.GetPz());
       }
 
-      if (fgUsedVars[kVertexingLxyOverErr] || fgUsedVars[kVertexingLzOverErr] || fgUsedVars[kVertexingLxyzOverErr]) {
+      if (usedVars[kVertexingLxyOverErr] || usedVars[kVertexingLzOverErr] || usedVars[kVertexingLxyzOverErr]) {
         values[kVertexingLxyOverErr] = values[kVertexingLxy] / values[kVertexingLxyErr];
         values[kVertexingLzOverErr] = values[kVertexingLz] / values[kVertexingLzErr];
         values[kVertexingLxyzOverErr] = values[kVertexingLxyz] / values[kVertexingLxyzErr];
       }
 
-      if (fgUsedVars[kKFChi2OverNDFGeo])
+      if (usedVars[kKFChi2OverNDFGeo])
         values[kKFChi2OverNDFGeo] = KFGeoTwoProng.GetChi2() / KFGeoTwoProng.GetNDF();
-      if (fgUsedVars[kKFCosPA])
+      if (usedVars[kKFCosPA])
         values[kKFCosPA] = calculateCosPA(KFGeoTwoProng, KFPV);
 
       // in principle, they should be in FillTrack
-      if (fgUsedVars[kKFTrack0DCAxyz] || fgUsedVars[kKFTrack1DCAxyz]) {
+      if (usedVars[kKFTrack0DCAxyz] || usedVars[kKFTrack1DCAxyz]) {
         values[kKFTrack0DCAxyz] = trk0KF.GetDistanceFromVertex(KFPV);
         values[kKFTrack1DCAxyz] = trk1KF.GetDistanceFromVertex(KFPV);
       }
-      if (fgUsedVars[kKFTrack0DCAxy] || fgUsedVars[kKFTrack1DCAxy]) {
+      if (usedVars[kKFTrack0DCAxy] || usedVars[kKFTrack1DCAxy]) {
         values[kKFTrack0DCAxy] = trk0KF.GetDistanceFromVertexXY(KFPV);
         values[kKFTrack1DCAxy] = trk1KF.GetDistanceFromVertexXY(KFPV);
       }
-      if (fgUsedVars[kKFDCAxyzBetweenProngs])
+      if (usedVars[kKFDCAxyzBetweenProngs])
         values[kKFDCAxyzBetweenProngs] = trk0KF.GetDistanceFromParticle(trk1KF);
-      if (fgUsedVars[kKFDCAxyBetweenProngs])
+      if (usedVars[kKFDCAxyBetweenProngs])
         values[kKFDCAxyBetweenProngs] = trk0KF.GetDistanceFromParticleXY(trk1KF);
 
-      if (fgUsedVars[kKFTracksDCAxyzMax]) {
+      if (usedVars[kKFTracksDCAxyzMax]) {
         values[kKFTracksDCAxyzMax] = values[kKFTrack0DCAxyz] > values[kKFTrack1DCAxyz] ? values[kKFTrack0DCAxyz] : values[kKFTrack1DCAxyz];
       }
-      if (fgUsedVars[kKFTracksDCAxyMax]) {
+      if (usedVars[kKFTracksDCAxyMax]) {
         values[kKFTracksDCAxyMax] = TMath::Abs(values[kKFTrack0DCAxy]) > TMath::Abs(values[kKFTrack1DCAxy]) ? values[kKFTrack0DCAxy] : values[kKFTrack1DCAxy];
       }
-      if (fgUsedVars[kKFTrack0DeviationFromPV] || fgUsedVars[kKFTrack1DeviationFromPV]) {
+      if (usedVars[kKFTrack0DeviationFromPV] || usedVars[kKFTrack1DeviationFromPV]) {
         values[kKFTrack0DeviationFromPV] = trk0KF.GetDeviationFromVertex(KFPV);
         values[kKFTrack1DeviationFromPV] = trk1KF.GetDeviationFromVertex(KFPV);
       }
-      if (fgUsedVars[kKFTrack0DeviationxyFromPV] || fgUsedVars[kKFTrack1DeviationxyFromPV]) {
+      if (usedVars[kKFTrack0DeviationxyFromPV] || usedVars[kKFTrack1DeviationxyFromPV]) {
         values[kKFTrack0DeviationxyFromPV] = trk0KF.GetDeviationFromVertexXY(KFPV);
         values[kKFTrack1DeviationxyFromPV] = trk1KF.GetDeviationFromVertexXY(KFPV);
       }
-      if (fgUsedVars[kKFJpsiDCAxyz]) {
+      if (usedVars[kKFJpsiDCAxyz]) {
         values[kKFJpsiDCAxyz] = KFGeoTwoProng.GetDistanceFromVertex(KFPV);
       }
-      if (fgUsedVars[kKFJpsiDCAxy]) {
+      if (usedVars[kKFJpsiDCAxy]) {
         values[kKFJpsiDCAxy] = KFGeoTwoProng.GetDistanceFromVertexXY(KFPV);
       }
-      if (fgUsedVars[kKFPairDeviationFromPV] || fgUsedVars[kKFPairDeviationxyFromPV]) {
+      if (usedVars[kKFPairDeviationFromPV] || usedVars[kKFPairDeviationxyFromPV]) {
         values[kKFPairDeviationFromPV] = KFGeoTwoProng.GetDeviationFromVertex(KFPV);
         values[kKFPairDeviationxyFromPV] = KFGeoTwoProng.GetDeviationFromVertexXY(KFPV);
       }
-      if (fgUsedVars[kKFChi2OverNDFGeoTop] || fgUsedVars[kKFMassGeoTop]) {
+      if (usedVars[kKFChi2OverNDFGeoTop] || usedVars[kKFMassGeoTop]) {
         KFParticle KFGeoTopTwoProngBarrel = KFGeoTwoProng;
         KFGeoTopTwoProngBarrel.SetProductionVertex(KFPV);
         values[kKFChi2OverNDFGeoTop] = KFGeoTopTwoProngBarrel.GetChi2() / KFGeoTopTwoProngBarrel.GetNDF();
@@ -4770,6 +4820,7 @@ void VarManager::FillTripletVertexing(C const& collision, T const& t1, T const&
   if (!values) {
     values = fgValues;
   }
+  const bool* usedVars = fgUsedVars;
 
   float m1, m2, m3;
 
@@ -4851,7 +4902,7 @@ void VarManager::FillTripletVertexing(C const& collision, T const& t1, T const&
       o2::dataformats::VertexBase primaryVertex = {std::move(vtxXYZ), std::move(vtxCov)};
       auto covMatrixPV = primaryVertex.getCov();
 
-      if (fgUsedVars[kVertexingChi2PCA]) {
+      if (usedVars[kVertexingChi2PCA]) {
         auto chi2PCA = fgFitterThreeProngBarrel.getChi2AtPCACandidate();
         values[VarManager::kVertexingChi2PCA] = chi2PCA;
       }
@@ -4926,7 +4977,7 @@ void VarManager::FillTripletVertexing(C const& collision, T const& t1, T const&
       KFGeoThreeProng.AddDaughter(trk1KF);
       KFGeoThreeProng.AddDaughter(trk2KF);
     }
-    if (fgUsedVars[kKFMass]) {
+    if (usedVars[kKFMass]) {
       float mass = 0., massErr = 0.;
       if (!KFGeoThreeProng.GetMass(mass, massErr))
         values[kKFMass] = mass;
@@ -4992,6 +5043,7 @@ void VarManager::FillDileptonTrackVertexing(C const& collision, T1 const& lepton
   if (!values) {
     values = fgValues;
   }
+  const bool* usedVars = fgUsedVars;
 
   float mtrack;
   float mlepton1, mlepton2;
@@ -5055,7 +5107,7 @@ void VarManager::FillDileptonTrackVertexing(C const& collision, T1 const& lepton
     values[VarManager::kPairPt] = v123.Pt();
     values[VarManager::kPairRap] = -v123.Rapidity();
     values[VarManager::kPairEta] = v123.Eta();
-    if (fgUsedVars[kPairMassDau] || fgUsedVars[kPairPtDau]) {
+    if (usedVars[kPairMassDau] || usedVars[kPairPtDau]) {
       values[VarManager::kPairMassDau] = v12.M();
       values[VarManager::kPairPtDau] = v12.Pt();
     }
@@ -5104,7 +5156,7 @@ void VarManager::FillDileptonTrackVertexing(C const& collision, T1 const& lepton
         covMatrixPCA = fgFitterThreeProngFwd.calcPCACovMatrixFlat();
       }
 
-      if (fgUsedVars[kVertexingChi2PCA]) {
+      if (usedVars[kVertexingChi2PCA]) {
         auto chi2PCA = fgFitterThreeProngBarrel.getChi2AtPCACandidate();
         values[VarManager::kVertexingChi2PCA] = chi2PCA;
       }
@@ -5113,7 +5165,7 @@ void VarManager::FillDileptonTrackVertexing(C const& collision, T1 const& lepton
       double theta = std::atan2(secondaryVertex[2] - collision.posZ(),
                                 std::sqrt((secondaryVertex[0] - collision.posX()) * (secondaryVertex[0] - collision.posX()) +
                                           (secondaryVertex[1] - collision.posY()) * (secondaryVertex[1] - collision.posY())));
-      if (fgUsedVars[kVertexingLxy] || fgUsedVars[kVertexingLz] || fgUsedVars[kVertexingLxyz]) {
+      if (usedVars[kVertexingLxy] || usedVars[kVertexingLz] || usedVars[kVertexingLxyz]) {
 
         values[VarManager::kVertexingLxy] = (collision.posX() - secondaryVertex[0]) * (collision.posX() - secondaryVertex[0]) +
                                             (collision.posY() - secondaryVertex[1]) * (collision.posY() - secondaryVertex[1]);
@@ -5124,7 +5176,7 @@ void VarManager::FillDileptonTrackVertexing(C const& collision, T1 const& lepton
         values[VarManager::kVertexingLxyz] = std::sqrt(values[VarManager::kVertexingLxyz]);
       }
 
-      if (fgUsedVars[kVertexingLxyzErr] || fgUsedVars[kVertexingLxyErr] || fgUsedVars[kVertexingLzErr]) {
+      if (usedVars[kVertexingLxyzErr] || usedVars[kVertexingLxyErr] || usedVars[kVertexingLzErr]) {
         values[kVertexingLxyzErr] = std::sqrt(getRotatedCovMatrixXX(covMatrixPV, phi, theta) + getRotatedCovMatrixXX(covMatrixPCA, phi, theta));
         values[kVertexingLxyErr] = std::sqrt(getRotatedCovMatrixXX(covMatrixPV, phi, 0.) + getRotatedCovMatrixXX(covMatrixPCA, phi, 0.));
         values[kVertexingLzErr] = std::sqrt(getRotatedCovMatrixXX(covMatrixPV, 0, theta) + getRotatedCovMatrixXX(covMatrixPCA, 0, theta));
@@ -5139,14 +5191,14 @@ void VarManager::FillDileptonTrackVertexing(C const& collision, T1 const& lepton
       values[kVertexingTauzErr] = values[kVertexingLzErr] * v123.M() / (TMath::Abs(v123.Pz()) * o2::constants::physics::LightSpeedCm2NS);
       values[kVertexingTauxyErr] = values[kVertexingLxyErr] * v123.M() / (v123.Pt() * o2::constants::physics::LightSpeedCm2NS);
 
-      if (fgUsedVars[kCosPointingAngle] && fgUsedVars[kVertexingLxyz]) {
+      if (usedVars[kCosPointingAngle] && usedVars[kVertexingLxyz]) {
         values[VarManager::kCosPointingAngle] = ((collision.posX() - secondaryVertex[0]) * v123.Px() +
                                                  (collision.posY() - secondaryVertex[1]) * v123.Py() +
                                                  (collision.posZ() - secondaryVertex[2]) * v123.Pz()) /
                                                 (v123.P() * values[VarManager::kVertexingLxyz]);
       }
       // run 2 definitions: Lxy projected onto the momentum vector of the candidate
-      if (fgUsedVars[kVertexingLxyProjected] || fgUsedVars[kVertexingLxyzProjected] || values[kVertexingTauxyProjected]) {
+      if (usedVars[kVertexingLxyProjected] || usedVars[kVertexingLxyzProjected] || values[kVertexingTauxyProjected]) {
         values[kVertexingLzProjected] = (secondaryVertex[2] - collision.posZ()) * v123.Pz();
         values[kVertexingLzProjected] = values[kVertexingLzProjected] / TMath::Sqrt(v123.Pz() * v123.Pz());
         values[kVertexingLxyProjected] = ((secondaryVertex[0] - collision.posX()) * v123.Px()) + ((secondaryVertex[1] - collision.posY()) * v123.Py());
@@ -5176,20 +5228,20 @@ void VarManager::FillDileptonTrackVertexing(C const& collision, T1 const& lepton
       KFGeoTwoLeptons.AddDaughter(lepton1KF);
       KFGeoTwoLeptons.AddDaughter(lepton2KF);
 
-      if (fgUsedVars[kPairMassDau] || fgUsedVars[kPairPtDau]) {
+      if (usedVars[kPairMassDau] || usedVars[kPairPtDau]) {
         values[VarManager::kPairMassDau] = KFGeoTwoLeptons.GetMass();
         values[VarManager::kPairPtDau] = KFGeoTwoLeptons.GetPt();
       }
 
       // Quantities between 3rd prong and candidate
-      if (fgUsedVars[kKFDCAxyzBetweenProngs])
+      if (usedVars[kKFDCAxyzBetweenProngs])
         values[kKFDCAxyzBetweenProngs] = KFGeoTwoLeptons.GetDistanceFromParticle(hadronKF);
 
       KFGeoThreeProng.SetConstructMethod(2);
       KFGeoThreeProng.AddDaughter(KFGeoTwoLeptons);
       KFGeoThreeProng.AddDaughter(hadronKF);
 
-      if (fgUsedVars[kKFMass])
+      if (usedVars[kKFMass])
         values[kKFMass] = KFGeoThreeProng.GetMass();
 
       if constexpr (eventHasVtxCov) {
@@ -5199,7 +5251,7 @@ void VarManager::FillDileptonTrackVertexing(C const& collision, T1 const& lepton
         double dyTriplet3PV = KFGeoThreeProng.GetY() - KFPV.GetY();
         double dzTriplet3PV = KFGeoThreeProng.GetZ() - KFPV.GetZ();
 
-        if (fgUsedVars[kVertexingLxy] || fgUsedVars[kVertexingLz] || fgUsedVars[kVertexingLxyz] || fgUsedVars[kVertexingLxyErr] || fgUsedVars[kVertexingLzErr] || fgUsedVars[kVertexingTauxy] || fgUsedVars[kVertexingLxyOverErr] || fgUsedVars[kVertexingLzOverErr] || fgUsedVars[kVertexingLxyzOverErr] || fgUsedVars[kCosPointingAngle]) {
+        if (usedVars[kVertexingLxy] || usedVars[kVertexingLz] || usedVars[kVertexingLxyz] || usedVars[kVertexingLxyErr] || usedVars[kVertexingLzErr] || usedVars[kVertexingTauxy] || usedVars[kVertexingLxyOverErr] || usedVars[kVertexingLzOverErr] || usedVars[kVertexingLxyzOverErr] || usedVars[kCosPointingAngle]) {
           values[kVertexingLxy] = std::sqrt(dxTriplet3PV * dxTriplet3PV + dyTriplet3PV * dyTriplet3PV);
           values[kVertexingLz] = std::sqrt(dzTriplet3PV * dzTriplet3PV);
           values[kVertexingLxyz] = std::sqrt(dxTriplet3PV * dxTriplet3PV + dyTriplet3PV * dyTriplet3PV + dzTriplet3PV * dzTriplet3PV);
@@ -5216,12 +5268,12 @@ void VarManager::FillDileptonTrackVertexing(C const& collision, T1 const& lepton
             values[kVertexingLxyz] = 1.e-8f;
           values[kVertexingLxyzErr] = values[kVertexingLxyzErr] < 0. ? 1.e8f : std::sqrt(values[kVertexingLxyzErr]) / values[kVertexingLxyz];
 
-          if (fgUsedVars[kVertexingTauxy])
+          if (usedVars[kVertexingTauxy])
             values[kVertexingTauxy] = KFGeoThreeProng.GetPseudoProperDecayTime(KFPV, KFGeoThreeProng.GetMass()) / (o2::constants::physics::LightSpeedCm2NS);
-          if (fgUsedVars[kVertexingTauxyErr])
+          if (usedVars[kVertexingTauxyErr])
             values[kVertexingTauxyErr] = values[kVertexingLxyErr] * KFGeoThreeProng.GetMass() / (KFGeoThreeProng.GetPt() * o2::constants::physics::LightSpeedCm2NS);
 
-          if (fgUsedVars[kCosPointingAngle])
+          if (usedVars[kCosPointingAngle])
             values[VarManager::kCosPointingAngle] = (dxTriplet3PV * KFGeoThreeProng.GetPx() +
                                                      dyTriplet3PV * KFGeoThreeProng.GetPy() +
                                                      dzTriplet3PV * KFGeoThreeProng.GetPz()) /
@@ -5229,7 +5281,7 @@ void VarManager::FillDileptonTrackVertexing(C const& collision, T1 const& lepton
         } // end calculate vertex variables
 
         // As defined in Run 2 (projected onto momentum)
-        if (fgUsedVars[kVertexingLxyProjected] || fgUsedVars[kVertexingLxyzProjected] || fgUsedVars[kVertexingLzProjected]) {
+        if (usedVars[kVertexingLxyProjected] || usedVars[kVertexingLxyzProjected] || usedVars[kVertexingLzProjected]) {
           values[kVertexingLzProjected] = (dzTriplet3PV * KFGeoThreeProng.GetPz()) / TMath::Sqrt(KFGeoThreeProng.GetPz() * KFGeoThreeProng.GetPz());
           values[kVertexingLxyProjected] = (dxTriplet3PV * KFGeoThreeProng.GetPx()) + (dyTriplet3PV * KFGeoThreeProng.GetPy());
           values[kVertexingLxyProjected] = values[kVertexingLxyProjected] / TMath::Sqrt((KFGeoThreeProng.GetPx() * KFGeoThreeProng.GetPx()) + (KFGeoThreeProng.GetPy() * KFGeoThreeProng.GetPy()));
@@ -5559,6 +5611,7 @@ void VarManager::FillPairVn(T1 const& t1, T2 const& t2, float* values)
   if (!values) {
     values = fgValues;
   }
+  const bool* usedVars = fgUsedVars;
 
   float m1 = o2::constants::physics::MassElectron;
   float m2 = o2::constants::physics::MassElectron;
@@ -5635,7 +5688,7 @@ void VarManager::FillPairVn(T1 const& t1, T2 const& t2, float* values)
   }
 
   // global polarization parameters
-  bool useGlobalPolarizatiobSpinOne = fgUsedVars[kCosThetaStarTPC] || fgUsedVars[kCosThetaStarFT0A] || fgUsedVars[kCosThetaStarFT0C];
+  bool useGlobalPolarizatiobSpinOne = usedVars[kCosThetaStarTPC] || usedVars[kCosThetaStarFT0A] || usedVars[kCosThetaStarFT0C];
   if (useGlobalPolarizatiobSpinOne) {
     ROOT::Math::Boost boostv12{v12.BoostToCM()};
     ROOT::Math::XYZVectorF v1_CM{(boostv12(v1).Vect()).Unit()};
@@ -5746,8 +5799,9 @@ void VarManager::FillDileptonHadron(T1 const& dilepton, T2 const& hadron, float*
   if (!values) {
     values = fgValues;
   }
+  const bool* usedVars = fgUsedVars;
 
-  if (fgUsedVars[kPairMass] || fgUsedVars[kPairPt] || fgUsedVars[kPairEta] || fgUsedVars[kPairPhi] || fgUsedVars[kPairMassDau] || fgUsedVars[kPairPtDau] || fgUsedVars[kDileptonHadronKstar]) {
+  if (usedVars[kPairMass] || usedVars[kPairPt] || usedVars[kPairEta] || usedVars[kPairPhi] || usedVars[kPairMassDau] || usedVars[kPairPtDau] || usedVars[kDileptonHadronKstar]) {
     ROOT::Math::PtEtaPhiMVector v1(dilepton.pt(), dilepton.eta(), dilepton.phi(), dilepton.mass());
     ROOT::Math::PtEtaPhiMVector v2(hadron.pt(), hadron.eta(), hadron.phi(), hadronMass);
     ROOT::Math::PtEtaPhiMVector v12 = v1 + v2;
@@ -5766,7 +5820,7 @@ void VarManager::FillDileptonHadron(T1 const& dilepton, T2 const& hadron, float*
     values[kDileptonHadronKstar] = sqrt(Q1 * Q1 - v12_Qvect.M2()) / 2.0;
   }
 
-  if (fgUsedVars[kDeltaPhi]) {
+  if (usedVars[kDeltaPhi]) {
     double delta = dilepton.phi() - hadron.phi();
     if (delta > 3.0 / 2.0 * M_PI) {
       delta -= 2.0 * M_PI;
@@ -5776,14 +5830,14 @@ void VarManager::FillDileptonHadron(T1 const& dilepton, T2 const& hadron, float*
     }
     values[kDeltaPhi] = delta;
   }
-  if (fgUsedVars[kDeltaPhiSym]) {
+  if (usedVars[kDeltaPhiSym]) {
     double delta = std::abs(dilepton.phi() - hadron.phi());
     if (delta > M_PI) {
       delta = 2 * M_PI - delta;
     }
     values[kDeltaPhiSym] = delta;
   }
-  if (fgUsedVars[kDeltaEta]) {
+  if (usedVars[kDeltaEta]) {
     values[kDeltaEta] = dilepton.eta() - hadron.eta();
   }
 }
@@ -5791,6 +5845,7 @@ void VarManager::FillDileptonHadron(T1 const& dilepton, T2 const& hadron, float*
 template <typename T1, typename T2, typename T3>
 void VarManager::FillEnergyCorrelatorTriple(T1 const& lepton1, T2 const& lepton2, T3 const& hadron, float* values, float Translow, float Transhigh, bool applyFitMass, float sidebandMass)
 {
+  const bool* usedVars = fgUsedVars;
   float m1 = o2::constants::physics::MassElectron;
   float m2 = o2::constants::physics::MassElectron;
 
@@ -5806,7 +5861,7 @@ void VarManager::FillEnergyCorrelatorTriple(T1 const& lepton1, T2 const& lepton2
     dileptonmass = sidebandMass;
   }
 
-  if (fgUsedVars[kCosChi] || fgUsedVars[kECWeight] || fgUsedVars[kCosTheta] || fgUsedVars[kEWeight_before] || fgUsedVars[kPtDau] || fgUsedVars[kEtaDau] || fgUsedVars[kPhiDau] || fgUsedVars[kCosChi_randomPhi_trans] || fgUsedVars[kCosChi_randomPhi_toward] || fgUsedVars[kCosChi_randomPhi_away]) {
+  if (usedVars[kCosChi] || usedVars[kECWeight] || usedVars[kCosTheta] || usedVars[kEWeight_before] || usedVars[kPtDau] || usedVars[kEtaDau] || usedVars[kPhiDau] || usedVars[kCosChi_randomPhi_trans] || usedVars[kCosChi_randomPhi_toward] || usedVars[kCosChi_randomPhi_away]) {
     values[kdileptonmass] = dileptonmass;
     ROOT::Math::PtEtaPhiMVector v1(dilepton.pt(), dilepton.eta(), dilepton.phi(), dileptonmass);
     ROOT::Math::PtEtaPhiMVector v2(hadron.pt(), hadron.eta(), hadron.phi(), o2::constants::physics::MassPionCharged);
@@ -5861,7 +5916,8 @@ void VarManager::FillEnergyCorrelatorTriple(T1 const& lepton1, T2 const& lepton2
 template <int pairType, typename T1, typename T2, typename T3, typename T4, typename T5>
 void VarManager::FillEnergyCorrelatorsUnfoldingTriple(T1 const& lepton1, T2 const& lepton2, T3 const& hadron, T4 const& track, T5 const& t1, float* values, bool applyFitMass)
 {
-  if (fgUsedVars[kMCCosChi_gen] || fgUsedVars[kMCWeight_gen] || fgUsedVars[kMCdeltaeta_gen] || fgUsedVars[kMCCosChi_rec] || fgUsedVars[kMCWeight_rec] || fgUsedVars[kMCdeltaeta_rec]) {
+  const bool* usedVars = fgUsedVars;
+  if (usedVars[kMCCosChi_gen] || usedVars[kMCWeight_gen] || usedVars[kMCdeltaeta_gen] || usedVars[kMCCosChi_rec] || usedVars[kMCWeight_rec] || usedVars[kMCdeltaeta_rec]) {
     // energy correlators
 
     float m1 = o2::constants::physics::MassElectron;
@@ -5906,7 +5962,8 @@ void VarManager::FillDileptonPhoton(T1 const& dilepton, T2 const& photon, float*
   if (!values) {
     values = fgValues;
   }
-  if (fgUsedVars[kPairMass] || fgUsedVars[kPairPt] || fgUsedVars[kPairEta] || fgUsedVars[kPairPhi]) {
+  const bool* usedVars = fgUsedVars;
+  if (usedVars[kPairMass] || usedVars[kPairPt] || usedVars[kPairEta] || usedVars[kPairPhi]) {
     ROOT::Math::PtEtaPhiMVector v1(dilepton.pt(), dilepton.eta(), dilepton.phi(), dilepton.mass());
     ROOT::Math::PtEtaPhiMVector v2(photon.pt(), photon.eta(), photon.phi(), photon.mGamma());
     ROOT::Math::PtEtaPhiMVector v12 = v1 + v2;
@@ -5984,6 +6041,7 @@ void VarManager::FillDileptonTrackTrack(T1 const& dilepton, T2 const& hadron1, T
   if (!values) {
     values = fgValues;
   }
+  const bool* usedVars = fgUsedVars;
 
   double defaultDileptonMass = 3.096;
   double hadronMass1 = o2::constants::physics::MassPionCharged;
@@ -6017,7 +6075,7 @@ void VarManager::FillDileptonTrackTrack(T1 const& dilepton, T2 const& hadron1, T
   values[kTrackDCAzProng2] = hadron2.dcaZ();
   values[kPt2] = hadron2.pt();
 
-  if (fgUsedVars[kCosthetaDileptonDitrack] || fgUsedVars[kPairMass] || fgUsedVars[kPairPt] || fgUsedVars[kDitrackPt] || fgUsedVars[kDitrackMass] || fgUsedVars[kQ] || fgUsedVars[kDeltaR1] || fgUsedVars[kDeltaR2] || fgUsedVars[kRap]) {
+  if (usedVars[kCosthetaDileptonDitrack] || usedVars[kPairMass] || usedVars[kPairPt] || usedVars[kDitrackPt] || usedVars[kDitrackMass] || usedVars[kQ] || usedVars[kDeltaR1] || usedVars[kDeltaR2] || usedVars[kRap]) {
     ROOT::Math::PtEtaPhiMVector v23 = v2 + v3;
     values[kPairMass] = v1.M();
     values[kPairPt] = v1.Pt();
@@ -6046,6 +6104,7 @@ void VarManager::FillDileptonTrackTrackVertexing(C const& collision, T1 const& l
   if (!values) {
     values = fgValues;
   }
+  const bool* usedVars = fgUsedVars;
 
   float mtrack1, mtrack2;
   float mlepton1, mlepton2;
@@ -6188,7 +6247,7 @@ void VarManager::FillDileptonTrackTrackVertexing(C const& collision, T1 const& l
       KFGeoTwoLeptons.AddDaughter(lepton1KF);
       KFGeoTwoLeptons.AddDaughter(lepton2KF);
 
-      if (fgUsedVars[kPairMass] || fgUsedVars[kPairPt]) {
+      if (usedVars[kPairMass] || usedVars[kPairPt]) {
         values[VarManager::kPairMass] = KFGeoTwoLeptons.GetMass();
         values[VarManager::kPairPt] = KFGeoTwoLeptons.GetPt();
       }
@@ -6197,7 +6256,7 @@ void VarManager::FillDileptonTrackTrackVertexing(C const& collision, T1 const& l
       KFGeoTwoTracks.AddDaughter(trk1KF);
       KFGeoTwoTracks.AddDaughter(trk2KF);
 
-      if (fgUsedVars[kDitrackMass] || fgUsedVars[kDitrackPt]) {
+      if (usedVars[kDitrackMass] || usedVars[kDitrackPt]) {
         values[VarManager::kDitrackMass] = KFGeoTwoTracks.GetMass();
         values[VarManager::kDitrackPt] = KFGeoTwoTracks.GetPt();
       }
@@ -6221,7 +6280,7 @@ void VarManager::FillDileptonTrackTrackVertexing(C const& collision, T1 const& l
       KFGeoTwoLeptons.AddDaughter(lepton1KF);
       KFGeoTwoLeptons.AddDaughter(lepton2KF);
 
-      if (fgUsedVars[kPairMass] || fgUsedVars[kPairPt]) {
+      if (usedVars[kPairMass] || usedVars[kPairPt]) {
         values[VarManager::kPairMass] = KFGeoTwoLeptons.GetMass();
         values[VarManager::kPairPt] = KFGeoTwoLeptons.GetPt();
       }
@@ -6232,7 +6291,7 @@ void VarManager::FillDileptonTrackTrackVertexing(C const& collision, T1 const& l
       KFGeoFourProng.AddDaughter(trk2KF);
     }
 
-    if (fgUsedVars[kKFMass]) {
+    if (usedVars[kKFMass]) {
       float mass = 0., massErr = 0.;
       if (!KFGeoFourProng.GetMass(mass, massErr))
         values[kKFMass] = mass;
@@ -6615,34 +6674,35 @@ void VarManager::FillTrackAlice3(T const& track, float* values)
   if (!values) {
     values = fgValues;
   }
+  const bool* usedVars = fgUsedVars;
 
   if constexpr ((fillMap & Track) > 0 || (fillMap & ReducedTrack) > 0) {
     values[kPt] = track.pt();
     values[kSignedPt] = track.pt() * track.sign();
-    if (fgUsedVars[kP]) {
+    if (usedVars[kP]) {
       values[kP] = track.p();
     }
-    if (fgUsedVars[kPx]) {
+    if (usedVars[kPx]) {
       values[kPx] = track.px();
     }
-    if (fgUsedVars[kPy]) {
+    if (usedVars[kPy]) {
       values[kPy] = track.py();
     }
-    if (fgUsedVars[kPz]) {
+    if (usedVars[kPz]) {
       values[kPz] = track.pz();
     }
-    if (fgUsedVars[kInvPt]) {
+    if (usedVars[kInvPt]) {
       values[kInvPt] = 1. / track.pt();
     }
     values[kEta] = track.eta();
     values[kPhi] = track.phi();
     values[kCharge] = track.sign();
 
-    if (fgUsedVars[kPVContributor]) {
+    if (usedVars[kPVContributor]) {
       values[kPVContributor] = (track.flags() & o2::aod::track::PVContributor) > 0;
     }
 
-    if (fgUsedVars[kITSClusterMap]) {
+    if (usedVars[kITSClusterMap]) {
       values[kITSClusterMap] = track.itsClusterMap();
     }
 
@@ -6660,16 +6720,16 @@ void VarManager::FillTrackAlice3(T const& track, float* values)
       values[kTrackDCAxy] = track.dcaXY();
       values[kTrackDCAz] = track.dcaZ();
       if constexpr ((fillMap & ReducedTrackBarrelCov) > 0) {
-        if (fgUsedVars[kTrackDCAsigXY]) {
+        if (usedVars[kTrackDCAsigXY]) {
           values[kTrackDCAsigXY] = track.dcaXY() / std::sqrt(track.cYY());
         }
-        if (fgUsedVars[kTrackDCAsigZ]) {
+        if (usedVars[kTrackDCAsigZ]) {
           values[kTrackDCAsigZ] = track.dcaZ() / std::sqrt(track.cZZ());
         }
-        if (fgUsedVars[kTrackDCAresXY]) {
+        if (usedVars[kTrackDCAresXY]) {
           values[kTrackDCAresXY] = std::sqrt(track.cYY());
         }
-        if (fgUsedVars[kTrackDCAresZ]) {
+        if (usedVars[kTrackDCAresZ]) {
           values[kTrackDCAresZ] = std::sqrt(track.cZZ());
         }
       }
@@ -6681,16 +6741,16 @@ void VarManager::FillTrackAlice3(T const& track, float* values)
     values[kTrackDCAxy] = track.dcaXY();
     values[kTrackDCAz] = track.dcaZ();
     if constexpr ((fillMap & TrackCov) > 0) {
-      if (fgUsedVars[kTrackDCAsigXY]) {
+      if (usedVars[kTrackDCAsigXY]) {
         values[kTrackDCAsigXY] = track.dcaXY() / std::sqrt(track.cYY());
       }
-      if (fgUsedVars[kTrackDCAsigZ]) {
+      if (usedVars[kTrackDCAsigZ]) {
         values[kTrackDCAsigZ] = track.dcaZ() / std::sqrt(track.cZZ());
       }
-      if (fgUsedVars[kTrackDCAresXY]) {
+      if (usedVars[kTrackDCAresXY]) {
         values[kTrackDCAresXY] = std::sqrt(track.cYY());
       }
-      if (fgUsedVars[kTrackDCAresZ]) {
+      if (usedVars[kTrackDCAresZ]) {
         values[kTrackDCAresZ] = std::sqrt(track.cZZ());
       }
     }
@@ -6768,6 +6828,7 @@ void VarManager::FillPairAlice3(T1 const& t1, T2 const& t2, float* values)
   if (!values) {
     values = fgValues;
   }
+  const bool* usedVars = fgUsedVars;
 
   float m1 = o2::constants::physics::MassElectron;
   float m2 = o2::constants::physics::MassElectron;
@@ -6813,7 +6874,7 @@ void VarManager::FillPairAlice3(T1 const& t1, T2 const& t2, float* values)
   values[kEta2] = t2.eta();
   values[kPhi2] = t2.phi();
 
-  if (fgUsedVars[kDeltaPhiPair2]) {
+  if (usedVars[kDeltaPhiPair2]) {
     double phipair2 = v1.Phi() - v2.Phi();
     if (phipair2 > 3 * TMath::Pi() / 2) {
       values[kDeltaPhiPair2] = phipair2 - 2 * TMath::Pi();
@@ -6824,17 +6885,17 @@ void VarManager::FillPairAlice3(T1 const& t1, T2 const& t2, float* values)
     }
   }
 
-  if (fgUsedVars[kDeltaEtaPair2]) {
+  if (usedVars[kDeltaEtaPair2]) {
     values[kDeltaEtaPair2] = v1.Eta() - v2.Eta();
   }
 
-  if (fgUsedVars[kPsiPair]) {
+  if (usedVars[kPsiPair]) {
     values[kDeltaPhiPair] = (t1.sign() * fgMagField > 0.) ? (v1.Phi() - v2.Phi()) : (v2.Phi() - v1.Phi());
     double xipair = TMath::ACos((v1.Px() * v2.Px() + v1.Py() * v2.Py() + v1.Pz() * v2.Pz()) / v1.P() / v2.P());
     values[kPsiPair] = (t1.sign() * fgMagField > 0.) ? TMath::ASin((v1.Theta() - v2.Theta()) / xipair) : TMath::ASin((v2.Theta() - v1.Theta()) / xipair);
   }
 
-  if (fgUsedVars[kOpeningAngle]) {
+  if (usedVars[kOpeningAngle]) {
     double scalar = v1.Px() * v2.Px() + v1.Py() * v2.Py() + v1.Pz() * v2.Pz();
     double Ptot12 = Ptot1 * Ptot2;
     if (Ptot12 <= 0) {
@@ -6850,10 +6911,10 @@ void VarManager::FillPairAlice3(T1 const& t1, T2 const& t2, float* values)
   }
 
   // polarization parameters
-  bool useHE = fgUsedVars[kCosThetaHE] || fgUsedVars[kPhiHE]; // helicity frame
-  bool useCS = fgUsedVars[kCosThetaCS] || fgUsedVars[kPhiCS]; // Collins-Soper frame
-  bool usePP = fgUsedVars[kCosThetaPP];                       // production plane frame
-  bool useRM = fgUsedVars[kCosThetaRM];                       // Random frame
+  bool useHE = usedVars[kCosThetaHE] || usedVars[kPhiHE]; // helicity frame
+  bool useCS = usedVars[kCosThetaCS] || usedVars[kPhiCS]; // Collins-Soper frame
+  bool usePP = usedVars[kCosThetaPP];                       // production plane frame
+  bool useRM = usedVars[kCosThetaRM];                       // Random frame
 
   if (useHE || useCS || usePP || useRM) {
     ROOT::Math::Boost boostv12{v12.BoostToCM()};
@@ -6869,16 +6930,16 @@ void VarManager::FillPairAlice3(T1 const& t1, T2 const& t2, float* values)
       ROOT::Math::XYZVectorF zaxis_HE{(v12.Vect()).Unit()};
       ROOT::Math::XYZVectorF yaxis_HE{(Beam1_CM.Cross(Beam2_CM)).Unit()};
       ROOT::Math::XYZVectorF xaxis_HE{(yaxis_HE.Cross(zaxis_HE)).Unit()};
-      if (fgUsedVars[kCosThetaHE])
+      if (usedVars[kCosThetaHE])
         values[kCosThetaHE] = zaxis_HE.Dot(v_CM);
-      if (fgUsedVars[kPhiHE]) {
+      if (usedVars[kPhiHE]) {
         values[kPhiHE] = TMath::ATan2(yaxis_HE.Dot(v_CM), xaxis_HE.Dot(v_CM));
         if (values[kPhiHE] < 0) {
           values[kPhiHE] += 2 * TMath::Pi(); // ensure phi is in [0, 2pi]
         }
       }
-      if (fgUsedVars[kPhiTildeHE]) {
-        if (fgUsedVars[kCosThetaHE] && fgUsedVars[kPhiHE]) {
+      if (usedVars[kPhiTildeHE]) {
+        if (usedVars[kCosThetaHE] && usedVars[kPhiHE]) {
           if (values[kCosThetaHE] > 0) {
             values[kPhiTildeHE] = values[kPhiHE] - 0.25 * TMath::Pi(); // phi_tilde = phi - pi/4
             if (values[kPhiTildeHE] < 0) {
@@ -6900,16 +6961,16 @@ void VarManager::FillPairAlice3(T1 const& t1, T2 const& t2, float* values)
       ROOT::Math::XYZVectorF zaxis_CS{(Beam1_CM - Beam2_CM).Unit()};
       ROOT::Math::XYZVectorF yaxis_CS{(Beam1_CM.Cross(Beam2_CM)).Unit()};
       ROOT::Math::XYZVectorF xaxis_CS{(yaxis_CS.Cross(zaxis_CS)).Unit()};
-      if (fgUsedVars[kCosThetaCS])
+      if (usedVars[kCosThetaCS])
         values[kCosThetaCS] = zaxis_CS.Dot(v_CM);
-      if (fgUsedVars[kPhiCS]) {
+      if (usedVars[kPhiCS]) {
         values[kPhiCS] = TMath::ATan2(yaxis_CS.Dot(v_CM), xaxis_CS.Dot(v_CM));
         if (values[kPhiCS] < 0) {
           values[kPhiCS] += 2 * TMath::Pi(); // ensure phi is in [0, 2pi]
         }
       }
-      if (fgUsedVars[kPhiTildeCS]) {
-        if (fgUsedVars[kCosThetaCS] && fgUsedVars[kPhiCS]) {
+      if (usedVars[kPhiTildeCS]) {
+        if (usedVars[kCosThetaCS] && usedVars[kPhiCS]) {
           if (values[kCosThetaCS] > 0) {
             values[kPhiTildeCS] = values[kPhiCS] - 0.25 * TMath::Pi(); // phi_tilde = phi - pi/4
             if (values[kPhiTildeCS] < 0) {
@@ -6931,17 +6992,17 @@ void VarManager::FillPairAlice3(T1 const& t1, T2 const& t2, float* values)
       ROOT::Math::XYZVector zaxis_PP = ROOT::Math::XYZVector(v12.Py(), -v12.Px(), 0.f);
       ROOT::Math::XYZVector yaxis_PP{(v12.Vect()).Unit()};
       ROOT::Math::XYZVector xaxis_PP{(yaxis_PP.Cross(zaxis_PP)).Unit()};
-      if (fgUsedVars[kCosThetaPP]) {
+      if (usedVars[kCosThetaPP]) {
         values[kCosThetaPP] = zaxis_PP.Dot(v_CM) / std::sqrt(zaxis_PP.Mag2());
       }
-      if (fgUsedVars[kPhiPP]) {
+      if (usedVars[kPhiPP]) {
         values[kPhiPP] = TMath::ATan2(yaxis_PP.Dot(v_CM), xaxis_PP.Dot(v_CM));
         if (values[kPhiPP] < 0) {
           values[kPhiPP] += 2 * TMath::Pi(); // ensure phi is in [0, 2pi]
         }
       }
-      if (fgUsedVars[kPhiTildePP]) {
-        if (fgUsedVars[kCosThetaPP] && fgUsedVars[kPhiPP]) {
+      if (usedVars[kPhiTildePP]) {
+        if (usedVars[kCosThetaPP] && usedVars[kPhiPP]) {
           if (values[kCosThetaPP] > 0) {
             values[kPhiTildePP] = values[kPhiPP] - 0.25 * TMath::Pi(); // phi_tilde = phi - pi/4
             if (values[kPhiTildePP] < 0) {
@@ -6963,14 +7024,14 @@ void VarManager::FillPairAlice3(T1 const& t1, T2 const& t2, float* values)
       double randomCostheta = gRandom->Uniform(-1., 1.);
       double randomPhi = gRandom->Uniform(0., 2. * TMath::Pi());
       ROOT::Math::XYZVectorF zaxis_RM(randomCostheta, std::sqrt(1 - randomCostheta * randomCostheta) * std::cos(randomPhi), std::sqrt(1 - randomCostheta * randomCostheta) * std::sin(randomPhi));
-      if (fgUsedVars[kCosThetaRM])
+      if (usedVars[kCosThetaRM])
         values[kCosThetaRM] = zaxis_RM.Dot(v_CM);
     }
   }
 
   if constexpr ((pairType == kDecayToEE) && ((fillMap & TrackCov) > 0 || (fillMap & ReducedTrackBarrelCov) > 0)) {
 
-    if (fgUsedVars[kQuadDCAabsXY] || fgUsedVars[kQuadDCAsigXY] || fgUsedVars[kQuadDCAabsZ] || fgUsedVars[kQuadDCAsigZ] || fgUsedVars[kQuadDCAsigXYZ] || fgUsedVars[kSignQuadDCAsigXY]) {
+    if (usedVars[kQuadDCAabsXY] || usedVars[kQuadDCAsigXY] || usedVars[kQuadDCAabsZ] || usedVars[kQuadDCAsigZ] || usedVars[kQuadDCAsigXYZ] || usedVars[kSignQuadDCAsigXY]) {
       // Quantities based on the barrel tables
       double dca1XY = t1.dcaXY();
       double dca2XY = t2.dcaXY();
@@ -7003,7 +7064,7 @@ void VarManager::FillPairAlice3(T1 const& t1, T2 const& t2, float* values)
     }
   }
   if constexpr ((pairType == kDecayToMuMu) && ((fillMap & Muon) > 0 || (fillMap & ReducedMuon) > 0)) {
-    if (fgUsedVars[kQuadDCAabsXY]) {
+    if (usedVars[kQuadDCAabsXY]) {
       double dca1X = t1.fwdDcaX();
       double dca1Y = t1.fwdDcaY();
       double dca1XY = std::sqrt(dca1X * dca1X + dca1Y * dca1Y);
@@ -7013,7 +7074,7 @@ void VarManager::FillPairAlice3(T1 const& t1, T2 const& t2, float* values)
       values[kQuadDCAabsXY] = std::sqrt((dca1XY * dca1XY + dca2XY * dca2XY) / 2.);
     }
   }
-  if (fgUsedVars[kPairPhiv]) {
+  if (usedVars[kPairPhiv]) {
     values[kPairPhiv] = calculatePhiV<pairType>(t1, t2);
   }
 }
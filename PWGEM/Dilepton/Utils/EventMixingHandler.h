@@ -15,12 +15,43 @@
 #ifndef PWGEM_DILEPTON_UTILS_EVENTMIXINGHANDLER_H_
 #define PWGEM_DILEPTON_UTILS_EVENTMIXINGHANDLER_H_
 
-#include <map>
+#include <cstddef>
+#include <functional>
+#include <span>
+#include <tuple>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
 namespace o2::aod::pwgem::dilepton::utils
 {
+// hash of the mixing bin and collision keys (tuples or pairs of integers)
+struct EventMixingKeyHash {
+  template <typename K>
+  static void combine(std::size_t& seed, const K& value)
+  {
+    seed ^= std::hash<K>{}(value) + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2);
+  }
+  template <typename... Ts>
+  std::size_t operator()(const std::tuple<Ts...>& key) const
+  {
+    std::size_t seed = 0;
+    std::apply([&seed](const auto&... values) { (combine(seed, values), ...); }, key);
+    return seed;
+  }
+  template <typename A, typename B>
+  std::size_t operator()(const std::pair<A, B>& key) const
+  {
+    std::size_t seed = 0;
+    combine(seed, key.first);
+    combine(seed, key.second);
+    return seed;
+  }
+};
+
+// Each mixing bin keeps a ring buffer of the last fNdepth collisions. The tracks of each collision are stored in a slot whose
+// buffer is recycled when the collision is evicted from its pool, so that no memory is reallocated once the pools are full.
+// Accessors return spans, valid until the next call to AddTrackToEventPool() or AddCollisionIdAtLast().
 template <typename T, typename U, typename V>
 class EventMixingHandler
 {
@@ -28,55 +59,118 @@ class EventMixingHandler
   EventMixingHandler()
   {
     fNdepth = 0;
-    fMapMixBins.clear();
-    fMap_Tracks_per_collision.clear();
   }
 
   explicit EventMixingHandler(int ndepth)
   {
     fNdepth = ndepth;
-    fMapMixBins.clear();
-    fMap_Tracks_per_collision.clear();
   }
 
-  ~EventMixingHandler()
-  {
-    fMapMixBins.clear();
-    fMap_Tracks_per_collision.clear();
-  }
+  ~EventMixingHandler() = default;
 
   void SetNdepth(int ndepth) { fNdepth = ndepth; }
 
   void ReserveNTracksPerCollision(U key_df_collision, int ntrack)
   {
-    fMap_Tracks_per_collision[key_df_collision].reserve(ntrack);
+    fSlots[GetSlot(key_df_collision)].tracks.reserve(ntrack);
   }
 
   void AddTrackToEventPool(U key_df_collision, V obj)
   {
-    fMap_Tracks_per_collision[key_df_collision].emplace_back(obj);
+    fSlots[GetSlot(key_df_collision)].tracks.emplace_back(obj);
   }
 
-  std::vector<U> GetCollisionIdsFromEventPool(T key_bin) { return fMapMixBins[key_bin]; }
-  std::vector<V> GetTracksPerCollision(T key_bin, int index) { return fMap_Tracks_per_collision[fMapMixBins[key_bin][index]]; }
-  std::vector<V> GetTracksPerCollision(U key_df_collision) { return fMap_Tracks_per_collision[key_df_collision]; }
+  // collisions in the pool of a mixing bin, from the oldest to the most recent one
+  std::span<const U> GetCollisionIdsFromEventPool(T key_bin) const
+  {
+    auto pool = fMapMixBins.find(key_bin);
+    if (pool == fMapMixBins.end()) {
+      return {};
+    }
+    return std::span<const U>(pool->second.collisions.data() + pool->second.first, pool->second.size);
+  }
+  std::span<const V> GetTracksPerCollision(T key_bin, int index) const
+  {
+    auto collisionIds = GetCollisionIdsFromEventPool(key_bin);
+    if (index < 0 || index >= static_cast<int>(collisionIds.size())) {
+      return {};
+    }
+    return GetTracksPerCollision(collisionIds[index]);
+  }
+  std::span<const V> GetTracksPerCollision(U key_df_collision) const
+  {
+    auto slot = fMapSlots.find(key_df_collision);
+    if (slot == fMapSlots.end()) {
+      return {};
+    }
+    return std::span<const V>(fSlots[slot->second].tracks);
+  }
 
   // call this function at the end of collision loop
   void AddCollisionIdAtLast(T key_bin, U key_df_collision)
   {
-    // LOGF(info, "fMapMixBins[key_bin].size() = %d", fMapMixBins[key_bin].size());
-    if (static_cast<int>(fMapMixBins[key_bin].size()) >= fNdepth) {
-      fMap_Tracks_per_collision[fMapMixBins[key_bin][0]].clear();
-      fMap_Tracks_per_collision[fMapMixBins[key_bin][0]].shrink_to_fit();
-      fMapMixBins[key_bin].erase(fMapMixBins[key_bin].begin());
+    if (fNdepth < 1) {
+      ReleaseSlot(key_df_collision);
+      return;
     }
-    fMapMixBins[key_bin].emplace_back(key_df_collision);
+    auto& pool = fMapMixBins[key_bin];
+    if (pool.collisions.empty()) {
+      // the collision keys are stored twice, so that the pool content is always contiguous in [first, first + size)
+      pool.collisions.resize(2 * fNdepth);
+    }
+    const int depth = pool.collisions.size() / 2;
+    if (pool.size >= depth) {
+      ReleaseSlot(pool.collisions[pool.first]);
+      pool.first = (pool.first + 1) % depth;
+      pool.size--;
+    }
+    const int last = (pool.first + pool.size) % depth;
+    pool.collisions[last] = key_df_collision;
+    pool.collisions[last + depth] = key_df_collision;
+    pool.size++;
   }
 
  private:
-  int fNdepth;                                           // depth of event mixing
-  std::map<T, std::vector<U>> fMapMixBins;               // map : e.g. <zbin, centbin, epbin> -> pair<df index, global collision index>
-  std::map<U, std::vector<V>> fMap_Tracks_per_collision; // map : e.g. pair<df index, global collision index> -> track array
+  struct EventPool {
+    std::vector<U> collisions; // ring buffer of 2 x depth collision keys, each key written at index i and i + depth
+    int first = 0;             // index of the oldest collision
+    int size = 0;              // number of collisions in the pool
+  };
+  struct TrackSlot {
+    std::vector<V> tracks; // tracks of one collision
+  };
+
+  int GetSlot(const U& key_df_collision)
+  {
+    auto [slot, inserted] = fMapSlots.try_emplace(key_df_collision, 0);
+    if (inserted) {
+      if (fFreeSlots.empty()) {
+        slot->second = fSlots.size();
+        fSlots.emplace_back();
+      } else {
+        slot->second = fFreeSlots.back();
+        fFreeSlots.pop_back();
+      }
+    }
+    return slot->second;
+  }
+
+  void ReleaseSlot(const U& key_df_collision)
+  {
+    auto slot = fMapSlots.find(key_df_collision);
+    if (slot == fMapSlots.end()) {
+      return;
+    }
+    fSlots[slot->second].tracks.clear(); // keep the capacity for the next collision using this slot
+    fFreeSlots.emplace_back(slot->second);
+    fMapSlots.erase(slot);
+  }
+
+  int fNdepth;                                                      // depth of event mixing
+  std::unordered_map<T, EventPool, EventMixingKeyHash> fMapMixBins; // map : e.g. <zbin, centbin, epbin> -> ring buffer of pair<df index, global collision index>
+  std::unordered_map<U, int, EventMixingKeyHash> fMapSlots;         // map : e.g. pair<df index, global collision index> -> track slot
+  std::vector<TrackSlot> fSlots;                                    // track arrays of all collisions, reused after eviction
+  std::vector<int> fFreeSlots;                                      // indices of the slots available for new collisions
 };
 } // namespace o2::aod::pwgem::dilepton::utils
 #endif // PWGEM_DILEPTON_UTILS_EVENTMIXINGHANDLER_H_
@@ -32,6 +32,7 @@
 #include "PWGLF/DataModel/LFStrangenessTables.h"
 
 #include "Common/CCDB/TriggerAliases.h"
+#include "Common/Core/DcaFitterPreFilter.h"
 #include "Common/Core/RecoDecay.h"
 #include "Common/Core/TrackSelectorPID.h"
 #include "Common/Core/ZorroSummary.h"
@@ -78,12 +79,14 @@
 
 #include <algorithm> // std::find
 #include <array>
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
 #include <cstdlib>
 #include <iterator> // std::distance
 #include <numeric>
 #include <string>  // std::string
+#include <thread>
 #include <utility> // std::forward
 #include <vector>  // std::vector
 
@@ -1413,6 +1416,9 @@ struct HfTrackIndexSkimCreator {
     Configurable<double> maxDZIni{"maxDZIni", 4., "reject (if>0) PCA candidate if tracks DZ exceeds threshold"};
     Configurable<double> minParamChange{"minParamChange", 1.e-3, "stop iterations if largest change of any X is smaller than this"};
     Configurable<double> minRelChi2Change{"minRelChi2Change", 0.9, "stop iterations if chi2/chi2old > this"};
+    Configurable<bool> applyDcaFitterPreFilter{"applyDcaFitterPreFilter", false, "reject track pairs for which the vertex fitter cannot find a seed before calling it"};
+    Configurable<float> dcaFitterPreFilterTolerance{"dcaFitterPreFilterTolerance", 0.5f, "margin (cm) added to the fitter cuts in the pre-filter"};
+    Configurable<int> nThreads{"nThreads", 1, "number of threads for the 2- and 3-prong vertexing, > 1 only without PV refit, debug, ML for HF filters and histograms"};
     // CCDB
     Configurable<std::string> ccdbUrl{"ccdbUrl", "http://alice-ccdb.cern.ch", "url of the ccdb repository"};
     Configurable<std::string> ccdbPathLut{"ccdbPathLut", "GLO/Param/MatLUT", "Path for LUT parametrization"};
@@ -1481,8 +1487,9 @@ struct HfTrackIndexSkimCreator {
   } config;
 
   SliceCache cache;
-  o2::vertexing::DCAFitterN<2> df2; // 2-prong vertex fitter
-  o2::vertexing::DCAFitterN<3> df3; // 3-prong vertex fitter
+  o2::vertexing::DCAFitterN<2> df2;                        // 2-prong vertex fitter, configured in init and copied to the workers
+  o2::vertexing::DCAFitterN<3> df3;                        // 3-prong vertex fitter, configured in init and copied to the workers
+  o2::common::core::DcaFitterPreFilter dcaFitterPreFilter; // geometric pre-filter of the track pairs seeding df2 and df3
   // Needed for PV refitting
   Service<o2::ccdb::BasicCCDBManager> ccdb{};
   o2::base::MatLayerCylSet* lut{};
@@ -1505,6 +1512,83 @@ struct HfTrackIndexSkimCreator {
   std::array<LabeledArray<double>, kN3ProngDecays> cut3Prong{};
   std::array<std::vector<double>, kN3ProngDecays> binsPt3Prong{};
 
+  // track parameters at the primary vertex of the current collision, one entry per track of a collision slice
+  struct TrackParCache {
+    std::vector<o2::track::TrackParCov> trackParVar; // re-propagated to the PV if the track belongs to another collision
+    std::vector<std::array<float, 3>> pVec;
+    std::vector<std::array<float, 2>> dcaInfo;
+    std::vector<uint32_t> isSelProng;
+    std::vector<uint32_t> isIdentifiedPid;
+
+    void clear()
+    {
+      trackParVar.clear();
+      pVec.clear();
+      dcaInfo.clear();
+      isSelProng.clear();
+      isIdentifiedPid.clear();
+    }
+  };
+  struct CollisionTrackPars {
+    TrackParCache trackParPos{};         // positive tracks for 2- and 3-prongs
+    TrackParCache trackParNeg{};         // negative tracks for 2- and 3-prongs
+    TrackParCache trackParSoftPionPos{}; // positive soft pions for D*
+    TrackParCache trackParSoftPionNeg{}; // negative soft pions for D*
+  };
+
+  // inputs of the combinatorics of a collision, retrieved sequentially
+  template <typename TCollision, typename TTrackIndices>
+  struct CollisionInput {
+    TCollision collision;
+    TTrackIndices groupedTrackIndicesPos;
+    TTrackIndices groupedTrackIndicesNeg;
+    TTrackIndices groupedTrackIndicesSoftPionsPos;
+    TTrackIndices groupedTrackIndicesSoftPionsNeg;
+    float bz; // nominal magnetic field for the fitters
+  };
+
+  // candidates of a collision, filled in the track-index tables in collision order
+  struct CombinatoricsOutput {
+    struct Prong2 {
+      int64_t collisionId;
+      int64_t prong0Id;
+      int64_t prong1Id;
+      uint32_t flag;
+    };
+    struct Prong3 {
+      int64_t collisionId;
+      int64_t prong0Id;
+      int64_t prong1Id;
+      int64_t prong2Id;
+      uint32_t flag;
+    };
+    struct Dstar {
+      int64_t collisionId;
+      int64_t softPionId;
+      int indexProng2; // index of the D0 among the 2-prongs of the collision
+    };
+    std::vector<Prong2> prong2;
+    std::vector<Prong3> prong3;
+    std::vector<Dstar> dstar;
+
+    void clear()
+    {
+      prong2.clear();
+      prong3.clear();
+      dstar.clear();
+    }
+  };
+
+  // fitters and buffers of a thread of the combinatorics, the sequential mode uses the first one
+  struct CombinatoricsWorker {
+    o2::vertexing::DCAFitterN<2> df2;
+    o2::vertexing::DCAFitterN<3> df3;
+    o2::common::core::DcaFitterPreFilter dcaFitterPreFilter;
+    CollisionTrackPars trackPars{};
+    CombinatoricsOutput output{};
+  };
+  std::vector<CombinatoricsWorker> workers;
+
   // ML response
   o2::analysis::MlResponse<float> hfMlResponse2Prongs;                               // only D0
   std::array<o2::analysis::MlResponse<float>, kN3ProngDecays> hfMlResponse3Prongs{}; // D+, Lc, Ds, Xic
@@ -1599,6 +1683,13 @@ struct HfTrackIndexSkimCreator {
     df3.setUseAbsDCA(config.useAbsDCA);
     df3.setWeightedFinalPCA(config.useWeightedFinalPCA);
 
+    dcaFitterPreFilter.setTolerance(config.dcaFitterPreFilterTolerance);
+
+    if (config.nThreads > 1 && (doprocess2And3ProngsWithPvRefit || doprocess2And3ProngsWithPvRefitWithPidForHfFiltersBdt || config.debug || config.applyMlForHfFilters || config.fillHistograms)) {
+      LOG(fatal) << "Multi-threaded vertexing (nThreads > 1) not supported with PV refit, debug mode, ML for HF filters or histograms";
+    }
+    workers.assign(std::max(1, config.nThreads.value), CombinatoricsWorker{df2, df3, dcaFitterPreFilter});
+
     ccdb->setURL(config.ccdbUrl);
     ccdb->setCaching(true);
     ccdb->setLocalObjectValidityChecking();
@@ -1633,6 +1724,14 @@ struct HfTrackIndexSkimCreator {
       registry.add("hMassCtToTrKPi", "C Triton candidates;inv. mass (Tr K #pi) (GeV/#it{c}^{2});entries", {HistType::kTH1D, {{500, 0., 5.}}});
       registry.add("hMassChToHeKPi", "C Helium3 candidates;inv. mass (He3 K #pi) (GeV/#it{c}^{2});entries", {HistType::kTH1D, {{500, 0., 5.}}});
       registry.add("hMassCaToAlKPi", "C Alpha candidates;inv. mass (Alpha K #pi) (GeV/#it{c}^{2});entries", {HistType::kTH1D, {{500, 2., 7.}}});
+      // vertex fitter pre-filter
+      if (config.applyDcaFitterPreFilter) {
+        registry.add("hDcaFitterPreFilter", "track pairs before vertex fit;;entries", {HistType::kTH1D, {{o2::common::core::DcaFitterPreFilter::NStatus, -0.5, o2::common::core::DcaFitterPreFilter::NStatus - 0.5}}});
+        registry.get<TH1>(HIST("hDcaFitterPreFilter"))->GetXaxis()->SetBinLabel(1, "accepted");
+        registry.get<TH1>(HIST("hDcaFitterPreFilter"))->GetXaxis()->SetBinLabel(2, "rejected DXY");
+        registry.get<TH1>(HIST("hDcaFitterPreFilter"))->GetXaxis()->SetBinLabel(3, "rejected R");
+        registry.get<TH1>(HIST("hDcaFitterPreFilter"))->GetXaxis()->SetBinLabel(4, "rejected DZ");
+      }
 
       // needed for PV refitting
       if (doprocess2And3ProngsWithPvRefit || doprocess2And3ProngsWithPvRefitWithPidForHfFiltersBdt) {
@@ -2287,406 +2386,261 @@ struct HfTrackIndexSkimCreator {
 
   } /// end of performPvRefitCandProngs function
 
-  template <bool DoPvRefit, bool UsePidForHfFiltersBdt, typename TTracks>
-  void run2And3Prongs(SelectedCollisions const& collisions,
-                      aod::BCsWithTimestamps const& bcWithTimeStamps,
-                      FilteredTrackAssocSel const&,
-                      TTracks const& tracks)
+  /// Fills the cache with the parameters at the primary vertex of the tracks of a collision slice,
+  /// so that each track is propagated at most once per collision in the combinatorics
+  template <typename TTracks, typename TTrackIndices, typename TCollision>
+  void fillTrackParCache(TrackParCache& trackParCache, TTrackIndices const& trackIndices, TCollision const& collision)
   {
-
-    // can be added to run over limited collisions per file - for tesing purposes
-    /*
-    if (nCollsMax > -1){
-      if (nColls == nCollMax){
-        return;
-        //can be added to run over limited collisions per file - for tesing purposes
+    trackParCache.clear();
+    for (const auto& trackIndex : trackIndices) {
+      const auto track = trackIndex.template track_as<TTracks>();
+      auto trackParVar = getTrackParCov(track);
+      std::array pVecTrack{track.pVector()};
+      std::array dcaInfo{track.dcaXY(), track.dcaZ()};
+      if (collision.globalIndex() != track.collisionId()) { // this is not the "default" collision for this track, we have to re-propagate it
+        o2::base::Propagator::Instance()->propagateToDCABxByBz({collision.posX(), collision.posY(), collision.posZ()}, trackParVar, 2.f, noMatCorr, &dcaInfo);
+        getPxPyPz(trackParVar, pVecTrack);
       }
-      nColls++;
+      trackParCache.trackParVar.push_back(trackParVar);
+      trackParCache.pVec.push_back(pVecTrack);
+      trackParCache.dcaInfo.push_back(dcaInfo);
+      trackParCache.isSelProng.push_back(trackIndex.isSelProng());
+      trackParCache.isIdentifiedPid.push_back(trackIndex.isIdentifiedPid());
     }
-    */
-
-    for (const auto& collision : collisions) {
+  }
 
-      /// retrieve PV contributors for the current collision
-      std::vector<int64_t> vecPvContributorGlobId{};
-      std::vector<o2::track::TrackParCov> vecPvContributorTrackParCov{};
-      std::vector<bool> vecPvRefitContributorUsed{};
-      if constexpr (DoPvRefit) {
-        auto groupedTracksUnfiltered = tracks.sliceBy(tracksPerCollision, collision.globalIndex());
-        const int nTrk = groupedTracksUnfiltered.size();
-        int nContrib = 0;
-        int nNonContrib = 0;
-        for (const auto& trackUnfiltered : groupedTracksUnfiltered) {
-          if (!trackUnfiltered.isPVContributor()) {
-            /// the track did not contribute to fit the primary vertex
-            nNonContrib++;
-            continue;
-          }
-          vecPvContributorGlobId.push_back(trackUnfiltered.globalIndex());
-          vecPvContributorTrackParCov.push_back(getTrackParCov(trackUnfiltered));
-          nContrib++;
-          if (config.debugPvRefit) {
-            LOG(info) << "---> a contributor! stuff saved";
-            LOG(info) << "vec_contrib size: " << vecPvContributorTrackParCov.size() << ", nContrib: " << nContrib;
-          }
-        }
-        if (config.debugPvRefit) {
-          LOG(info) << "===> nTrk: " << nTrk << ",   nContrib: " << nContrib << ",   nNonContrib: " << nNonContrib;
-          if (static_cast<uint16_t>(vecPvContributorTrackParCov.size()) != collision.numContrib() || static_cast<uint16_t>(nContrib != collision.numContrib())) {
-            LOG(info) << "!!! Some problem here !!! vecPvContributorTrackParCov.size()= " << vecPvContributorTrackParCov.size() << ", nContrib=" << nContrib << ", collision.numContrib()" << collision.numContrib();
-          }
-        }
-        vecPvRefitContributorUsed = std::vector<bool>(vecPvContributorGlobId.size(), true);
-      }
+  /// Checks with the geometric pre-filter whether the vertex fitter can find a seed for a track pair
+  /// \param preFilter pre-filter of the current worker
+  /// \param trackParVar0 parameters of the first track of the fit
+  /// \param trackParVar1 parameters of the second track of the fit
+  /// \return true if the pair has to be fitted
+  bool isSelectedByDcaFitterPreFilter(o2::common::core::DcaFitterPreFilter& preFilter, o2::track::TrackParCov const& trackParVar0, o2::track::TrackParCov const& trackParVar1)
+  {
+    if (!config.applyDcaFitterPreFilter) {
+      return true;
+    }
+    const auto status = preFilter.check(trackParVar0, trackParVar1);
+    if (config.fillHistograms) {
+      registry.fill(HIST("hDcaFitterPreFilter"), status);
+    }
+    return status == o2::common::core::DcaFitterPreFilter::Accepted;
+  }
 
-      // auto centrality = collision.centV0M(); //FIXME add centrality when option for variations to the process function appears
+  /// Retrieves the magnetic field and the track slices of a collision and propagates its tracks to the PV
+  /// \param collision collision
+  /// \param trackPars track parameters to be filled
+  /// \return inputs of the combinatorics of the collision
+  template <typename TTracks, typename TCollision>
+  auto prepare2And3Prongs(TCollision const& collision, CollisionTrackPars& trackPars)
+  {
+    // set the magnetic field from CCDB
+    const auto bc = collision.template bc_as<o2::aod::BCsWithTimestamps>();
+    initCCDB(bc, runNumber, ccdb, config.isRun2 ? config.ccdbPathGrp : config.ccdbPathGrpMag, lut, config.isRun2);
 
-      const auto n2ProngBit = BIT(kN2ProngDecays) - 1; // bit value for 2-prong candidates where each candidate is one bit and they are all set to 1
-      const auto n3ProngBit = BIT(kN3ProngDecays) - 1; // bit value for 3-prong candidates where each candidate is one bit and they are all set to 1
+    // parameters at the PV of all the tracks of this collision, the combinatorics only reads them
+    auto groupedTrackIndicesPos = positiveFor2And3Prongs->sliceByCached(aod::track::collisionId, collision.globalIndex(), cache);
+    auto groupedTrackIndicesNeg = negativeFor2And3Prongs->sliceByCached(aod::track::collisionId, collision.globalIndex(), cache);
+    auto groupedTrackIndicesSoftPionsPos = positiveSoftPions->sliceByCached(aod::track::collisionId, collision.globalIndex(), cache);
+    auto groupedTrackIndicesSoftPionsNeg = negativeSoftPions->sliceByCached(aod::track::collisionId, collision.globalIndex(), cache);
+    fillTrackParCache<TTracks>(trackPars.trackParPos, groupedTrackIndicesPos, collision);
+    fillTrackParCache<TTracks>(trackPars.trackParNeg, groupedTrackIndicesNeg, collision);
+    if (config.doDstar) {
+      fillTrackParCache<TTracks>(trackPars.trackParSoftPionPos, groupedTrackIndicesSoftPionsPos, collision);
+      fillTrackParCache<TTracks>(trackPars.trackParSoftPionNeg, groupedTrackIndicesSoftPionsNeg, collision);
+    }
+    return CollisionInput<TCollision, decltype(groupedTrackIndicesPos)>{collision, groupedTrackIndicesPos, groupedTrackIndicesNeg, groupedTrackIndicesSoftPionsPos, groupedTrackIndicesSoftPionsNeg, o2::base::Propagator::Instance()->getNominalBz()};
+  }
 
-      std::array<std::vector<bool>, kN2ProngDecays> cutStatus2Prong{};
-      std::array<std::vector<bool>, kN3ProngDecays> cutStatus3Prong{};
-      uint8_t nCutStatus2ProngBit[kN2ProngDecays]; // bit value for selection status for each 2-prong candidate where each selection is one bit and they are all set to 1
-      uint8_t nCutStatus3ProngBit[kN3ProngDecays]; // bit value for selection status for each 3-prong candidate where each selection is one bit and they are all set to 1
+  /// Fills the track-index tables with the candidates of a collision
+  /// \param output candidates of the collision, cleared afterwards
+  void fillTrackIndexTables(CombinatoricsOutput& output)
+  {
+    const int indexFirstProng2 = rowTrackIndexProng2.lastIndex() + 1;
+    for (const auto& cand : output.prong2) {
+      rowTrackIndexProng2(cand.collisionId, cand.prong0Id, cand.prong1Id, cand.flag);
+    }
+    for (const auto& cand : output.prong3) {
+      rowTrackIndexProng3(cand.collisionId, cand.prong0Id, cand.prong1Id, cand.prong2Id, cand.flag);
+    }
+    for (const auto& cand : output.dstar) {
+      rowTrackIndexDstar(cand.collisionId, cand.softPionId, cand.indexProng2 < 0 ? cand.indexProng2 : indexFirstProng2 + cand.indexProng2);
+    }
+    output.clear();
+  }
 
-      for (int iDecay2P = 0; iDecay2P < kN2ProngDecays; iDecay2P++) {
-        nCutStatus2ProngBit[iDecay2P] = BIT(kNCuts2Prong[iDecay2P]) - 1;
-        cutStatus2Prong[iDecay2P] = std::vector<bool>(kNCuts2Prong[iDecay2P], true);
+  /// 2-prong, 3-prong and D* combinatorics of a collision
+  /// \param input magnetic field and track slices of the collision
+  /// \param tracks tracks
+  /// \param trackPars parameters at the PV of the tracks of the collision
+  /// \param worker fitters to be used
+  /// \param output candidates of the collision
+  template <bool DoPvRefit, bool UsePidForHfFiltersBdt, typename TTracks, typename TCollisionInput>
+  void run2And3ProngsInCollision(TCollisionInput const& input,
+                                 TTracks const& tracks,
+                                 CollisionTrackPars const& trackPars,
+                                 CombinatoricsWorker& worker,
+                                 CombinatoricsOutput& output)
+  {
+    const auto& collision = input.collision;
+    const auto& [trackParPos, trackParNeg, trackParSoftPionPos, trackParSoftPionNeg] = trackPars;
+
+    /// retrieve PV contributors for the current collision
+    std::vector<int64_t> vecPvContributorGlobId{};
+    std::vector<o2::track::TrackParCov> vecPvContributorTrackParCov{};
+    std::vector<bool> vecPvRefitContributorUsed{};
+    if constexpr (DoPvRefit) {
+      auto groupedTracksUnfiltered = tracks.sliceBy(tracksPerCollision, collision.globalIndex());
+      const int nTrk = groupedTracksUnfiltered.size();
+      int nContrib = 0;
+      int nNonContrib = 0;
+      for (const auto& trackUnfiltered : groupedTracksUnfiltered) {
+        if (!trackUnfiltered.isPVContributor()) {
+          /// the track did not contribute to fit the primary vertex
+          nNonContrib++;
+          continue;
+        }
+        vecPvContributorGlobId.push_back(trackUnfiltered.globalIndex());
+        vecPvContributorTrackParCov.push_back(getTrackParCov(trackUnfiltered));
+        nContrib++;
+        if (config.debugPvRefit) {
+          LOG(info) << "---> a contributor! stuff saved";
+          LOG(info) << "vec_contrib size: " << vecPvContributorTrackParCov.size() << ", nContrib: " << nContrib;
+        }
       }
-      for (int iDecay3P = 0; iDecay3P < kN3ProngDecays; iDecay3P++) {
-        nCutStatus3ProngBit[iDecay3P] = BIT(kNCuts3Prong[iDecay3P]) - 1;
-        cutStatus3Prong[iDecay3P] = std::vector<bool>(kNCuts3Prong[iDecay3P], true);
+      if (config.debugPvRefit) {
+        LOG(info) << "===> nTrk: " << nTrk << ",   nContrib: " << nContrib << ",   nNonContrib: " << nNonContrib;
+        if (static_cast<uint16_t>(vecPvContributorTrackParCov.size()) != collision.numContrib() || static_cast<uint16_t>(nContrib != collision.numContrib())) {
+          LOG(info) << "!!! Some problem here !!! vecPvContributorTrackParCov.size()= " << vecPvContributorTrackParCov.size() << ", nContrib=" << nContrib << ", collision.numContrib()" << collision.numContrib();
+        }
       }
+      vecPvRefitContributorUsed = std::vector<bool>(vecPvContributorGlobId.size(), true);
+    }
 
-      int whichHypo2Prong[kN2ProngDecays + 1]; // we also put D0 for D* in the last slot
-      int whichHypo3Prong[kN3ProngDecays];
+    // auto centrality = collision.centV0M(); //FIXME add centrality when option for variations to the process function appears
 
-      // set the magnetic field from CCDB
-      const auto bc = collision.bc_as<o2::aod::BCsWithTimestamps>();
-      initCCDB(bc, runNumber, ccdb, config.isRun2 ? config.ccdbPathGrp : config.ccdbPathGrpMag, lut, config.isRun2);
-      df2.setBz(o2::base::Propagator::Instance()->getNominalBz());
-      df3.setBz(o2::base::Propagator::Instance()->getNominalBz());
+    const auto n2ProngBit = BIT(kN2ProngDecays) - 1; // bit value for 2-prong candidates where each candidate is one bit and they are all set to 1
+    const auto n3ProngBit = BIT(kN3ProngDecays) - 1; // bit value for 3-prong candidates where each candidate is one bit and they are all set to 1
 
-      // used to calculate number of candidiates per event
-      auto nCand2 = rowTrackIndexProng2.lastIndex();
-      auto nCand3 = rowTrackIndexProng3.lastIndex();
+    std::array<std::vector<bool>, kN2ProngDecays> cutStatus2Prong{};
+    std::array<std::vector<bool>, kN3ProngDecays> cutStatus3Prong{};
+    uint8_t nCutStatus2ProngBit[kN2ProngDecays]; // bit value for selection status for each 2-prong candidate where each selection is one bit and they are all set to 1
+    uint8_t nCutStatus3ProngBit[kN3ProngDecays]; // bit value for selection status for each 3-prong candidate where each selection is one bit and they are all set to 1
 
-      // if there isn't at least a positive and a negative track, continue immediately
-      // if (tracksPos.size() < 1 || tracksNeg.size() < 1) {
-      //  return;
-      //}
+    for (int iDecay2P = 0; iDecay2P < kN2ProngDecays; iDecay2P++) {
+      nCutStatus2ProngBit[iDecay2P] = BIT(kNCuts2Prong[iDecay2P]) - 1;
+      cutStatus2Prong[iDecay2P] = std::vector<bool>(kNCuts2Prong[iDecay2P], true);
+    }
+    for (int iDecay3P = 0; iDecay3P < kN3ProngDecays; iDecay3P++) {
+      nCutStatus3ProngBit[iDecay3P] = BIT(kNCuts3Prong[iDecay3P]) - 1;
+      cutStatus3Prong[iDecay3P] = std::vector<bool>(kNCuts3Prong[iDecay3P], true);
+    }
 
-      const auto thisCollId = collision.globalIndex();
+    int whichHypo2Prong[kN2ProngDecays + 1]; // we also put D0 for D* in the last slot
+    int whichHypo3Prong[kN3ProngDecays];
 
-      // first loop over positive tracks
-      const auto groupedTrackIndicesPos1 = positiveFor2And3Prongs->sliceByCached(aod::track::collisionId, collision.globalIndex(), cache);
-      int lastFilledD0 = -1; // index to be filled in table for D* mesons
-      for (auto trackIndexPos1 = groupedTrackIndicesPos1.begin(); trackIndexPos1 != groupedTrackIndicesPos1.end(); ++trackIndexPos1) {
-        const auto trackPos1 = trackIndexPos1.template track_as<TTracks>();
+    // set the magnetic field retrieved from CCDB
+    worker.df2.setBz(input.bz);
+    worker.df3.setBz(input.bz);
+    worker.dcaFitterPreFilter.setFromFitter(worker.df2);
 
-        // retrieve the selection flag that corresponds to this collision
-        const auto isSelProngPos1 = trackIndexPos1.isSelProng();
-        const bool sel2ProngStatusPos = TESTBIT(isSelProngPos1, CandidateType::Cand2Prong);
-        const bool sel3ProngStatusPos1 = TESTBIT(isSelProngPos1, CandidateType::Cand3Prong);
-
-        auto trackParVarPos1 = getTrackParCov(trackPos1);
-        std::array pVecTrackPos1{trackPos1.pVector()};
-        std::array dcaInfoPos1{trackPos1.dcaXY(), trackPos1.dcaZ()};
-        if (thisCollId != trackPos1.collisionId()) { // this is not the "default" collision for this track, we have to re-propagate it
-          o2::base::Propagator::Instance()->propagateToDCABxByBz({collision.posX(), collision.posY(), collision.posZ()}, trackParVarPos1, 2.f, noMatCorr, &dcaInfoPos1);
-          getPxPyPz(trackParVarPos1, pVecTrackPos1);
-        }
+    // if there isn't at least a positive and a negative track, continue immediately
+    // if (tracksPos.size() < 1 || tracksNeg.size() < 1) {
+    //  return;
+    //}
 
-        // first loop over negative tracks
-        const auto groupedTrackIndicesNeg1 = negativeFor2And3Prongs->sliceByCached(aod::track::collisionId, collision.globalIndex(), cache);
-        for (auto trackIndexNeg1 = groupedTrackIndicesNeg1.begin(); trackIndexNeg1 != groupedTrackIndicesNeg1.end(); ++trackIndexNeg1) {
-          const auto trackNeg1 = trackIndexNeg1.template track_as<TTracks>();
-
-          // retrieve the selection flag that corresponds to this collision
-          const auto isSelProngNeg1 = trackIndexNeg1.isSelProng();
-          const bool sel2ProngStatusNeg = TESTBIT(isSelProngNeg1, CandidateType::Cand2Prong);
-          const bool sel3ProngStatusNeg1 = TESTBIT(isSelProngNeg1, CandidateType::Cand3Prong);
-
-          auto trackParVarNeg1 = getTrackParCov(trackNeg1);
-          std::array pVecTrackNeg1{trackNeg1.pVector()};
-          std::array dcaInfoNeg1{trackNeg1.dcaXY(), trackNeg1.dcaZ()};
-          if (thisCollId != trackNeg1.collisionId()) { // this is not the "default" collision for this track, we have to re-propagate it
-            o2::base::Propagator::Instance()->propagateToDCABxByBz({collision.posX(), collision.posY(), collision.posZ()}, trackParVarNeg1, 2.f, noMatCorr, &dcaInfoNeg1);
-            getPxPyPz(trackParVarNeg1, pVecTrackNeg1);
-          }
+    const auto thisCollId = collision.globalIndex();
 
-          uint isSelected2ProngCand = n2ProngBit; // bitmap for checking status of two-prong candidates (1 is true, 0 is rejected)
+    const auto& groupedTrackIndicesPos1 = input.groupedTrackIndicesPos;
+    const auto& groupedTrackIndicesNeg1 = input.groupedTrackIndicesNeg;
 
-          if (config.debug) {
-            for (int iDecay2P = 0; iDecay2P < kN2ProngDecays; iDecay2P++) {
-              for (int iCut = 0; iCut < kNCuts2Prong[iDecay2P]; iCut++) {
-                cutStatus2Prong[iDecay2P][iCut] = true;
-              }
-            }
-          }
+    // first loop over positive tracks
+    int lastFilledD0 = -1; // index of the D0 among the 2-prongs of this collision, for D* mesons
+    int iPos1 = 0;
+    for (auto trackIndexPos1 = groupedTrackIndicesPos1.begin(); trackIndexPos1 != groupedTrackIndicesPos1.end(); ++trackIndexPos1, ++iPos1) {
+      const auto trackPos1 = trackIndexPos1.template track_as<TTracks>();
 
-          // initialise PV refit coordinates and cov matrix for 2-prongs already here for D*
-          std::array pvRefitCoord2Prong = {collision.posX(), collision.posY(), collision.posZ()}; /// initialize to the original PV
-          std::array pvRefitCovMatrix2Prong = getPrimaryVertex(collision).getCov();               /// initialize to the original PV
+      // retrieve the selection flag that corresponds to this collision
+      const auto isSelProngPos1 = trackParPos.isSelProng[iPos1];
+      const bool sel2ProngStatusPos = TESTBIT(isSelProngPos1, CandidateType::Cand2Prong);
+      const bool sel3ProngStatusPos1 = TESTBIT(isSelProngPos1, CandidateType::Cand3Prong);
 
-          // 2-prong vertex reconstruction
-          float pt2Prong{-1.};
-          bool is2ProngCandidateGoodFor3Prong{sel3ProngStatusPos1 && sel3ProngStatusNeg1};
-          int nVtxFrom2ProngFitter = 0;
-          if (sel2ProngStatusPos && sel2ProngStatusNeg) {
+      const auto& trackParVarPos1 = trackParPos.trackParVar[iPos1];
+      const auto& pVecTrackPos1 = trackParPos.pVec[iPos1];
+      const auto& dcaInfoPos1 = trackParPos.dcaInfo[iPos1];
 
-            // 2-prong preselections
-            // TODO: in case of PV refit, the single-track DCA is calculated wrt two different PV vertices (only 1 track excluded)
-            applyPreselection2Prong(pVecTrackPos1, pVecTrackNeg1, dcaInfoPos1[0], dcaInfoNeg1[0], cutStatus2Prong, whichHypo2Prong, isSelected2ProngCand, pt2Prong);
+      // first loop over negative tracks
+      int iNeg1 = 0;
+      for (auto trackIndexNeg1 = groupedTrackIndicesNeg1.begin(); trackIndexNeg1 != groupedTrackIndicesNeg1.end(); ++trackIndexNeg1, ++iNeg1) {
+        const auto trackNeg1 = trackIndexNeg1.template track_as<TTracks>();
 
-            if (isSelected2ProngCand > 0) {
-              // secondary vertex reconstruction and further 2-prong selections
-              try {
-                nVtxFrom2ProngFitter = df2.process(trackParVarPos1, trackParVarNeg1);
-              } catch (...) {
-              }
+        // retrieve the selection flag that corresponds to this collision
+        const auto isSelProngNeg1 = trackParNeg.isSelProng[iNeg1];
+        const bool sel2ProngStatusNeg = TESTBIT(isSelProngNeg1, CandidateType::Cand2Prong);
+        const bool sel3ProngStatusNeg1 = TESTBIT(isSelProngNeg1, CandidateType::Cand3Prong);
 
-              if (nVtxFrom2ProngFitter > 0) { // should it be this or > 0 or are they equivalent
-                // get secondary vertex
-                const auto& secondaryVertex2 = df2.getPCACandidate();
-                // get track momenta
-                std::array<float, 3> pvec0{};
-                std::array<float, 3> pvec1{};
-                df2.getTrack(0).getPxPyPzGlo(pvec0);
-                df2.getTrack(1).getPxPyPzGlo(pvec1);
+        const auto& trackParVarNeg1 = trackParNeg.trackParVar[iNeg1];
+        const auto& pVecTrackNeg1 = trackParNeg.pVec[iNeg1];
+        const auto& dcaInfoNeg1 = trackParNeg.dcaInfo[iNeg1];
 
-                /// PV refit excluding the candidate daughters, if contributors
-                if constexpr (DoPvRefit) {
-                  if (config.fillHistograms) {
-                    registry.fill(HIST("PvRefit/verticesPerCandidate"), 1);
-                  }
-                  int nCandContr = 2;
-                  auto trackFirstIt = std::find(vecPvContributorGlobId.begin(), vecPvContributorGlobId.end(), trackPos1.globalIndex());
-                  auto trackSecondIt = std::find(vecPvContributorGlobId.begin(), vecPvContributorGlobId.end(), trackNeg1.globalIndex());
-                  bool isTrackFirstContr = true;
-                  bool isTrackSecondContr = true;
-                  if (trackFirstIt == vecPvContributorGlobId.end()) {
-                    /// This track did not contribute to the original PV refit
-                    if (config.debugPvRefit) {
-                      LOG(info) << "--- [2 Prong] trackPos1 with globalIndex " << trackPos1.globalIndex() << " was not a PV contributor";
-                    }
-                    nCandContr--;
-                    isTrackFirstContr = false;
-                  }
-                  if (trackSecondIt == vecPvContributorGlobId.end()) {
-                    /// This track did not contribute to the original PV refit
-                    if (config.debugPvRefit) {
-                      LOG(info) << "--- [2 Prong] trackNeg1 with globalIndex " << trackNeg1.globalIndex() << " was not a PV contributor";
-                    }
-                    nCandContr--;
-                    isTrackSecondContr = false;
-                  }
-                  if (nCandContr == 2) { // o2-linter: disable="magic-number" (see comment below)
-                    /// Both the daughter tracks were used for the original PV refit, let's refit it after excluding them
-                    if (config.debugPvRefit) {
-                      LOG(info) << "### [2 Prong] Calling performPvRefitCandProngs for HF 2 prong candidate";
-                    }
-                    performPvRefitCandProngs(collision, bcWithTimeStamps, vecPvContributorGlobId, vecPvContributorTrackParCov, {trackPos1.globalIndex(), trackNeg1.globalIndex()}, pvRefitCoord2Prong, pvRefitCovMatrix2Prong);
-                  } else if (nCandContr == 1) {
-                    /// Only one daughter was a contributor, let's use then the PV recalculated by excluding only it
-                    if (config.debugPvRefit) {
-                      LOG(info) << "####### [2 Prong] nCandContr==" << nCandContr << " ---> just 1 contributor!";
-                    }
-                    if (config.fillHistograms) {
-                      registry.fill(HIST("PvRefit/verticesPerCandidate"), 5);
-                    }
-                    if (isTrackFirstContr && !isTrackSecondContr) {
-                      /// the first daughter is contributor, the second is not
-                      pvRefitCoord2Prong = {trackPos1.pvRefitX(), trackPos1.pvRefitY(), trackPos1.pvRefitZ()};
-                      pvRefitCovMatrix2Prong = {trackPos1.pvRefitSigmaX2(), trackPos1.pvRefitSigmaXY(), trackPos1.pvRefitSigmaY2(), trackPos1.pvRefitSigmaXZ(), trackPos1.pvRefitSigmaYZ(), trackPos1.pvRefitSigmaZ2()};
-                    } else if (!isTrackFirstContr && isTrackSecondContr) {
-                      ///  the second daughter is contributor, the first is not
-                      pvRefitCoord2Prong = {trackNeg1.pvRefitX(), trackNeg1.pvRefitY(), trackNeg1.pvRefitZ()};
-                      pvRefitCovMatrix2Prong = {trackNeg1.pvRefitSigmaX2(), trackNeg1.pvRefitSigmaXY(), trackNeg1.pvRefitSigmaY2(), trackNeg1.pvRefitSigmaXZ(), trackNeg1.pvRefitSigmaYZ(), trackNeg1.pvRefitSigmaZ2()};
-                    }
-                  } else {
-                    /// 0 contributors among the HF candidate daughters
-                    if (config.fillHistograms) {
-                      registry.fill(HIST("PvRefit/verticesPerCandidate"), 6);
-                    }
-                    if (config.debugPvRefit) {
-                      LOG(info) << "####### [2 Prong] nCandContr==" << nCandContr << " ---> some of the candidate daughters did not contribute to the original PV fit, PV refit not redone";
-                    }
-                  }
-                }
+        uint isSelected2ProngCand = n2ProngBit; // bitmap for checking status of two-prong candidates (1 is true, 0 is rejected)
 
-                const auto pVecCandProng2 = RecoDecay::pVec(pvec0, pvec1);
-                // 2-prong selections after secondary vertex
-                std::array pvCoord2Prong = {collision.posX(), collision.posY(), collision.posZ()};
-                if constexpr (DoPvRefit) {
-                  pvCoord2Prong[0] = pvRefitCoord2Prong[0];
-                  pvCoord2Prong[1] = pvRefitCoord2Prong[1];
-                  pvCoord2Prong[2] = pvRefitCoord2Prong[2];
-                }
-                applySelection2Prong(pVecCandProng2, secondaryVertex2, pvCoord2Prong, cutStatus2Prong, isSelected2ProngCand);
-                if (is2ProngCandidateGoodFor3Prong && config.do3Prong) {
-                  is2ProngCandidateGoodFor3Prong = isTwoTrackVertexSelectedFor3Prongs(secondaryVertex2, pvCoord2Prong, df2);
-                }
+        if (config.debug) {
+          for (int iDecay2P = 0; iDecay2P < kN2ProngDecays; iDecay2P++) {
+            for (int iCut = 0; iCut < kNCuts2Prong[iDecay2P]; iCut++) {
+              cutStatus2Prong[iDecay2P][iCut] = true;
+            }
+          }
+        }
 
-                std::vector<float> mlScoresD0{};
-                if (config.applyMlForHfFilters) {
-                  const auto trackParVarPcaPos1 = df2.getTrack(0);
-                  const auto trackParVarPcaNeg1 = df2.getTrack(1);
-                  const std::vector<float> inputFeatures{trackParVarPcaPos1.getPt(), dcaInfoPos1[0], dcaInfoPos1[1], trackParVarPcaNeg1.getPt(), dcaInfoNeg1[0], dcaInfoNeg1[1]};
-                  applyMlSelectionForHfFilters2Prong(inputFeatures, mlScoresD0, isSelected2ProngCand);
-                }
+        // initialise PV refit coordinates and cov matrix for 2-prongs already here for D*
+        std::array pvRefitCoord2Prong = {collision.posX(), collision.posY(), collision.posZ()}; /// initialize to the original PV
+        std::array pvRefitCovMatrix2Prong = getPrimaryVertex(collision).getCov();               /// initialize to the original PV
 
-                if (isSelected2ProngCand > 0) {
-                  // fill table row
-                  rowTrackIndexProng2(thisCollId, trackPos1.globalIndex(), trackNeg1.globalIndex(), isSelected2ProngCand);
-                  if (config.applyMlForHfFilters) {
-                    rowTrackIndexMlScoreProng2(mlScoresD0);
-                  }
-                  if (TESTBIT(isSelected2ProngCand, hf_cand_2prong::DecayType::D0ToPiK)) {
-                    lastFilledD0 = rowTrackIndexProng2.lastIndex();
-                  }
+        // pre-filter of the pair, which is also the one seeding the 3-prong vertex fits
+        const bool isPairGoodForFitter = isSelectedByDcaFitterPreFilter(worker.dcaFitterPreFilter, trackParVarPos1, trackParVarNeg1);
 
-                  if constexpr (DoPvRefit) {
-                    // fill table row with coordinates of PV refit
-                    rowProng2PVrefit(pvRefitCoord2Prong[0], pvRefitCoord2Prong[1], pvRefitCoord2Prong[2],
-                                     pvRefitCovMatrix2Prong[0], pvRefitCovMatrix2Prong[1], pvRefitCovMatrix2Prong[2], pvRefitCovMatrix2Prong[3], pvRefitCovMatrix2Prong[4], pvRefitCovMatrix2Prong[5]);
-                  }
+        // 2-prong vertex reconstruction
+        float pt2Prong{-1.};
+        bool is2ProngCandidateGoodFor3Prong{sel3ProngStatusPos1 && sel3ProngStatusNeg1 && isPairGoodForFitter};
+        int nVtxFrom2ProngFitter = 0;
+        if (sel2ProngStatusPos && sel2ProngStatusNeg) {
 
-                  if (config.debug) {
-                    uint8_t prong2CutStatus[kN2ProngDecays];
-                    for (int iDecay2P = 0; iDecay2P < kN2ProngDecays; iDecay2P++) {
-                      prong2CutStatus[iDecay2P] = nCutStatus2ProngBit[iDecay2P];
-                      for (int iCut = 0; iCut < kNCuts2Prong[iDecay2P]; iCut++) {
-                        if (!cutStatus2Prong[iDecay2P][iCut]) {
-                          CLRBIT(prong2CutStatus[iDecay2P], iCut);
-                        }
-                      }
-                    }
-                    rowProng2CutStatus(prong2CutStatus[0], prong2CutStatus[1], prong2CutStatus[2]); // FIXME when we can do this by looping over kN2ProngDecays
-                  }
+          // 2-prong preselections
+          // TODO: in case of PV refit, the single-track DCA is calculated wrt two different PV vertices (only 1 track excluded)
+          applyPreselection2Prong(pVecTrackPos1, pVecTrackNeg1, dcaInfoPos1[0], dcaInfoNeg1[0], cutStatus2Prong, whichHypo2Prong, isSelected2ProngCand, pt2Prong);
 
-                  // fill histograms
-                  if (config.fillHistograms) {
-                    registry.fill(HIST("hVtx2ProngX"), secondaryVertex2[0]);
-                    registry.fill(HIST("hVtx2ProngY"), secondaryVertex2[1]);
-                    registry.fill(HIST("hVtx2ProngZ"), secondaryVertex2[2]);
-                    const std::array arrMom{pvec0, pvec1};
-                    for (int iDecay2P = 0; iDecay2P < kN2ProngDecays; iDecay2P++) {
-                      if (TESTBIT(isSelected2ProngCand, iDecay2P)) {
-                        if (TESTBIT(whichHypo2Prong[iDecay2P], 0)) {
-                          const auto mass2Prong = RecoDecay::m(arrMom, arrMass2Prong[iDecay2P][0]);
-                          switch (iDecay2P) {
-                            case hf_cand_2prong::DecayType::D0ToPiK:
-                              registry.fill(HIST("hMassD0ToPiK"), mass2Prong);
-                              break;
-                            case hf_cand_2prong::DecayType::JpsiToEE:
-                              registry.fill(HIST("hMassJpsiToEE"), mass2Prong);
-                              break;
-                            case hf_cand_2prong::DecayType::JpsiToMuMu:
-                              registry.fill(HIST("hMassJpsiToMuMu"), mass2Prong);
-                              break;
-                          }
-                        }
-                        if (TESTBIT(whichHypo2Prong[iDecay2P], 1)) {
-                          const auto mass2Prong = RecoDecay::m(arrMom, arrMass2Prong[iDecay2P][1]);
-                          if (iDecay2P == hf_cand_2prong::DecayType::D0ToPiK) {
-                            registry.fill(HIST("hMassD0ToPiK"), mass2Prong);
-                          }
-                        }
-                      }
-                    }
-                  }
-                }
-              } else {
-                isSelected2ProngCand = 0; // reset to 0 not to use the D0 to build a D* meson
-              }
-            } else {
-              isSelected2ProngCand = 0; // reset to 0 not to use the D0 to build a D* meson
-            }
-          }
-
-          // if the cut on the decay length of 3-prongs computed with the first two tracks is enabled and the vertex was not computed for the D0, we compute it now
-          if (config.do3Prong && is2ProngCandidateGoodFor3Prong && (config.minTwoTrackDecayLengthFor3Prongs > 0.f || config.maxTwoTrackChi2PcaFor3Prongs < 1.e9f) && nVtxFrom2ProngFitter == 0) { // o2-linter: disable="magic-number" (default maxTwoTrackChi2PcaFor3Prongs is 1.e10)
+          if (isSelected2ProngCand > 0) {
+            // secondary vertex reconstruction and further 2-prong selections
             try {
-              nVtxFrom2ProngFitter = df2.process(trackParVarPos1, trackParVarNeg1);
+              if (isPairGoodForFitter) {
+                nVtxFrom2ProngFitter = worker.df2.process(trackParVarPos1, trackParVarNeg1);
+              }
             } catch (...) {
             }
-            if (nVtxFrom2ProngFitter > 0) {
-              const auto& secondaryVertex2 = df2.getPCACandidate();
-              const std::array pvCoord2Prong{collision.posX(), collision.posY(), collision.posZ()};
-              is2ProngCandidateGoodFor3Prong = isTwoTrackVertexSelectedFor3Prongs(secondaryVertex2, pvCoord2Prong, df2);
-            } else {
-              is2ProngCandidateGoodFor3Prong = false;
-            }
-          }
-
-          if (config.do3Prong && is2ProngCandidateGoodFor3Prong) { // if 3 prongs are enabled and the first 2 tracks are selected for the 3-prong channels
-            // second loop over positive tracks
-            for (auto trackIndexPos2 = trackIndexPos1 + 1; trackIndexPos2 != groupedTrackIndicesPos1.end(); ++trackIndexPos2) {
-
-              uint isSelected3ProngCand = n3ProngBit;
-              if (!TESTBIT(trackIndexPos2.isSelProng(), CandidateType::Cand3Prong)) { // continue immediately
-                if (!config.debug) {
-                  continue;
-                }
-                isSelected3ProngCand = 0;
-              }
-
-              if (config.applyKaonPidIn3Prongs && !TESTBIT(trackIndexNeg1.isIdentifiedPid(), ChannelKaonPid)) { // continue immediately if kaon PID enabled and opposite-sign track not a kaon
-                if (!config.debug) {
-                  continue;
-                }
-                isSelected3ProngCand = 0;
-              }
-
-              const auto trackPos2 = trackIndexPos2.template track_as<TTracks>();
-
-              auto trackParVarPos2 = getTrackParCov(trackPos2);
-              std::array dcaInfoPos2{trackPos2.dcaXY(), trackPos2.dcaZ()};
 
-              // preselection of 3-prong candidates
-              if (isSelected3ProngCand) {
-                std::array pVecTrackPos2{trackPos2.pVector()};
-                if (thisCollId != trackPos2.collisionId()) { // this is not the "default" collision for this track and we still did not re-propagate it, we have to re-propagate it
-                  o2::base::Propagator::Instance()->propagateToDCABxByBz({collision.posX(), collision.posY(), collision.posZ()}, trackParVarPos2, 2.f, noMatCorr, &dcaInfoPos2);
-                  getPxPyPz(trackParVarPos2, pVecTrackPos2);
-                }
-
-                if (config.debug) {
-                  for (int iDecay3P = 0; iDecay3P < kN3ProngDecays; iDecay3P++) {
-                    for (int iCut = 0; iCut < kNCuts3Prong[iDecay3P]; iCut++) {
-                      cutStatus3Prong[iDecay3P][iCut] = true;
-                    }
-                  }
-                }
-
-                // 3-prong preselections
-                const auto isIdentifiedPidTrackPos1 = trackIndexPos1.isIdentifiedPid();
-                const auto isIdentifiedPidTrackPos2 = trackIndexPos2.isIdentifiedPid();
-                applyPreselection3Prong(pVecTrackPos1, pVecTrackNeg1, pVecTrackPos2, isIdentifiedPidTrackPos1, isIdentifiedPidTrackPos2, cutStatus3Prong, whichHypo3Prong, isSelected3ProngCand);
-                if (!config.debug && isSelected3ProngCand == 0) {
-                  continue;
-                }
-              }
+            if (nVtxFrom2ProngFitter > 0) { // should it be this or > 0 or are they equivalent
+              // get secondary vertex
+              const auto& secondaryVertex2 = worker.df2.getPCACandidate();
+              // get track momenta
+              std::array<float, 3> pvec0{};
+              std::array<float, 3> pvec1{};
+              worker.df2.getTrack(0).getPxPyPzGlo(pvec0);
+              worker.df2.getTrack(1).getPxPyPzGlo(pvec1);
 
               /// PV refit excluding the candidate daughters, if contributors
-              std::array pvRefitCoord3Prong2Pos1Neg{collision.posX(), collision.posY(), collision.posZ()}; /// initialize to the original PV
-              std::array pvRefitCovMatrix3Prong2Pos1Neg{getPrimaryVertex(collision).getCov()};             /// initialize to the original PV
               if constexpr (DoPvRefit) {
                 if (config.fillHistograms) {
                   registry.fill(HIST("PvRefit/verticesPerCandidate"), 1);
                 }
-                int nCandContr = 3;
+                int nCandContr = 2;
                 auto trackFirstIt = std::find(vecPvContributorGlobId.begin(), vecPvContributorGlobId.end(), trackPos1.globalIndex());
                 auto trackSecondIt = std::find(vecPvContributorGlobId.begin(), vecPvContributorGlobId.end(), trackNeg1.globalIndex());
-                auto trackThirdIt = std::find(vecPvContributorGlobId.begin(), vecPvContributorGlobId.end(), trackPos2.globalIndex());
                 bool isTrackFirstContr = true;
                 bool isTrackSecondContr = true;
-                bool isTrackThirdContr = true;
                 if (trackFirstIt == vecPvContributorGlobId.end()) {
                   /// This track did not contribute to the original PV refit
                   if (config.debugPvRefit) {
-                    LOG(info) << "--- [3 prong] trackPos1 with globalIndex " << trackPos1.globalIndex() << " was not a PV contributor";
+                    LOG(info) << "--- [2 Prong] trackPos1 with globalIndex " << trackPos1.globalIndex() << " was not a PV contributor";
                   }
                   nCandContr--;
                   isTrackFirstContr = false;
@@ -2694,58 +2648,33 @@ struct HfTrackIndexSkimCreator {
                 if (trackSecondIt == vecPvContributorGlobId.end()) {
                   /// This track did not contribute to the original PV refit
                   if (config.debugPvRefit) {
-                    LOG(info) << "--- [3 prong] trackNeg1 with globalIndex " << trackNeg1.globalIndex() << " was not a PV contributor";
+                    LOG(info) << "--- [2 Prong] trackNeg1 with globalIndex " << trackNeg1.globalIndex() << " was not a PV contributor";
                   }
                   nCandContr--;
                   isTrackSecondContr = false;
                 }
-                if (trackThirdIt == vecPvContributorGlobId.end()) {
-                  /// This track did not contribute to the original PV refit
-                  if (config.debugPvRefit) {
-                    LOG(info) << "--- [3 prong] trackPos2 with globalIndex " << trackPos2.globalIndex() << " was not a PV contributor";
-                  }
-                  nCandContr--;
-                  isTrackThirdContr = false;
-                }
-
-                // Fill a vector with global ID of candidate daughters that are contributors
-                std::vector<int64_t> vecCandPvContributorGlobId = {};
-                if (isTrackFirstContr) {
-                  vecCandPvContributorGlobId.push_back(trackPos1.globalIndex());
-                }
-                if (isTrackSecondContr) {
-                  vecCandPvContributorGlobId.push_back(trackNeg1.globalIndex());
-                }
-                if (isTrackThirdContr) {
-                  vecCandPvContributorGlobId.push_back(trackPos2.globalIndex());
-                }
-
-                if (nCandContr == 3 || nCandContr == 2) { // o2-linter: disable="magic-number" (see comment below)
-                  /// At least two of the daughter tracks were used for the original PV refit, let's refit it after excluding them
+                if (nCandContr == 2) { // o2-linter: disable="magic-number" (see comment below)
+                  /// Both the daughter tracks were used for the original PV refit, let's refit it after excluding them
                   if (config.debugPvRefit) {
-                    LOG(info) << "### [3 prong] Calling performPvRefitCandProngs for HF 3 prong candidate, removing " << nCandContr << " daughters";
+                    LOG(info) << "### [2 Prong] Calling performPvRefitCandProngs for HF 2 prong candidate";
                   }
-                  performPvRefitCandProngs(collision, bcWithTimeStamps, vecPvContributorGlobId, vecPvContributorTrackParCov, vecCandPvContributorGlobId, pvRefitCoord3Prong2Pos1Neg, pvRefitCovMatrix3Prong2Pos1Neg);
+                  performPvRefitCandProngs(collision, bcWithTimeStamps, vecPvContributorGlobId, vecPvContributorTrackParCov, {trackPos1.globalIndex(), trackNeg1.globalIndex()}, pvRefitCoord2Prong, pvRefitCovMatrix2Prong);
                 } else if (nCandContr == 1) {
                   /// Only one daughter was a contributor, let's use then the PV recalculated by excluding only it
                   if (config.debugPvRefit) {
-                    LOG(info) << "####### [3 Prong] nCandContr==" << nCandContr << " ---> just 1 contributor!";
+                    LOG(info) << "####### [2 Prong] nCandContr==" << nCandContr << " ---> just 1 contributor!";
                   }
                   if (config.fillHistograms) {
                     registry.fill(HIST("PvRefit/verticesPerCandidate"), 5);
                   }
-                  if (isTrackFirstContr && !isTrackSecondContr && !isTrackThirdContr) {
-                    /// the first daughter is contributor, the second and the third are not
-                    pvRefitCoord3Prong2Pos1Neg = {trackPos1.pvRefitX(), trackPos1.pvRefitY(), trackPos1.pvRefitZ()};
-                    pvRefitCovMatrix3Prong2Pos1Neg = {trackPos1.pvRefitSigmaX2(), trackPos1.pvRefitSigmaXY(), trackPos1.pvRefitSigmaY2(), trackPos1.pvRefitSigmaXZ(), trackPos1.pvRefitSigmaYZ(), trackPos1.pvRefitSigmaZ2()};
-                  } else if (!isTrackFirstContr && isTrackSecondContr && !isTrackThirdContr) {
-                    /// the second daughter is contributor, the first and the third are not
-                    pvRefitCoord3Prong2Pos1Neg = {trackNeg1.pvRefitX(), trackNeg1.pvRefitY(), trackNeg1.pvRefitZ()};
-                    pvRefitCovMatrix3Prong2Pos1Neg = {trackNeg1.pvRefitSigmaX2(), trackNeg1.pvRefitSigmaXY(), trackNeg1.pvRefitSigmaY2(), trackNeg1.pvRefitSigmaXZ(), trackNeg1.pvRefitSigmaYZ(), trackNeg1.pvRefitSigmaZ2()};
-                  } else if (!isTrackFirstContr && !isTrackSecondContr && isTrackThirdContr) {
-                    /// the third daughter is contributor, the first and the second are not
-                    pvRefitCoord3Prong2Pos1Neg = {trackPos2.pvRefitX(), trackPos2.pvRefitY(), trackPos2.pvRefitZ()};
-                    pvRefitCovMatrix3Prong2Pos1Neg = {trackPos2.pvRefitSigmaX2(), trackPos2.pvRefitSigmaXY(), trackPos2.pvRefitSigmaY2(), trackPos2.pvRefitSigmaXZ(), trackPos2.pvRefitSigmaYZ(), trackPos2.pvRefitSigmaZ2()};
+                  if (isTrackFirstContr && !isTrackSecondContr) {
+                    /// the first daughter is contributor, the second is not
+                    pvRefitCoord2Prong = {trackPos1.pvRefitX(), trackPos1.pvRefitY(), trackPos1.pvRefitZ()};
+                    pvRefitCovMatrix2Prong = {trackPos1.pvRefitSigmaX2(), trackPos1.pvRefitSigmaXY(), trackPos1.pvRefitSigmaY2(), trackPos1.pvRefitSigmaXZ(), trackPos1.pvRefitSigmaYZ(), trackPos1.pvRefitSigmaZ2()};
+                  } else if (!isTrackFirstContr && isTrackSecondContr) {
+                    ///  the second daughter is contributor, the first is not
+                    pvRefitCoord2Prong = {trackNeg1.pvRefitX(), trackNeg1.pvRefitY(), trackNeg1.pvRefitZ()};
+                    pvRefitCovMatrix2Prong = {trackNeg1.pvRefitSigmaX2(), trackNeg1.pvRefitSigmaXY(), trackNeg1.pvRefitSigmaY2(), trackNeg1.pvRefitSigmaXZ(), trackNeg1.pvRefitSigmaYZ(), trackNeg1.pvRefitSigmaZ2()};
                   }
                 } else {
                   /// 0 contributors among the HF candidate daughters
@@ -2753,516 +2682,799 @@ struct HfTrackIndexSkimCreator {
                     registry.fill(HIST("PvRefit/verticesPerCandidate"), 6);
                   }
                   if (config.debugPvRefit) {
-                    LOG(info) << "####### [3 prong] nCandContr==" << nCandContr << " ---> some of the candidate daughters did not contribute to the original PV fit, PV refit not redone";
+                    LOG(info) << "####### [2 Prong] nCandContr==" << nCandContr << " ---> some of the candidate daughters did not contribute to the original PV fit, PV refit not redone";
                   }
                 }
               }
 
-              // reconstruct the 3-prong secondary vertex
-              int nVtxFrom3ProngFitter = 0;
-              try {
-                nVtxFrom3ProngFitter = df3.process(trackParVarPos1, trackParVarNeg1, trackParVarPos2);
-              } catch (...) {
-                continue;
+              const auto pVecCandProng2 = RecoDecay::pVec(pvec0, pvec1);
+              // 2-prong selections after secondary vertex
+              std::array pvCoord2Prong = {collision.posX(), collision.posY(), collision.posZ()};
+              if constexpr (DoPvRefit) {
+                pvCoord2Prong[0] = pvRefitCoord2Prong[0];
+                pvCoord2Prong[1] = pvRefitCoord2Prong[1];
+                pvCoord2Prong[2] = pvRefitCoord2Prong[2];
               }
-
-              if (nVtxFrom3ProngFitter == 0) {
-                continue;
+              applySelection2Prong(pVecCandProng2, secondaryVertex2, pvCoord2Prong, cutStatus2Prong, isSelected2ProngCand);
+              if (is2ProngCandidateGoodFor3Prong && config.do3Prong) {
+                is2ProngCandidateGoodFor3Prong = isTwoTrackVertexSelectedFor3Prongs(secondaryVertex2, pvCoord2Prong, worker.df2);
               }
-              // get secondary vertex
-              const auto& secondaryVertex3 = df3.getPCACandidate();
-              // get track momenta
-              std::array<float, 3> pvec0{};
-              std::array<float, 3> pvec1{};
-              std::array<float, 3> pvec2{};
-              const auto trackParVarPcaPos1 = df3.getTrack(0);
-              const auto trackParVarPcaNeg1 = df3.getTrack(1);
-              const auto trackParVarPcaPos2 = df3.getTrack(2);
-              trackParVarPcaPos1.getPxPyPzGlo(pvec0);
-              trackParVarPcaNeg1.getPxPyPzGlo(pvec1);
-              trackParVarPcaPos2.getPxPyPzGlo(pvec2);
-              const auto pVecCandProng3Pos = RecoDecay::pVec(pvec0, pvec1, pvec2);
-
-              // 3-prong selections after secondary vertex
-              applySelection3Prong(pVecCandProng3Pos, secondaryVertex3, pvRefitCoord3Prong2Pos1Neg, cutStatus3Prong, isSelected3ProngCand);
-
-              std::array<std::vector<float>, kN3ProngDecaysUsedMlForHfFilters> mlScores3Prongs;
+
+              std::vector<float> mlScoresD0{};
               if (config.applyMlForHfFilters) {
-                const std::vector<float> inputFeatures{trackParVarPcaPos1.getPt(), dcaInfoPos1[0], dcaInfoPos1[1], trackParVarPcaNeg1.getPt(), dcaInfoNeg1[0], dcaInfoNeg1[1], trackParVarPcaPos2.getPt(), dcaInfoPos2[0], dcaInfoPos2[1]};
-                std::vector<float> inputFeaturesLcPid{};
-                if constexpr (UsePidForHfFiltersBdt) {
-                  inputFeaturesLcPid.push_back(trackPos1.tpcNSigmaPr());
-                  inputFeaturesLcPid.push_back(trackPos2.tpcNSigmaPr());
-                  inputFeaturesLcPid.push_back(trackPos1.tpcNSigmaPi());
-                  inputFeaturesLcPid.push_back(trackPos2.tpcNSigmaPi());
-                  inputFeaturesLcPid.push_back(trackNeg1.tpcNSigmaKa());
-                }
-                applyMlSelectionForHfFilters3Prong<UsePidForHfFiltersBdt>(inputFeatures, inputFeaturesLcPid, mlScores3Prongs, isSelected3ProngCand);
+                const auto trackParVarPcaPos1 = worker.df2.getTrack(0);
+                const auto trackParVarPcaNeg1 = worker.df2.getTrack(1);
+                const std::vector<float> inputFeatures{trackParVarPcaPos1.getPt(), dcaInfoPos1[0], dcaInfoPos1[1], trackParVarPcaNeg1.getPt(), dcaInfoNeg1[0], dcaInfoNeg1[1]};
+                applyMlSelectionForHfFilters2Prong(inputFeatures, mlScoresD0, isSelected2ProngCand);
               }
 
-              if (!config.debug && isSelected3ProngCand == 0) {
-                continue;
-              }
+              if (isSelected2ProngCand > 0) {
+                // fill table row
+                output.prong2.push_back({thisCollId, trackPos1.globalIndex(), trackNeg1.globalIndex(), isSelected2ProngCand});
+                if (config.applyMlForHfFilters) {
+                  rowTrackIndexMlScoreProng2(mlScoresD0);
+                }
+                if (TESTBIT(isSelected2ProngCand, hf_cand_2prong::DecayType::D0ToPiK)) {
+                  lastFilledD0 = static_cast<int>(output.prong2.size()) - 1;
+                }
 
-              // fill table row
-              rowTrackIndexProng3(thisCollId, trackPos1.globalIndex(), trackNeg1.globalIndex(), trackPos2.globalIndex(), isSelected3ProngCand);
-              if (config.applyMlForHfFilters) {
-                rowTrackIndexMlScoreProng3(mlScores3Prongs[0], mlScores3Prongs[1], mlScores3Prongs[2], mlScores3Prongs[3]);
-              }
-              if constexpr (DoPvRefit) {
-                // fill table row of coordinates of PV refit
-                rowProng3PVrefit(pvRefitCoord3Prong2Pos1Neg[0], pvRefitCoord3Prong2Pos1Neg[1], pvRefitCoord3Prong2Pos1Neg[2],
-                                 pvRefitCovMatrix3Prong2Pos1Neg[0], pvRefitCovMatrix3Prong2Pos1Neg[1], pvRefitCovMatrix3Prong2Pos1Neg[2], pvRefitCovMatrix3Prong2Pos1Neg[3], pvRefitCovMatrix3Prong2Pos1Neg[4], pvRefitCovMatrix3Prong2Pos1Neg[5]);
-              }
+                if constexpr (DoPvRefit) {
+                  // fill table row with coordinates of PV refit
+                  rowProng2PVrefit(pvRefitCoord2Prong[0], pvRefitCoord2Prong[1], pvRefitCoord2Prong[2],
+                                   pvRefitCovMatrix2Prong[0], pvRefitCovMatrix2Prong[1], pvRefitCovMatrix2Prong[2], pvRefitCovMatrix2Prong[3], pvRefitCovMatrix2Prong[4], pvRefitCovMatrix2Prong[5]);
+                }
 
-              if (config.debug) {
-                uint8_t prong3CutStatus[kN3ProngDecays];
-                for (int iDecay3P = 0; iDecay3P < kN3ProngDecays; iDecay3P++) {
-                  prong3CutStatus[iDecay3P] = nCutStatus3ProngBit[iDecay3P];
-                  for (int iCut = 0; iCut < kNCuts3Prong[iDecay3P]; iCut++) {
-                    if (!cutStatus3Prong[iDecay3P][iCut]) {
-                      CLRBIT(prong3CutStatus[iDecay3P], iCut);
+                if (config.debug) {
+                  uint8_t prong2CutStatus[kN2ProngDecays];
+                  for (int iDecay2P = 0; iDecay2P < kN2ProngDecays; iDecay2P++) {
+                    prong2CutStatus[iDecay2P] = nCutStatus2ProngBit[iDecay2P];
+                    for (int iCut = 0; iCut < kNCuts2Prong[iDecay2P]; iCut++) {
+                      if (!cutStatus2Prong[iDecay2P][iCut]) {
+                        CLRBIT(prong2CutStatus[iDecay2P], iCut);
+                      }
                     }
                   }
+                  rowProng2CutStatus(prong2CutStatus[0], prong2CutStatus[1], prong2CutStatus[2]); // FIXME when we can do this by looping over kN2ProngDecays
                 }
-                rowProng3CutStatus(prong3CutStatus[0], prong3CutStatus[1], prong3CutStatus[2], prong3CutStatus[3]); // FIXME when we can do this by looping over kN3ProngDecays
-              }
 
-              // fill histograms
-              if (config.fillHistograms) {
-                registry.fill(HIST("hVtx3ProngX"), secondaryVertex3[0]);
-                registry.fill(HIST("hVtx3ProngY"), secondaryVertex3[1]);
-                registry.fill(HIST("hVtx3ProngZ"), secondaryVertex3[2]);
-                const std::array arr3Mom{pvec0, pvec1, pvec2};
-                for (int iDecay3P = 0; iDecay3P < kN3ProngDecays; iDecay3P++) {
-                  if (TESTBIT(isSelected3ProngCand, iDecay3P)) {
-                    if (TESTBIT(whichHypo3Prong[iDecay3P], 0)) {
-                      const auto mass3Prong = RecoDecay::m(arr3Mom, arrMass3Prong[iDecay3P][0]);
-                      switch (iDecay3P) {
-                        case hf_cand_3prong::DecayType::DplusToPiKPi:
-                          registry.fill(HIST("hMassDPlusToPiKPi"), mass3Prong);
-                          break;
-                        case hf_cand_3prong::DecayType::DsToKKPi:
-                          registry.fill(HIST("hMassDsToKKPi"), mass3Prong);
-                          break;
-                        case hf_cand_3prong::DecayType::LcToPKPi:
-                          registry.fill(HIST("hMassLcToPKPi"), mass3Prong);
-                          break;
-                        case hf_cand_3prong::DecayType::XicToPKPi:
-                          registry.fill(HIST("hMassXicToPKPi"), mass3Prong);
-                          break;
-                        case hf_cand_3prong::DecayType::CdToDeKPi:
-                          registry.fill(HIST("hMassCdToDeKPi"), mass3Prong);
-                          break;
-                        case hf_cand_3prong::DecayType::CtToTrKPi:
-                          registry.fill(HIST("hMassCtToTrKPi"), mass3Prong);
-                          break;
-                        case hf_cand_3prong::DecayType::ChToHeKPi:
-                          registry.fill(HIST("hMassChToHeKPi"), mass3Prong);
-                          break;
-                        case hf_cand_3prong::DecayType::CaToAlKPi:
-                          registry.fill(HIST("hMassCaToAlKPi"), mass3Prong);
-                          break;
+                // fill histograms
+                if (config.fillHistograms) {
+                  registry.fill(HIST("hVtx2ProngX"), secondaryVertex2[0]);
+                  registry.fill(HIST("hVtx2ProngY"), secondaryVertex2[1]);
+                  registry.fill(HIST("hVtx2ProngZ"), secondaryVertex2[2]);
+                  const std::array arrMom{pvec0, pvec1};
+                  for (int iDecay2P = 0; iDecay2P < kN2ProngDecays; iDecay2P++) {
+                    if (TESTBIT(isSelected2ProngCand, iDecay2P)) {
+                      if (TESTBIT(whichHypo2Prong[iDecay2P], 0)) {
+                        const auto mass2Prong = RecoDecay::m(arrMom, arrMass2Prong[iDecay2P][0]);
+                        switch (iDecay2P) {
+                          case hf_cand_2prong::DecayType::D0ToPiK:
+                            registry.fill(HIST("hMassD0ToPiK"), mass2Prong);
+                            break;
+                          case hf_cand_2prong::DecayType::JpsiToEE:
+                            registry.fill(HIST("hMassJpsiToEE"), mass2Prong);
+                            break;
+                          case hf_cand_2prong::DecayType::JpsiToMuMu:
+                            registry.fill(HIST("hMassJpsiToMuMu"), mass2Prong);
+                            break;
+                        }
                       }
-                    }
-                    if (TESTBIT(whichHypo3Prong[iDecay3P], 1)) {
-                      const auto mass3Prong = RecoDecay::m(arr3Mom, arrMass3Prong[iDecay3P][1]);
-                      switch (iDecay3P) {
-                        case hf_cand_3prong::DecayType::DsToKKPi:
-                          registry.fill(HIST("hMassDsToKKPi"), mass3Prong);
-                          break;
-                        case hf_cand_3prong::DecayType::LcToPKPi:
-                          registry.fill(HIST("hMassLcToPKPi"), mass3Prong);
-                          break;
-                        case hf_cand_3prong::DecayType::XicToPKPi:
-                          registry.fill(HIST("hMassXicToPKPi"), mass3Prong);
-                          break;
-                        case hf_cand_3prong::DecayType::CdToDeKPi:
-                          registry.fill(HIST("hMassCdToDeKPi"), mass3Prong);
-                          break;
-                        case hf_cand_3prong::DecayType::CtToTrKPi:
-                          registry.fill(HIST("hMassCtToTrKPi"), mass3Prong);
-                          break;
-                        case hf_cand_3prong::DecayType::ChToHeKPi:
-                          registry.fill(HIST("hMassChToHeKPi"), mass3Prong);
-                          break;
-                        case hf_cand_3prong::DecayType::CaToAlKPi:
-                          registry.fill(HIST("hMassCaToAlKPi"), mass3Prong);
-                          break;
+                      if (TESTBIT(whichHypo2Prong[iDecay2P], 1)) {
+                        const auto mass2Prong = RecoDecay::m(arrMom, arrMass2Prong[iDecay2P][1]);
+                        if (iDecay2P == hf_cand_2prong::DecayType::D0ToPiK) {
+                          registry.fill(HIST("hMassD0ToPiK"), mass2Prong);
+                        }
                       }
                     }
                   }
                 }
               }
+            } else {
+              isSelected2ProngCand = 0; // reset to 0 not to use the D0 to build a D* meson
             }
+          } else {
+            isSelected2ProngCand = 0; // reset to 0 not to use the D0 to build a D* meson
+          }
+        }
+
+        // if the cut on the decay length of 3-prongs computed with the first two tracks is enabled and the vertex was not computed for the D0, we compute it now
+        if (config.do3Prong && is2ProngCandidateGoodFor3Prong && (config.minTwoTrackDecayLengthFor3Prongs > 0.f || config.maxTwoTrackChi2PcaFor3Prongs < 1.e9f) && nVtxFrom2ProngFitter == 0) { // o2-linter: disable="magic-number" (default maxTwoTrackChi2PcaFor3Prongs is 1.e10)
+          try {
+            nVtxFrom2ProngFitter = worker.df2.process(trackParVarPos1, trackParVarNeg1);
+          } catch (...) {
+          }
+          if (nVtxFrom2ProngFitter > 0) {
+            const auto& secondaryVertex2 = worker.df2.getPCACandidate();
+            const std::array pvCoord2Prong{collision.posX(), collision.posY(), collision.posZ()};
+            is2ProngCandidateGoodFor3Prong = isTwoTrackVertexSelectedFor3Prongs(secondaryVertex2, pvCoord2Prong, worker.df2);
+          } else {
+            is2ProngCandidateGoodFor3Prong = false;
+          }
+        }
 
-            // second loop over negative tracks
-            for (auto trackIndexNeg2 = trackIndexNeg1 + 1; trackIndexNeg2 != groupedTrackIndicesNeg1.end(); ++trackIndexNeg2) {
+        if (config.do3Prong && is2ProngCandidateGoodFor3Prong) { // if 3 prongs are enabled and the first 2 tracks are selected for the 3-prong channels
+          // second loop over positive tracks
+          int iPos2 = iPos1 + 1;
+          for (auto trackIndexPos2 = trackIndexPos1 + 1; trackIndexPos2 != groupedTrackIndicesPos1.end(); ++trackIndexPos2, ++iPos2) {
 
-              int isSelected3ProngCand = n3ProngBit;
-              if (!TESTBIT(trackIndexNeg2.isSelProng(), CandidateType::Cand3Prong)) { // continue immediately
-                if (!config.debug) {
-                  continue;
-                }
-                isSelected3ProngCand = 0;
+            uint isSelected3ProngCand = n3ProngBit;
+            if (!TESTBIT(trackParPos.isSelProng[iPos2], CandidateType::Cand3Prong)) { // continue immediately
+              if (!config.debug) {
+                continue;
               }
+              isSelected3ProngCand = 0;
+            }
 
-              if (config.applyKaonPidIn3Prongs && !TESTBIT(trackIndexPos1.isIdentifiedPid(), ChannelKaonPid)) { // continue immediately if kaon PID enabled and opposite-sign track not a kaon
-                if (!config.debug) {
-                  continue;
-                }
-                isSelected3ProngCand = 0;
+            if (config.applyKaonPidIn3Prongs && !TESTBIT(trackParNeg.isIdentifiedPid[iNeg1], ChannelKaonPid)) { // continue immediately if kaon PID enabled and opposite-sign track not a kaon
+              if (!config.debug) {
+                continue;
               }
+              isSelected3ProngCand = 0;
+            }
 
-              auto trackNeg2 = trackIndexNeg2.template track_as<TTracks>();
-              auto trackParVarNeg2 = getTrackParCov(trackNeg2);
-              std::array dcaInfoNeg2{trackNeg2.dcaXY(), trackNeg2.dcaZ()};
-
-              // preselection of 3-prong candidates
-              if (isSelected3ProngCand) {
-                std::array pVecTrackNeg2{trackNeg2.pVector()};
-                if (thisCollId != trackNeg2.collisionId()) { // this is not the "default" collision for this track and we still did not re-propagate it, we have to re-propagate it
-                  o2::base::Propagator::Instance()->propagateToDCABxByBz({collision.posX(), collision.posY(), collision.posZ()}, trackParVarNeg2, 2.f, noMatCorr, &dcaInfoNeg2);
-                  getPxPyPz(trackParVarNeg2, pVecTrackNeg2);
-                }
+            const auto trackPos2 = trackIndexPos2.template track_as<TTracks>();
 
-                if (config.debug) {
-                  for (int iDecay3P = 0; iDecay3P < kN3ProngDecays; iDecay3P++) {
-                    for (int iCut = 0; iCut < kNCuts3Prong[iDecay3P]; iCut++) {
-                      cutStatus3Prong[iDecay3P][iCut] = true;
-                    }
+            // tracks of candidates already rejected (debug mode) are not re-propagated to the PV
+            const auto trackParVarPos2 = isSelected3ProngCand ? trackParPos.trackParVar[iPos2] : getTrackParCov(trackPos2);
+            const auto dcaInfoPos2 = isSelected3ProngCand ? trackParPos.dcaInfo[iPos2] : std::array{trackPos2.dcaXY(), trackPos2.dcaZ()};
+
+            // preselection of 3-prong candidates
+            if (isSelected3ProngCand) {
+              const auto& pVecTrackPos2 = trackParPos.pVec[iPos2];
+
+              if (config.debug) {
+                for (int iDecay3P = 0; iDecay3P < kN3ProngDecays; iDecay3P++) {
+                  for (int iCut = 0; iCut < kNCuts3Prong[iDecay3P]; iCut++) {
+                    cutStatus3Prong[iDecay3P][iCut] = true;
                   }
                 }
+              }
 
-                // 3-prong preselections
-                int8_t const isIdentifiedPidTrackNeg1 = trackIndexNeg1.isIdentifiedPid();
-                int8_t const isIdentifiedPidTrackNeg2 = trackIndexNeg2.isIdentifiedPid();
-                applyPreselection3Prong(pVecTrackNeg1, pVecTrackPos1, pVecTrackNeg2, isIdentifiedPidTrackNeg1, isIdentifiedPidTrackNeg2, cutStatus3Prong, whichHypo3Prong, isSelected3ProngCand);
-                if (!config.debug && isSelected3ProngCand == 0) {
-                  continue;
-                }
+              // 3-prong preselections
+              const auto isIdentifiedPidTrackPos1 = trackParPos.isIdentifiedPid[iPos1];
+              const auto isIdentifiedPidTrackPos2 = trackParPos.isIdentifiedPid[iPos2];
+              applyPreselection3Prong(pVecTrackPos1, pVecTrackNeg1, pVecTrackPos2, isIdentifiedPidTrackPos1, isIdentifiedPidTrackPos2, cutStatus3Prong, whichHypo3Prong, isSelected3ProngCand);
+              if (!config.debug && isSelected3ProngCand == 0) {
+                continue;
               }
+            }
 
-              /// PV refit excluding the candidate daughters, if contributors
-              std::array pvRefitCoord3Prong1Pos2Neg{collision.posX(), collision.posY(), collision.posZ()}; /// initialize to the original PV
-              std::array pvRefitCovMatrix3Prong1Pos2Neg{getPrimaryVertex(collision).getCov()};             /// initialize to the original PV
-              if constexpr (DoPvRefit) {
-                if (config.fillHistograms) {
-                  registry.fill(HIST("PvRefit/verticesPerCandidate"), 1);
-                }
-                int nCandContr = 3;
-                auto trackFirstIt = std::find(vecPvContributorGlobId.begin(), vecPvContributorGlobId.end(), trackPos1.globalIndex());
-                auto trackSecondIt = std::find(vecPvContributorGlobId.begin(), vecPvContributorGlobId.end(), trackNeg1.globalIndex());
-                auto trackThirdIt = std::find(vecPvContributorGlobId.begin(), vecPvContributorGlobId.end(), trackNeg2.globalIndex());
-                bool isTrackFirstContr = true;
-                bool isTrackSecondContr = true;
-                bool isTrackThirdContr = true;
-                if (trackFirstIt == vecPvContributorGlobId.end()) {
-                  /// This track did not contribute to the original PV refit
-                  if (config.debugPvRefit) {
-                    LOG(info) << "--- [3 prong] trackPos1 with globalIndex " << trackPos1.globalIndex() << " was not a PV contributor";
-                  }
-                  nCandContr--;
-                  isTrackFirstContr = false;
+            /// PV refit excluding the candidate daughters, if contributors
+            std::array pvRefitCoord3Prong2Pos1Neg{collision.posX(), collision.posY(), collision.posZ()}; /// initialize to the original PV
+            std::array pvRefitCovMatrix3Prong2Pos1Neg{getPrimaryVertex(collision).getCov()};             /// initialize to the original PV
+            if constexpr (DoPvRefit) {
+              if (config.fillHistograms) {
+                registry.fill(HIST("PvRefit/verticesPerCandidate"), 1);
+              }
+              int nCandContr = 3;
+              auto trackFirstIt = std::find(vecPvContributorGlobId.begin(), vecPvContributorGlobId.end(), trackPos1.globalIndex());
+              auto trackSecondIt = std::find(vecPvContributorGlobId.begin(), vecPvContributorGlobId.end(), trackNeg1.globalIndex());
+              auto trackThirdIt = std::find(vecPvContributorGlobId.begin(), vecPvContributorGlobId.end(), trackPos2.globalIndex());
+              bool isTrackFirstContr = true;
+              bool isTrackSecondContr = true;
+              bool isTrackThirdContr = true;
+              if (trackFirstIt == vecPvContributorGlobId.end()) {
+                /// This track did not contribute to the original PV refit
+                if (config.debugPvRefit) {
+                  LOG(info) << "--- [3 prong] trackPos1 with globalIndex " << trackPos1.globalIndex() << " was not a PV contributor";
                 }
-                if (trackSecondIt == vecPvContributorGlobId.end()) {
-                  /// This track did not contribute to the original PV refit
-                  if (config.debugPvRefit) {
-                    LOG(info) << "--- [3 prong] trackNeg1 with globalIndex " << trackNeg1.globalIndex() << " was not a PV contributor";
-                  }
-                  nCandContr--;
-                  isTrackSecondContr = false;
+                nCandContr--;
+                isTrackFirstContr = false;
+              }
+              if (trackSecondIt == vecPvContributorGlobId.end()) {
+                /// This track did not contribute to the original PV refit
+                if (config.debugPvRefit) {
+                  LOG(info) << "--- [3 prong] trackNeg1 with globalIndex " << trackNeg1.globalIndex() << " was not a PV contributor";
                 }
-                if (trackThirdIt == vecPvContributorGlobId.end()) {
-                  /// This track did not contribute to the original PV refit
-                  if (config.debugPvRefit) {
-                    LOG(info) << "--- [3 prong] trackNeg2 with globalIndex " << trackNeg2.globalIndex() << " was not a PV contributor";
-                  }
-                  nCandContr--;
-                  isTrackThirdContr = false;
+                nCandContr--;
+                isTrackSecondContr = false;
+              }
+              if (trackThirdIt == vecPvContributorGlobId.end()) {
+                /// This track did not contribute to the original PV refit
+                if (config.debugPvRefit) {
+                  LOG(info) << "--- [3 prong] trackPos2 with globalIndex " << trackPos2.globalIndex() << " was not a PV contributor";
                 }
+                nCandContr--;
+                isTrackThirdContr = false;
+              }
 
-                // Fill a vector with global ID of candidate daughters that are contributors
-                std::vector<int64_t> vecCandPvContributorGlobId = {};
-                if (isTrackFirstContr) {
-                  vecCandPvContributorGlobId.push_back(trackPos1.globalIndex());
+              // Fill a vector with global ID of candidate daughters that are contributors
+              std::vector<int64_t> vecCandPvContributorGlobId = {};
+              if (isTrackFirstContr) {
+                vecCandPvContributorGlobId.push_back(trackPos1.globalIndex());
+              }
+              if (isTrackSecondContr) {
+                vecCandPvContributorGlobId.push_back(trackNeg1.globalIndex());
+              }
+              if (isTrackThirdContr) {
+                vecCandPvContributorGlobId.push_back(trackPos2.globalIndex());
+              }
+
+              if (nCandContr == 3 || nCandContr == 2) { // o2-linter: disable="magic-number" (see comment below)
+                /// At least two of the daughter tracks were used for the original PV refit, let's refit it after excluding them
+                if (config.debugPvRefit) {
+                  LOG(info) << "### [3 prong] Calling performPvRefitCandProngs for HF 3 prong candidate, removing " << nCandContr << " daughters";
+                }
+                performPvRefitCandProngs(collision, bcWithTimeStamps, vecPvContributorGlobId, vecPvContributorTrackParCov, vecCandPvContributorGlobId, pvRefitCoord3Prong2Pos1Neg, pvRefitCovMatrix3Prong2Pos1Neg);
+              } else if (nCandContr == 1) {
+                /// Only one daughter was a contributor, let's use then the PV recalculated by excluding only it
+                if (config.debugPvRefit) {
+                  LOG(info) << "####### [3 Prong] nCandContr==" << nCandContr << " ---> just 1 contributor!";
+                }
+                if (config.fillHistograms) {
+                  registry.fill(HIST("PvRefit/verticesPerCandidate"), 5);
                 }
-                if (isTrackSecondContr) {
-                  vecCandPvContributorGlobId.push_back(trackNeg1.globalIndex());
+                if (isTrackFirstContr && !isTrackSecondContr && !isTrackThirdContr) {
+                  /// the first daughter is contributor, the second and the third are not
+                  pvRefitCoord3Prong2Pos1Neg = {trackPos1.pvRefitX(), trackPos1.pvRefitY(), trackPos1.pvRefitZ()};
+                  pvRefitCovMatrix3Prong2Pos1Neg = {trackPos1.pvRefitSigmaX2(), trackPos1.pvRefitSigmaXY(), trackPos1.pvRefitSigmaY2(), trackPos1.pvRefitSigmaXZ(), trackPos1.pvRefitSigmaYZ(), trackPos1.pvRefitSigmaZ2()};
+                } else if (!isTrackFirstContr && isTrackSecondContr && !isTrackThirdContr) {
+                  /// the second daughter is contributor, the first and the third are not
+                  pvRefitCoord3Prong2Pos1Neg = {trackNeg1.pvRefitX(), trackNeg1.pvRefitY(), trackNeg1.pvRefitZ()};
+                  pvRefitCovMatrix3Prong2Pos1Neg = {trackNeg1.pvRefitSigmaX2(), trackNeg1.pvRefitSigmaXY(), trackNeg1.pvRefitSigmaY2(), trackNeg1.pvRefitSigmaXZ(), trackNeg1.pvRefitSigmaYZ(), trackNeg1.pvRefitSigmaZ2()};
+                } else if (!isTrackFirstContr && !isTrackSecondContr && isTrackThirdContr) {
+                  /// the third daughter is contributor, the first and the second are not
+                  pvRefitCoord3Prong2Pos1Neg = {trackPos2.pvRefitX(), trackPos2.pvRefitY(), trackPos2.pvRefitZ()};
+                  pvRefitCovMatrix3Prong2Pos1Neg = {trackPos2.pvRefitSigmaX2(), trackPos2.pvRefitSigmaXY(), trackPos2.pvRefitSigmaY2(), trackPos2.pvRefitSigmaXZ(), trackPos2.pvRefitSigmaYZ(), trackPos2.pvRefitSigmaZ2()};
                 }
-                if (isTrackThirdContr) {
-                  vecCandPvContributorGlobId.push_back(trackNeg2.globalIndex());
+              } else {
+                /// 0 contributors among the HF candidate daughters
+                if (config.fillHistograms) {
+                  registry.fill(HIST("PvRefit/verticesPerCandidate"), 6);
                 }
+                if (config.debugPvRefit) {
+                  LOG(info) << "####### [3 prong] nCandContr==" << nCandContr << " ---> some of the candidate daughters did not contribute to the original PV fit, PV refit not redone";
+                }
+              }
+            }
 
-                if (nCandContr == 3 || nCandContr == 2) { // o2-linter: disable="magic-number" (see comment below)
-                  /// At least two of the daughter tracks were used for the original PV refit, let's refit it after excluding them
-                  if (config.debugPvRefit) {
-                    LOG(info) << "### [3 prong] Calling performPvRefitCandProngs for HF 3 prong candidate, removing " << nCandContr << " daughters";
-                  }
-                  performPvRefitCandProngs(collision, bcWithTimeStamps, vecPvContributorGlobId, vecPvContributorTrackParCov, vecCandPvContributorGlobId, pvRefitCoord3Prong1Pos2Neg, pvRefitCovMatrix3Prong1Pos2Neg);
-                } else if (nCandContr == 1) {
-                  /// Only one daughter was a contributor, let's use then the PV recalculated by excluding only it
-                  if (config.debugPvRefit) {
-                    LOG(info) << "####### [3 Prong] nCandContr==" << nCandContr << " ---> just 1 contributor!";
-                  }
-                  if (config.fillHistograms) {
-                    registry.fill(HIST("PvRefit/verticesPerCandidate"), 5);
-                  }
-                  if (isTrackFirstContr && !isTrackSecondContr && !isTrackThirdContr) {
-                    /// the first daughter is contributor, the second and the third are not
-                    pvRefitCoord3Prong1Pos2Neg = {trackPos1.pvRefitX(), trackPos1.pvRefitY(), trackPos1.pvRefitZ()};
-                    pvRefitCovMatrix3Prong1Pos2Neg = {trackPos1.pvRefitSigmaX2(), trackPos1.pvRefitSigmaXY(), trackPos1.pvRefitSigmaY2(), trackPos1.pvRefitSigmaXZ(), trackPos1.pvRefitSigmaYZ(), trackPos1.pvRefitSigmaZ2()};
-                  } else if (!isTrackFirstContr && isTrackSecondContr && !isTrackThirdContr) {
-                    /// the second daughter is contributor, the first and the third are not
-                    pvRefitCoord3Prong1Pos2Neg = {trackNeg1.pvRefitX(), trackNeg1.pvRefitY(), trackNeg1.pvRefitZ()};
-                    pvRefitCovMatrix3Prong1Pos2Neg = {trackNeg1.pvRefitSigmaX2(), trackNeg1.pvRefitSigmaXY(), trackNeg1.pvRefitSigmaY2(), trackNeg1.pvRefitSigmaXZ(), trackNeg1.pvRefitSigmaYZ(), trackNeg1.pvRefitSigmaZ2()};
-                  } else if (!isTrackFirstContr && !isTrackSecondContr && isTrackThirdContr) {
-                    /// the third daughter is contributor, the first and the second are not
-                    pvRefitCoord3Prong1Pos2Neg = {trackNeg2.pvRefitX(), trackNeg2.pvRefitY(), trackNeg2.pvRefitZ()};
-                    pvRefitCovMatrix3Prong1Pos2Neg = {trackNeg2.pvRefitSigmaX2(), trackNeg2.pvRefitSigmaXY(), trackNeg2.pvRefitSigmaY2(), trackNeg2.pvRefitSigmaXZ(), trackNeg2.pvRefitSigmaYZ(), trackNeg2.pvRefitSigmaZ2()};
+            // reconstruct the 3-prong secondary vertex
+            int nVtxFrom3ProngFitter = 0;
+            try {
+              nVtxFrom3ProngFitter = worker.df3.process(trackParVarPos1, trackParVarNeg1, trackParVarPos2);
+            } catch (...) {
+              continue;
+            }
+
+            if (nVtxFrom3ProngFitter == 0) {
+              continue;
+            }
+            // get secondary vertex
+            const auto& secondaryVertex3 = worker.df3.getPCACandidate();
+            // get track momenta
+            std::array<float, 3> pvec0{};
+            std::array<float, 3> pvec1{};
+            std::array<float, 3> pvec2{};
+            const auto trackParVarPcaPos1 = worker.df3.getTrack(0);
+            const auto trackParVarPcaNeg1 = worker.df3.getTrack(1);
+            const auto trackParVarPcaPos2 = worker.df3.getTrack(2);
+            trackParVarPcaPos1.getPxPyPzGlo(pvec0);
+            trackParVarPcaNeg1.getPxPyPzGlo(pvec1);
+            trackParVarPcaPos2.getPxPyPzGlo(pvec2);
+            const auto pVecCandProng3Pos = RecoDecay::pVec(pvec0, pvec1, pvec2);
+
+            // 3-prong selections after secondary vertex
+            applySelection3Prong(pVecCandProng3Pos, secondaryVertex3, pvRefitCoord3Prong2Pos1Neg, cutStatus3Prong, isSelected3ProngCand);
+
+            std::array<std::vector<float>, kN3ProngDecaysUsedMlForHfFilters> mlScores3Prongs;
+            if (config.applyMlForHfFilters) {
+              const std::vector<float> inputFeatures{trackParVarPcaPos1.getPt(), dcaInfoPos1[0], dcaInfoPos1[1], trackParVarPcaNeg1.getPt(), dcaInfoNeg1[0], dcaInfoNeg1[1], trackParVarPcaPos2.getPt(), dcaInfoPos2[0], dcaInfoPos2[1]};
+              std::vector<float> inputFeaturesLcPid{};
+              if constexpr (UsePidForHfFiltersBdt) {
+                inputFeaturesLcPid.push_back(trackPos1.tpcNSigmaPr());
+                inputFeaturesLcPid.push_back(trackPos2.tpcNSigmaPr());
+                inputFeaturesLcPid.push_back(trackPos1.tpcNSigmaPi());
+                inputFeaturesLcPid.push_back(trackPos2.tpcNSigmaPi());
+                inputFeaturesLcPid.push_back(trackNeg1.tpcNSigmaKa());
+              }
+              applyMlSelectionForHfFilters3Prong<UsePidForHfFiltersBdt>(inputFeatures, inputFeaturesLcPid, mlScores3Prongs, isSelected3ProngCand);
+            }
+
+            if (!config.debug && isSelected3ProngCand == 0) {
+              continue;
+            }
+
+            // fill table row
+            output.prong3.push_back({thisCollId, trackPos1.globalIndex(), trackNeg1.globalIndex(), trackPos2.globalIndex(), static_cast<uint32_t>(isSelected3ProngCand)});
+            if (config.applyMlForHfFilters) {
+              rowTrackIndexMlScoreProng3(mlScores3Prongs[0], mlScores3Prongs[1], mlScores3Prongs[2], mlScores3Prongs[3]);
+            }
+            if constexpr (DoPvRefit) {
+              // fill table row of coordinates of PV refit
+              rowProng3PVrefit(pvRefitCoord3Prong2Pos1Neg[0], pvRefitCoord3Prong2Pos1Neg[1], pvRefitCoord3Prong2Pos1Neg[2],
+                               pvRefitCovMatrix3Prong2Pos1Neg[0], pvRefitCovMatrix3Prong2Pos1Neg[1], pvRefitCovMatrix3Prong2Pos1Neg[2], pvRefitCovMatrix3Prong2Pos1Neg[3], pvRefitCovMatrix3Prong2Pos1Neg[4], pvRefitCovMatrix3Prong2Pos1Neg[5]);
+            }
+
+            if (config.debug) {
+              uint8_t prong3CutStatus[kN3ProngDecays];
+              for (int iDecay3P = 0; iDecay3P < kN3ProngDecays; iDecay3P++) {
+                prong3CutStatus[iDecay3P] = nCutStatus3ProngBit[iDecay3P];
+                for (int iCut = 0; iCut < kNCuts3Prong[iDecay3P]; iCut++) {
+                  if (!cutStatus3Prong[iDecay3P][iCut]) {
+                    CLRBIT(prong3CutStatus[iDecay3P], iCut);
                   }
-                } else {
-                  /// 0 contributors among the HF candidate daughters
-                  if (config.fillHistograms) {
-                    registry.fill(HIST("PvRefit/verticesPerCandidate"), 6);
+                }
+              }
+              rowProng3CutStatus(prong3CutStatus[0], prong3CutStatus[1], prong3CutStatus[2], prong3CutStatus[3]); // FIXME when we can do this by looping over kN3ProngDecays
+            }
+
+            // fill histograms
+            if (config.fillHistograms) {
+              registry.fill(HIST("hVtx3ProngX"), secondaryVertex3[0]);
+              registry.fill(HIST("hVtx3ProngY"), secondaryVertex3[1]);
+              registry.fill(HIST("hVtx3ProngZ"), secondaryVertex3[2]);
+              const std::array arr3Mom{pvec0, pvec1, pvec2};
+              for (int iDecay3P = 0; iDecay3P < kN3ProngDecays; iDecay3P++) {
+                if (TESTBIT(isSelected3ProngCand, iDecay3P)) {
+                  if (TESTBIT(whichHypo3Prong[iDecay3P], 0)) {
+                    const auto mass3Prong = RecoDecay::m(arr3Mom, arrMass3Prong[iDecay3P][0]);
+                    switch (iDecay3P) {
+                      case hf_cand_3prong::DecayType::DplusToPiKPi:
+                        registry.fill(HIST("hMassDPlusToPiKPi"), mass3Prong);
+                        break;
+                      case hf_cand_3prong::DecayType::DsToKKPi:
+                        registry.fill(HIST("hMassDsToKKPi"), mass3Prong);
+                        break;
+                      case hf_cand_3prong::DecayType::LcToPKPi:
+                        registry.fill(HIST("hMassLcToPKPi"), mass3Prong);
+                        break;
+                      case hf_cand_3prong::DecayType::XicToPKPi:
+                        registry.fill(HIST("hMassXicToPKPi"), mass3Prong);
+                        break;
+                      case hf_cand_3prong::DecayType::CdToDeKPi:
+                        registry.fill(HIST("hMassCdToDeKPi"), mass3Prong);
+                        break;
+                      case hf_cand_3prong::DecayType::CtToTrKPi:
+                        registry.fill(HIST("hMassCtToTrKPi"), mass3Prong);
+                        break;
+                      case hf_cand_3prong::DecayType::ChToHeKPi:
+                        registry.fill(HIST("hMassChToHeKPi"), mass3Prong);
+                        break;
+                      case hf_cand_3prong::DecayType::CaToAlKPi:
+                        registry.fill(HIST("hMassCaToAlKPi"), mass3Prong);
+                        break;
+                    }
                   }
-                  if (config.debugPvRefit) {
-                    LOG(info) << "####### [3 prong] nCandContr==" << nCandContr << " ---> some of the candidate daughters did not contribute to the original PV fit, PV refit not redone";
+                  if (TESTBIT(whichHypo3Prong[iDecay3P], 1)) {
+                    const auto mass3Prong = RecoDecay::m(arr3Mom, arrMass3Prong[iDecay3P][1]);
+                    switch (iDecay3P) {
+                      case hf_cand_3prong::DecayType::DsToKKPi:
+                        registry.fill(HIST("hMassDsToKKPi"), mass3Prong);
+                        break;
+                      case hf_cand_3prong::DecayType::LcToPKPi:
+                        registry.fill(HIST("hMassLcToPKPi"), mass3Prong);
+                        break;
+                      case hf_cand_3prong::DecayType::XicToPKPi:
+                        registry.fill(HIST("hMassXicToPKPi"), mass3Prong);
+                        break;
+                      case hf_cand_3prong::DecayType::CdToDeKPi:
+                        registry.fill(HIST("hMassCdToDeKPi"), mass3Prong);
+                        break;
+                      case hf_cand_3prong::DecayType::CtToTrKPi:
+                        registry.fill(HIST("hMassCtToTrKPi"), mass3Prong);
+                        break;
+                      case hf_cand_3prong::DecayType::ChToHeKPi:
+                        registry.fill(HIST("hMassChToHeKPi"), mass3Prong);
+                        break;
+                      case hf_cand_3prong::DecayType::CaToAlKPi:
+                        registry.fill(HIST("hMassCaToAlKPi"), mass3Prong);
+                        break;
+                    }
                   }
                 }
               }
+            }
+          }
 
-              // reconstruct the 3-prong secondary vertex
-              int nVtxFrom3ProngFitterSecondLoop = 0;
-              try {
-                nVtxFrom3ProngFitterSecondLoop = df3.process(trackParVarNeg1, trackParVarPos1, trackParVarNeg2);
-              } catch (...) {
+          // second loop over negative tracks
+          int iNeg2 = iNeg1 + 1;
+          for (auto trackIndexNeg2 = trackIndexNeg1 + 1; trackIndexNeg2 != groupedTrackIndicesNeg1.end(); ++trackIndexNeg2, ++iNeg2) {
+
+            int isSelected3ProngCand = n3ProngBit;
+            if (!TESTBIT(trackParNeg.isSelProng[iNeg2], CandidateType::Cand3Prong)) { // continue immediately
+              if (!config.debug) {
                 continue;
               }
+              isSelected3ProngCand = 0;
+            }
 
-              if (nVtxFrom3ProngFitterSecondLoop == 0) {
+            if (config.applyKaonPidIn3Prongs && !TESTBIT(trackParPos.isIdentifiedPid[iPos1], ChannelKaonPid)) { // continue immediately if kaon PID enabled and opposite-sign track not a kaon
+              if (!config.debug) {
                 continue;
               }
-              // get secondary vertex
-              const auto& secondaryVertex3 = df3.getPCACandidate();
-              // get track momenta
-              std::array<float, 3> pvec0{};
-              std::array<float, 3> pvec1{};
-              std::array<float, 3> pvec2{};
-              const auto trackParVarPcaNeg1 = df3.getTrack(0);
-              const auto trackParVarPcaPos1 = df3.getTrack(1);
-              const auto trackParVarPcaNeg2 = df3.getTrack(2);
-              trackParVarPcaNeg1.getPxPyPzGlo(pvec0);
-              trackParVarPcaPos1.getPxPyPzGlo(pvec1);
-              trackParVarPcaNeg2.getPxPyPzGlo(pvec2);
+              isSelected3ProngCand = 0;
+            }
 
-              const auto pVecCandProng3Neg = RecoDecay::pVec(pvec0, pvec1, pvec2);
+            auto trackNeg2 = trackIndexNeg2.template track_as<TTracks>();
+            // tracks of candidates already rejected (debug mode) are not re-propagated to the PV
+            const auto trackParVarNeg2 = isSelected3ProngCand ? trackParNeg.trackParVar[iNeg2] : getTrackParCov(trackNeg2);
+            const auto dcaInfoNeg2 = isSelected3ProngCand ? trackParNeg.dcaInfo[iNeg2] : std::array{trackNeg2.dcaXY(), trackNeg2.dcaZ()};
 
-              // 3-prong selections after secondary vertex
-              applySelection3Prong(pVecCandProng3Neg, secondaryVertex3, pvRefitCoord3Prong1Pos2Neg, cutStatus3Prong, isSelected3ProngCand);
+            // preselection of 3-prong candidates
+            if (isSelected3ProngCand) {
+              const auto& pVecTrackNeg2 = trackParNeg.pVec[iNeg2];
 
-              std::array<std::vector<float>, kN3ProngDecaysUsedMlForHfFilters> mlScores3Prongs{};
-              if (config.applyMlForHfFilters) {
-                const std::vector<float> inputFeatures{trackParVarPcaNeg1.getPt(), dcaInfoNeg1[0], dcaInfoNeg1[1], trackParVarPcaPos1.getPt(), dcaInfoPos1[0], dcaInfoPos1[1], trackParVarPcaNeg2.getPt(), dcaInfoNeg2[0], dcaInfoNeg2[1]};
-                std::vector<float> inputFeaturesLcPid{};
-                if constexpr (UsePidForHfFiltersBdt) {
-                  inputFeaturesLcPid.push_back(trackNeg1.tpcNSigmaPr());
-                  inputFeaturesLcPid.push_back(trackNeg2.tpcNSigmaPr());
-                  inputFeaturesLcPid.push_back(trackNeg1.tpcNSigmaPi());
-                  inputFeaturesLcPid.push_back(trackNeg2.tpcNSigmaPi());
-                  inputFeaturesLcPid.push_back(trackPos1.tpcNSigmaKa());
+              if (config.debug) {
+                for (int iDecay3P = 0; iDecay3P < kN3ProngDecays; iDecay3P++) {
+                  for (int iCut = 0; iCut < kNCuts3Prong[iDecay3P]; iCut++) {
+                    cutStatus3Prong[iDecay3P][iCut] = true;
+                  }
                 }
-                applyMlSelectionForHfFilters3Prong<UsePidForHfFiltersBdt>(inputFeatures, inputFeaturesLcPid, mlScores3Prongs, isSelected3ProngCand);
               }
 
+              // 3-prong preselections
+              int8_t const isIdentifiedPidTrackNeg1 = trackParNeg.isIdentifiedPid[iNeg1];
+              int8_t const isIdentifiedPidTrackNeg2 = trackParNeg.isIdentifiedPid[iNeg2];
+              applyPreselection3Prong(pVecTrackNeg1, pVecTrackPos1, pVecTrackNeg2, isIdentifiedPidTrackNeg1, isIdentifiedPidTrackNeg2, cutStatus3Prong, whichHypo3Prong, isSelected3ProngCand);
               if (!config.debug && isSelected3ProngCand == 0) {
                 continue;
               }
+            }
 
-              // fill table row
-              rowTrackIndexProng3(thisCollId, trackNeg1.globalIndex(), trackPos1.globalIndex(), trackNeg2.globalIndex(), isSelected3ProngCand);
-              if (config.applyMlForHfFilters) {
-                rowTrackIndexMlScoreProng3(mlScores3Prongs[0], mlScores3Prongs[1], mlScores3Prongs[2], mlScores3Prongs[3]);
+            /// PV refit excluding the candidate daughters, if contributors
+            std::array pvRefitCoord3Prong1Pos2Neg{collision.posX(), collision.posY(), collision.posZ()}; /// initialize to the original PV
+            std::array pvRefitCovMatrix3Prong1Pos2Neg{getPrimaryVertex(collision).getCov()};             /// initialize to the original PV
+            if constexpr (DoPvRefit) {
+              if (config.fillHistograms) {
+                registry.fill(HIST("PvRefit/verticesPerCandidate"), 1);
               }
-              if constexpr (DoPvRefit) {
-                // fill table row of coordinates of PV refit
-                rowProng3PVrefit(pvRefitCoord3Prong1Pos2Neg[0], pvRefitCoord3Prong1Pos2Neg[1], pvRefitCoord3Prong1Pos2Neg[2],
-                                 pvRefitCovMatrix3Prong1Pos2Neg[0], pvRefitCovMatrix3Prong1Pos2Neg[1], pvRefitCovMatrix3Prong1Pos2Neg[2], pvRefitCovMatrix3Prong1Pos2Neg[3], pvRefitCovMatrix3Prong1Pos2Neg[4], pvRefitCovMatrix3Prong1Pos2Neg[5]);
+              int nCandContr = 3;
+              auto trackFirstIt = std::find(vecPvContributorGlobId.begin(), vecPvContributorGlobId.end(), trackPos1.globalIndex());
+              auto trackSecondIt = std::find(vecPvContributorGlobId.begin(), vecPvContributorGlobId.end(), trackNeg1.globalIndex());
+              auto trackThirdIt = std::find(vecPvContributorGlobId.begin(), vecPvContributorGlobId.end(), trackNeg2.globalIndex());
+              bool isTrackFirstContr = true;
+              bool isTrackSecondContr = true;
+              bool isTrackThirdContr = true;
+              if (trackFirstIt == vecPvContributorGlobId.end()) {
+                /// This track did not contribute to the original PV refit
+                if (config.debugPvRefit) {
+                  LOG(info) << "--- [3 prong] trackPos1 with globalIndex " << trackPos1.globalIndex() << " was not a PV contributor";
+                }
+                nCandContr--;
+                isTrackFirstContr = false;
               }
-
-              if (config.debug) {
-                int prong3CutStatus[kN3ProngDecays];
-                for (int iDecay3P = 0; iDecay3P < kN3ProngDecays; iDecay3P++) {
-                  prong3CutStatus[iDecay3P] = nCutStatus3ProngBit[iDecay3P];
-                  for (int iCut = 0; iCut < kNCuts3Prong[iDecay3P]; iCut++) {
-                    if (!cutStatus3Prong[iDecay3P][iCut]) {
-                      CLRBIT(prong3CutStatus[iDecay3P], iCut);
-                    }
-                  }
+              if (trackSecondIt == vecPvContributorGlobId.end()) {
+                /// This track did not contribute to the original PV refit
+                if (config.debugPvRefit) {
+                  LOG(info) << "--- [3 prong] trackNeg1 with globalIndex " << trackNeg1.globalIndex() << " was not a PV contributor";
                 }
-                rowProng3CutStatus(prong3CutStatus[0], prong3CutStatus[1], prong3CutStatus[2], prong3CutStatus[3]); // FIXME when we can do this by looping over kN3ProngDecays
+                nCandContr--;
+                isTrackSecondContr = false;
+              }
+              if (trackThirdIt == vecPvContributorGlobId.end()) {
+                /// This track did not contribute to the original PV refit
+                if (config.debugPvRefit) {
+                  LOG(info) << "--- [3 prong] trackNeg2 with globalIndex " << trackNeg2.globalIndex() << " was not a PV contributor";
+                }
+                nCandContr--;
+                isTrackThirdContr = false;
               }
 
-              // fill histograms
-              if (config.fillHistograms) {
-                registry.fill(HIST("hVtx3ProngX"), secondaryVertex3[0]);
-                registry.fill(HIST("hVtx3ProngY"), secondaryVertex3[1]);
-                registry.fill(HIST("hVtx3ProngZ"), secondaryVertex3[2]);
-                const std::array arr3Mom{pvec0, pvec1, pvec2};
-                for (int iDecay3P = 0; iDecay3P < kN3ProngDecays; iDecay3P++) {
-                  if (TESTBIT(isSelected3ProngCand, iDecay3P)) {
-                    if (TESTBIT(whichHypo3Prong[iDecay3P], 0)) {
-                      const auto mass3Prong = RecoDecay::m(arr3Mom, arrMass3Prong[iDecay3P][0]);
-                      switch (iDecay3P) {
-                        case hf_cand_3prong::DecayType::DplusToPiKPi:
-                          registry.fill(HIST("hMassDPlusToPiKPi"), mass3Prong);
-                          break;
-                        case hf_cand_3prong::DecayType::DsToKKPi:
-                          registry.fill(HIST("hMassDsToKKPi"), mass3Prong);
-                          break;
-                        case hf_cand_3prong::DecayType::LcToPKPi:
-                          registry.fill(HIST("hMassLcToPKPi"), mass3Prong);
-                          break;
-                        case hf_cand_3prong::DecayType::XicToPKPi:
-                          registry.fill(HIST("hMassXicToPKPi"), mass3Prong);
-                          break;
-                        case hf_cand_3prong::DecayType::CdToDeKPi:
-                          registry.fill(HIST("hMassCdToDeKPi"), mass3Prong);
-                          break;
-                        case hf_cand_3prong::DecayType::CtToTrKPi:
-                          registry.fill(HIST("hMassCtToTrKPi"), mass3Prong);
-                          break;
-                        case hf_cand_3prong::DecayType::ChToHeKPi:
-                          registry.fill(HIST("hMassChToHeKPi"), mass3Prong);
-                          break;
-                        case hf_cand_3prong::DecayType::CaToAlKPi:
-                          registry.fill(HIST("hMassCaToAlKPi"), mass3Prong);
-                          break;
-                      }
-                    }
-                    if (TESTBIT(whichHypo3Prong[iDecay3P], 1)) {
-                      const auto mass3Prong = RecoDecay::m(arr3Mom, arrMass3Prong[iDecay3P][1]);
-                      switch (iDecay3P) {
-                        case hf_cand_3prong::DecayType::DsToKKPi:
-                          registry.fill(HIST("hMassDsToKKPi"), mass3Prong);
-                          break;
-                        case hf_cand_3prong::DecayType::LcToPKPi:
-                          registry.fill(HIST("hMassLcToPKPi"), mass3Prong);
-                          break;
-                        case hf_cand_3prong::DecayType::XicToPKPi:
-                          registry.fill(HIST("hMassXicToPKPi"), mass3Prong);
-                          break;
-                        case hf_cand_3prong::DecayType::CdToDeKPi:
-                          registry.fill(HIST("hMassCdToDeKPi"), mass3Prong);
-                          break;
-                        case hf_cand_3prong::DecayType::CtToTrKPi:
-                          registry.fill(HIST("hMassCtToTrKPi"), mass3Prong);
-                          break;
-                        case hf_cand_3prong::DecayType::ChToHeKPi:
-                          registry.fill(HIST("hMassChToHeKPi"), mass3Prong);
-                          break;
-                        case hf_cand_3prong::DecayType::CaToAlKPi:
-                          registry.fill(HIST("hMassCaToAlKPi"), mass3Prong);
-                          break;
-                      }
-                    }
-                  }
+              // Fill a vector with global ID of candidate daughters that are contributors
+              std::vector<int64_t> vecCandPvContributorGlobId = {};
+              if (isTrackFirstContr) {
+                vecCandPvContributorGlobId.push_back(trackPos1.globalIndex());
+              }
+              if (isTrackSecondContr) {
+                vecCandPvContributorGlobId.push_back(trackNeg1.globalIndex());
+              }
+              if (isTrackThirdContr) {
+                vecCandPvContributorGlobId.push_back(trackNeg2.globalIndex());
+              }
+
+              if (nCandContr == 3 || nCandContr == 2) { // o2-linter: disable="magic-number" (see comment below)
+                /// At least two of the daughter tracks were used for the original PV refit, let's refit it after excluding them
+                if (config.debugPvRefit) {
+                  LOG(info) << "### [3 prong] Calling performPvRefitCandProngs for HF 3 prong candidate, removing " << nCandContr << " daughters";
+                }
+                performPvRefitCandProngs(collision, bcWithTimeStamps, vecPvContributorGlobId, vecPvContributorTrackParCov, vecCandPvContributorGlobId, pvRefitCoord3Prong1Pos2Neg, pvRefitCovMatrix3Prong1Pos2Neg);
+              } else if (nCandContr == 1) {
+                /// Only one daughter was a contributor, let's use then the PV recalculated by excluding only it
+                if (config.debugPvRefit) {
+                  LOG(info) << "####### [3 Prong] nCandContr==" << nCandContr << " ---> just 1 contributor!";
+                }
+                if (config.fillHistograms) {
+                  registry.fill(HIST("PvRefit/verticesPerCandidate"), 5);
+                }
+                if (isTrackFirstContr && !isTrackSecondContr && !isTrackThirdContr) {
+                  /// the first daughter is contributor, the second and the third are not
+                  pvRefitCoord3Prong1Pos2Neg = {trackPos1.pvRefitX(), trackPos1.pvRefitY(), trackPos1.pvRefitZ()};
+                  pvRefitCovMatrix3Prong1Pos2Neg = {trackPos1.pvRefitSigmaX2(), trackPos1.pvRefitSigmaXY(), trackPos1.pvRefitSigmaY2(), trackPos1.pvRefitSigmaXZ(), trackPos1.pvRefitSigmaYZ(), trackPos1.pvRefitSigmaZ2()};
+                } else if (!isTrackFirstContr && isTrackSecondContr && !isTrackThirdContr) {
+                  /// the second daughter is contributor, the first and the third are not
+                  pvRefitCoord3Prong1Pos2Neg = {trackNeg1.pvRefitX(), trackNeg1.pvRefitY(), trackNeg1.pvRefitZ()};
+                  pvRefitCovMatrix3Prong1Pos2Neg = {trackNeg1.pvRefitSigmaX2(), trackNeg1.pvRefitSigmaXY(), trackNeg1.pvRefitSigmaY2(), trackNeg1.pvRefitSigmaXZ(), trackNeg1.pvRefitSigmaYZ(), trackNeg1.pvRefitSigmaZ2()};
+                } else if (!isTrackFirstContr && !isTrackSecondContr && isTrackThirdContr) {
+                  /// the third daughter is contributor, the first and the second are not
+                  pvRefitCoord3Prong1Pos2Neg = {trackNeg2.pvRefitX(), trackNeg2.pvRefitY(), trackNeg2.pvRefitZ()};
+                  pvRefitCovMatrix3Prong1Pos2Neg = {trackNeg2.pvRefitSigmaX2(), trackNeg2.pvRefitSigmaXY(), trackNeg2.pvRefitSigmaY2(), trackNeg2.pvRefitSigmaXZ(), trackNeg2.pvRefitSigmaYZ(), trackNeg2.pvRefitSigmaZ2()};
+                }
+              } else {
+                /// 0 contributors among the HF candidate daughters
+                if (config.fillHistograms) {
+                  registry.fill(HIST("PvRefit/verticesPerCandidate"), 6);
+                }
+                if (config.debugPvRefit) {
+                  LOG(info) << "####### [3 prong] nCandContr==" << nCandContr << " ---> some of the candidate daughters did not contribute to the original PV fit, PV refit not redone";
                 }
               }
             }
-          }
 
-          if (config.doDstar && TESTBIT(isSelected2ProngCand, hf_cand_2prong::DecayType::D0ToPiK) && (pt2Prong + config.ptTolerance) * 1.2 > config.binsPtDstarToD0Pi->at(0) && whichHypo2Prong[kN2ProngDecays] != 0) { // o2-linter: disable="magic-number" (see comment below)
-                                                                                                                                                                                                                        // if D* enabled and pt of the D0 is larger than the minimum of the D* one within 20% (D* and D0 momenta are very similar, always within 20% according to PYTHIA8)
-            // second loop over positive tracks
-            if (TESTBIT(whichHypo2Prong[kN2ProngDecays], 0) && (!config.applyKaonPidIn3Prongs || TESTBIT(trackIndexNeg1.isIdentifiedPid(), ChannelKaonPid))) { // only for D0 candidates; moreover if kaon PID enabled, apply to the negative track
-              auto groupedTrackIndicesSoftPionsPos = positiveSoftPions->sliceByCached(aod::track::collisionId, collision.globalIndex(), cache);
-              for (auto trackIndexPos2 = groupedTrackIndicesSoftPionsPos.begin(); trackIndexPos2 != groupedTrackIndicesSoftPionsPos.end(); ++trackIndexPos2) {
-                if (trackIndexPos2 == trackIndexPos1) {
-                  continue;
-                }
-                auto trackPos2 = trackIndexPos2.template track_as<TTracks>();
-                std::array pVecTrackPos2{trackPos2.pVector()};
-                if (thisCollId != trackPos2.collisionId()) { // this is not the "default" collision for this track, we have to re-propagate it
-                  auto trackParVarPos2 = getTrackParCov(trackPos2);
-                  std::array dcaInfoPos2{trackPos2.dcaXY(), trackPos2.dcaZ()};
-                  o2::base::Propagator::Instance()->propagateToDCABxByBz({collision.posX(), collision.posY(), collision.posZ()}, trackParVarPos2, 2.f, noMatCorr, &dcaInfoPos2);
-                  getPxPyPz(trackParVarPos2, pVecTrackPos2);
+            // reconstruct the 3-prong secondary vertex
+            int nVtxFrom3ProngFitterSecondLoop = 0;
+            try {
+              nVtxFrom3ProngFitterSecondLoop = worker.df3.process(trackParVarNeg1, trackParVarPos1, trackParVarNeg2);
+            } catch (...) {
+              continue;
+            }
+
+            if (nVtxFrom3ProngFitterSecondLoop == 0) {
+              continue;
+            }
+            // get secondary vertex
+            const auto& secondaryVertex3 = worker.df3.getPCACandidate();
+            // get track momenta
+            std::array<float, 3> pvec0{};
+            std::array<float, 3> pvec1{};
+            std::array<float, 3> pvec2{};
+            const auto trackParVarPcaNeg1 = worker.df3.getTrack(0);
+            const auto trackParVarPcaPos1 = worker.df3.getTrack(1);
+            const auto trackParVarPcaNeg2 = worker.df3.getTrack(2);
+            trackParVarPcaNeg1.getPxPyPzGlo(pvec0);
+            trackParVarPcaPos1.getPxPyPzGlo(pvec1);
+            trackParVarPcaNeg2.getPxPyPzGlo(pvec2);
+
+            const auto pVecCandProng3Neg = RecoDecay::pVec(pvec0, pvec1, pvec2);
+
+            // 3-prong selections after secondary vertex
+            applySelection3Prong(pVecCandProng3Neg, secondaryVertex3, pvRefitCoord3Prong1Pos2Neg, cutStatus3Prong, isSelected3ProngCand);
+
+            std::array<std::vector<float>, kN3ProngDecaysUsedMlForHfFilters> mlScores3Prongs{};
+            if (config.applyMlForHfFilters) {
+              const std::vector<float> inputFeatures{trackParVarPcaNeg1.getPt(), dcaInfoNeg1[0], dcaInfoNeg1[1], trackParVarPcaPos1.getPt(), dcaInfoPos1[0], dcaInfoPos1[1], trackParVarPcaNeg2.getPt(), dcaInfoNeg2[0], dcaInfoNeg2[1]};
+              std::vector<float> inputFeaturesLcPid{};
+              if constexpr (UsePidForHfFiltersBdt) {
+                inputFeaturesLcPid.push_back(trackNeg1.tpcNSigmaPr());
+                inputFeaturesLcPid.push_back(trackNeg2.tpcNSigmaPr());
+                inputFeaturesLcPid.push_back(trackNeg1.tpcNSigmaPi());
+                inputFeaturesLcPid.push_back(trackNeg2.tpcNSigmaPi());
+                inputFeaturesLcPid.push_back(trackPos1.tpcNSigmaKa());
+              }
+              applyMlSelectionForHfFilters3Prong<UsePidForHfFiltersBdt>(inputFeatures, inputFeaturesLcPid, mlScores3Prongs, isSelected3ProngCand);
+            }
+
+            if (!config.debug && isSelected3ProngCand == 0) {
+              continue;
+            }
+
+            // fill table row
+            output.prong3.push_back({thisCollId, trackNeg1.globalIndex(), trackPos1.globalIndex(), trackNeg2.globalIndex(), static_cast<uint32_t>(isSelected3ProngCand)});
+            if (config.applyMlForHfFilters) {
+              rowTrackIndexMlScoreProng3(mlScores3Prongs[0], mlScores3Prongs[1], mlScores3Prongs[2], mlScores3Prongs[3]);
+            }
+            if constexpr (DoPvRefit) {
+              // fill table row of coordinates of PV refit
+              rowProng3PVrefit(pvRefitCoord3Prong1Pos2Neg[0], pvRefitCoord3Prong1Pos2Neg[1], pvRefitCoord3Prong1Pos2Neg[2],
+                               pvRefitCovMatrix3Prong1Pos2Neg[0], pvRefitCovMatrix3Prong1Pos2Neg[1], pvRefitCovMatrix3Prong1Pos2Neg[2], pvRefitCovMatrix3Prong1Pos2Neg[3], pvRefitCovMatrix3Prong1Pos2Neg[4], pvRefitCovMatrix3Prong1Pos2Neg[5]);
+            }
+
+            if (config.debug) {
+              int prong3CutStatus[kN3ProngDecays];
+              for (int iDecay3P = 0; iDecay3P < kN3ProngDecays; iDecay3P++) {
+                prong3CutStatus[iDecay3P] = nCutStatus3ProngBit[iDecay3P];
+                for (int iCut = 0; iCut < kNCuts3Prong[iDecay3P]; iCut++) {
+                  if (!cutStatus3Prong[iDecay3P][iCut]) {
+                    CLRBIT(prong3CutStatus[iDecay3P], iCut);
+                  }
                 }
+              }
+              rowProng3CutStatus(prong3CutStatus[0], prong3CutStatus[1], prong3CutStatus[2], prong3CutStatus[3]); // FIXME when we can do this by looping over kN3ProngDecays
+            }
 
-                uint8_t isSelectedDstar{0};
-                uint8_t cutStatus{BIT(kNCutsDstar) - 1};
-                float deltaMass{-1.};
-                isSelectedDstar = applySelectionDstar(pVecTrackPos1, pVecTrackNeg1, pVecTrackPos2, cutStatus, deltaMass); // we do not compute the D* decay vertex at this stage because we are not interested in applying topological selections
-                if (isSelectedDstar) {
-                  rowTrackIndexDstar(thisCollId, trackPos2.globalIndex(), lastFilledD0);
-                  if (config.fillHistograms) {
-                    registry.fill(HIST("hMassDstarToD0Pi"), deltaMass);
+            // fill histograms
+            if (config.fillHistograms) {
+              registry.fill(HIST("hVtx3ProngX"), secondaryVertex3[0]);
+              registry.fill(HIST("hVtx3ProngY"), secondaryVertex3[1]);
+              registry.fill(HIST("hVtx3ProngZ"), secondaryVertex3[2]);
+              const std::array arr3Mom{pvec0, pvec1, pvec2};
+              for (int iDecay3P = 0; iDecay3P < kN3ProngDecays; iDecay3P++) {
+                if (TESTBIT(isSelected3ProngCand, iDecay3P)) {
+                  if (TESTBIT(whichHypo3Prong[iDecay3P], 0)) {
+                    const auto mass3Prong = RecoDecay::m(arr3Mom, arrMass3Prong[iDecay3P][0]);
+                    switch (iDecay3P) {
+                      case hf_cand_3prong::DecayType::DplusToPiKPi:
+                        registry.fill(HIST("hMassDPlusToPiKPi"), mass3Prong);
+                        break;
+                      case hf_cand_3prong::DecayType::DsToKKPi:
+                        registry.fill(HIST("hMassDsToKKPi"), mass3Prong);
+                        break;
+                      case hf_cand_3prong::DecayType::LcToPKPi:
+                        registry.fill(HIST("hMassLcToPKPi"), mass3Prong);
+                        break;
+                      case hf_cand_3prong::DecayType::XicToPKPi:
+                        registry.fill(HIST("hMassXicToPKPi"), mass3Prong);
+                        break;
+                      case hf_cand_3prong::DecayType::CdToDeKPi:
+                        registry.fill(HIST("hMassCdToDeKPi"), mass3Prong);
+                        break;
+                      case hf_cand_3prong::DecayType::CtToTrKPi:
+                        registry.fill(HIST("hMassCtToTrKPi"), mass3Prong);
+                        break;
+                      case hf_cand_3prong::DecayType::ChToHeKPi:
+                        registry.fill(HIST("hMassChToHeKPi"), mass3Prong);
+                        break;
+                      case hf_cand_3prong::DecayType::CaToAlKPi:
+                        registry.fill(HIST("hMassCaToAlKPi"), mass3Prong);
+                        break;
+                    }
                   }
-                  if constexpr (DoPvRefit) {
-                    // fill table row with coordinates of PV refit (same as 2-prong because we do not remove the soft pion)
-                    rowDstarPVrefit(pvRefitCoord2Prong[0], pvRefitCoord2Prong[1], pvRefitCoord2Prong[2],
-                                    pvRefitCovMatrix2Prong[0], pvRefitCovMatrix2Prong[1], pvRefitCovMatrix2Prong[2], pvRefitCovMatrix2Prong[3], pvRefitCovMatrix2Prong[4], pvRefitCovMatrix2Prong[5]);
+                  if (TESTBIT(whichHypo3Prong[iDecay3P], 1)) {
+                    const auto mass3Prong = RecoDecay::m(arr3Mom, arrMass3Prong[iDecay3P][1]);
+                    switch (iDecay3P) {
+                      case hf_cand_3prong::DecayType::DsToKKPi:
+                        registry.fill(HIST("hMassDsToKKPi"), mass3Prong);
+                        break;
+                      case hf_cand_3prong::DecayType::LcToPKPi:
+                        registry.fill(HIST("hMassLcToPKPi"), mass3Prong);
+                        break;
+                      case hf_cand_3prong::DecayType::XicToPKPi:
+                        registry.fill(HIST("hMassXicToPKPi"), mass3Prong);
+                        break;
+                      case hf_cand_3prong::DecayType::CdToDeKPi:
+                        registry.fill(HIST("hMassCdToDeKPi"), mass3Prong);
+                        break;
+                      case hf_cand_3prong::DecayType::CtToTrKPi:
+                        registry.fill(HIST("hMassCtToTrKPi"), mass3Prong);
+                        break;
+                      case hf_cand_3prong::DecayType::ChToHeKPi:
+                        registry.fill(HIST("hMassChToHeKPi"), mass3Prong);
+                        break;
+                      case hf_cand_3prong::DecayType::CaToAlKPi:
+                        registry.fill(HIST("hMassCaToAlKPi"), mass3Prong);
+                        break;
+                    }
                   }
                 }
-                if (config.debug) {
-                  rowDstarCutStatus(cutStatus);
-                }
               }
             }
+          }
+        }
 
-            // second loop over negative tracks
-            if (TESTBIT(whichHypo2Prong[kN2ProngDecays], 1) && (!config.applyKaonPidIn3Prongs || TESTBIT(trackIndexPos1.isIdentifiedPid(), ChannelKaonPid))) { // only for D0bar candidates; moreover if kaon PID enabled, apply to the positive track
-              auto groupedTrackIndicesSoftPionsNeg = negativeSoftPions->sliceByCached(aod::track::collisionId, collision.globalIndex(), cache);
-              for (auto trackIndexNeg2 = groupedTrackIndicesSoftPionsNeg.begin(); trackIndexNeg2 != groupedTrackIndicesSoftPionsNeg.end(); ++trackIndexNeg2) {
-                if (trackIndexNeg1 == trackIndexNeg2) {
-                  continue;
+        if (config.doDstar && TESTBIT(isSelected2ProngCand, hf_cand_2prong::DecayType::D0ToPiK) && (pt2Prong + config.ptTolerance) * 1.2 > config.binsPtDstarToD0Pi->at(0) && whichHypo2Prong[kN2ProngDecays] != 0) { // o2-linter: disable="magic-number" (see comment below)
+                                                                                                                                                                                                                      // if D* enabled and pt of the D0 is larger than the minimum of the D* one within 20% (D* and D0 momenta are very similar, always within 20% according to PYTHIA8)
+          // second loop over positive tracks
+          if (TESTBIT(whichHypo2Prong[kN2ProngDecays], 0) && (!config.applyKaonPidIn3Prongs || TESTBIT(trackParNeg.isIdentifiedPid[iNeg1], ChannelKaonPid))) { // only for D0 candidates; moreover if kaon PID enabled, apply to the negative track
+            const auto& groupedTrackIndicesSoftPionsPos = input.groupedTrackIndicesSoftPionsPos;
+            int iPos2 = 0;
+            for (auto trackIndexPos2 = groupedTrackIndicesSoftPionsPos.begin(); trackIndexPos2 != groupedTrackIndicesSoftPionsPos.end(); ++trackIndexPos2, ++iPos2) {
+              if (trackIndexPos2 == trackIndexPos1) {
+                continue;
+              }
+              auto trackPos2 = trackIndexPos2.template track_as<TTracks>();
+              const auto& pVecTrackPos2 = trackParSoftPionPos.pVec[iPos2];
+
+              uint8_t isSelectedDstar{0};
+              uint8_t cutStatus{BIT(kNCutsDstar) - 1};
+              float deltaMass{-1.};
+              isSelectedDstar = applySelectionDstar(pVecTrackPos1, pVecTrackNeg1, pVecTrackPos2, cutStatus, deltaMass); // we do not compute the D* decay vertex at this stage because we are not interested in applying topological selections
+              if (isSelectedDstar) {
+                output.dstar.push_back({thisCollId, trackPos2.globalIndex(), lastFilledD0});
+                if (config.fillHistograms) {
+                  registry.fill(HIST("hMassDstarToD0Pi"), deltaMass);
                 }
-                auto trackNeg2 = trackIndexNeg2.template track_as<TTracks>();
-                std::array pVecTrackNeg2{trackNeg2.pVector()};
-                if (thisCollId != trackNeg2.collisionId()) { // this is not the "default" collision for this track, we have to re-propagate it
-                  auto trackParVarNeg2 = getTrackParCov(trackNeg2);
-                  std::array dcaInfoNeg2{trackNeg2.dcaXY(), trackNeg2.dcaZ()};
-                  o2::base::Propagator::Instance()->propagateToDCABxByBz({collision.posX(), collision.posY(), collision.posZ()}, trackParVarNeg2, 2.f, noMatCorr, &dcaInfoNeg2);
-                  getPxPyPz(trackParVarNeg2, pVecTrackNeg2);
+                if constexpr (DoPvRefit) {
+                  // fill table row with coordinates of PV refit (same as 2-prong because we do not remove the soft pion)
+                  rowDstarPVrefit(pvRefitCoord2Prong[0], pvRefitCoord2Prong[1], pvRefitCoord2Prong[2],
+                                  pvRefitCovMatrix2Prong[0], pvRefitCovMatrix2Prong[1], pvRefitCovMatrix2Prong[2], pvRefitCovMatrix2Prong[3], pvRefitCovMatrix2Prong[4], pvRefitCovMatrix2Prong[5]);
                 }
+              }
+              if (config.debug) {
+                rowDstarCutStatus(cutStatus);
+              }
+            }
+          }
 
-                uint8_t isSelectedDstar{0};
-                uint8_t cutStatus{BIT(kNCutsDstar) - 1};
-                float deltaMass{-1.};
-                isSelectedDstar = applySelectionDstar(pVecTrackNeg1, pVecTrackPos1, pVecTrackNeg2, cutStatus, deltaMass); // we do not compute the D* decay vertex at this stage because we are not interested in applying topological selections
-                if (isSelectedDstar) {
-                  rowTrackIndexDstar(thisCollId, trackNeg2.globalIndex(), lastFilledD0);
-                  if (config.fillHistograms) {
-                    registry.fill(HIST("hMassDstarToD0Pi"), deltaMass);
-                  }
-                  if constexpr (DoPvRefit) {
-                    // fill table row with coordinates of PV refit (same as 2-prong because we do not remove the soft pion)
-                    rowDstarPVrefit(pvRefitCoord2Prong[0], pvRefitCoord2Prong[1], pvRefitCoord2Prong[2],
-                                    pvRefitCovMatrix2Prong[0], pvRefitCovMatrix2Prong[1], pvRefitCovMatrix2Prong[2], pvRefitCovMatrix2Prong[3], pvRefitCovMatrix2Prong[4], pvRefitCovMatrix2Prong[5]);
-                  }
+          // second loop over negative tracks
+          if (TESTBIT(whichHypo2Prong[kN2ProngDecays], 1) && (!config.applyKaonPidIn3Prongs || TESTBIT(trackParPos.isIdentifiedPid[iPos1], ChannelKaonPid))) { // only for D0bar candidates; moreover if kaon PID enabled, apply to the positive track
+            const auto& groupedTrackIndicesSoftPionsNeg = input.groupedTrackIndicesSoftPionsNeg;
+            int iNeg2 = 0;
+            for (auto trackIndexNeg2 = groupedTrackIndicesSoftPionsNeg.begin(); trackIndexNeg2 != groupedTrackIndicesSoftPionsNeg.end(); ++trackIndexNeg2, ++iNeg2) {
+              if (trackIndexNeg1 == trackIndexNeg2) {
+                continue;
+              }
+              auto trackNeg2 = trackIndexNeg2.template track_as<TTracks>();
+              const auto& pVecTrackNeg2 = trackParSoftPionNeg.pVec[iNeg2];
+
+              uint8_t isSelectedDstar{0};
+              uint8_t cutStatus{BIT(kNCutsDstar) - 1};
+              float deltaMass{-1.};
+              isSelectedDstar = applySelectionDstar(pVecTrackNeg1, pVecTrackPos1, pVecTrackNeg2, cutStatus, deltaMass); // we do not compute the D* decay vertex at this stage because we are not interested in applying topological selections
+              if (isSelectedDstar) {
+                output.dstar.push_back({thisCollId, trackNeg2.globalIndex(), lastFilledD0});
+                if (config.fillHistograms) {
+                  registry.fill(HIST("hMassDstarToD0Pi"), deltaMass);
                 }
-                if (config.debug) {
-                  rowDstarCutStatus(cutStatus);
+                if constexpr (DoPvRefit) {
+                  // fill table row with coordinates of PV refit (same as 2-prong because we do not remove the soft pion)
+                  rowDstarPVrefit(pvRefitCoord2Prong[0], pvRefitCoord2Prong[1], pvRefitCoord2Prong[2],
+                                  pvRefitCovMatrix2Prong[0], pvRefitCovMatrix2Prong[1], pvRefitCovMatrix2Prong[2], pvRefitCovMatrix2Prong[3], pvRefitCovMatrix2Prong[4], pvRefitCovMatrix2Prong[5]);
                 }
               }
+              if (config.debug) {
+                rowDstarCutStatus(cutStatus);
+              }
             }
-          } // end of D*
-        }
+          }
+        } // end of D*
       }
+    }
 
-      const int nTracks = 0;
-      // auto nTracks = trackIndicesPerCollision.lastIndex() - trackIndicesPerCollision.firstIndex(); // number of tracks passing 2 and 3 prong selection in this collision
-      nCand2 = rowTrackIndexProng2.lastIndex() - nCand2; // number of 2-prong candidates in this collision
-      nCand3 = rowTrackIndexProng3.lastIndex() - nCand3; // number of 3-prong candidates in this collision
+    const int nTracks = 0;
+    // auto nTracks = trackIndicesPerCollision.lastIndex() - trackIndicesPerCollision.firstIndex(); // number of tracks passing 2 and 3 prong selection in this collision
+    const auto nCand2 = output.prong2.size(); // number of 2-prong candidates in this collision
+    const auto nCand3 = output.prong3.size(); // number of 3-prong candidates in this collision
 
-      if (config.fillHistograms) {
-        registry.fill(HIST("hNTracks"), nTracks);
-        registry.fill(HIST("hNCand2Prong"), nCand2);
-        registry.fill(HIST("hNCand3Prong"), nCand3);
-        registry.fill(HIST("hNCand2ProngVsNTracks"), nTracks, nCand2);
-        registry.fill(HIST("hNCand3ProngVsNTracks"), nTracks, nCand3);
+    if (config.fillHistograms) {
+      registry.fill(HIST("hNTracks"), nTracks);
+      registry.fill(HIST("hNCand2Prong"), nCand2);
+      registry.fill(HIST("hNCand3Prong"), nCand3);
+      registry.fill(HIST("hNCand2ProngVsNTracks"), nTracks, nCand2);
+      registry.fill(HIST("hNCand3ProngVsNTracks"), nTracks, nCand3);
+    }
+  }
+
+  template <bool DoPvRefit, bool UsePidForHfFiltersBdt, typename TTracks>
+  void run2And3Prongs(SelectedCollisions const& collisions,
+                      aod::BCsWithTimestamps const&,
+                      FilteredTrackAssocSel const&,
+                      TTracks const& tracks)
+  {
+    // can be added to run over limited collisions per file - for tesing purposes
+    /*
+    if (nCollsMax > -1){
+      if (nColls == nCollMax){
+        return;
+        //can be added to run over limited collisions per file - for tesing purposes
+      }
+      nColls++;
+    }
+    */
+
+    if (workers.size() < 2) {
+      auto& worker = workers.front();
+      for (auto collision = collisions.begin(); collision != collisions.end(); ++collision) {
+        const auto input = prepare2And3Prongs<TTracks>(collision, worker.trackPars);
+        run2And3ProngsInCollision<DoPvRefit, UsePidForHfFiltersBdt>(input, tracks, worker.trackPars, worker, worker.output);
+        fillTrackIndexTables(worker.output);
+      }
+      return;
+    }
+
+    // multi-threaded mode: CCDB, slicing and propagation to the PV in this thread, in collision order,
+    // then the vertexing of the collisions shared among the workers and the tables filled in collision order
+    std::vector<CollisionTrackPars> trackPars(collisions.size());
+    std::vector<decltype(prepare2And3Prongs<TTracks>(collisions.begin(), trackPars.front()))> inputs;
+    inputs.reserve(collisions.size());
+    for (auto collision = collisions.begin(); collision != collisions.end(); ++collision) {
+      inputs.push_back(prepare2And3Prongs<TTracks>(collision, trackPars[inputs.size()]));
+    }
+    std::vector<CombinatoricsOutput> outputs(inputs.size());
+    std::atomic<std::size_t> nextCollision{0};
+    auto processCollisions = [&](CombinatoricsWorker& worker) {
+      for (auto iCollision = nextCollision++; iCollision < inputs.size(); iCollision = nextCollision++) {
+        run2And3ProngsInCollision<DoPvRefit, UsePidForHfFiltersBdt>(inputs[iCollision], tracks, trackPars[iCollision], worker, outputs[iCollision]);
       }
+    };
+    std::vector<std::thread> threads;
+    threads.reserve(workers.size());
+    for (auto& worker : workers) {
+      threads.emplace_back(processCollisions, std::ref(worker));
+    }
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    for (auto& output : outputs) {
+      fillTrackIndexTables(output);
     }
   } /// end of run2And3Prongs function
 
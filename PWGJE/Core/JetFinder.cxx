@@ -16,11 +16,14 @@
 
 #include "PWGJE/Core/JetFinder.h"
 
+#include <fastjet/ClusterSequence.hh>
+#include <fastjet/ClusterSequenceActiveAreaExplicitGhosts.hh>
 #include <fastjet/ClusterSequenceArea.hh>
 #include <fastjet/JetDefinition.hh>
 #include <fastjet/PseudoJet.hh>
 #include <fastjet/Selector.hh>
 
+#include <memory>
 #include <vector>
 
 /// Sets the jet finding parameters
@@ -65,3 +68,55 @@ fastjet::ClusterSequenceArea JetFinder::findJets(std::vector<fastjet::PseudoJet>
   jets = fastjet::sorted_by_pt(jets);
   return clusterSeq;
 }
+
+bool JetFinder::canShareGhosts() const
+{
+  return shareGhosts && areaType == fastjet::active_area && ghostRepeatN == 1;
+}
+
+/// Generates one set of ghosts following the ghost area specification
+/// \param ghosts vector of ghosts to be filled
+/// \return area carried by each ghost
+double JetFinder::generateGhosts(std::vector<fastjet::PseudoJet>& ghosts)
+{
+  setParams();
+  ghosts.clear();
+  ghostAreaSpec.add_ghosts(ghosts);
+  return ghostAreaSpec.actual_ghost_area();
+}
+
+/// Performs jet finding on a set of explicit ghosts
+/// \note jet four-momenta are those of the active-area clustering, as the ghosts carry negligible momentum
+/// \param inputParticles vector of input particles/tracks
+/// \param ghosts ghosts from generateGhosts
+/// \param ghostAreaActual area carried by each ghost
+/// \param jets vector of jets to be filled
+/// \return cluster sequence needed to access constituents
+std::unique_ptr<fastjet::ClusterSequenceActiveAreaExplicitGhosts> JetFinder::findJets(std::vector<fastjet::PseudoJet>& inputParticles, const std::vector<fastjet::PseudoJet>& ghosts, double ghostAreaActual, std::vector<fastjet::PseudoJet>& jets)
+{
+  setParams();
+  auto clusterSeq = std::make_unique<fastjet::ClusterSequenceActiveAreaExplicitGhosts>(inputParticles, jetDef, ghosts, ghostAreaActual);
+  selectJets(clusterSeq->inclusive_jets(), jets);
+  return clusterSeq;
+}
+
+/// Extracts the jets of radius jetR from a sequence clustered with a larger radius
+/// \note C/A merges pairs in order of increasing distance, normalised to the clustering radius, so the inclusive jets of radius R are the exclusive jets at dcut = (R / clusterR)^2
+/// \param clusterSeq cluster sequence
+/// \param clusterR jet radius with which clusterSeq was clustered
+/// \param jets vector of jets to be filled
+void JetFinder::findJets(const fastjet::ClusterSequence& clusterSeq, double clusterR, std::vector<fastjet::PseudoJet>& jets)
+{
+  setParams();
+  if (jetR >= clusterR) {
+    selectJets(clusterSeq.inclusive_jets(), jets);
+  } else {
+    selectJets(clusterSeq.exclusive_jets(jetR * jetR / (clusterR * clusterR)), jets);
+  }
+}
+
+void JetFinder::selectJets(const std::vector<fastjet::PseudoJet>& candidates, std::vector<fastjet::PseudoJet>& jets) const
+{
+  jets = (selJets && !fastjet::SelectorIsPureGhost())(candidates);
+  jets = fastjet::sorted_by_pt(jets);
+}
@@ -19,6 +19,8 @@
 #define PWGJE_CORE_JETFINDER_H_
 
 #include <fastjet/AreaDefinition.hh>
+#include <fastjet/ClusterSequence.hh>
+#include <fastjet/ClusterSequenceActiveAreaExplicitGhosts.hh>
 #include <fastjet/ClusterSequenceArea.hh>
 #include <fastjet/GhostedAreaSpec.hh>
 #include <fastjet/JetDefinition.hh>
@@ -27,6 +29,7 @@
 
 #include <Rtypes.h>
 
+#include <memory>
 #include <vector>
 
 #include <math.h>
@@ -70,6 +73,7 @@ class JetFinder
 
   bool isReclustering = false;
   bool isTriggering = false;
+  bool shareGhosts = false; // cluster all jet radii of an event on one set of explicit ghosts
 
   fastjet::JetAlgorithm algorithm = fastjet::antikt_algorithm;
   fastjet::RecombinationScheme recombScheme = fastjet::E_scheme;
@@ -92,7 +96,38 @@ class JetFinder
   /// \return ClusterSequenceArea object needed to access constituents
   fastjet::ClusterSequenceArea findJets(std::vector<fastjet::PseudoJet>& inputParticles, std::vector<fastjet::PseudoJet>& jets); // ideally find a way of passing the cluster sequence as a reeference
 
+  /// Returns whether jet finding can run on explicit ghosts shared between jet radii
+  /// \note only active areas with a single ghost repetition are supported, other area types use findJets per radius
+  bool canShareGhosts() const;
+
+  /// Generates one set of ghosts following the ghost area specification
+  /// \note the ghosts are shared by all jet radii of an event
+  /// \param ghosts vector of ghosts to be filled
+  /// \return area carried by each ghost
+  double generateGhosts(std::vector<fastjet::PseudoJet>& ghosts);
+
+  /// Performs jet finding on a set of explicit ghosts
+  /// \param inputParticles vector of input particles/tracks
+  /// \param ghosts ghosts from generateGhosts
+  /// \param ghostAreaActual area carried by each ghost
+  /// \param jets vector of jets to be filled, without pure-ghost jets
+  /// \return cluster sequence needed to access constituents (which include the ghosts)
+  std::unique_ptr<fastjet::ClusterSequenceActiveAreaExplicitGhosts> findJets(std::vector<fastjet::PseudoJet>& inputParticles, const std::vector<fastjet::PseudoJet>& ghosts, double ghostAreaActual, std::vector<fastjet::PseudoJet>& jets);
+
+  /// Returns whether the jets of radius jetR can be taken from a sequence clustered with a larger radius
+  /// \note valid for the Cambridge/Aachen algorithm, whose merging sequence does not depend on R
+  bool canReuseSequence() const { return algorithm == fastjet::cambridge_algorithm; }
+
+  /// Extracts the jets of radius jetR from a sequence clustered with a larger radius
+  /// \param clusterSeq cluster sequence, see canReuseSequence
+  /// \param clusterR jet radius with which clusterSeq was clustered
+  /// \param jets vector of jets to be filled
+  void findJets(const fastjet::ClusterSequence& clusterSeq, double clusterR, std::vector<fastjet::PseudoJet>& jets);
+
  private:
+  /// Applies the jet selection, removes pure-ghost jets and sorts the jets by pt
+  void selectJets(const std::vector<fastjet::PseudoJet>& candidates, std::vector<fastjet::PseudoJet>& jets) const;
+
   ClassDefNV(JetFinder, 1);
 };
 
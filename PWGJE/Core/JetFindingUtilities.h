@@ -34,7 +34,9 @@
 
 #include <fastjet/ClusterSequenceArea.hh>
 #include <fastjet/PseudoJet.hh>
+#include <fastjet/Selector.hh>
 
+#include <algorithm>
 #include <cmath>
 #include <memory>
 #include <string>
@@ -267,6 +269,105 @@ bool analyseV0s(std::vector<fastjet::PseudoJet>& inputParticles, T const& v0s, f
   }
 }
 
+/**
+ * Fills the jet tables with the jets of one jet radius
+ *
+ * @param jets jets found with radius R
+ * @param R jet radius
+ * @param collision the collision within which jets are being found
+ * @param jetsTable output table of jets
+ * @param constituentsTable output table of jet constituents
+ * @param doCandidateJetFinding set whether only jets containing a candidate are saved
+ * @param hasGhosts set whether the jet constituents include explicit ghosts, which are skipped
+ */
+template <typename T, typename U, typename V>
+void fillJetTables(std::vector<fastjet::PseudoJet> const& jets, double R, float jetAreaFractionMin, T const& collision, U& jetsTable, V& constituentsTable, std::shared_ptr<THn> thnSparseJet, bool fillThnSparse, bool doCandidateJetFinding, bool hasGhosts)
+{
+  for (const auto& jet : jets) {
+    if (jet.has_area() && jet.area() < jetAreaFractionMin * M_PI * R * R) {
+      continue;
+    }
+    if (fillThnSparse) {
+      thnSparseJet->Fill(R, jet.pt(), jet.eta(), jet.phi()); // important for normalisation in V0Jet analyses to store all jets, including those that aren't V0s
+    }
+    std::vector<fastjet::PseudoJet> constituents = jet.constituents();
+    if (hasGhosts) {
+      constituents = (!fastjet::SelectorIsPureGhost())(constituents);
+    }
+    if (doCandidateJetFinding) {
+      bool isCandidateJet = false;
+      for (const auto& constituent : constituents) {
+        JetConstituentStatus constituentStatus = constituent.template user_info<fastjetutilities::fastjet_user_info>().getStatus();
+        if (constituentStatus == JetConstituentStatus::candidate) { // note currently we cannot run V0 and HF in the same jet. If we ever need to we can seperate the loops
+          isCandidateJet = true;
+          break;
+        }
+      }
+      if (!isCandidateJet) {
+        continue;
+      }
+    }
+    std::vector<int> tracks;
+    std::vector<int> cands;
+    std::vector<int> clusters;
+    jetsTable(collision.globalIndex(), jet.pt(), jet.eta(), jet.phi(),
+              jet.E(), jet.rapidity(), jet.m(), jet.has_area() ? jet.area() : 0., std::round(R * 100));
+    for (const auto& constituent : sorted_by_pt(constituents)) {
+      if (constituent.template user_info<fastjetutilities::fastjet_user_info>().getStatus() == JetConstituentStatus::track) {
+        tracks.push_back(constituent.template user_info<fastjetutilities::fastjet_user_info>().getIndex());
+      }
+      if (constituent.template user_info<fastjetutilities::fastjet_user_info>().getStatus() == JetConstituentStatus::cluster) {
+        clusters.push_back(constituent.template user_info<fastjetutilities::fastjet_user_info>().getIndex());
+      }
+      if (constituent.template user_info<fastjetutilities::fastjet_user_info>().getStatus() == JetConstituentStatus::candidate) {
+        cands.push_back(constituent.template user_info<fastjetutilities::fastjet_user_info>().getIndex());
+      }
+    }
+    constituentsTable(jetsTable.lastIndex(), tracks, clusters, cands);
+  }
+}
+
+/**
+ * Performs jet finding for all jet radii on one set of explicit ghosts and fills jet tables
+ *
+ * The ghosts are generated once per event instead of once per radius, and can also be passed to JetBkgSubUtils::estimateRhoAreaMedian.
+ * For the C/A algorithm the event is clustered once with the largest radius and the jets of the smaller radii are taken from the same sequence.
+ * Jet four-momenta and constituents are the same as with findJets, jet areas are evaluated on the shared ghosts.
+ *
+ * @param jetFinder JetFinder object which carries jet finding parameters
+ * @param inputParticles fastjet container
+ * @param ghosts ghosts from JetFinder::generateGhosts
+ * @param ghostAreaActual area carried by each ghost
+ * @param jetRadius jet finding radii
+ * @param collision the collision within which jets are being found
+ * @param jetsTable output table of jets
+ * @param constituentsTable output table of jet constituents
+ * @param doCandidateJetFinding set whether only jets containing a candidate are saved
+ */
+template <typename T, typename U, typename V>
+void findJetsSharedGhosts(JetFinder& jetFinder, std::vector<fastjet::PseudoJet>& inputParticles, const std::vector<fastjet::PseudoJet>& ghosts, double ghostAreaActual, float jetPtMin, float jetPtMax, std::vector<double> const& jetRadius, float jetAreaFractionMin, T const& collision, U& jetsTable, V& constituentsTable, std::shared_ptr<THn> thnSparseJet, bool fillThnSparse, bool doCandidateJetFinding = false)
+{
+  jetFinder.jetPtMin = jetPtMin;
+  jetFinder.jetPtMax = jetPtMax;
+  std::vector<fastjet::PseudoJet> jets;
+  if (jetFinder.canReuseSequence() && jetRadius.size() > 1) {
+    jetFinder.jetR = *std::max_element(jetRadius.begin(), jetRadius.end());
+    const double clusterR = jetFinder.jetR;
+    auto clusterSeq = jetFinder.findJets(inputParticles, ghosts, ghostAreaActual, jets);
+    for (auto R : jetRadius) {
+      jetFinder.jetR = R;
+      jetFinder.findJets(*clusterSeq, clusterR, jets);
+      fillJetTables(jets, R, jetAreaFractionMin, collision, jetsTable, constituentsTable, thnSparseJet, fillThnSparse, doCandidateJetFinding, true);
+    }
+    return;
+  }
+  for (auto R : jetRadius) {
+    jetFinder.jetR = R;
+    auto clusterSeq = jetFinder.findJets(inputParticles, ghosts, ghostAreaActual, jets);
+    fillJetTables(jets, R, jetAreaFractionMin, collision, jetsTable, constituentsTable, thnSparseJet, fillThnSparse, doCandidateJetFinding, true);
+  }
+}
+
 /**
  * Performs jet finding and fills jet tables
  *
@@ -282,50 +383,19 @@ template <typename T, typename U, typename V>
 void findJets(JetFinder& jetFinder, std::vector<fastjet::PseudoJet>& inputParticles, float jetPtMin, float jetPtMax, std::vector<double> jetRadius, float jetAreaFractionMin, T const& collision, U& jetsTable, V& constituentsTable, std::shared_ptr<THn> thnSparseJet, bool fillThnSparse, bool doCandidateJetFinding = false)
 {
   auto jetRValues = static_cast<std::vector<double>>(jetRadius);
+  if (jetFinder.canShareGhosts()) {
+    std::vector<fastjet::PseudoJet> ghosts;
+    double ghostAreaActual = jetFinder.generateGhosts(ghosts);
+    findJetsSharedGhosts(jetFinder, inputParticles, ghosts, ghostAreaActual, jetPtMin, jetPtMax, jetRValues, jetAreaFractionMin, collision, jetsTable, constituentsTable, thnSparseJet, fillThnSparse, doCandidateJetFinding);
+    return;
+  }
   jetFinder.jetPtMin = jetPtMin;
   jetFinder.jetPtMax = jetPtMax;
   for (auto R : jetRValues) {
     jetFinder.jetR = R;
     std::vector<fastjet::PseudoJet> jets;
     fastjet::ClusterSequenceArea clusterSeq(jetFinder.findJets(inputParticles, jets));
-    for (const auto& jet : jets) {
-      if (jet.has_area() && jet.area() < jetAreaFractionMin * M_PI * R * R) {
-        continue;
-      }
-      if (fillThnSparse) {
-        thnSparseJet->Fill(R, jet.pt(), jet.eta(), jet.phi()); // important for normalisation in V0Jet analyses to store all jets, including those that aren't V0s
-      }
-      if (doCandidateJetFinding) {
-        bool isCandidateJet = false;
-        for (const auto& constituent : jet.constituents()) {
-          JetConstituentStatus constituentStatus = constituent.template user_info<fastjetutilities::fastjet_user_info>().getStatus();
-          if (constituentStatus == JetConstituentStatus::candidate) { // note currently we cannot run V0 and HF in the same jet. If we ever need to we can seperate the loops
-            isCandidateJet = true;
-            break;
-          }
-        }
-        if (!isCandidateJet) {
-          continue;
-        }
-      }
-      std::vector<int> tracks;
-      std::vector<int> cands;
-      std::vector<int> clusters;
-      jetsTable(collision.globalIndex(), jet.pt(), jet.eta(), jet.phi(),
-                jet.E(), jet.rapidity(), jet.m(), jet.has_area() ? jet.area() : 0., std::round(R * 100));
-      for (const auto& constituent : sorted_by_pt(jet.constituents())) {
-        if (constituent.template user_info<fastjetutilities::fastjet_user_info>().getStatus() == JetConstituentStatus::track) {
-          tracks.push_back(constituent.template user_info<fastjetutilities::fastjet_user_info>().getIndex());
-        }
-        if (constituent.template user_info<fastjetutilities::fastjet_user_info>().getStatus() == JetConstituentStatus::cluster) {
-          clusters.push_back(constituent.template user_info<fastjetutilities::fastjet_user_info>().getIndex());
-        }
-        if (constituent.template user_info<fastjetutilities::fastjet_user_info>().getStatus() == JetConstituentStatus::candidate) {
-          cands.push_back(constituent.template user_info<fastjetutilities::fastjet_user_info>().getIndex());
-        }
-      }
-      constituentsTable(jetsTable.lastIndex(), tracks, clusters, cands);
-    }
+    fillJetTables(jets, R, jetAreaFractionMin, collision, jetsTable, constituentsTable, thnSparseJet, fillThnSparse, doCandidateJetFinding, false);
   }
 }
 
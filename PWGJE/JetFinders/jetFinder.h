@@ -108,6 +108,7 @@ struct JetFinderTask {
   o2::framework::Configurable<int> jetPtBinWidth{"jetPtBinWidth", 5, "used to define the width of the jetPt bins for the THnSparse"};
   o2::framework::Configurable<bool> fillTHnSparse{"fillTHnSparse", false, "switch to fill the THnSparse"};
   o2::framework::Configurable<double> jetExtraParam{"jetExtraParam", -99.0, "sets the _extra_param in fastjet"};
+  o2::framework::Configurable<bool> jetShareGhosts{"jetShareGhosts", false, "cluster all jet radii on one set of ghosts per event (and only once for C/A); jet areas then come from one ghost realisation per event"};
 
   o2::framework::Service<o2::framework::O2DatabasePDG> pdgDatabase;
   int trackSelection = -1;
@@ -160,6 +161,7 @@ struct JetFinderTask {
       jetFinder.isTriggering = true;
     }
     jetFinder.fastjetExtraParam = jetExtraParam;
+    jetFinder.shareGhosts = jetShareGhosts;
 
     auto jetRadiiBins = (std::vector<double>)jetRadius;
     if (jetRadiiBins.size() > 1) {
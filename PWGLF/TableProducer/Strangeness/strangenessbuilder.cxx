@@ -351,6 +351,7 @@ struct StrangenessBuilder {
     Configurable<float> dcav0dau{"dcav0dau", 1.0, "DCA V0 Daughters"};
     Configurable<float> v0radius{"v0radius", 0.9, "v0radius"};
     Configurable<float> maxDaughterEta{"maxDaughterEta", 5.0, "Maximum daughter eta (in abs value)"};
+    Configurable<bool> useFitterPreFilter{"useFitterPreFilter", false, "skip daughter pairs for which the DCA fitter cannot find a seed before calling it"};
 
     // MC builder options
     Configurable<bool> mc_populateV0MCCoresSymmetric{"mc_populateV0MCCoresSymmetric", false, "populate V0MCCores table for derived data analysis, keep V0MCCores joinable with V0Cores"};
@@ -651,6 +652,15 @@ struct StrangenessBuilder {
     hPrimaryV0s->GetXaxis()->SetBinLabel(1, "All V0s");
     hPrimaryV0s->GetXaxis()->SetBinLabel(2, "Primary V0s");
 
+    if (v0BuilderOpts.useFitterPreFilter.value) {
+      // outcome of the geometric pre-filter of the V0 daughters, per stage
+      auto hDcaFitterPreFilter = histos.add<TH1>("hDcaFitterPreFilter", "V0 daughter pairs before vertex fit;;entries", kTH1D, {{o2::common::core::DcaFitterPreFilter::NStatus, -0.5f, o2::common::core::DcaFitterPreFilter::NStatus - 0.5f}});
+      hDcaFitterPreFilter->GetXaxis()->SetBinLabel(1, "accepted");
+      hDcaFitterPreFilter->GetXaxis()->SetBinLabel(2, "rejected DXY");
+      hDcaFitterPreFilter->GetXaxis()->SetBinLabel(3, "rejected R");
+      hDcaFitterPreFilter->GetXaxis()->SetBinLabel(4, "rejected DZ");
+    }
+
     mRunNumber = 0;
 
     mEnabledTables.resize(nTables, 0);
@@ -735,6 +745,7 @@ struct StrangenessBuilder {
     LOGF(info, "-~> V0 | DCA between V0 daughters ......: %f", v0BuilderOpts.dcav0dau.value);
     LOGF(info, "-~> V0 | V0 2D decay radius ............: %f", v0BuilderOpts.v0radius.value);
     LOGF(info, "-~> V0 | Maximum daughter eta ..........: %f", v0BuilderOpts.maxDaughterEta.value);
+    LOGF(info, "-~> V0 | DCA fitter pre-filter .........: %i", v0BuilderOpts.useFitterPreFilter.value);
 
     LOGF(info, "-~> Cascade | min crossed rows .........: %i", cascadeBuilderOpts.minCrossedRows.value);
     LOGF(info, "-~> Cascade | DCA bach track to PV .....: %f", cascadeBuilderOpts.dcabachtopv.value);
@@ -758,6 +769,7 @@ struct StrangenessBuilder {
     straHelper.v0selections.dcav0dau = v0BuilderOpts.dcav0dau;
     straHelper.v0selections.v0radius = v0BuilderOpts.v0radius;
     straHelper.v0selections.maxDaughterEta = v0BuilderOpts.maxDaughterEta;
+    straHelper.useFitterPreFilter = v0BuilderOpts.useFitterPreFilter;
 
     // set cascade parameters in the helper
     straHelper.cascadeselections.minCrossedRows = cascadeBuilderOpts.minCrossedRows;
@@ -2831,6 +2843,15 @@ struct StrangenessBuilder {
     }
 
     populateCascadeInterlinks();
+
+    // export the pre-filter counters of this time frame
+    if (v0BuilderOpts.useFitterPreFilter.value) {
+      const auto& counters = straHelper.fitterPreFilter.getCounters();
+      for (int status = 0; status < o2::common::core::DcaFitterPreFilter::NStatus; status++) {
+        histos.fill(HIST("hDcaFitterPreFilter"), status, counters[status]);
+      }
+      straHelper.fitterPreFilter.resetCounters();
+    }
   }
 
   void processRealData(soa::Join<aod::Collisions, aod::EvSels> const& collisions, aod::V0s const& v0s, aod::Cascades const& cascades, aod::TrackedCascades const& trackedCascades, FullTracksExtIU const& tracks, aod::BCsWithTimestamps const& bcs)
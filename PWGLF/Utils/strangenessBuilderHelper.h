@@ -20,6 +20,7 @@
 #include "ReconstructionDataFormats/Track.h"
 #include "DetectorsBase/GeometryManager.h"
 #include "CommonConstants/PhysicsConstants.h"
+#include "Common/Core/DcaFitterPreFilter.h"
 #include "Common/Core/trackUtilities.h"
 #include "Tools/KFparticle/KFUtilities.h"
 
@@ -347,6 +348,15 @@ class strangenessBuilderHelper
       v0.negativeDCAxy = 0.0f; // default invalid
     }
 
+    // skip pairs for which the DCA fitter cannot find a seed (collinear seeding not emulated)
+    if (useFitterPreFilter && !useCollinearFit) {
+      fitterPreFilter.setFromFitter(fitter);
+      if (fitterPreFilter.check(positiveTrackParam, negativeTrackParam) != o2::common::core::DcaFitterPreFilter::Accepted) {
+        v0 = {};
+        return false;
+      }
+    }
+
     // Perform DCA fit
     int nCand = 0;
     fitter.setCollinear(useCollinearFit);
@@ -1246,6 +1256,11 @@ class strangenessBuilderHelper
   o2::base::MatLayerCylSet* lut;       // material LUT for DCA fitter
   o2::vertexing::DCAFitterN<2> fitter; // 2-prong o2 dca fitter
 
+  // geometric pre-filter of the V0 daughters before the DCA fit, off by default
+  // rejection counters available via fitterPreFilter.getCounters(), histogrammed per time frame by the strangenessbuilder
+  bool useFitterPreFilter = false;
+  o2::common::core::DcaFitterPreFilter fitterPreFilter;
+
   v0candidate v0;           // storage for V0 candidate properties
   cascadeCandidate cascade; // storage for cascade candidate properties
 
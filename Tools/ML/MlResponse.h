@@ -18,13 +18,18 @@
 #define TOOLS_ML_MLRESPONSE_H_
 
 #include "Tools/ML/model.h"
+#include "Tools/ML/sessionRegistry.h"
+#include "Tools/ML/treeEnsemble.h"
 
 #include <CCDB/CcdbApi.h>
 #include <Framework/Array2D.h>
 #include <Framework/Logger.h>
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
+#include <filesystem>
+#include <iterator>
 #include <map>
 #include <string>
 #include <vector>
@@ -41,6 +46,15 @@ enum CutDirection {
 };
 } // namespace cuts_ml
 
+namespace ml
+{
+// inference backend of the models
+enum MlBackend {
+  BackendOnnxRuntime = 0, // ONNX Runtime session, any model
+  BackendTreeEnsemble     // native evaluator of tree-ensemble (BDT) models
+};
+} // namespace ml
+
 namespace analysis
 {
 // TypeOutputScore is the type of the output score from o2::ml::OnnxModel (float by default)
@@ -106,6 +120,7 @@ class MlResponse
   /// \param pathsCCDB is a vector of model paths in CCDB, one for each bin
   /// \param timestampCCDB is the CCDB timestamp
   /// \note On the CCDB, different models must be stored in different folders
+  /// \note Identical models already retrieved in the same process are not downloaded again, and identical model files share the same ONNX session
   void setModelPathsCCDB(const std::vector<std::string>& onnxFiles, const o2::ccdb::CcdbApi& ccdbApi, const std::vector<std::string>& pathsCCDB, int64_t timestampCCDB)
   {
     if (onnxFiles.size() != mNModels) {
@@ -124,10 +139,20 @@ class MlResponse
       }
     }
 
+    auto& registry = o2::ml::OnnxSessionRegistry::instance();
     for (auto iFile{0}; iFile < mNModels; ++iFile) {
+      // identical blobs (same CCDB path, timestamp and file name) are downloaded only once per process,
+      // as long as the local file has not been overwritten by another blob of the same name
+      const std::string blobKey = pathsCCDB[iFile] + "@" + std::to_string(timestampCCDB) + ":" + onnxFiles[iFile];
+      if (registry.isFileRetrieved(onnxFiles[iFile], blobKey) && std::filesystem::exists(onnxFiles[iFile])) {
+        LOG(info) << "ML model " << onnxFiles[iFile] << " from " << pathsCCDB[iFile] << " already retrieved, reusing it";
+        mPaths[iFile] = onnxFiles[iFile];
+        continue;
+      }
       std::map<std::string, std::string> metadata;
       bool retrieveSuccess = ccdbApi.retrieveBlob(pathsCCDB[iFile], ".", metadata, timestampCCDB, false, onnxFiles[iFile]);
       if (retrieveSuccess) {
+        registry.setFileRetrieved(onnxFiles[iFile], blobKey);
         mPaths[iFile] = onnxFiles[iFile];
       } else {
         LOG(fatal) << "Error encountered while accessing the ML model from " << pathsCCDB[iFile] << "! Maybe the ML model doesn't exist yet for this run number or timestamp?";
@@ -145,18 +170,38 @@ class MlResponse
     mPaths = onnxFiles;
   }
 
-  /// Initialize class instance (initialize OnnxModels)
+  /// Initialize class instance (initialize OnnxModels, or native tree-ensemble models if selected with setBackend)
   /// \param enableOptimizations is a switch to enable optimizations
   /// \param threads is the number of active threads
   void init(bool enableOptimizations = false, int threads = 0)
   {
+    if (mBackend == o2::ml::MlBackend::BackendTreeEnsemble) {
+      mTreeEnsembles = std::vector<o2::ml::TreeEnsemble>(mNModels);
+    }
     uint8_t counterModel{0};
     for (const auto& path : mPaths) {
-      mModels[counterModel].initModel(path, enableOptimizations, threads);
+      if (mBackend == o2::ml::MlBackend::BackendTreeEnsemble) {
+        mTreeEnsembles[counterModel].loadModel(path);
+        if (mTreeEnsembles[counterModel].getNumOutputs() < mNClasses) {
+          LOG(fatal) << "Model " << path << " has " << mTreeEnsembles[counterModel].getNumOutputs() << " classes, while " << static_cast<int>(mNClasses) << " are expected! Please check your configurables.";
+        }
+      } else {
+        mModels[counterModel].initModel(path, enableOptimizations, threads);
+      }
       ++counterModel;
     }
   }
 
+  /// Select the inference backend, to be called before init
+  /// \param backend is the backend (see o2::ml::MlBackend): ONNX Runtime, or native evaluator for tree-ensemble models
+  void setBackend(const int backend)
+  {
+    if (backend != o2::ml::MlBackend::BackendOnnxRuntime && backend != o2::ml::MlBackend::BackendTreeEnsemble) {
+      LOG(fatal) << "Unknown ML backend " << backend << "! Please check your configurables.";
+    }
+    mBackend = backend;
+  }
+
   /// Method to translate configurable input-feature strings into integers
   /// \param cfgInputFeatures array of input features names
   void cacheInputFeaturesIndices(std::vector<std::string> const& cfgInputFeatures)
@@ -182,7 +227,25 @@ class MlResponse
       LOG(fatal) << "Model index " << nModel << " is out of range! The number of initialised models is " << mModels.size() << ". Please check your configurables.";
     }
 
+    if (mBackend == o2::ml::MlBackend::BackendTreeEnsemble) {
+      std::vector<TypeOutputScore> output(mTreeEnsembles[nModel].getNumOutputs());
+      mTreeEnsembles[nModel].evaluate(input.data(), 1, input.size(), output.data());
+      output.resize(mNClasses);
+      return output;
+    }
+
+    // pre-bound buffers if the model allows it, otherwise a session run on tensors created for this candidate
+    if (mModels[nModel].template isIoBindingPossible<TypeOutputScore>()) {
+      const TypeOutputScore* outputPtr = mModels[nModel].template evalModelBound<TypeOutputScore>(input);
+      if (outputPtr == nullptr || mModels[nModel].getNumBoundOutputValues() < mNClasses) {
+        LOG(fatal) << "Model " << nModel << " did not return the " << static_cast<int>(mNClasses) << " expected scores per candidate! Please check your configurables.";
+      }
+      return std::vector<TypeOutputScore>{outputPtr, outputPtr + mNClasses};
+    }
     TypeOutputScore* outputPtr = mModels[nModel].template evalModel<TypeOutputScore>(input);
+    if (outputPtr == nullptr) {
+      LOG(fatal) << "Model " << nModel << " did not return any score! Please check your configurables.";
+    }
     return std::vector<TypeOutputScore>{outputPtr, outputPtr + mNClasses};
   }
 
@@ -195,20 +258,7 @@ class MlResponse
   {
     int nModel = findBin(candVar);
     auto output = getModelOutput(input, nModel);
-    uint8_t iClass{0};
-    for (const auto& outputValue : output) {
-      uint8_t dir = mCutDir.at(iClass);
-      if (dir != o2::cuts_ml::CutDirection::CutNot) {
-        if (dir == o2::cuts_ml::CutDirection::CutGreater && outputValue > mCuts.get(nModel, iClass)) {
-          return false;
-        }
-        if (dir == o2::cuts_ml::CutDirection::CutSmaller && outputValue < mCuts.get(nModel, iClass)) {
-          return false;
-        }
-      }
-      ++iClass;
-    }
-    return true;
+    return isSelectedScores(output.data(), nModel);
   }
 
   /// ML selections
@@ -221,20 +271,7 @@ class MlResponse
   {
     int nModel = findBin(candVar);
     output = getModelOutput(input, nModel);
-    uint8_t iClass{0};
-    for (const auto& outputValue : output) {
-      uint8_t dir = mCutDir.at(iClass);
-      if (dir != o2::cuts_ml::CutDirection::CutNot) {
-        if (dir == o2::cuts_ml::CutDirection::CutGreater && outputValue > mCuts.get(nModel, iClass)) {
-          return false;
-        }
-        if (dir == o2::cuts_ml::CutDirection::CutSmaller && outputValue < mCuts.get(nModel, iClass)) {
-          return false;
-        }
-      }
-      ++iClass;
-    }
-    return true;
+    return isSelectedScores(output.data(), nModel);
   }
 
   /// ML selections
@@ -251,20 +288,109 @@ class MlResponse
     }
     int nModel = findBin2D(candVar1, candVar2);
     output = getModelOutput(input, nModel);
-    uint8_t iClass{0};
-    for (const auto& outputValue : output) {
-      uint8_t dir = mCutDir.at(iClass);
-      if (dir != o2::cuts_ml::CutDirection::CutNot) {
-        if (dir == o2::cuts_ml::CutDirection::CutGreater && outputValue > mCuts.get(nModel, iClass)) {
-          return false;
-        }
-        if (dir == o2::cuts_ml::CutDirection::CutSmaller && outputValue < mCuts.get(nModel, iClass)) {
-          return false;
-        }
+    return isSelectedScores(output.data(), nModel);
+  }
+
+  /// Add a candidate to the batch of the model selected by candVar, to be evaluated with evaluateBatch()
+  /// \param input is the input features
+  /// \param candVar is the variable value (e.g. pT) used to select which model to use
+  /// \return index of the candidate in the batch, to be used with getBatchOutput and isSelectedBatch
+  template <typename T1, typename T2>
+  std::size_t addToBatch(const T1& input, const T2& candVar)
+  {
+    return addToBatchModel(input, findBin(candVar));
+  }
+
+  /// Add a candidate to the batch of the model selected by candVar1 and candVar2, to be evaluated with evaluateBatch()
+  /// \param input is the input features
+  /// \param candVar1 is the first variable value (e.g. pT) used to select which model to use
+  /// \param candVar2 is the second variable value (e.g. multiplicity) used to select which model to use
+  /// \return index of the candidate in the batch, to be used with getBatchOutput and isSelectedBatch
+  template <typename T1, typename T2, typename T3>
+  std::size_t addToBatch(const T1& input, const T2& candVar1, const T3& candVar2)
+  {
+    return addToBatchModel(input, findBin2D(candVar1, candVar2));
+  }
+
+  /// Evaluate all the candidates added to the batch, with a single inference call per model
+  void evaluateBatch()
+  {
+    mBatchOutputs.assign(mModels.size(), nullptr);
+    mBatchStrides.assign(mModels.size(), 0);
+    for (std::size_t iModel{0}; iModel < mModels.size(); ++iModel) {
+      if (iModel >= mBatchNRows.size() || mBatchNRows[iModel] == 0) {
+        continue;
+      }
+      if (mBackend == o2::ml::MlBackend::BackendTreeEnsemble) {
+        mBatchStrides[iModel] = mTreeEnsembles[iModel].getNumOutputs();
+        mBatchScores.resize(mModels.size());
+        mBatchScores[iModel].resize(mBatchNRows[iModel] * mBatchStrides[iModel]);
+        mTreeEnsembles[iModel].evaluate(mBatchInputs[iModel].data(), mBatchNRows[iModel], mBatchInputs[iModel].size() / mBatchNRows[iModel], mBatchScores[iModel].data());
+        mBatchOutputs[iModel] = mBatchScores[iModel].data();
+        continue;
+      }
+      if (mModels[iModel].template isIoBindingPossible<TypeOutputScore>()) {
+        mBatchOutputs[iModel] = mModels[iModel].template evalModelBound<TypeOutputScore>(mBatchInputs[iModel]);
+        mBatchStrides[iModel] = mModels[iModel].getNumBoundOutputValues();
+      } else {
+        mBatchScores.resize(mModels.size());
+        mBatchStrides[iModel] = mModels[iModel].template evalModelBatch<TypeOutputScore>(mBatchInputs[iModel], mBatchScores[iModel]);
+        mBatchOutputs[iModel] = mBatchStrides[iModel] > 0 ? mBatchScores[iModel].data() : nullptr;
+      }
+      if (mBatchOutputs[iModel] == nullptr || mBatchStrides[iModel] < mNClasses) {
+        LOG(fatal) << "Model " << iModel << " did not return the " << static_cast<int>(mNClasses) << " expected scores per candidate! Please check your configurables.";
       }
-      ++iClass;
     }
-    return true;
+  }
+
+  /// Get the model predictions of a candidate of the evaluated batch
+  /// \param iCand is the index of the candidate returned by addToBatch
+  /// \return pointer to the mNClasses scores of the candidate, owned by the model and valid until the next inference call
+  const TypeOutputScore* getBatchOutput(const std::size_t iCand) const
+  {
+    const auto nModel = mBatchModelIndices[iCand];
+    return mBatchOutputs[nModel] + mBatchRowIndices[iCand] * mBatchStrides[nModel];
+  }
+
+  /// Get the model predictions of a candidate of the evaluated batch
+  /// \param iCand is the index of the candidate returned by addToBatch
+  /// \param output is a container to be filled with model output
+  void getBatchOutput(const std::size_t iCand, std::vector<TypeOutputScore>& output) const
+  {
+    const TypeOutputScore* outputPtr = getBatchOutput(iCand);
+    output.assign(outputPtr, outputPtr + mNClasses);
+  }
+
+  /// ML selections on a candidate of the evaluated batch
+  /// \param iCand is the index of the candidate returned by addToBatch
+  /// \return boolean telling if model predictions pass the cuts
+  bool isSelectedBatch(const std::size_t iCand) const
+  {
+    return isSelectedScores(getBatchOutput(iCand), mBatchModelIndices[iCand]);
+  }
+
+  /// ML selections on a candidate of the evaluated batch
+  /// \param iCand is the index of the candidate returned by addToBatch
+  /// \param output is a container to be filled with model output
+  /// \return boolean telling if model predictions pass the cuts
+  bool isSelectedBatch(const std::size_t iCand, std::vector<TypeOutputScore>& output) const
+  {
+    getBatchOutput(iCand, output);
+    return isSelectedScores(output.data(), mBatchModelIndices[iCand]);
+  }
+
+  /// Number of candidates in the current batch
+  std::size_t getBatchSize() const { return mBatchModelIndices.size(); }
+
+  /// Remove all the candidates from the batch, keeping the allocated memory for the next data frame
+  void clearBatch()
+  {
+    for (auto& inputs : mBatchInputs) {
+      inputs.clear();
+    }
+    std::fill(mBatchNRows.begin(), mBatchNRows.end(), 0);
+    mBatchModelIndices.clear();
+    mBatchRowIndices.clear();
   }
 
  protected:
@@ -281,10 +407,57 @@ class MlResponse
   uint8_t mNVar1Bins = 1;                                 // number of bins of the first variable (e.g. pT) used to select which model to use
   uint8_t mNVar2Bins = 1;                                 // number of bins of the second variable (e.g. multiplicity) used to select which model to use
   bool mUse2DBinning = false;                             // switch to enable/disable 2D binning
+  std::vector<std::vector<TypeOutputScore>> mBatchInputs; // row-major input features of the batched candidates, one matrix for each model
+  std::vector<const TypeOutputScore*> mBatchOutputs;      // row-major scores of the batched candidates in the pre-bound model buffers, one matrix for each model
+  std::vector<int64_t> mBatchNRows;                       // number of batched candidates for each model
+  std::vector<std::size_t> mBatchStrides;                 // number of scores per candidate returned by each model
+  std::vector<int> mBatchModelIndices;                    // model index of each batched candidate
+  std::vector<int64_t> mBatchRowIndices;                  // row of each batched candidate in the matrix of its model
+  std::vector<std::vector<TypeOutputScore>> mBatchScores; // row-major scores of the batched candidates not evaluated on pre-bound buffers, one matrix for each model
+  std::vector<o2::ml::TreeEnsemble> mTreeEnsembles;       // native tree-ensemble models, one for each bin (if enabled)
+  int mBackend = o2::ml::MlBackend::BackendOnnxRuntime;   // inference backend
 
   virtual void setAvailableInputFeatures() { return; } // method to fill the map of available input features
 
  private:
+  /// Applies the cuts of a given model to its scores
+  /// \param scores pointer to the mNClasses model scores
+  /// \param nModel is the model index
+  /// \return boolean telling if model predictions pass the cuts
+  bool isSelectedScores(const TypeOutputScore* scores, const int nModel) const
+  {
+    for (uint8_t iClass{0}; iClass < mNClasses; ++iClass) {
+      uint8_t dir = mCutDir.at(iClass);
+      if (dir == o2::cuts_ml::CutDirection::CutGreater && scores[iClass] > mCuts.get(nModel, iClass)) {
+        return false;
+      }
+      if (dir == o2::cuts_ml::CutDirection::CutSmaller && scores[iClass] < mCuts.get(nModel, iClass)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /// Appends the input features of a candidate to the batch of a given model
+  /// \param input is the input features
+  /// \param nModel is the model index
+  /// \return index of the candidate in the batch
+  template <typename T>
+  std::size_t addToBatchModel(const T& input, const int nModel)
+  {
+    if (nModel < 0 || static_cast<std::size_t>(nModel) >= mModels.size()) {
+      LOG(fatal) << "Model index " << nModel << " is out of range! The number of initialised models is " << mModels.size() << ". Please check your configurables.";
+    }
+    if (mBatchInputs.size() != mModels.size()) {
+      mBatchInputs.resize(mModels.size());
+      mBatchNRows.resize(mModels.size(), 0);
+    }
+    mBatchInputs[nModel].insert(mBatchInputs[nModel].end(), std::begin(input), std::end(input));
+    mBatchModelIndices.push_back(nModel);
+    mBatchRowIndices.push_back(mBatchNRows[nModel]++);
+    return mBatchModelIndices.size() - 1;
+  }
+
   /// Finds matching bin in mBinsLimits
   /// \param value e.g. pT
   /// \return index of the matching bin, used to access mModels
@@ -0,0 +1,128 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file     benchmarkTreeEnsemble.cxx
+///
+/// \brief    exec to compare scores and throughput (candidates/second) of the ONNX Runtime
+///           and native tree-ensemble backends on a BDT model, with random input features,
+///           optionally with a fraction of NaN features to check the missing-value handling
+///
+
+#include "Tools/ML/model.h"
+#include "Tools/ML/treeEnsemble.h"
+
+#include <Framework/Logger.h>
+
+#include <boost/program_options.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace bpo = boost::program_options;
+
+int main(int argc, char* argv[])
+{
+  bpo::options_description options("Allowed options");
+  options.add_options()(
+    "model,m", bpo::value<std::string>()->default_value("model.onnx"), "Path to the .onnx file of the tree-ensemble model")(
+    "candidates,n", bpo::value<int>()->default_value(1000000), "Number of candidates to evaluate")(
+    "batch,b", bpo::value<int>()->default_value(1), "Number of candidates evaluated per call")(
+    "min", bpo::value<float>()->default_value(-1.f), "Lower bound of the random input features")(
+    "max", bpo::value<float>()->default_value(1.f), "Upper bound of the random input features")(
+    "nan-fraction", bpo::value<float>()->default_value(0.f), "Fraction of input features set to NaN, to compare the handling of missing values")(
+    "help,h", "Produce help message.");
+  bpo::variables_map arguments;
+  try {
+    bpo::store(parse_command_line(argc, argv, options), arguments);
+    if (arguments.count("help")) {
+      LOG(info) << options;
+      return 0;
+    }
+    bpo::notify(arguments);
+  } catch (const bpo::error& e) {
+    LOG(error) << e.what();
+    LOG(error) << options;
+    return 1;
+  }
+
+  const std::string modelPath = arguments["model"].as<std::string>();
+  const int nCandidates = arguments["candidates"].as<int>();
+  const int batchSize = std::max(1, std::min(arguments["batch"].as<int>(), nCandidates));
+
+  o2::ml::OnnxModel onnxModel;
+  onnxModel.initModel(modelPath, false, 1);
+  o2::ml::TreeEnsemble treeEnsemble;
+  treeEnsemble.loadModel(modelPath);
+
+  const int nFeatures = onnxModel.getNumInputNodes();
+  const int nOutputs = treeEnsemble.getNumOutputs();
+  std::mt19937 generator(42);
+  std::uniform_real_distribution<float> distribution(arguments["min"].as<float>(), arguments["max"].as<float>());
+  std::vector<float> features(static_cast<std::size_t>(nCandidates) * nFeatures);
+  std::generate(features.begin(), features.end(), [&]() { return distribution(generator); });
+  const float nanFraction = arguments["nan-fraction"].as<float>();
+  if (nanFraction > 0.f) {
+    std::uniform_real_distribution<float> uniform(0.f, 1.f);
+    for (auto& feature : features) {
+      if (uniform(generator) < nanFraction) {
+        feature = std::numeric_limits<float>::quiet_NaN();
+      }
+    }
+  }
+
+  std::vector<float> scoresOnnx(static_cast<std::size_t>(nCandidates) * nOutputs);
+  std::vector<float> scoresNative(static_cast<std::size_t>(nCandidates) * nOutputs);
+
+  auto start = std::chrono::high_resolution_clock::now();
+  for (int iCand = 0; iCand < nCandidates; iCand += batchSize) {
+    const int nRows = std::min(batchSize, nCandidates - iCand);
+    float* input = onnxModel.getBoundInput<float>(nRows);
+    std::copy_n(features.data() + static_cast<std::size_t>(iCand) * nFeatures, nRows * nFeatures, input);
+    const float* output = onnxModel.evalModelBound<float>();
+    const auto nValues = onnxModel.getNumBoundOutputValues();
+    for (int iRow = 0; iRow < nRows; ++iRow) {
+      std::copy_n(output + iRow * nValues, std::min<std::size_t>(nValues, nOutputs), scoresOnnx.data() + static_cast<std::size_t>(iCand + iRow) * nOutputs);
+    }
+  }
+  const double timeOnnx = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+  start = std::chrono::high_resolution_clock::now();
+  for (int iCand = 0; iCand < nCandidates; iCand += batchSize) {
+    const int nRows = std::min(batchSize, nCandidates - iCand);
+    treeEnsemble.evaluate(features.data() + static_cast<std::size_t>(iCand) * nFeatures, nRows, nFeatures, scoresNative.data() + static_cast<std::size_t>(iCand) * nOutputs);
+  }
+  const double timeNative = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - start).count();
+
+  std::size_t nDifferent = 0;
+  float maxDifference = 0.f;
+  for (std::size_t i = 0; i < scoresOnnx.size(); ++i) {
+    if (scoresOnnx[i] != scoresNative[i]) {
+      ++nDifferent;
+      maxDifference = std::max(maxDifference, std::abs(scoresOnnx[i] - scoresNative[i]));
+    }
+  }
+
+  LOG(info) << "Model " << modelPath << ": " << treeEnsemble.getNumTrees() << " trees, " << treeEnsemble.getNumNodes() << " nodes, " << nFeatures << " features, " << nOutputs << " classes";
+  LOG(info) << "Candidates: " << nCandidates << ", batch size: " << batchSize << ", NaN fraction: " << nanFraction;
+  LOG(info) << "ONNX Runtime:          " << nCandidates / timeOnnx << " candidates/s";
+  LOG(info) << "Native tree ensemble:  " << nCandidates / timeNative << " candidates/s (x" << timeOnnx / timeNative << ")";
+  LOG(info) << "Scores differing from ONNX Runtime: " << nDifferent << " / " << scoresOnnx.size() << ", max. absolute difference: " << maxDifference;
+
+  return nDifferent == 0 ? 0 : 2;
+}
@@ -19,12 +19,16 @@
 
 #include "Tools/ML/model.h"
 
+#include "Tools/ML/sessionRegistry.h"
+
 #include <Framework/Logger.h>
 
 #include <TSystem.h>
 
 #include <onnxruntime_cxx_api.h>
 
+#include <algorithm>
+#include <array>
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
@@ -85,20 +89,39 @@ void OnnxModel::initModel(const std::string& localPath, const bool enableOptimiz
   /// Enableing optimizations
   if (enableOptimizations) {
     sessionOptions.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_EXTENDED);
+    mOptimizationsEnabled = true;
   }
 
-  mEnv = std::make_shared<Ort::Env>(ORT_LOGGING_LEVEL_WARNING, "onnx-model");
-  mSession = std::make_shared<Ort::Session>(*mEnv, modelPath.c_str(), sessionOptions);
+  /// Environment and sessions are shared process-wide: identical model files with identical settings are parsed only once
+  auto& registry = OnnxSessionRegistry::instance();
+  mEnv = registry.getEnv();
+  mSession = registry.getSession(modelPath, sessionOptions, getSessionOptionsKey());
+  mMemoryInfo = Ort::MemoryInfo::CreateCpu(OrtAllocatorType::OrtArenaAllocator, OrtMemType::OrtMemTypeDefault);
+  mRunOptions = Ort::RunOptions{};
+
+  // Clear node descriptions in case the model is re-initialised (e.g. new validity range)
+  mInputNames.clear();
+  mInputShapes.clear();
+  mOutputNames.clear();
+  mOutputShapes.clear();
+  mInputNamesChar.clear();
+  mOutputNamesChar.clear();
+  mInputNamesAllocated.clear();
+  mOutputNamesAllocated.clear();
 
   Ort::AllocatorWithDefaultOptions const tmpAllocator;
   for (std::size_t i = 0; i < mSession->GetInputCount(); ++i) {
-    mInputNames.push_back(mSession->GetInputNameAllocated(i, tmpAllocator).get());
+    mInputNamesAllocated.emplace_back(mSession->GetInputNameAllocated(i, tmpAllocator));
+    mInputNamesChar.push_back(mInputNamesAllocated.back().get());
+    mInputNames.push_back(mInputNamesChar.back());
   }
   for (std::size_t i = 0; i < mSession->GetInputCount(); ++i) {
     mInputShapes.emplace_back(mSession->GetInputTypeInfo(i).GetTensorTypeAndShapeInfo().GetShape());
   }
   for (std::size_t i = 0; i < mSession->GetOutputCount(); ++i) {
-    mOutputNames.push_back(mSession->GetOutputNameAllocated(i, tmpAllocator).get());
+    mOutputNamesAllocated.emplace_back(mSession->GetOutputNameAllocated(i, tmpAllocator));
+    mOutputNamesChar.push_back(mOutputNamesAllocated.back().get());
+    mOutputNames.push_back(mOutputNamesChar.back());
   }
   for (std::size_t i = 0; i < mSession->GetOutputCount(); ++i) {
     mOutputShapes.emplace_back(mSession->GetOutputTypeInfo(i).GetTensorTypeAndShapeInfo().GetShape());
@@ -116,11 +139,36 @@ void OnnxModel::initModel(const std::string& localPath, const bool enableOptimiz
   validFrom = from;
   validUntil = until;
 
+  mInputElementType = mSession->GetInputCount() > 0 ? mSession->GetInputTypeInfo(0).GetTensorTypeAndShapeInfo().GetElementType() : ONNX_TENSOR_ELEMENT_DATA_TYPE_UNDEFINED;
+  mOutputElementType = mSession->GetOutputCount() > 0 ? mSession->GetOutputTypeInfo(mSession->GetOutputCount() - 1).GetTensorTypeAndShapeInfo().GetElementType() : ONNX_TENSOR_ELEMENT_DATA_TYPE_UNDEFINED;
+  mIoBindingPossible = checkIoBinding();
+
+  if (mUseIoBinding) {
+    enableIoBinding(mMaxBatchSize);
+  }
+
   LOG(info) << "Model validity - From: " << validFrom << ", Until: " << validUntil;
 
   LOG(info) << "--- Model initialized! ---";
 }
 
+void OnnxModel::resetSession()
+{
+  mSession = OnnxSessionRegistry::instance().getSession(modelPath, sessionOptions, getSessionOptionsKey());
+  if (mUseIoBinding) {
+    enableIoBinding(mMaxBatchSize);
+  }
+}
+
+std::string OnnxModel::getSessionOptionsKey() const
+{
+  // options modified through getSessionOptions() are unknown, the session is then not shared
+  if (mSessionOptionsModified) {
+    return "";
+  }
+  return std::to_string(mOptimizationsEnabled) + "-" + std::to_string(activeThreads);
+}
+
 void OnnxModel::setActiveThreads(const int threads)
 {
   activeThreads = threads;
@@ -129,6 +177,116 @@ void OnnxModel::setActiveThreads(const int threads)
   }
 }
 
+bool OnnxModel::checkIoBinding() const
+{
+  if (mInputNames.size() != 1 || mOutputNames.empty()) {
+    return false;
+  }
+  if (getElementSize(mSession->GetInputTypeInfo(0).GetTensorTypeAndShapeInfo().GetElementType()) == 0) {
+    return false;
+  }
+  for (std::size_t i = 0; i < mOutputNames.size(); ++i) {
+    if (getElementSize(mSession->GetOutputTypeInfo(i).GetTensorTypeAndShapeInfo().GetElementType()) == 0) {
+      return false;
+    }
+    for (std::size_t idim = 1; idim < mOutputShapes[i].size(); ++idim) {
+      if (mOutputShapes[i][idim] < 0) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+void OnnxModel::enableIoBinding(const int64_t maxBatchSize)
+{
+  if (!mIoBindingPossible) {
+    LOG(fatal) << "IoBinding is only supported for models with a single input node, numeric tensors and static output shapes apart from the batch dimension, model " << modelPath << " has " << mInputNames.size() << " input nodes";
+  }
+
+  mIoBinding = Ort::IoBinding{*mSession};
+  mUseIoBinding = true;
+  mBoundRows = -1;
+  mMaxBatchSize = 0;
+
+  mBoundInputType = mSession->GetInputTypeInfo(0).GetTensorTypeAndShapeInfo().GetElementType();
+  mBoundInputElementSize = getElementSize(mBoundInputType);
+  mBoundOutputs.resize(mOutputNames.size());
+  mBoundOutputTypes.clear();
+  mBoundOutputElementSizes.clear();
+  mBoundOutputSizes.clear();
+  for (std::size_t i = 0; i < mOutputNames.size(); ++i) {
+    mBoundOutputTypes.push_back(mSession->GetOutputTypeInfo(i).GetTensorTypeAndShapeInfo().GetElementType());
+    mBoundOutputElementSizes.push_back(getElementSize(mBoundOutputTypes.back()));
+    std::size_t size = 1;
+    for (std::size_t idim = 1; idim < mOutputShapes[i].size(); ++idim) {
+      size *= mOutputShapes[i][idim];
+    }
+    mBoundOutputSizes.push_back(size);
+  }
+
+  bindIo(std::max<int64_t>(maxBatchSize, 1));
+}
+
+void OnnxModel::bindIo(const int64_t nRows)
+{
+  if (!mUseIoBinding) {
+    enableIoBinding(nRows);
+    return;
+  }
+  if (nRows == mBoundRows) {
+    return;
+  }
+
+  const int64_t nFeatures = mInputShapes[0][1];
+  if (nRows > mMaxBatchSize) {
+    mBoundInput.resize(nRows * nFeatures * mBoundInputElementSize);
+    for (std::size_t i = 0; i < mBoundOutputs.size(); ++i) {
+      mBoundOutputs[i].resize(nRows * mBoundOutputSizes[i] * mBoundOutputElementSizes[i]);
+    }
+    mMaxBatchSize = nRows;
+  }
+
+  // Tensors are views on the pre-allocated buffers, they only need to be recreated when the batch size changes
+  mIoBinding.ClearBoundInputs();
+  mIoBinding.ClearBoundOutputs();
+  const std::array<int64_t, 2> inputShape{nRows, nFeatures};
+  mBoundInputTensor = Ort::Value::CreateTensor(mMemoryInfo, mBoundInput.data(), nRows * nFeatures * mBoundInputElementSize, inputShape.data(), inputShape.size(), mBoundInputType);
+  mIoBinding.BindInput(mInputNamesChar[0], mBoundInputTensor);
+  mBoundOutputTensors.clear();
+  for (std::size_t i = 0; i < mBoundOutputs.size(); ++i) {
+    std::vector<int64_t> outputShape = mOutputShapes[i];
+    outputShape[0] = nRows;
+    mBoundOutputTensors.emplace_back(Ort::Value::CreateTensor(mMemoryInfo, mBoundOutputs[i].data(), nRows * mBoundOutputSizes[i] * mBoundOutputElementSizes[i], outputShape.data(), outputShape.size(), mBoundOutputTypes[i]));
+    mIoBinding.BindOutput(mOutputNamesChar[i], mBoundOutputTensors.back());
+  }
+  mBoundRows = nRows;
+}
+
+std::size_t OnnxModel::getElementSize(const ONNXTensorElementDataType type)
+{
+  switch (type) {
+    case ONNX_TENSOR_ELEMENT_DATA_TYPE_BOOL:
+    case ONNX_TENSOR_ELEMENT_DATA_TYPE_INT8:
+    case ONNX_TENSOR_ELEMENT_DATA_TYPE_UINT8:
+      return 1;
+    case ONNX_TENSOR_ELEMENT_DATA_TYPE_INT16:
+    case ONNX_TENSOR_ELEMENT_DATA_TYPE_UINT16:
+    case ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT16:
+      return 2;
+    case ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT:
+    case ONNX_TENSOR_ELEMENT_DATA_TYPE_INT32:
+    case ONNX_TENSOR_ELEMENT_DATA_TYPE_UINT32:
+      return 4;
+    case ONNX_TENSOR_ELEMENT_DATA_TYPE_DOUBLE:
+    case ONNX_TENSOR_ELEMENT_DATA_TYPE_INT64:
+    case ONNX_TENSOR_ELEMENT_DATA_TYPE_UINT64:
+      return 8;
+    default:
+      return 0; // not supported for IoBinding
+  }
+}
+
 } // namespace ml
 
 } // namespace o2
@@ -25,10 +25,10 @@
 #include <onnxruntime_cxx_api.h>
 
 #include <algorithm>
+#include <array>
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
-#include <iterator>
 #include <memory>
 #include <string>
 #include <vector>
@@ -45,11 +45,14 @@ class OnnxModel
  public:
   OnnxModel() = default;
   ~OnnxModel() = default;
+  OnnxModel(OnnxModel&&) = default; // sessions, buffers and bindings move with the model
+  OnnxModel& operator=(OnnxModel&&) = default;
 
   // Inferencing
   void initModel(const std::string&, const bool = false, const int = 0, const uint64_t = 0, const uint64_t = 0);
 
   // template methods -- best to define them in header
+  /// \return pointer to the values of the last output tensor, owned by the model and valid until the next inference call
   template <typename T>
   T* evalModel(std::vector<Ort::Value>& input)
   {
@@ -57,26 +60,18 @@ class OnnxModel
     // assert(input[0].GetTensorTypeAndShapeInfo().GetShape() == getNumInputNodes()); --> Fails build in debug mode, TODO: assertion should be checked somehow
 
     try {
-      const Ort::RunOptions runOptions;
-      std::vector<const char*> inputNamesChar(mInputNames.size(), nullptr);
-      std::transform(std::begin(mInputNames), std::end(mInputNames), std::begin(inputNamesChar),
-                     [&](const std::string& str) { return str.c_str(); });
-
-      std::vector<const char*> outputNamesChar(mOutputNames.size(), nullptr);
-      std::transform(std::begin(mOutputNames), std::end(mOutputNames), std::begin(outputNamesChar),
-                     [&](const std::string& str) { return str.c_str(); });
-      auto outputTensors = mSession->Run(runOptions, inputNamesChar.data(), input.data(), input.size(), outputNamesChar.data(), outputNamesChar.size());
-      LOG(debug) << "Number of output tensors: " << outputTensors.size();
-      if (outputTensors.size() != mOutputNames.size()) {
-        LOG(fatal) << "Number of output tensors: " << outputTensors.size() << " does not agree with the model specified size: " << mOutputNames.size();
+      mOutputTensors = mSession->Run(mRunOptions, mInputNamesChar.data(), input.data(), input.size(), mOutputNamesChar.data(), mOutputNamesChar.size());
+      LOG(debug) << "Number of output tensors: " << mOutputTensors.size();
+      if (mOutputTensors.size() != mOutputNames.size()) {
+        LOG(fatal) << "Number of output tensors: " << mOutputTensors.size() << " does not agree with the model specified size: " << mOutputNames.size();
       }
-      for (std::size_t i = 0; i < outputTensors.size(); i++) {
-        LOG(debug) << "Output tensor shape: " << printShape(outputTensors[i].GetTensorTypeAndShapeInfo().GetShape());
-        if ((outputTensors[i].GetTensorTypeAndShapeInfo().GetShape() != mOutputShapes[i]) && (mOutputShapes[i][0] != -1)) {
-          LOG(fatal) << "Shape of tensor " << i << " does not agree with model specification! Output: " << printShape(outputTensors[i].GetTensorTypeAndShapeInfo().GetShape()) << " model: " << printShape(mOutputShapes[i]);
+      for (std::size_t i = 0; i < mOutputTensors.size(); i++) {
+        LOG(debug) << "Output tensor shape: " << printShape(mOutputTensors[i].GetTensorTypeAndShapeInfo().GetShape());
+        if ((mOutputTensors[i].GetTensorTypeAndShapeInfo().GetShape() != mOutputShapes[i]) && (mOutputShapes[i][0] != -1)) {
+          LOG(fatal) << "Shape of tensor " << i << " does not agree with model specification! Output: " << printShape(mOutputTensors[i].GetTensorTypeAndShapeInfo().GetShape()) << " model: " << printShape(mOutputShapes[i]);
         }
       }
-      T* outputValues = outputTensors.back().GetTensorMutableData<T>();
+      T* outputValues = mOutputTensors.back().GetTensorMutableData<T>();
       return outputValues;
     } catch (const Ort::Exception& exception) {
       LOG(error) << "Error running model inference: " << exception.what();
@@ -91,9 +86,7 @@ class OnnxModel
     assert(size % mInputShapes[0][1] == 0);
     std::vector<int64_t> inputShape{size / mInputShapes[0][1], mInputShapes[0][1]};
     std::vector<Ort::Value> inputTensors;
-    Ort::MemoryInfo memInfo =
-      Ort::MemoryInfo::CreateCpu(OrtAllocatorType::OrtArenaAllocator, OrtMemType::OrtMemTypeDefault);
-    inputTensors.emplace_back(Ort::Value::CreateTensor<T>(memInfo, input.data(), size, inputShape.data(), inputShape.size()));
+    inputTensors.emplace_back(Ort::Value::CreateTensor<T>(mMemoryInfo, input.data(), size, inputShape.data(), inputShape.size()));
     LOG(debug) << "Input shape calculated from vector: " << printShape(inputShape);
     return evalModel<T>(inputTensors);
   }
@@ -104,8 +97,6 @@ class OnnxModel
   {
     std::vector<Ort::Value> inputTensors;
 
-    Ort::MemoryInfo memInfo = Ort::MemoryInfo::CreateCpu(OrtAllocatorType::OrtArenaAllocator, OrtMemType::OrtMemTypeDefault);
-
     for (std::size_t iinput = 0; iinput < input.size(); iinput++) {
       [[maybe_unused]] int totalSize = 1;
       int64_t size = input[iinput].size();
@@ -119,20 +110,125 @@ class OnnxModel
         inputShape.push_back(mInputShapes[iinput][idim]);
       }
 
-      inputTensors.emplace_back(Ort::Value::CreateTensor<T>(memInfo, input[iinput].data(), size, inputShape.data(), inputShape.size()));
+      inputTensors.emplace_back(Ort::Value::CreateTensor<T>(mMemoryInfo, input[iinput].data(), size, inputShape.data(), inputShape.size()));
     }
 
     return evalModel<T>(inputTensors);
   }
 
-  // Reset session
-  void resetSession()
+  /// Batched inference on a row-major matrix of input features, with a single Run() call for all entries
+  /// \param input pointer to nRows x getNumInputNodes() contiguous input values
+  /// \param nRows number of entries (e.g. candidates) in the batch
+  /// \param output vector filled with the values of the last output tensor, nRows x (number of values per entry)
+  /// \return number of output values per entry, 0 in case of failure
+  template <typename T>
+  std::size_t evalModelBatch(T* input, const int64_t nRows, std::vector<T>& output)
+  {
+    output.clear();
+    if (nRows <= 0) {
+      return 0;
+    }
+    if (mInputNames.size() != 1) {
+      LOG(fatal) << "Batched inference is only supported for models with a single input node, this model has " << mInputNames.size();
+    }
+
+    const int64_t nFeatures = mInputShapes[0][1];
+    const std::array<int64_t, 2> inputShape{nRows, nFeatures};
+    try {
+      Ort::Value inputTensor = Ort::Value::CreateTensor<T>(mMemoryInfo, input, nRows * nFeatures, inputShape.data(), inputShape.size());
+      auto outputTensors = mSession->Run(mRunOptions, mInputNamesChar.data(), &inputTensor, 1, mOutputNamesChar.data(), mOutputNamesChar.size());
+      if (outputTensors.size() != mOutputNames.size()) {
+        LOG(fatal) << "Number of output tensors: " << outputTensors.size() << " does not agree with the model specified size: " << mOutputNames.size();
+      }
+      const std::size_t nValues = outputTensors.back().GetTensorTypeAndShapeInfo().GetElementCount();
+      const T* outputValues = outputTensors.back().GetTensorData<T>();
+      output.assign(outputValues, outputValues + nValues);
+      return nValues / nRows;
+    } catch (const Ort::Exception& exception) {
+      LOG(error) << "Error running batched model inference: " << exception.what();
+    }
+    return 0;
+  }
+
+  /// Batched inference on a row-major matrix of input features
+  /// \param input vector of nRows x getNumInputNodes() input values
+  /// \param output vector filled with the values of the last output tensor
+  /// \return number of output values per entry, 0 in case of failure
+  template <typename T>
+  std::size_t evalModelBatch(std::vector<T>& input, std::vector<T>& output)
+  {
+    const int64_t nFeatures = mInputShapes[0][1];
+    assert(static_cast<int64_t>(input.size()) % nFeatures == 0);
+    return evalModelBatch<T>(input.data(), static_cast<int64_t>(input.size()) / nFeatures, output);
+  }
+
+  /// Enables inference on input and output buffers owned by the model and bound once to the session (IoBinding),
+  /// so that no allocation happens in steady state. Buffers are grown if a larger batch is requested later.
+  /// Fatal if the model does not support it, see isIoBindingPossible().
+  /// \param maxBatchSize number of entries for which the buffers are pre-allocated
+  void enableIoBinding(const int64_t maxBatchSize = 1);
+
+  /// Whether the model can be evaluated with evalModelBound() on input and last output values of type T:
+  /// single input node, static output shapes apart from the batch dimension and matching element types
+  template <typename T>
+  bool isIoBindingPossible() const
+  {
+    return mIoBindingPossible && mInputElementType == Ort::TypeToTensorType<T>::type && mOutputElementType == Ort::TypeToTensorType<T>::type;
+  }
+
+  /// Pre-bound input buffer, to be filled with nRows x getNumInputNodes() values before calling evalModelBound()
+  /// \param nRows number of entries to be evaluated
+  template <typename T>
+  T* getBoundInput(const int64_t nRows)
   {
-    mSession.reset(new Ort::Session{*mEnv, modelPath.c_str(), sessionOptions});
+    bindIo(nRows);
+    if (Ort::TypeToTensorType<T>::type != mBoundInputType) {
+      LOG(fatal) << "Bound input of ONNX element type " << Ort::TypeToTensorType<T>::type << " requested, while the input of model " << modelPath << " is of type " << mBoundInputType;
+    }
+    return reinterpret_cast<T*>(mBoundInput.data());
   }
 
+  /// Inference on the pre-bound input buffer
+  /// \return pointer to the values of the last output, owned by the model and valid until the next call
+  template <typename T>
+  const T* evalModelBound()
+  {
+    if (Ort::TypeToTensorType<T>::type != mBoundOutputTypes.back()) {
+      LOG(fatal) << "Bound output of ONNX element type " << Ort::TypeToTensorType<T>::type << " requested, while the last output of model " << modelPath << " is of type " << mBoundOutputTypes.back();
+    }
+    try {
+      mSession->Run(mRunOptions, mIoBinding);
+    } catch (const Ort::Exception& exception) {
+      LOG(error) << "Error running model inference: " << exception.what();
+      return nullptr;
+    }
+    return reinterpret_cast<const T*>(mBoundOutputs.back().data());
+  }
+
+  /// Inference on a row-major matrix of input features, copied into the pre-bound input buffer
+  /// \param input vector of nRows x getNumInputNodes() input values
+  /// \return pointer to the values of the last output, owned by the model and valid until the next call
+  template <typename T>
+  const T* evalModelBound(const std::vector<T>& input)
+  {
+    if (input.empty()) {
+      return nullptr;
+    }
+    const int64_t nFeatures = mInputShapes[0][1];
+    assert(static_cast<int64_t>(input.size()) % nFeatures == 0);
+    std::copy(input.begin(), input.end(), getBoundInput<T>(static_cast<int64_t>(input.size()) / nFeatures));
+    return evalModelBound<T>();
+  }
+
+  // Reset session, e.g. after changing the session options
+  void resetSession();
+
   // Getters & Setters
-  Ort::SessionOptions* getSessionOptions() { return &sessionOptions; } // For optimizations in post
+  Ort::SessionOptions* getSessionOptions() // For optimizations in post, sessions are then not shared with other models
+  {
+    mSessionOptionsModified = true;
+    return &sessionOptions;
+  }
   std::shared_ptr<Ort::Session> getSession()
   {
     return mSession;
@@ -140,6 +236,7 @@ class OnnxModel
   int getNumInputNodes() const { return mInputShapes[0][1]; }
   std::vector<std::vector<int64_t>> getInputShapes() const { return mInputShapes; }
   int getNumOutputNodes() const { return mOutputShapes[0][1]; }
+  std::size_t getNumBoundOutputValues() const { return mBoundOutputSizes.back(); } // number of values per entry of the last bound output
   uint64_t getValidityFrom() const { return validFrom; }
   uint64_t getValidityUntil() const { return validUntil; }
   void setActiveThreads(const int);
@@ -149,6 +246,8 @@ class OnnxModel
   std::shared_ptr<Ort::Env> mEnv = nullptr;
   std::shared_ptr<Ort::Session> mSession = nullptr;
   Ort::SessionOptions sessionOptions;
+  bool mOptimizationsEnabled = false;   // graph optimizations set in sessionOptions
+  bool mSessionOptionsModified = false; // sessionOptions handed out by getSessionOptions()
 
   // Input & Output specifications of the loaded network
   std::vector<std::string> mInputNames;
@@ -156,6 +255,33 @@ class OnnxModel
   std::vector<std::string> mOutputNames;
   std::vector<std::vector<int64_t>> mOutputShapes;
 
+  // Node names and memory description cached at initialisation, to avoid rebuilding them at every inference
+  std::vector<Ort::AllocatedStringPtr> mInputNamesAllocated;
+  std::vector<Ort::AllocatedStringPtr> mOutputNamesAllocated;
+  std::vector<const char*> mInputNamesChar;
+  std::vector<const char*> mOutputNamesChar;
+  Ort::MemoryInfo mMemoryInfo{nullptr};
+  Ort::RunOptions mRunOptions{nullptr};
+  std::vector<Ort::Value> mOutputTensors; // outputs of the last evalModel call, kept alive for the returned pointer
+  ONNXTensorElementDataType mInputElementType = ONNX_TENSOR_ELEMENT_DATA_TYPE_UNDEFINED;  // element type of the first input
+  ONNXTensorElementDataType mOutputElementType = ONNX_TENSOR_ELEMENT_DATA_TYPE_UNDEFINED; // element type of the last output
+  bool mIoBindingPossible = false;                                                        // single input node and static output shapes apart from the batch dimension
+
+  // Pre-allocated buffers bound to the session, raw bytes to support any tensor element type
+  bool mUseIoBinding = false;
+  Ort::IoBinding mIoBinding{nullptr};
+  int64_t mMaxBatchSize = 0;
+  int64_t mBoundRows = -1;
+  std::vector<uint8_t> mBoundInput;
+  ONNXTensorElementDataType mBoundInputType = ONNX_TENSOR_ELEMENT_DATA_TYPE_UNDEFINED;
+  std::size_t mBoundInputElementSize = 0;
+  Ort::Value mBoundInputTensor{nullptr};
+  std::vector<std::vector<uint8_t>> mBoundOutputs;
+  std::vector<ONNXTensorElementDataType> mBoundOutputTypes;
+  std::vector<std::size_t> mBoundOutputElementSizes;
+  std::vector<std::size_t> mBoundOutputSizes; // number of values per entry of each output
+  std::vector<Ort::Value> mBoundOutputTensors;
+
   // Environment settings
   std::string modelPath;
   int activeThreads = 0;
@@ -165,6 +291,10 @@ class OnnxModel
   // Internal function for printing the shape of tensors
   std::string printShape(const std::vector<int64_t>&);
   bool checkHyperloop(const bool = true);
+  std::string getSessionOptionsKey() const;
+  void bindIo(const int64_t);
+  bool checkIoBinding() const;
+  static std::size_t getElementSize(const ONNXTensorElementDataType);
 };
 
 } // namespace ml
@@ -0,0 +1,142 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file     sessionRegistry.cxx
+///
+/// \brief    Process-wide registry sharing the ONNX Runtime environment, thread pools and sessions
+///
+
+#include "Tools/ML/sessionRegistry.h"
+
+#include <Framework/Logger.h>
+
+#include <onnxruntime_cxx_api.h>
+
+#include <cstddef>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+
+namespace o2
+{
+
+namespace ml
+{
+
+OnnxSessionRegistry& OnnxSessionRegistry::instance()
+{
+  static OnnxSessionRegistry registry;
+  return registry;
+}
+
+void OnnxSessionRegistry::enableGlobalThreadPools(const int intraOpThreads, const int interOpThreads)
+{
+  const std::lock_guard<std::mutex> lock(mMutex);
+  if (mEnv) {
+    LOG(warning) << "ONNX environment already created, global thread pools can not be enabled anymore";
+    return;
+  }
+  mUseGlobalThreadPools = true;
+  mIntraOpThreads = intraOpThreads;
+  mInterOpThreads = interOpThreads;
+}
+
+std::shared_ptr<Ort::Env> OnnxSessionRegistry::getEnvUnlocked()
+{
+  if (!mEnv) {
+    if (mUseGlobalThreadPools) {
+      Ort::ThreadingOptions threadingOptions;
+      threadingOptions.SetGlobalIntraOpNumThreads(mIntraOpThreads);
+      threadingOptions.SetGlobalInterOpNumThreads(mInterOpThreads);
+      mEnv = std::make_shared<Ort::Env>(threadingOptions, ORT_LOGGING_LEVEL_WARNING, "onnx-model");
+      LOG(info) << "ONNX environment created with global thread pools (intra-op threads: " << mIntraOpThreads << ", inter-op threads: " << mInterOpThreads << ")";
+    } else {
+      mEnv = std::make_shared<Ort::Env>(ORT_LOGGING_LEVEL_WARNING, "onnx-model");
+    }
+  }
+  return mEnv;
+}
+
+std::shared_ptr<Ort::Env> OnnxSessionRegistry::getEnv()
+{
+  const std::lock_guard<std::mutex> lock(mMutex);
+  return getEnvUnlocked();
+}
+
+std::shared_ptr<Ort::Session> OnnxSessionRegistry::getSession(const std::string& modelPath, Ort::SessionOptions& sessionOptions, const std::string& optionsKey)
+{
+  std::ifstream file(modelPath, std::ios::binary);
+  if (!file) {
+    LOG(fatal) << "Could not open ONNX model file " << modelPath;
+  }
+  const std::string content{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+  if (optionsKey.empty()) {
+    const std::lock_guard<std::mutex> lock(mMutex);
+    if (mUseGlobalThreadPools) {
+      sessionOptions.DisablePerSessionThreads();
+    }
+    return std::make_shared<Ort::Session>(*getEnvUnlocked(), content.data(), content.size(), sessionOptions);
+  }
+  std::stringstream key;
+  key << std::hex << std::hash<std::string>{}(content) << std::dec << ":" << content.size() << ":" << optionsKey;
+
+  const std::lock_guard<std::mutex> lock(mMutex);
+  // drop the sessions released by all their users (e.g. models of past validity ranges)
+  for (auto entry = mSessions.begin(); entry != mSessions.end();) {
+    entry = entry->second.expired() ? mSessions.erase(entry) : std::next(entry);
+  }
+  auto& cached = mSessions[key.str()];
+  if (auto session = cached.lock()) {
+    LOG(info) << "Reusing ONNX session for " << modelPath << " (key " << key.str() << ")";
+    return session;
+  }
+
+  if (mUseGlobalThreadPools) {
+    sessionOptions.DisablePerSessionThreads();
+  }
+  auto session = std::make_shared<Ort::Session>(*getEnvUnlocked(), content.data(), content.size(), sessionOptions);
+  cached = session;
+  return session;
+}
+
+bool OnnxSessionRegistry::isFileRetrieved(const std::string& localFile, const std::string& key)
+{
+  const std::lock_guard<std::mutex> lock(mMutex);
+  const auto retrieved = mRetrievedFiles.find(localFile);
+  return retrieved != mRetrievedFiles.end() && retrieved->second == key;
+}
+
+void OnnxSessionRegistry::setFileRetrieved(const std::string& localFile, const std::string& key)
+{
+  const std::lock_guard<std::mutex> lock(mMutex);
+  mRetrievedFiles[localFile] = key;
+}
+
+std::size_t OnnxSessionRegistry::getNumSessions()
+{
+  const std::lock_guard<std::mutex> lock(mMutex);
+  std::size_t nSessions = 0;
+  for (const auto& [key, session] : mSessions) {
+    if (!session.expired()) {
+      ++nSessions;
+    }
+  }
+  return nSessions;
+}
+
+} // namespace ml
+
+} // namespace o2
@@ -0,0 +1,86 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file     sessionRegistry.h
+///
+/// \brief    Process-wide registry sharing the ONNX Runtime environment, thread pools and sessions
+///           among all OnnxModel instances (e.g. the pT-bin models of several MlResponse objects)
+///
+
+#ifndef TOOLS_ML_SESSIONREGISTRY_H_
+#define TOOLS_ML_SESSIONREGISTRY_H_
+
+#include <onnxruntime_cxx_api.h>
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace o2
+{
+
+namespace ml
+{
+
+class OnnxSessionRegistry
+{
+
+ public:
+  static OnnxSessionRegistry& instance();
+
+  OnnxSessionRegistry(const OnnxSessionRegistry&) = delete;
+  OnnxSessionRegistry& operator=(const OnnxSessionRegistry&) = delete;
+
+  /// Use thread pools owned by the environment and shared by all sessions instead of per-session pools
+  /// \note Must be called before the first model is initialised
+  void enableGlobalThreadPools(const int intraOpThreads, const int interOpThreads = 1);
+
+  /// Environment shared by all sessions of the process
+  std::shared_ptr<Ort::Env> getEnv();
+
+  /// Session for a model file, shared among all callers with identical file content and options
+  /// \param modelPath path to the .onnx file
+  /// \param sessionOptions options used if the session has to be created
+  /// \param optionsKey string identifying all the settings applied to sessionOptions, empty for a session not shared with any other caller
+  /// \return reference-counted session, released when the last user drops it
+  std::shared_ptr<Ort::Session> getSession(const std::string& modelPath, Ort::SessionOptions& sessionOptions, const std::string& optionsKey);
+
+  /// Bookkeeping of files already retrieved (e.g. from CCDB), to avoid downloading identical blobs twice
+  /// \param localFile path of the local file the blob is written to
+  /// \param key string identifying the blob (e.g. CCDB path, timestamp and file name)
+  /// \return whether localFile currently holds the blob identified by key
+  bool isFileRetrieved(const std::string& localFile, const std::string& key);
+  void setFileRetrieved(const std::string& localFile, const std::string& key);
+
+  std::size_t getNumSessions(); // number of sessions currently alive
+
+ private:
+  OnnxSessionRegistry() = default;
+
+  std::shared_ptr<Ort::Env> getEnvUnlocked();
+
+  std::mutex mMutex;
+  std::shared_ptr<Ort::Env> mEnv = nullptr;
+  bool mUseGlobalThreadPools = false;
+  int mIntraOpThreads = 0;
+  int mInterOpThreads = 1;
+  std::unordered_map<std::string, std::weak_ptr<Ort::Session>> mSessions; // sessions keyed by file hash and options
+  std::unordered_map<std::string, std::string> mRetrievedFiles; // key of the blob last written to each local file
+};
+
+} // namespace ml
+
+} // namespace o2
+
+#endif // TOOLS_ML_SESSIONREGISTRY_H_
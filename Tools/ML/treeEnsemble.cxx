@@ -0,0 +1,488 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file     treeEnsemble.cxx
+///
+/// \brief    Native evaluator of tree-ensemble (BDT) models stored in ONNX files
+///
+
+#include "Tools/ML/treeEnsemble.h"
+
+#include <Framework/Logger.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace
+{
+
+/// Minimal reader of the protobuf wire format, enough to extract the attributes of an ONNX node
+class ProtoReader
+{
+ public:
+  explicit ProtoReader(std::string_view buffer) : mBuffer(buffer) {}
+
+  bool atEnd() const { return mPos >= mBuffer.size(); }
+
+  bool readTag(uint32_t& field, uint32_t& wireType)
+  {
+    if (atEnd()) {
+      return false;
+    }
+    const uint64_t tag = readVarint();
+    field = static_cast<uint32_t>(tag >> 3);
+    wireType = static_cast<uint32_t>(tag & 0x7);
+    return true;
+  }
+
+  uint64_t readVarint()
+  {
+    uint64_t value = 0;
+    for (int shift = 0; shift < 64 && !atEnd(); shift += 7) {
+      const auto byte = static_cast<uint8_t>(mBuffer[mPos++]);
+      value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+      if (!(byte & 0x80)) {
+        return value;
+      }
+    }
+    LOG(fatal) << "Malformed varint in ONNX file";
+    return value;
+  }
+
+  float readFloat()
+  {
+    checkSize(sizeof(float));
+    float value;
+    std::memcpy(&value, mBuffer.data() + mPos, sizeof(float));
+    mPos += sizeof(float);
+    return value;
+  }
+
+  std::string_view readBytes()
+  {
+    const auto size = static_cast<std::size_t>(readVarint());
+    checkSize(size);
+    const std::string_view bytes = mBuffer.substr(mPos, size);
+    mPos += size;
+    return bytes;
+  }
+
+  void skip(const uint32_t wireType)
+  {
+    switch (wireType) {
+      case 0:
+        readVarint();
+        break;
+      case 1:
+        checkSize(8);
+        mPos += 8;
+        break;
+      case 2:
+        readBytes();
+        break;
+      case 5:
+        checkSize(4);
+        mPos += 4;
+        break;
+      default:
+        LOG(fatal) << "Unsupported protobuf wire type " << wireType << " in ONNX file";
+    }
+  }
+
+ private:
+  void checkSize(const std::size_t size) const
+  {
+    if (mPos + size > mBuffer.size()) {
+      LOG(fatal) << "Truncated ONNX file";
+    }
+  }
+
+  std::string_view mBuffer;
+  std::size_t mPos = 0;
+};
+
+/// Attribute of an ONNX node (AttributeProto), only the fields used by the tree-ensemble operators
+struct Attribute {
+  std::vector<int64_t> ints;
+  std::vector<float> floats;
+  std::vector<std::string> strings;
+  bool isTensor = false;
+};
+
+void readAttribute(std::string_view buffer, std::map<std::string, Attribute>& attributes)
+{
+  ProtoReader reader(buffer);
+  std::string name;
+  Attribute attribute;
+  uint32_t field, wireType;
+  while (reader.readTag(field, wireType)) {
+    if (field == 1 && wireType == 2) { // name
+      name = reader.readBytes();
+    } else if (field == 2 && wireType == 5) { // f
+      attribute.floats.push_back(reader.readFloat());
+    } else if (field == 3 && wireType == 0) { // i
+      attribute.ints.push_back(static_cast<int64_t>(reader.readVarint()));
+    } else if (field == 4 && wireType == 2) { // s
+      attribute.strings.emplace_back(reader.readBytes());
+    } else if (field == 5 && wireType == 2) { // t
+      reader.readBytes();
+      attribute.isTensor = true;
+    } else if (field == 7 && wireType == 5) { // floats, not packed
+      attribute.floats.push_back(reader.readFloat());
+    } else if (field == 7 && wireType == 2) { // floats, packed
+      ProtoReader packed(reader.readBytes());
+      while (!packed.atEnd()) {
+        attribute.floats.push_back(packed.readFloat());
+      }
+    } else if (field == 8 && wireType == 0) { // ints, not packed
+      attribute.ints.push_back(static_cast<int64_t>(reader.readVarint()));
+    } else if (field == 8 && wireType == 2) { // ints, packed
+      ProtoReader packed(reader.readBytes());
+      while (!packed.atEnd()) {
+        attribute.ints.push_back(static_cast<int64_t>(packed.readVarint()));
+      }
+    } else if (field == 9 && wireType == 2) { // strings
+      attribute.strings.emplace_back(reader.readBytes());
+    } else {
+      reader.skip(wireType);
+    }
+  }
+  attributes[name] = std::move(attribute);
+}
+
+/// Finds the first node with the given operator type in the graph of an ONNX model and reads its attributes
+bool readTreeEnsembleNode(std::string_view model, const std::string& opType, std::map<std::string, Attribute>& attributes)
+{
+  ProtoReader modelReader(model);
+  uint32_t field, wireType;
+  while (modelReader.readTag(field, wireType)) {
+    if (field != 7 || wireType != 2) { // ModelProto.graph
+      modelReader.skip(wireType);
+      continue;
+    }
+    ProtoReader graphReader(modelReader.readBytes());
+    while (graphReader.readTag(field, wireType)) {
+      if (field != 1 || wireType != 2) { // GraphProto.node
+        graphReader.skip(wireType);
+        continue;
+      }
+      ProtoReader nodeReader(graphReader.readBytes());
+      std::string nodeOpType;
+      std::vector<std::string_view> nodeAttributes;
+      while (nodeReader.readTag(field, wireType)) {
+        if (field == 4 && wireType == 2) { // NodeProto.op_type
+          nodeOpType = nodeReader.readBytes();
+        } else if (field == 5 && wireType == 2) { // NodeProto.attribute
+          nodeAttributes.push_back(nodeReader.readBytes());
+        } else {
+          nodeReader.skip(wireType);
+        }
+      }
+      if (nodeOpType == opType) {
+        for (const auto& nodeAttribute : nodeAttributes) {
+          readAttribute(nodeAttribute, attributes);
+        }
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+} // namespace
+
+namespace o2
+{
+
+namespace ml
+{
+
+void TreeEnsemble::loadModel(const std::string& path)
+{
+  LOG(info) << "--- Native tree-ensemble model ---";
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    LOG(fatal) << "Could not open ONNX model file " << path;
+  }
+  const std::string content{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+
+  std::map<std::string, Attribute> attributes;
+  if (!readTreeEnsembleNode(content, "TreeEnsembleClassifier", attributes)) {
+    LOG(fatal) << "No TreeEnsembleClassifier node found in " << path << ", the native tree-ensemble evaluator can not be used for this model";
+  }
+  for (const auto& [name, attribute] : attributes) {
+    if (attribute.isTensor) {
+      LOG(fatal) << "Tensor attribute " << name << " (double precision tree ensemble) not supported by the native tree-ensemble evaluator";
+    }
+  }
+
+  const auto& treeIds = attributes["nodes_treeids"].ints;
+  const auto& nodeIds = attributes["nodes_nodeids"].ints;
+  const auto& featureIds = attributes["nodes_featureids"].ints;
+  const auto& values = attributes["nodes_values"].floats;
+  const auto& modes = attributes["nodes_modes"].strings;
+  const auto& trueNodeIds = attributes["nodes_truenodeids"].ints;
+  const auto& falseNodeIds = attributes["nodes_falsenodeids"].ints;
+  const auto& missingTracksTrue = attributes["nodes_missing_value_tracks_true"].ints;
+  const auto& classTreeIds = attributes["class_treeids"].ints;
+  const auto& classNodeIds = attributes["class_nodeids"].ints;
+  const auto& classIds = attributes["class_ids"].ints;
+  const auto& classWeights = attributes["class_weights"].floats;
+  const std::size_t nNodes = treeIds.size();
+  if (nodeIds.size() != nNodes || featureIds.size() != nNodes || values.size() != nNodes || modes.size() != nNodes || trueNodeIds.size() != nNodes || falseNodeIds.size() != nNodes || (!missingTracksTrue.empty() && missingTracksTrue.size() != nNodes)) {
+    LOG(fatal) << "Inconsistent node attributes in " << path;
+  }
+  if (classNodeIds.size() != classTreeIds.size() || classIds.size() != classTreeIds.size() || classWeights.size() != classTreeIds.size()) {
+    LOG(fatal) << "Inconsistent class attributes in " << path;
+  }
+
+  mNClasses = std::max(attributes["classlabels_int64s"].ints.size(), attributes["classlabels_strings"].strings.size());
+  if (mNClasses < 2 || mNClasses > MaxClasses) {
+    LOG(fatal) << "Number of classes " << mNClasses << " not supported by the native tree-ensemble evaluator";
+  }
+  mBaseValues = attributes["base_values"].floats;
+
+  const auto& postTransform = attributes["post_transform"].strings;
+  const std::string postTransformName = postTransform.empty() ? "NONE" : postTransform[0];
+  if (postTransformName == "NONE") {
+    mPostTransform = None;
+  } else if (postTransformName == "LOGISTIC") {
+    mPostTransform = Logistic;
+  } else if (postTransformName == "SOFTMAX") {
+    mPostTransform = Softmax;
+  } else if (postTransformName == "SOFTMAX_ZERO") {
+    mPostTransform = SoftmaxZero;
+  } else {
+    LOG(fatal) << "Post transform " << postTransformName << " not supported by the native tree-ensemble evaluator";
+  }
+
+  // index of each (tree, node) pair in the attribute arrays
+  auto key = [](int64_t treeId, int64_t nodeId) { return std::make_pair(treeId, nodeId); };
+  std::map<std::pair<int64_t, int64_t>, std::size_t> nodeIndices;
+  for (std::size_t i = 0; i < nNodes; ++i) {
+    if (!nodeIndices.emplace(key(treeIds[i], nodeIds[i]), i).second) {
+      LOG(fatal) << "Node " << nodeIds[i] << " of tree " << treeIds[i] << " defined twice in " << path;
+    }
+  }
+  std::map<std::pair<int64_t, int64_t>, std::vector<std::size_t>> leafWeightIndices;
+  std::vector<int64_t> weightedClasses;
+  mWeightsAllPositive = true;
+  for (std::size_t i = 0; i < classTreeIds.size(); ++i) {
+    leafWeightIndices[key(classTreeIds[i], classNodeIds[i])].push_back(i);
+    if (std::find(weightedClasses.begin(), weightedClasses.end(), classIds[i]) == weightedClasses.end()) {
+      weightedClasses.push_back(classIds[i]);
+    }
+    if (classWeights[i] < 0.f) {
+      mWeightsAllPositive = false;
+    }
+    if (classIds[i] < 0 || classIds[i] >= mNClasses) {
+      LOG(fatal) << "Class id " << classIds[i] << " out of range in " << path;
+    }
+  }
+  mBinaryCase = (mNClasses == 2 && weightedClasses.size() == 1);
+
+  // depth-first layout: the true child of a branch is the next node
+  mNodes.clear();
+  mRoots.clear();
+  mWeights.clear();
+  mNFeatures = 0;
+  std::vector<std::pair<std::size_t, int64_t>> stack; // (attribute index of the node, position of the parent whose false child it is)
+  auto addTree = [&](std::size_t rootIndex) {
+    stack.assign(1, {rootIndex, -1});
+    while (!stack.empty()) {
+      const auto [index, parentPosition] = stack.back();
+      stack.pop_back();
+      if (parentPosition >= 0) {
+        mNodes[parentPosition].falseChild = static_cast<int32_t>(mNodes.size());
+      }
+      Node node;
+      const std::string& mode = modes[index];
+      if (mode == "LEAF") {
+        node.mode = Leaf;
+        node.featureId = static_cast<int32_t>(mWeights.size());
+        for (const auto iWeight : leafWeightIndices[key(treeIds[index], nodeIds[index])]) {
+          mWeights.push_back({static_cast<int32_t>(classIds[iWeight]), classWeights[iWeight]});
+        }
+        node.falseChild = static_cast<int32_t>(mWeights.size());
+        mNodes.push_back(node);
+        continue;
+      }
+      if (mode == "BRANCH_LEQ") {
+        node.mode = BranchLeq;
+      } else if (mode == "BRANCH_LT") {
+        node.mode = BranchLt;
+      } else if (mode == "BRANCH_GTE") {
+        node.mode = BranchGte;
+      } else if (mode == "BRANCH_GT") {
+        node.mode = BranchGt;
+      } else if (mode == "BRANCH_EQ") {
+        node.mode = BranchEq;
+      } else if (mode == "BRANCH_NEQ") {
+        node.mode = BranchNeq;
+      } else {
+        LOG(fatal) << "Unknown node mode " << mode << " in " << path;
+      }
+      node.threshold = values[index];
+      node.featureId = static_cast<int32_t>(featureIds[index]);
+      node.missingTracksTrue = missingTracksTrue.empty() ? 0 : static_cast<uint8_t>(missingTracksTrue[index] != 0);
+      mNFeatures = std::max(mNFeatures, node.featureId + 1);
+      const auto trueChild = nodeIndices.find(key(treeIds[index], trueNodeIds[index]));
+      const auto falseChild = nodeIndices.find(key(treeIds[index], falseNodeIds[index]));
+      if (trueChild == nodeIndices.end() || falseChild == nodeIndices.end()) {
+        LOG(fatal) << "Missing child of node " << nodeIds[index] << " of tree " << treeIds[index] << " in " << path;
+      }
+      stack.emplace_back(falseChild->second, static_cast<int64_t>(mNodes.size()));
+      stack.emplace_back(trueChild->second, -1);
+      mNodes.push_back(node);
+    }
+  };
+
+  // trees are evaluated in order of appearance, their root being the first node listed for each tree
+  int64_t previousTreeId = -1;
+  for (std::size_t i = 0; i < nNodes; ++i) {
+    if (i == 0 || treeIds[i] != previousTreeId) {
+      mRoots.push_back(static_cast<int32_t>(mNodes.size()));
+      addTree(i);
+      previousTreeId = treeIds[i];
+    }
+  }
+
+  LOG(info) << "Trees: " << mRoots.size() << ", nodes: " << mNodes.size() << ", features: " << mNFeatures << ", classes: " << mNClasses << ", post transform: " << postTransformName;
+  LOG(info) << "--- Model initialized! ---";
+}
+
+int TreeEnsemble::finalizeScores(float* scores, const uint8_t* hasScore, float* output) const
+{
+  if (mNClasses > 2) {
+    for (std::size_t iClass = 0; iClass < mBaseValues.size(); ++iClass) {
+      scores[iClass] += mBaseValues[iClass];
+    }
+    std::copy(scores, scores + mNClasses, output);
+    applyPostTransform(output, mNClasses);
+    return mNClasses;
+  }
+
+  // binary classification, following the conventions of ONNX Runtime
+  int nScores = 2;
+  if (mBaseValues.size() == 2) {
+    if (hasScore[1]) {
+      scores[1] = mBaseValues[1] + scores[0];
+      scores[0] = -scores[1];
+    } else {
+      scores[1] += mBaseValues[1];
+      scores[0] += mBaseValues[0];
+    }
+  } else if (mBaseValues.size() == 1) {
+    scores[0] += mBaseValues[0];
+    if (!hasScore[1]) {
+      nScores = 1;
+    }
+  } else if (!hasScore[1]) {
+    nScores = 1;
+  }
+
+  int secondClass = -1;
+  if (mBinaryCase) {
+    const float positiveWeight = (nScores > 1 && hasScore[1]) ? scores[1] : (hasScore[0] ? scores[0] : 0.f);
+    if (mWeightsAllPositive) {
+      secondClass = positiveWeight > 0.5f ? 0 : 1;
+    } else {
+      secondClass = positiveWeight > 0.f ? 2 : 3;
+    }
+  }
+
+  if (nScores == 2) {
+    output[0] = scores[0];
+    output[1] = scores[1];
+    applyPostTransform(output, 2);
+    return 2;
+  }
+
+  switch (secondClass) {
+    case 0:
+    case 1:
+      output[0] = 1.f - scores[0];
+      output[1] = scores[0];
+      return 2;
+    case 2:
+    case 3:
+      if (mPostTransform == Logistic) {
+        output[0] = computeLogistic(-scores[0]);
+        output[1] = computeLogistic(scores[0]);
+      } else if (secondClass == 2) {
+        output[0] = -scores[0];
+        output[1] = scores[0];
+      } else {
+        output[0] = scores[0];
+        output[1] = -scores[0];
+      }
+      return 2;
+    default:
+      output[0] = scores[0];
+      return 1;
+  }
+}
+
+void TreeEnsemble::applyPostTransform(float* scores, const int nScores) const
+{
+  switch (mPostTransform) {
+    case Logistic:
+      for (int i = 0; i < nScores; ++i) {
+        scores[i] = computeLogistic(scores[i]);
+      }
+      break;
+    case Softmax:
+    case SoftmaxZero: {
+      float maxScore = -std::numeric_limits<float>::max();
+      for (int i = 0; i < nScores; ++i) {
+        maxScore = std::max(maxScore, scores[i]);
+      }
+      const float expNegMax = std::exp(-maxScore);
+      float sum = 0.f;
+      for (int i = 0; i < nScores; ++i) {
+        if (mPostTransform == SoftmaxZero && scores[i] <= 0.0000001f && scores[i] >= -0.0000001f) {
+          scores[i] *= expNegMax;
+        } else {
+          scores[i] = std::exp(scores[i] - maxScore);
+        }
+        sum += scores[i];
+      }
+      for (int i = 0; i < nScores; ++i) {
+        scores[i] /= sum;
+      }
+      break;
+    }
+    default:
+      break;
+  }
+}
+
+float TreeEnsemble::computeLogistic(const float value)
+{
+  const float v = 1.f / (1.f + std::exp(-std::abs(value)));
+  return (value < 0) ? (1.f - v) : v;
+}
+
+} // namespace ml
+
+} // namespace o2
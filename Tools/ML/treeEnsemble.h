@@ -0,0 +1,181 @@
+// Copyright 2019-2020 CERN and copyright holders of ALICE O2.
+// See https://alice-o2.web.cern.ch/copyright for details of the copyright holders.
+// All rights not expressly granted are reserved.
+//
+// This software is distributed under the terms of the GNU General Public
+// License v3 (GPL Version 3), copied verbatim in the file "COPYING".
+//
+// In applying this license CERN does not waive the privileges and immunities
+// granted to it by virtue of its status as an Intergovernmental Organization
+// or submit itself to any jurisdiction.
+
+///
+/// \file     treeEnsemble.h
+///
+/// \brief    Native evaluator of tree-ensemble (BDT) models stored in ONNX files (ai.onnx.ml TreeEnsembleClassifier),
+///           avoiding the per-call overhead of ONNX Runtime for small models
+///
+/// The trees are stored in a flat array of nodes in depth-first order, so that the true child of a branch
+/// is always the next node. Scores are aggregated in tree order and post-transformed as done by the
+/// sequential ONNX Runtime implementation, to reproduce its output.
+///
+
+#ifndef TOOLS_ML_TREEENSEMBLE_H_
+#define TOOLS_ML_TREEENSEMBLE_H_
+
+#include <Framework/Logger.h>
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace o2
+{
+
+namespace ml
+{
+
+class TreeEnsemble
+{
+
+ public:
+  TreeEnsemble() = default;
+  ~TreeEnsemble() = default;
+
+  // comparison applied at a branch node, as defined by the ONNX operator
+  enum NodeMode : uint8_t {
+    BranchLeq = 0,
+    BranchLt,
+    BranchGte,
+    BranchGt,
+    BranchEq,
+    BranchNeq,
+    Leaf
+  };
+
+  // post-transformation of the aggregated scores, as defined by the ONNX operator
+  enum PostTransform : uint8_t {
+    None = 0,
+    Logistic,
+    Softmax,
+    SoftmaxZero
+  };
+
+  struct Node {
+    float threshold = 0.f;         // branch threshold
+    int32_t featureId = 0;         // branch: index of the input feature, leaf: index of the first weight
+    int32_t falseChild = 0;        // branch: index of the false child (true child is the next node), leaf: index after the last weight
+    uint8_t mode = Leaf;
+    uint8_t missingTracksTrue = 0; // NaN inputs follow the true branch
+  };
+
+  struct LeafWeight {
+    int32_t classId = 0;
+    float value = 0.f;
+  };
+
+  /// Loads the TreeEnsembleClassifier node of an ONNX file
+  /// \param path path to the .onnx file
+  void loadModel(const std::string& path);
+
+  /// Evaluates a batch of entries
+  /// \param input row-major matrix of nRows x nInputs input features
+  /// \param nRows number of entries
+  /// \param nInputs number of input features per entry, at least getNumFeatures()
+  /// \param output row-major matrix of nRows x getNumOutputs() scores to be filled
+  template <typename TIn, typename TOut>
+  void evaluate(const TIn* input, const std::size_t nRows, const std::size_t nInputs, TOut* output)
+  {
+    if (nInputs < static_cast<std::size_t>(mNFeatures)) {
+      LOG(fatal) << "Tree-ensemble model uses " << mNFeatures << " input features, only " << nInputs << " provided";
+    }
+    mScores.assign(nRows * mNClasses, 0.f);
+    mHasScore.assign(nRows * mNClasses, 0);
+
+    // trees in the outer loop, so that the nodes of one tree stay in cache over the whole batch
+    for (const auto root : mRoots) {
+      for (std::size_t iRow = 0; iRow < nRows; ++iRow) {
+        const TIn* features = input + iRow * nInputs;
+        const Node* node = &mNodes[root];
+        while (node->mode != Leaf) {
+          node = isTrueBranch(*node, features[node->featureId]) ? node + 1 : &mNodes[node->falseChild];
+        }
+        float* scores = &mScores[iRow * mNClasses];
+        uint8_t* hasScore = &mHasScore[iRow * mNClasses];
+        for (int32_t iWeight = node->featureId; iWeight < node->falseChild; ++iWeight) {
+          scores[mWeights[iWeight].classId] += mWeights[iWeight].value;
+          hasScore[mWeights[iWeight].classId] = 1;
+        }
+      }
+    }
+
+    float finalScores[MaxClasses];
+    for (std::size_t iRow = 0; iRow < nRows; ++iRow) {
+      const int nScores = finalizeScores(&mScores[iRow * mNClasses], &mHasScore[iRow * mNClasses], finalScores);
+      for (int iClass = 0; iClass < mNClasses; ++iClass) {
+        output[iRow * mNClasses + iClass] = iClass < nScores ? static_cast<TOut>(finalScores[iClass]) : TOut{0};
+      }
+    }
+  }
+
+  int getNumFeatures() const { return mNFeatures; }
+  int getNumOutputs() const { return mNClasses; }
+  std::size_t getNumTrees() const { return mRoots.size(); }
+  std::size_t getNumNodes() const { return mNodes.size(); }
+
+  static constexpr int MaxClasses = 32; // maximum number of classes supported
+
+ private:
+  std::vector<Node> mNodes;         // nodes of all trees, depth-first order
+  std::vector<int32_t> mRoots;      // index of the root node of each tree
+  std::vector<LeafWeight> mWeights; // weights of all leaves
+  std::vector<float> mBaseValues;   // values added to the aggregated scores
+  int mNFeatures = 0;               // number of input features
+  int mNClasses = 0;                // number of classes
+  uint8_t mPostTransform = None;    // post-transformation of the scores
+  bool mBinaryCase = false;         // two classes with weights for one class only
+  bool mWeightsAllPositive = true;  // all leaf weights are non-negative
+  std::vector<float> mScores;       // aggregated scores of the current batch
+  std::vector<uint8_t> mHasScore;   // whether a leaf contributed to a class score in the current batch
+
+  template <typename T>
+  static bool isTrueBranch(const Node& node, const T value)
+  {
+    // as in ONNX Runtime, the comparison decides also for NaN inputs (true only for BranchNeq),
+    // unless nodes_missing_value_tracks_true sends them to the true branch
+    return compare(node, value) || (node.missingTracksTrue && std::isnan(value));
+  }
+
+  template <typename T>
+  static bool compare(const Node& node, const T value)
+  {
+    switch (node.mode) {
+      case BranchLeq:
+        return value <= node.threshold;
+      case BranchLt:
+        return value < node.threshold;
+      case BranchGte:
+        return value >= node.threshold;
+      case BranchGt:
+        return value > node.threshold;
+      case BranchEq:
+        return value == node.threshold;
+      case BranchNeq:
+        return value != node.threshold;
+      default:
+        return false;
+    }
+  }
+
+  int finalizeScores(float* scores, const uint8_t* hasScore, float* output) const;
+  void applyPostTransform(float* scores, const int nScores) const;
+  static float computeLogistic(const float value);
+};
+
+} // namespace ml
+
+} // namespace o2
+
+#endif // TOOLS_ML_TREEENSEMBLE_H_
@@ -123,6 +123,8 @@ struct PidONNXModel {
 
     // Assume model has 1 input node and 1 output node.
     assert(mInputNames.size() == 1 && mOutputNames.size() == 1);
+
+    bindBuffers();
   }
   PidONNXModel() = default;
   PidONNXModel(PidONNXModel&&) = default;
@@ -214,10 +216,10 @@ struct PidONNXModel {
     return (value - scalingParams.first) / scalingParams.second;
   }
 
-  std::vector<float> getValues(const typename T::iterator& track)
+  // Fills the pre-bound input buffer, whose capacity is reserved at construction, so no reallocation happens
+  void getValues(const typename T::iterator& track, std::vector<float>& output)
   {
-    std::vector<float> output;
-    output.reserve(mTrainColumns.size());
+    output.clear();
 
     bool useTOF = !pidml::pidutils::tofMissing(track) && pidml::pidutils::inPLimit(track, mPLimits[kTPCTOF]);
     bool useTRD = !pidml::pidutils::trdMissing(track) && pidml::pidutils::inPLimit(track, mPLimits[kTPCTOFTRD]);
@@ -247,11 +249,11 @@ struct PidONNXModel {
 
       output.push_back(value);
     }
-
-    return output;
   }
 
-  float getModelOutput(const typename T::iterator& track)
+  // Input and output tensors are views on buffers owned by the model, bound once to the session (IoBinding),
+  // so that no allocation happens per track. Vector buffers keep their storage when the model is moved.
+  void bindBuffers()
   {
     // First rank of the expected model input is -1 which means that it is dynamic axis.
     // Axis is exported as dynamic to make it possible to run model inference with the batch of
@@ -260,36 +262,38 @@ struct PidONNXModel {
     static constexpr int64_t BatchSize = 1;
     auto inputShape = mInputShapes[0];
     inputShape[0] = BatchSize;
+    auto outputShape = mOutputShapes[0];
+    outputShape[0] = BatchSize;
 
-    std::vector<float> inputTensorValues = getValues(track);
-    std::vector<Ort::Value> inputTensors;
+    mInputBuffer.assign(mTrainColumns.size(), 0.f);
+    mOutputBuffer.assign(1, 0.f);
+    for (size_t i = 1; i < outputShape.size(); ++i) {
+      mOutputBuffer.resize(mOutputBuffer.size() * outputShape[i]);
+    }
 
     Ort::MemoryInfo memInfo = Ort::MemoryInfo::CreateCpu(OrtAllocatorType::OrtArenaAllocator, OrtMemType::OrtMemTypeDefault);
-    inputTensors.emplace_back(Ort::Value::CreateTensor<float>(memInfo, inputTensorValues.data(), inputTensorValues.size(), inputShape.data(), inputShape.size()));
+    mInputTensor = Ort::Value::CreateTensor<float>(memInfo, mInputBuffer.data(), mInputBuffer.size(), inputShape.data(), inputShape.size());
+    mOutputTensor = Ort::Value::CreateTensor<float>(memInfo, mOutputBuffer.data(), mOutputBuffer.size(), outputShape.data(), outputShape.size());
 
     // Double-check the dimensions of the input tensor
-    assert(inputTensors[0].IsTensor() &&
-           inputTensors[0].GetTensorTypeAndShapeInfo().GetShape() == inputShape);
-    LOG(debug) << "input tensor shape: " << printShape(inputTensors[0].GetTensorTypeAndShapeInfo().GetShape());
+    assert(mInputTensor.IsTensor() &&
+           mInputTensor.GetTensorTypeAndShapeInfo().GetShape() == inputShape);
+    LOG(debug) << "input tensor shape: " << printShape(mInputTensor.GetTensorTypeAndShapeInfo().GetShape());
+
+    mIoBinding = std::make_shared<Ort::IoBinding>(*mSession);
+    mIoBinding->BindInput(mInputNames[0].c_str(), mInputTensor);
+    mIoBinding->BindOutput(mOutputNames[0].c_str(), mOutputTensor);
+  }
+
+  float getModelOutput(const typename T::iterator& track)
+  {
+    getValues(track, mInputBuffer);
 
     try {
-      Ort::RunOptions runOptions;
-      std::vector<const char*> inputNamesChar(mInputNames.size(), nullptr);
-      std::transform(std::begin(mInputNames), std::end(mInputNames), std::begin(inputNamesChar),
-                     [&](const std::string& str) { return str.c_str(); });
-
-      std::vector<const char*> outputNamesChar(mOutputNames.size(), nullptr);
-      std::transform(std::begin(mOutputNames), std::end(mOutputNames), std::begin(outputNamesChar),
-                     [&](const std::string& str) { return str.c_str(); });
-      auto outputTensors = mSession->Run(runOptions, inputNamesChar.data(), inputTensors.data(), inputTensors.size(), outputNamesChar.data(), outputNamesChar.size());
-
-      // Double-check the dimensions of the output tensors
-      // The number of output tensors is equal to the number of output nodes specified in the Run() call
-      assert(outputTensors.size() == mOutputNames.size() && outputTensors[0].IsTensor());
-      LOG(debug) << "output tensor shape: " << printShape(outputTensors[0].GetTensorTypeAndShapeInfo().GetShape());
-
-      const float* outputValue = outputTensors[0].GetTensorData<float>();
-      float certainty = *outputValue;
+      mSession->Run(mRunOptions, *mIoBinding);
+      LOG(debug) << "output tensor shape: " << printShape(mOutputTensor.GetTensorTypeAndShapeInfo().GetShape());
+
+      float certainty = mOutputBuffer[0];
       return certainty;
     } catch (const Ort::Exception& exception) {
       LOG(error) << "Error running model inference: " << exception.what();
@@ -320,6 +324,14 @@ struct PidONNXModel {
   std::vector<std::vector<int64_t>> mInputShapes;
   std::vector<std::string> mOutputNames;
   std::vector<std::vector<int64_t>> mOutputShapes;
+
+  // Pre-allocated input and output buffers bound to the session
+  std::vector<float> mInputBuffer;
+  std::vector<float> mOutputBuffer;
+  Ort::Value mInputTensor{nullptr};
+  Ort::Value mOutputTensor{nullptr};
+  Ort::RunOptions mRunOptions;
+  std::shared_ptr<Ort::IoBinding> mIoBinding = nullptr;
 };
 
 #endif // TOOLS_PIDML_PIDONNXMODEL_H_